@@ -2,15 +2,22 @@
 include(CMakeParseArguments)
 
 function(paludis_add_test test_name)
-  set(options BASH GTEST PYTHON RUBY)
+  set(options BASH BENCHMARK GTEST PYTHON RUBY)
   set(single_value_args EBUILD_MODULE_SUFFIXES TEST_RUNNER)
   set(multiple_value_args LINK_LIBRARIES)
 
   cmake_parse_arguments(PAT "${options}" "${single_value_args}" "${multiple_value_args}" ${ARGN})
 
-  string(REGEX MATCH "_TEST" has_TEST ${test_name})
-  if(NOT has_TEST)
-    set(test_name ${test_name}_TEST)
+  if(PAT_BENCHMARK)
+    if(NOT ENABLE_BENCHMARKS)
+      return()
+    endif()
+    set(test_name ${test_name}_BENCHMARK)
+  else()
+    string(REGEX MATCH "_TEST" has_TEST ${test_name})
+    if(NOT has_TEST)
+      set(test_name ${test_name}_TEST)
+    endif()
   endif()
 
   if(PAT_GTEST AND NOT ENABLE_GTEST)
@@ -30,6 +37,12 @@ function(paludis_add_test test_name)
                             GTest::Main
                             GTest::gmock
                             ${PAT_LINK_LIBRARIES})
+  elseif(PAT_BENCHMARK AND NOT PAT_BASH)
+    target_link_libraries(${test_name}
+                          PRIVATE
+                            libpaludis
+                            libpaludisutil
+                            ${PAT_LINK_LIBRARIES})
   endif()
 
   set(pat_test_runner "${PROJECT_SOURCE_DIR}/paludis/util/run_test.sh")
@@ -43,6 +56,10 @@ function(paludis_add_test test_name)
   endif()
 
   string(REGEX REPLACE "_TEST" "" pat_display_name ${test_name})
+  if(PAT_BENCHMARK)
+    string(REGEX REPLACE "_BENCHMARK" "" pat_display_name ${test_name})
+    set(pat_display_name "benchmark_${pat_display_name}")
+  endif()
 
   set(pat_test_extension "")
   if(PAT_PYTHON)
@@ -101,5 +118,11 @@ function(paludis_add_test test_name)
                     SYDBOX_ACTIVE=\${SYDBOX_ACTIVE}
                     ${pat_environment_variables}
              "${BASH_EXECUTABLE}" ${pat_test_runner} "${pat_test_binary}")
+
+  if(PAT_BENCHMARK)
+    # NOTE benchmarks are only built with ENABLE_BENCHMARKS, and can be run on
+    # their own using `ctest -L benchmark`
+    set_tests_properties(${pat_display_name} PROPERTIES LABELS benchmark)
+  endif()
 endfunction()
 
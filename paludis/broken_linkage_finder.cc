@@ -28,7 +28,6 @@
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/set-impl.hh>
 #include <paludis/util/sequence-impl.hh>
-#include <paludis/util/visitor_cast.hh>
 #include <paludis/util/wrapped_forward_iterator-impl.hh>
 #include <paludis/util/member_iterator-impl.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
@@ -36,8 +35,9 @@
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_error.hh>
 #include <paludis/util/join.hh>
+#include <paludis/util/thread_pool.hh>
 
-#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/environment.hh>
 #include <paludis/metadata_key.hh>
 #include <paludis/package_id.hh>
@@ -45,13 +45,19 @@
 #include <paludis/filter.hh>
 #include <paludis/filtered_generator.hh>
 #include <paludis/selection.hh>
+#include <paludis/repository.hh>
 #include <paludis/notifier_callback.hh>
 
 #include <functional>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iterator>
+#include <list>
 #include <map>
 #include <set>
+#include <thread>
 #include <vector>
 #include <mutex>
 
@@ -75,9 +81,21 @@ namespace paludis
 
         std::mutex mutex;
 
+        /* files and directories waiting to be checked, shared between as
+         * many threads as will help */
+        std::mutex pending_mutex;
+        std::condition_variable pending_condition;
+        std::deque<FSPath> pending;
+        unsigned busy;
+        std::exception_ptr failure;
+
         bool has_files;
         Files files;
 
+        /* repositories that can look up owners themselves, so whose IDs'
+         * contents aren't put into files */
+        std::list<std::shared_ptr<const Repository> > indexed_repositories;
+
         Breakage breakage;
         PackageBreakage orphan_breakage;
 
@@ -86,6 +104,9 @@ namespace paludis
         void walk_directory(const FSPath &);
         void check_file(const FSPath &);
 
+        void check_pending();
+        void check_pending_in_this_thread();
+
         void add_breakage(const FSPath &, const std::string &);
         void gather_package(const std::shared_ptr<const PackageID> &);
 
@@ -93,6 +114,7 @@ namespace paludis
             env(the_env),
             config(the_env->preferred_root_key()->parse_value()),
             libraries(the_libraries),
+            busy(0),
             has_files(false)
         {
         }
@@ -142,13 +164,20 @@ namespace
 }
 
 BrokenLinkageFinder::BrokenLinkageFinder(const Environment * env, const std::shared_ptr<const Sequence<std::string>> & libraries) :
+    BrokenLinkageFinder(env, libraries, FSPath("/var/empty"))
+{
+}
+
+BrokenLinkageFinder::BrokenLinkageFinder(const Environment * env, const std::shared_ptr<const Sequence<std::string>> & libraries,
+        const FSPath & cache_file) :
     _imp(env, libraries)
 {
     using namespace std::placeholders;
 
     Context ctx("When checking for broken linkage in '" + stringify(env->preferred_root_key()->parse_value()) + "':");
 
-    _imp->checkers.push_back(std::make_shared<ElfLinkageChecker>(env->preferred_root_key()->parse_value(), libraries));
+    auto elf_checker(std::make_shared<ElfLinkageChecker>(env->preferred_root_key()->parse_value(), libraries, cache_file));
+    _imp->checkers.push_back(elf_checker);
     if (libraries->empty())
         _imp->checkers.push_back(std::make_shared<LibtoolLinkageChecker>(env->preferred_root_key()->parse_value()));
 
@@ -173,6 +202,8 @@ BrokenLinkageFinder::BrokenLinkageFinder(const Environment * env, const std::sha
 
     std::for_each(search_dirs_pruned.begin(), search_dirs_pruned.end(),
                       std::bind(&Imp<BrokenLinkageFinder>::search_directory, _imp.get(), _1));
+    _imp->check_pending();
+    elf_checker->save_cache();
 
     for (const auto & dir : _imp->extra_lib_dirs)
     {
@@ -240,8 +271,11 @@ Imp<BrokenLinkageFinder>::walk_directory(const FSPath & directory)
 
     try
     {
-        std::for_each(FSIterator(directory, { fsio_include_dotfiles, fsio_inode_sort }), FSIterator(),
-                std::bind(&Imp<BrokenLinkageFinder>::check_file, this, _1));
+        std::vector<FSPath> entries(FSIterator(directory, { fsio_include_dotfiles, fsio_inode_sort }), FSIterator());
+
+        std::unique_lock<std::mutex> l(pending_mutex);
+        pending.insert(pending.end(), entries.begin(), entries.end());
+        pending_condition.notify_all();
     }
     catch (const FSError & ex)
     {
@@ -249,6 +283,69 @@ Imp<BrokenLinkageFinder>::walk_directory(const FSPath & directory)
     }
 }
 
+void
+Imp<BrokenLinkageFinder>::check_pending()
+{
+    unsigned n_threads(std::max(1u, std::thread::hardware_concurrency()));
+    if (n_threads <= 1)
+        check_pending_in_this_thread();
+    else
+    {
+        ThreadPool pool;
+        for (unsigned t(0) ; t != n_threads ; ++t)
+            pool.create_thread(std::bind(&Imp<BrokenLinkageFinder>::check_pending_in_this_thread, this));
+    }
+
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+void
+Imp<BrokenLinkageFinder>::check_pending_in_this_thread()
+{
+    /* take a few at a time, so that we aren't fighting over the lock for
+     * every file in a big directory */
+    const std::size_t batch_size(32);
+
+    std::vector<FSPath> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> l(pending_mutex);
+            pending_condition.wait(l, [&] () { return failure || (! pending.empty()) || 0 == busy; });
+
+            /* nothing left, and nobody who could add more */
+            if (failure || pending.empty())
+            {
+                pending_condition.notify_all();
+                return;
+            }
+
+            std::size_t n(std::min(batch_size, pending.size()));
+            batch.assign(pending.begin(), std::next(pending.begin(), n));
+            pending.erase(pending.begin(), std::next(pending.begin(), n));
+            ++busy;
+        }
+
+        std::exception_ptr e;
+        try
+        {
+            for (const auto & file : batch)
+                check_file(file);
+        }
+        catch (...)
+        {
+            e = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> l(pending_mutex);
+        --busy;
+        if (e && ! failure)
+            failure = e;
+        pending_condition.notify_all();
+    }
+}
+
 void
 Imp<BrokenLinkageFinder>::check_file(const FSPath & file)
 {
@@ -305,20 +402,42 @@ Imp<BrokenLinkageFinder>::add_breakage(const FSPath & file, const std::string &
         std::shared_ptr<const PackageIDSequence> ids((*env)[selection::AllVersionsUnsorted(
                     generator::All() | filter::InstalledAtRoot(env->preferred_root_key()->parse_value()))]);
 
-        std::for_each(ids->begin(), ids->end(),
-                std::bind(&Imp<BrokenLinkageFinder>::gather_package, this, _1));
+        std::set<RepositoryName> seen_repositories;
+        for (const auto & id : *ids)
+        {
+            auto repo(env->fetch_repository(id->repository_name()));
+            if (repo->file_owner_interface())
+            {
+                if (seen_repositories.insert(repo->name()).second)
+                    indexed_repositories.push_back(repo);
+            }
+            else
+                gather_package(id);
+        }
     }
 
     FSPath without_root(file.strip_leading(env->preferred_root_key()->parse_value()));
+    bool owned(false);
+
     std::pair<Files::const_iterator, Files::const_iterator> range(files.equal_range(without_root));
-    if (range.first == range.second)
-        orphan_breakage[without_root].insert(req);
-    else
-        while (range.first != range.second)
+    for ( ; range.first != range.second ; ++range.first)
+    {
+        breakage[range.first->second][without_root].insert(req);
+        owned = true;
+    }
+
+    for (const auto & repo : indexed_repositories)
+    {
+        auto owners(repo->file_owner_interface()->file_owners(without_root));
+        for (const auto & id : *owners)
         {
-            breakage[range.first->second][without_root].insert(req);
-            ++range.first;
+            breakage[id][without_root].insert(req);
+            owned = true;
         }
+    }
+
+    if (! owned)
+        orphan_breakage[without_root].insert(req);
 }
 
 void
@@ -328,18 +447,13 @@ Imp<BrokenLinkageFinder>::gather_package(const std::shared_ptr<const PackageID>
 
     Context ctx("When gathering the contents of " + stringify(*pkg) + ":");
 
-    auto contents(pkg->contents());
-    if (! contents)
-        return;
-
-    for (const auto & content : *contents)
-    {
-        if (const auto *file = visitor_cast<const ContentsFileEntry>(*content))
-        {
-            std::unique_lock<std::mutex> l(mutex);
-            files.insert(std::make_pair(file->location_key()->parse_value(), pkg));
-        }
-    }
+    pkg->for_each_contents_entry([&] (const PackedContentsEntry & e) {
+            if (pcet_file == e.type)
+            {
+                std::unique_lock<std::mutex> l(mutex);
+                files.insert(std::make_pair(FSPath(std::string(e.path)), pkg));
+            }
+        });
 
     pkg->can_drop_in_memory_cache();
 }
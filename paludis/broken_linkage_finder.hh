@@ -41,6 +41,16 @@ namespace paludis
 
         public:
             BrokenLinkageFinder(const Environment *, const std::shared_ptr<const Sequence<std::string>> &);
+
+            /**
+             * Remember what was found in each ELF file in the specified
+             * cache file, which may be <code>/var/empty</code>, so that later
+             * runs need only read files that have changed.
+             *
+             * \since 3.0
+             */
+            BrokenLinkageFinder(const Environment *, const std::shared_ptr<const Sequence<std::string>> &, const FSPath &);
+
             ~BrokenLinkageFinder();
 
             BrokenLinkageFinder(const BrokenLinkageFinder &) = delete;
@@ -32,7 +32,7 @@ using namespace paludis;
 std::shared_ptr<const DependencySpecTree>
 CommaSeparatedDepParser::parse(const Environment * const env, const std::string & s)
 {
-    Context context("When parsing '" + s + "':");
+    LazyContext context([&] () { return "When parsing '" + s + "':"; });
 
     std::shared_ptr<DependencySpecTree> result(std::make_shared<DependencySpecTree>(std::make_shared<AllDepSpec>()));
 
@@ -42,7 +42,7 @@ CommaSeparatedDepParser::parse(const Environment * const env, const std::string
     for (const auto & token : tokens)
     {
         std::string a(strip_leading(strip_trailing(token, " \t\r\n"), " \t\r\n"));
-        Context local_context("When parsing token '" + a + "':");
+        LazyContext local_context([&] () { return "When parsing token '" + a + "':"; });
 
         if (a.empty())
             continue;
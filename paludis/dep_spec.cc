@@ -548,7 +548,7 @@ PackageDepSpec::~PackageDepSpec() = default;
 
 PackageDepSpec::PackageDepSpec(const PackageDepSpec & d) :
     Cloneable<DepSpec>(d),
-    StringDepSpec(d._imp->data->as_string()),
+    StringDepSpec(d.text()),
     CloneUsingThis<DepSpec, PackageDepSpec>(d),
     _imp(d._imp->data)
 {
@@ -0,0 +1,285 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/dependents_index.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/tokeniser.hh>
+#include <paludis/util/safe_ifstream.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace paludis;
+
+namespace
+{
+    const std::string format_line("paludis-dependents-1");
+
+    struct Entry
+    {
+        Timestamp stamp;
+        std::vector<std::string> names;
+        bool anything;
+    };
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<DependentsIndex>
+    {
+        const FSPath filename;
+
+        mutable std::mutex mutex;
+
+        mutable bool loaded;
+        bool changed;
+
+        /* read the first time anything is wanted */
+        mutable std::map<std::string, Entry> entries;
+
+        /* entries, turned around */
+        mutable std::map<std::string, std::set<std::string> > dependents_by_name;
+        mutable std::set<std::string> depend_upon_anything;
+
+        Imp(const FSPath & f) :
+            filename(f),
+            loaded(false),
+            changed(false)
+        {
+        }
+
+        void add(const std::string & dependent, const Entry & entry) const
+        {
+            for (const auto & n : entry.names)
+                dependents_by_name[n].insert(dependent);
+            if (entry.anything)
+                depend_upon_anything.insert(dependent);
+            entries.insert(std::make_pair(dependent, entry));
+        }
+
+        void remove(const std::string & dependent) const
+        {
+            auto e(entries.find(dependent));
+            if (entries.end() == e)
+                return;
+
+            for (const auto & n : e->second.names)
+            {
+                auto d(dependents_by_name.find(n));
+                d->second.erase(dependent);
+                if (d->second.empty())
+                    dependents_by_name.erase(d);
+            }
+            depend_upon_anything.erase(dependent);
+            entries.erase(e);
+        }
+
+        void need_loaded() const
+        {
+            if (loaded)
+                return;
+            loaded = true;
+
+            if (! filename.stat().is_regular_file())
+                return;
+
+            Context context("When reading dependents index '" + stringify(filename) + "':");
+
+            try
+            {
+                SafeIFStream s(filename);
+                std::string line;
+                if (! (std::getline(s, line) && line == format_line))
+                {
+                    Log::get_instance()->message("dependents_index.format", ll_warning, lc_context)
+                        << "File is not a dependents index in a format we understand";
+                    return;
+                }
+
+                /* dependent, a tab, then the stamp, whether it depends upon
+                 * anything, and the names */
+                while (std::getline(s, line))
+                {
+                    std::string::size_type tab(line.find('\t'));
+                    std::vector<std::string> tokens;
+                    if (std::string::npos != tab)
+                        tokenise_whitespace(line.substr(tab + 1), std::back_inserter(tokens));
+                    if (tokens.size() < 3)
+                    {
+                        Log::get_instance()->message("dependents_index.bad_line", ll_warning, lc_context)
+                            << "Ignoring the rest of the index after bad line '" << line << "'";
+                        return;
+                    }
+
+                    add(line.substr(0, tab), Entry{
+                            Timestamp(destringify<time_t>(tokens[0]), destringify<long>(tokens[1])),
+                            std::vector<std::string>(std::next(tokens.begin(), 3), tokens.end()),
+                            "1" == tokens[2] });
+                }
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("dependents_index.bad", ll_warning, lc_context)
+                    << "Ignoring the index because of error '" << e.message() << "' (" << e.what() << ")";
+                entries.clear();
+                dependents_by_name.clear();
+                depend_upon_anything.clear();
+            }
+        }
+
+        void write(const LogLevel failure_log_level)
+        {
+            need_loaded();
+            if (! changed)
+                return;
+
+            Context context("When writing dependents index '" + stringify(filename) + "':");
+
+            if (! filename.dirname().stat().is_directory_or_symlink_to_directory())
+            {
+                Log::get_instance()->message("dependents_index.save.no_dir", failure_log_level, lc_no_context) << "Directory '"
+                    << filename.dirname() << "' does not exist, so cannot save dependents index '" << filename << "'";
+                return;
+            }
+
+            /* written to a new file and renamed over the old one, so nobody
+             * ever reads half an index */
+            FSPath tmp(filename.dirname() / (filename.basename() + ".new." + stringify(::getpid())));
+            try
+            {
+                {
+                    SafeOFStream s(tmp, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, true);
+                    s << format_line << std::endl;
+                    for (const auto & e : entries)
+                    {
+                        s << e.first << '\t' << e.second.stamp.seconds() << ' ' << e.second.stamp.nanoseconds()
+                            << ' ' << (e.second.anything ? 1 : 0);
+                        for (const auto & n : e.second.names)
+                            s << ' ' << n;
+                        s << std::endl;
+                    }
+                }
+
+                tmp.rename(filename);
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("dependents_index.save.failure", failure_log_level, lc_no_context)
+                    << "Couldn't write dependents index to '" << filename << "': " << e.message() << " (" << e.what() << ")";
+
+                try
+                {
+                    if (tmp.stat().exists())
+                        tmp.unlink();
+                }
+                catch (const FSError &)
+                {
+                }
+                return;
+            }
+
+            changed = false;
+        }
+    };
+}
+
+DependentsIndex::DependentsIndex(const FSPath & f) :
+    _imp(f)
+{
+}
+
+DependentsIndex::~DependentsIndex() = default;
+
+const FSPath
+DependentsIndex::filename() const
+{
+    return _imp->filename;
+}
+
+std::map<std::string, Timestamp>
+DependentsIndex::stamps() const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    std::map<std::string, Timestamp> result;
+    for (const auto & e : _imp->entries)
+        result.insert(std::make_pair(e.first, e.second.stamp));
+    return result;
+}
+
+void
+DependentsIndex::replace(const std::string & dependent, const Timestamp & stamp,
+        const std::vector<std::string> & names, const bool depends_upon_anything)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    std::vector<std::string> sorted_names(names);
+    std::sort(sorted_names.begin(), sorted_names.end());
+    sorted_names.erase(std::unique(sorted_names.begin(), sorted_names.end()), sorted_names.end());
+
+    _imp->remove(dependent);
+    _imp->add(dependent, Entry{ stamp, sorted_names, depends_upon_anything });
+    _imp->changed = true;
+}
+
+void
+DependentsIndex::remove(const std::string & dependent)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    _imp->remove(dependent);
+    _imp->changed = true;
+}
+
+std::vector<std::string>
+DependentsIndex::dependents_of(const std::string & name) const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    std::set<std::string> result(_imp->depend_upon_anything);
+    auto d(_imp->dependents_by_name.find(name));
+    if (_imp->dependents_by_name.end() != d)
+        result.insert(d->second.begin(), d->second.end());
+    return std::vector<std::string>(result.begin(), result.end());
+}
+
+void
+DependentsIndex::write(const LogLevel failure_log_level)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->write(failure_log_level);
+}
+
+namespace paludis
+{
+    template class Pimp<DependentsIndex>;
+}
@@ -0,0 +1,121 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PALUDIS_GUARD_PALUDIS_DEPENDENTS_INDEX_HH
+#define PALUDIS_GUARD_PALUDIS_DEPENDENTS_INDEX_HH 1
+
+#include <paludis/dependents_index-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/log.hh>
+#include <map>
+#include <string>
+#include <vector>
+
+/** \file
+ * Declarations for DependentsIndex, which is used by some Repository
+ * subclasses to implement RepositoryDependentsInterface.
+ *
+ * \ingroup g_repository
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A persistent index from package names to whatever has a dependency
+     * upon something with that name.
+     *
+     * As with FileOwnerIndex, dependents are opaque strings chosen by the
+     * repository, and each has a stamp that the repository can use to decide
+     * whether its entries are stale. A dependent can also be recorded as
+     * possibly depending upon anything at all, for example because it
+     * depends upon a set, in which case it is returned for every name.
+     *
+     * The whole file is read the first time it is needed. Changes are kept
+     * in memory, and are visible to queries immediately, until write() is
+     * called.
+     *
+     * \see RepositoryDependentsInterface
+     * \ingroup g_repository
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE DependentsIndex
+    {
+        private:
+            Pimp<DependentsIndex> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit DependentsIndex(const FSPath & filename);
+            ~DependentsIndex();
+
+            DependentsIndex(const DependentsIndex &) = delete;
+            DependentsIndex & operator= (const DependentsIndex &) = delete;
+
+            ///\}
+
+            const FSPath filename() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\name Index operations
+            ///\{
+
+            /**
+             * Every dependent in the index, along with its stamp.
+             */
+            std::map<std::string, Timestamp> stamps() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Replace everything recorded for a dependent.
+             */
+            void replace(const std::string & dependent, const Timestamp & stamp,
+                    const std::vector<std::string> & names, const bool depends_upon_anything);
+
+            /**
+             * Remove a dependent.
+             */
+            void remove(const std::string & dependent);
+
+            /**
+             * Everything that might depend upon something with the specified
+             * name, sorted.
+             */
+            std::vector<std::string> dependents_of(const std::string & name) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Write out the file, if anything has changed.
+             *
+             * Failure is logged at the specified level, and leaves the
+             * changes in memory.
+             */
+            void write(const LogLevel failure_log_level);
+
+            ///\}
+    };
+
+    extern template class Pimp<DependentsIndex>;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <paludis/dependents_index.hh>
+
+#include <paludis/util/join.hh>
+#include <paludis/util/fs_stat.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    std::string dependents(const std::vector<std::string> & v)
+    {
+        return join(v.begin(), v.end(), " ");
+    }
+}
+
+TEST(DependentsIndex, NotExisting)
+{
+    DependentsIndex index(FSPath("dependents_index_TEST_dir/not_existing"));
+    EXPECT_TRUE(index.stamps().empty());
+    EXPECT_EQ("", dependents(index.dependents_of("cat/pkg")));
+}
+
+TEST(DependentsIndex, NotAnIndex)
+{
+    DependentsIndex index(FSPath("dependents_index_TEST_dir/not_an_index"));
+    EXPECT_TRUE(index.stamps().empty());
+    EXPECT_EQ("", dependents(index.dependents_of("cat/pkg")));
+}
+
+TEST(DependentsIndex, Queries)
+{
+    DependentsIndex index(FSPath("dependents_index_TEST_dir/queries"));
+    index.replace("one", Timestamp(1, 0), { "dev-libs/a", "dev-libs/b", "dev-libs/a" }, false);
+    index.replace("two", Timestamp(2, 0), { "dev-libs/b" }, false);
+    index.replace("three", Timestamp(3, 0), { }, true);
+
+    EXPECT_EQ("one three", dependents(index.dependents_of("dev-libs/a")));
+    EXPECT_EQ("one three two", dependents(index.dependents_of("dev-libs/b")));
+    EXPECT_EQ("three", dependents(index.dependents_of("dev-libs/c")));
+
+    index.replace("one", Timestamp(4, 0), { "dev-libs/c" }, false);
+    EXPECT_EQ("three", dependents(index.dependents_of("dev-libs/a")));
+    EXPECT_EQ("one three", dependents(index.dependents_of("dev-libs/c")));
+
+    index.remove("three");
+    EXPECT_EQ("two", dependents(index.dependents_of("dev-libs/b")));
+    EXPECT_EQ("", dependents(index.dependents_of("dev-libs/a")));
+}
+
+TEST(DependentsIndex, Persistence)
+{
+    {
+        DependentsIndex index(FSPath("dependents_index_TEST_dir/persistence"));
+        index.replace("one", Timestamp(1, 10), { "dev-libs/a" }, false);
+        index.replace("two with spaces", Timestamp(2, 20), { "dev-libs/a", "dev-libs/b" }, true);
+        index.write(ll_warning);
+    }
+
+    EXPECT_TRUE(FSPath("dependents_index_TEST_dir/persistence").stat().is_regular_file());
+
+    {
+        DependentsIndex index(FSPath("dependents_index_TEST_dir/persistence"));
+        auto stamps(index.stamps());
+        ASSERT_EQ(2u, stamps.size());
+        EXPECT_TRUE(Timestamp(1, 10) == stamps.find("one")->second);
+        EXPECT_TRUE(Timestamp(2, 20) == stamps.find("two with spaces")->second);
+
+        EXPECT_EQ("one two with spaces", dependents(index.dependents_of("dev-libs/a")));
+        EXPECT_EQ("two with spaces", dependents(index.dependents_of("dev-libs/z")));
+
+        index.remove("two with spaces");
+        index.write(ll_warning);
+    }
+
+    {
+        DependentsIndex index(FSPath("dependents_index_TEST_dir/persistence"));
+        EXPECT_EQ(1u, index.stamps().size());
+        EXPECT_EQ("one", dependents(index.dependents_of("dev-libs/a")));
+        EXPECT_EQ("", dependents(index.dependents_of("dev-libs/b")));
+    }
+}
+
+TEST(DependentsIndex, NoDirectory)
+{
+    DependentsIndex index(FSPath("dependents_index_TEST_dir/no_directory/index"));
+    index.replace("one", Timestamp(1, 0), { "dev-libs/a" }, false);
+    index.write(ll_debug);
+
+    EXPECT_TRUE(! FSPath("dependents_index_TEST_dir/no_directory/index").stat().exists());
+    EXPECT_EQ("one", dependents(index.dependents_of("dev-libs/a")));
+}
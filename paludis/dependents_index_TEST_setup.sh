@@ -0,0 +1,7 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir dependents_index_TEST_dir || exit 1
+cd dependents_index_TEST_dir || exit 1
+
+echo "not an index" > not_an_index
@@ -35,17 +35,28 @@
 #include <paludis/util/visitor_cast.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/safe_ifstream.hh>
+#include <paludis/util/safe_ofstream.hh>
 #include <paludis/util/fs_path.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/tokeniser.hh>
+#include <paludis/util/destringify.hh>
 
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <istream>
 #include <map>
 #include <set>
+#include <streambuf>
 #include <vector>
 #include <mutex>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace paludis;
 
 namespace
@@ -83,6 +94,14 @@ namespace
             _mips_n32(EM_MIPS == _machine && MIPS_ABI2 & elf.get_flags())
         {
         }
+
+        ElfArchitecture(unsigned machine, unsigned char elf_class, bool bigendian, bool mips_n32) :
+            _machine(machine),
+            _class(elf_class),
+            _bigendian(bigendian),
+            _mips_n32(mips_n32)
+        {
+        }
     };
 
     bool
@@ -96,6 +115,124 @@ namespace
             return _bigendian < other._bigendian;
         return _mips_n32 < other._mips_n32;
     }
+
+    /* everything we need to know about a file, so that it needn't be read
+     * again until it changes */
+    struct ElfFileInfo
+    {
+        enum Kind
+        {
+            not_elf,
+            not_interesting,
+            executable,
+            library,
+            invalid
+        };
+
+        Kind kind;
+        ElfArchitecture arch;
+        std::vector<std::string> needed;
+
+        ElfFileInfo() :
+            kind(not_elf),
+            arch(0, 0, false, false)
+        {
+        }
+    };
+
+    struct ElfCacheKey
+    {
+        dev_t device;
+        ino_t inode;
+
+        bool operator< (const ElfCacheKey & other) const
+        {
+            if (device != other.device)
+                return device < other.device;
+            return inode < other.inode;
+        }
+    };
+
+    struct ElfCacheEntry
+    {
+        std::string mtime;
+        off_t size;
+        ElfFileInfo info;
+    };
+
+    typedef std::map<ElfCacheKey, ElfCacheEntry> ElfCache;
+
+    const std::string cache_format("paludis-elf-cache-1");
+
+    std::string mtime_string(const FSStat & s)
+    {
+        return stringify(s.mtim().seconds()) + "." + stringify(s.mtim().nanoseconds());
+    }
+
+    /* an istream over a memory mapped file, so that ElfObject's reads are
+     * copies out of the page cache rather than read calls */
+    class MappedFileBuf :
+        public std::streambuf
+    {
+        private:
+            void * _data;
+            std::size_t _size;
+
+        public:
+            MappedFileBuf(void * data, std::size_t size) :
+                _data(data),
+                _size(size)
+            {
+                char * c(static_cast<char *>(_data));
+                setg(c, c, c + _size);
+            }
+
+            ~MappedFileBuf() override
+            {
+                ::munmap(_data, _size);
+            }
+
+            MappedFileBuf(const MappedFileBuf &) = delete;
+            MappedFileBuf & operator= (const MappedFileBuf &) = delete;
+
+        protected:
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+            {
+                if (! (which & std::ios_base::in))
+                    return pos_type(off_type(-1));
+
+                off_type base(std::ios_base::beg == dir ? 0 : std::ios_base::cur == dir ? gptr() - eback() : egptr() - eback());
+                if (base + off < 0 || base + off > egptr() - eback())
+                    return pos_type(off_type(-1));
+
+                setg(eback(), eback() + base + off, egptr());
+                return pos_type(base + off);
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+            {
+                return seekoff(off_type(pos), std::ios_base::beg, which);
+            }
+    };
+
+    /* null if the file is empty or can't be mapped, in which case it should
+     * be read normally */
+    std::shared_ptr<MappedFileBuf> map_file(const FSPath & file)
+    {
+        int fd(::open(stringify(file).c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY));
+        if (-1 == fd)
+            return nullptr;
+
+        struct ::stat st;
+        void * data(MAP_FAILED);
+        if (0 == ::fstat(fd, &st) && 0 < st.st_size)
+            data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (MAP_FAILED == data)
+            return nullptr;
+        return std::make_shared<MappedFileBuf>(data, st.st_size);
+    }
 }
 
 typedef std::multimap<FSPath, FSPath, FSPathComparator> Symlinks;
@@ -109,8 +246,13 @@ namespace paludis
         FSPath root;
         std::set<std::string> check_libraries;
 
+        FSPath cache_file;
+        ElfCache old_cache;
+
         std::mutex mutex;
 
+        ElfCache new_cache;
+
         std::map<FSPath, ElfArchitecture, FSPathComparator> seen;
         Symlinks symlinks;
 
@@ -119,12 +261,17 @@ namespace paludis
 
         std::vector<FSPath> extra_lib_dirs;
 
-        template <typename> bool check_elf(const FSPath &, std::istream &);
+        template <typename> bool check_elf(const FSPath &, std::istream &, ElfFileInfo &);
+        void add_file(const FSPath &, const ElfFileInfo &);
         void handle_library(const FSPath &, const ElfArchitecture &);
         template <typename> bool check_extra_elf(const FSPath &, std::istream &, std::set<ElfArchitecture> &);
 
-        Imp(const FSPath & the_root, const std::shared_ptr<const Sequence<std::string>> & the_libraries) :
-            root(the_root)
+        void load_cache();
+
+        Imp(const FSPath & the_root, const std::shared_ptr<const Sequence<std::string>> & the_libraries,
+                const FSPath & c) :
+            root(the_root),
+            cache_file(c)
         {
             for (const auto & library : *the_libraries)
                 check_libraries.insert(library);
@@ -132,29 +279,155 @@ namespace paludis
     };
 }
 
-ElfLinkageChecker::ElfLinkageChecker(const FSPath & root, const std::shared_ptr<const Sequence<std::string>> & libraries) :
-    _imp(root, libraries)
+ElfLinkageChecker::ElfLinkageChecker(const FSPath & root, const std::shared_ptr<const Sequence<std::string>> & libraries,
+        const FSPath & cache_file) :
+    _imp(root, libraries, cache_file)
 {
+    _imp->load_cache();
 }
 
 ElfLinkageChecker::~ElfLinkageChecker() = default;
 
+void
+Imp<ElfLinkageChecker>::load_cache()
+{
+    if (cache_file == FSPath("/var/empty") || ! cache_file.stat().is_regular_file())
+        return;
+
+    Context context("When loading ELF cache '" + stringify(cache_file) + "':");
+
+    try
+    {
+        SafeIFStream f(cache_file);
+        std::string line;
+        if (! (std::getline(f, line) && line == cache_format))
+        {
+            Log::get_instance()->message("broken_linkage_finder.cache.format", ll_warning, lc_context)
+                << "Cache is not in a format we understand, ignoring it";
+            return;
+        }
+
+        while (std::getline(f, line))
+        {
+            std::vector<std::string> tokens;
+            tokenise_whitespace(line, std::back_inserter(tokens));
+            if (tokens.size() < 9)
+            {
+                Log::get_instance()->message("broken_linkage_finder.cache.bad_line", ll_warning, lc_context)
+                    << "Ignoring the rest of the cache after bad line '" << line << "'";
+                return;
+            }
+
+            ElfCacheKey key{ destringify<dev_t>(tokens[0]), destringify<ino_t>(tokens[1]) };
+            ElfCacheEntry entry;
+            entry.mtime = tokens[2];
+            entry.size = destringify<off_t>(tokens[3]);
+            entry.info.kind = static_cast<ElfFileInfo::Kind>(destringify<int>(tokens[4]));
+            entry.info.arch = ElfArchitecture(destringify<unsigned>(tokens[5]), destringify<unsigned>(tokens[6]),
+                    "1" == tokens[7], "1" == tokens[8]);
+            entry.info.needed.assign(std::next(tokens.begin(), 9), tokens.end());
+            old_cache.insert(std::make_pair(key, entry));
+        }
+    }
+    catch (const Exception & e)
+    {
+        Log::get_instance()->message("broken_linkage_finder.cache.bad", ll_warning, lc_context)
+            << "Ignoring the cache because of error '" << e.message() << "' (" << e.what() << ")";
+        old_cache.clear();
+    }
+}
+
+void
+ElfLinkageChecker::save_cache() const
+{
+    if (_imp->cache_file == FSPath("/var/empty"))
+        return;
+
+    Context context("When saving ELF cache '" + stringify(_imp->cache_file) + "':");
+
+    if (! _imp->cache_file.dirname().stat().is_directory())
+    {
+        Log::get_instance()->message("broken_linkage_finder.cache.no_directory", ll_debug, lc_context)
+            << "Not saving the cache because '" << _imp->cache_file.dirname() << "' is not a directory";
+        return;
+    }
+
+    /* written elsewhere and renamed into place, so that an interrupted
+     * write doesn't leave half a cache behind */
+    FSPath temp_file(_imp->cache_file.dirname() / ("." + _imp->cache_file.basename() + ".tmp"));
+
+    try
+    {
+        {
+            SafeOFStream f(temp_file, -1, true);
+            f << cache_format << std::endl;
+            for (const auto & e : _imp->new_cache)
+            {
+                f << e.first.device << " " << e.first.inode << " " << e.second.mtime << " " << e.second.size << " "
+                    << int(e.second.info.kind) << " " << e.second.info.arch._machine << " " << int(e.second.info.arch._class) << " "
+                    << e.second.info.arch._bigendian << " " << e.second.info.arch._mips_n32;
+                for (const auto & n : e.second.info.needed)
+                    f << " " << n;
+                f << std::endl;
+            }
+        }
+
+        temp_file.rename(_imp->cache_file);
+    }
+    catch (const Exception & e)
+    {
+        Log::get_instance()->message("broken_linkage_finder.cache.write_failed", ll_warning, lc_context)
+            << "Cannot write the cache: '" << e.message() << "' (" << e.what() << ")";
+    }
+}
+
 bool
 ElfLinkageChecker::check_file(const FSPath & file)
 {
     std::string basename(file.basename());
+    FSStat file_stat(file);
     if (! (std::string::npos != basename.find(".so.") ||
            (3 <= basename.length() && ".so" == basename.substr(basename.length() - 3)) ||
-           (0 != (file.stat().permissions() & S_IXUSR))))
+           (0 != (file_stat.permissions() & S_IXUSR))))
         return false;
 
-    SafeIFStream stream(file);
-    return _imp->check_elf<Elf32Type>(file, stream) || _imp->check_elf<Elf64Type>(file, stream);
+    ElfCacheKey key{ file_stat.lowlevel_id().first, file_stat.lowlevel_id().second };
+    ElfCacheEntry entry;
+    entry.mtime = mtime_string(file_stat);
+    entry.size = file_stat.file_size();
+
+    auto cached(_imp->old_cache.find(key));
+    if (_imp->old_cache.end() != cached && cached->second.mtime == entry.mtime && cached->second.size == entry.size)
+        entry.info = cached->second.info;
+    else
+    {
+        std::shared_ptr<MappedFileBuf> mapped(map_file(file));
+        if (mapped)
+        {
+            std::istream stream(mapped.get());
+            _imp->check_elf<Elf32Type>(file, stream, entry.info) || _imp->check_elf<Elf64Type>(file, stream, entry.info);
+        }
+        else
+        {
+            SafeIFStream stream(file);
+            _imp->check_elf<Elf32Type>(file, stream, entry.info) || _imp->check_elf<Elf64Type>(file, stream, entry.info);
+        }
+    }
+
+    _imp->add_file(file, entry.info);
+
+    std::unique_lock<std::mutex> l(_imp->mutex);
+    /* invalid files aren't remembered, so that they are complained about
+     * every time */
+    if (ElfFileInfo::invalid != entry.info.kind)
+        _imp->new_cache[key] = entry;
+
+    return ElfFileInfo::not_elf != entry.info.kind;
 }
 
 template <typename ElfType_>
 bool
-Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream)
+Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream, ElfFileInfo & info)
 {
     if (! ElfObject<ElfType_>::is_valid_elf(stream))
         return false;
@@ -166,19 +439,14 @@ Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream)
         ElfObject<ElfType_> elf(stream);
         if (ET_EXEC != elf.get_type() && ET_DYN != elf.get_type())
         {
-            Log::get_instance()->message("broken_linkage_finder.not_interesting", ll_debug, lc_context)
-                << "File is not an executable or shared library";
+            info.kind = ElfFileInfo::not_interesting;
             return true;
         }
 
-        ElfArchitecture arch(elf);
+        info.kind = ET_DYN == elf.get_type() ? ElfFileInfo::library : ElfFileInfo::executable;
+        info.arch = ElfArchitecture(elf);
         elf.resolve_all_strings();
 
-        std::unique_lock<std::mutex> l(mutex);
-
-        if (check_libraries.empty() && ET_DYN == elf.get_type())
-            handle_library(file, arch);
-
         for (const auto & section : elf.sections())
         {
             if (const auto *dyn_sec = visitor_cast<const DynamicSection<ElfType_>>(section))
@@ -187,30 +455,61 @@ Imp<ElfLinkageChecker>::check_elf(const FSPath & file, std::istream & stream)
                 {
                     if (const auto *ent_str = visitor_cast<const DynamicEntryString<ElfType_>>(entry))
                     {
-                        if (ent_str->tag_name() != "NEEDED")
-                            continue;
-
-                        const std::string & req((*ent_str)());
-                        if (check_libraries.empty() || check_libraries.end() != check_libraries.find(req))
-                        {
-                            Log::get_instance()->message("broken_linkage_finder.depends", ll_debug, lc_context)
-                                << "File depends on " << req;
-                            needed[arch][req].push_back(file);
-                        }
+                        if (ent_str->tag_name() == "NEEDED")
+                            info.needed.push_back((*ent_str)());
                     }
                 }
             }
         }
+
+        /* the cache is whitespace separated, and no real library has
+         * whitespace in its name */
+        for (const auto & req : info.needed)
+            if (std::string::npos != req.find_first_of(" \t\n"))
+            {
+                Log::get_instance()->message("broken_linkage_finder.invalid", ll_warning, lc_no_context)
+                    << "'" << file << "' appears to be invalid or corrupted: NEEDED entry '" << req << "' contains whitespace";
+                info = ElfFileInfo();
+                info.kind = ElfFileInfo::invalid;
+                break;
+            }
     }
     catch (const InvalidElfFileError & e)
     {
         Log::get_instance()->message("broken_linkage_finder.invalid", ll_warning, lc_no_context)
             << "'" << file << "' appears to be invalid or corrupted: " << e.message();
+        info = ElfFileInfo();
+        info.kind = ElfFileInfo::invalid;
     }
 
     return true;
 }
 
+void
+Imp<ElfLinkageChecker>::add_file(const FSPath & file, const ElfFileInfo & info)
+{
+    if (ElfFileInfo::executable != info.kind && ElfFileInfo::library != info.kind)
+    {
+        if (ElfFileInfo::not_interesting == info.kind)
+            Log::get_instance()->message("broken_linkage_finder.not_interesting", ll_debug, lc_context)
+                << "'" << file << "' is not an executable or shared library";
+        return;
+    }
+
+    std::unique_lock<std::mutex> l(mutex);
+
+    if (check_libraries.empty() && ElfFileInfo::library == info.kind)
+        handle_library(file, info.arch);
+
+    for (const auto & req : info.needed)
+        if (check_libraries.empty() || check_libraries.end() != check_libraries.find(req))
+        {
+            Log::get_instance()->message("broken_linkage_finder.depends", ll_debug, lc_context)
+                << "'" << file << "' depends on " << req;
+            needed[info.arch][req].push_back(file);
+        }
+}
+
 void
 Imp<ElfLinkageChecker>::handle_library(const FSPath & file, const ElfArchitecture & arch)
 {
@@ -34,9 +34,19 @@ namespace paludis
             Pimp<ElfLinkageChecker> _imp;
 
         public:
-            ElfLinkageChecker(const FSPath &, const std::shared_ptr<const Sequence<std::string>> &);
+            /**
+             * What was found in each file is remembered in the specified
+             * cache file, which may be <code>/var/empty</code>, so that a
+             * later run need only read files that have changed.
+             */
+            ElfLinkageChecker(const FSPath &, const std::shared_ptr<const Sequence<std::string>> &, const FSPath &);
             ~ElfLinkageChecker() override;
 
+            /**
+             * Write out our cache, once every file has been checked.
+             */
+            void save_cache() const;
+
             bool check_file(const FSPath &) override PALUDIS_ATTRIBUTE((warn_unused_result));
             void note_symlink(const FSPath &, const FSPath &) override;
 
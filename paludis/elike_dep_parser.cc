@@ -41,7 +41,7 @@ namespace
 
     void parse_annotations(SimpleParser & parser, const ELikeDepParserCallbacks & callbacks)
     {
-        Context context("When parsing annotation block at offset '" + stringify(parser.offset()) + "':");
+        LazyContext context([offset = parser.offset()] () { return "When parsing annotation block at offset '" + stringify(offset) + "':"; });
 
         if (! parser.consume(*simple_parser::any_of(" \t\r\n") & simple_parser::exact("[[")))
         {
@@ -140,7 +140,7 @@ namespace
     {
         while (true)
         {
-            Context context("When parsing from offset '" + stringify(parser.offset()) + "':");
+            LazyContext context([offset = parser.offset()] () { return "When parsing from offset '" + stringify(offset) + "':"; });
             std::string word;
 
             if (parser.eof())
@@ -281,7 +281,7 @@ namespace
 void
 paludis::parse_elike_dependencies(const std::string & s, const ELikeDepParserCallbacks & callbacks, const ELikeDepParserOptions & options)
 {
-    Context context("When parsing '" + s + "':");
+    LazyContext context([&] () { return "When parsing '" + s + "':"; });
 
     SimpleParser parser(s);
     parse(parser, callbacks, options, false, false);
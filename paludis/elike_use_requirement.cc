@@ -861,7 +861,7 @@ paludis::parse_elike_use_requirement(const std::string & s,
         const ELikeUseRequirementOptions & options,
         const std::shared_ptr<Set<std::string> > & maybe_accumulate_mentioned)
 {
-    Context context("When parsing use requirement '" + s + "':");
+    LazyContext context([&] () { return "When parsing use requirement '" + s + "':"; });
 
     std::shared_ptr<UseRequirements> result(std::make_shared<UseRequirements>("[" + s + "]"));
     std::string::size_type pos(0);
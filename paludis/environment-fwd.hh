@@ -42,6 +42,11 @@ namespace paludis
 
     class Environment;
 
+    struct SelectionCacheStatistics;
+
+    struct RepositoryStartupTime;
+    typedef Sequence<RepositoryStartupTime> RepositoryStartupTimes;
+
     class CreateOutputManagerInfo;
     class CreateOutputManagerForPackageIDActionInfo;
     class CreateOutputManagerForRepositorySyncInfo;
@@ -119,4 +119,7 @@ AmbiguousPackageNameError::name() const
 namespace paludis
 {
     template class WrappedForwardIterator<AmbiguousPackageNameError::OptionsConstIteratorTag, const std::string>;
+
+    template class Sequence<RepositoryStartupTime>;
+    template class WrappedForwardIterator<Sequence<RepositoryStartupTime>::ConstIteratorTag, const RepositoryStartupTime>;
 }
@@ -23,7 +23,7 @@
 #include <paludis/environment-fwd.hh>
 
 #include <paludis/output_manager-fwd.hh>
-#include <paludis/name-fwd.hh>
+#include <paludis/name.hh>
 #include <paludis/hook-fwd.hh>
 #include <paludis/repository-fwd.hh>
 #include <paludis/dep_spec.hh>
@@ -42,8 +42,11 @@
 #include <paludis/util/tribool-fwd.hh>
 #include <paludis/util/visitor.hh>
 #include <paludis/util/pimp.hh>
-#include <paludis/util/sequence-fwd.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <paludis/util/named_value.hh>
 
+#include <chrono>
 #include <memory>
 
 /** \file
@@ -179,6 +182,56 @@ namespace paludis
             RepositoryName name() const;
     };
 
+    namespace n
+    {
+        typedef Name<struct name_hits> hits;
+        typedef Name<struct name_misses> misses;
+        typedef Name<struct name_uncacheable> uncacheable;
+        typedef Name<struct name_create_time> create_time;
+        typedef Name<struct name_name> name;
+        typedef Name<struct name_preload_time> preload_time;
+    }
+
+    /**
+     * Statistics for the Environment selection cache.
+     *
+     * \see Environment::selection_cache_statistics
+     * \ingroup g_environment
+     * \since 3.0
+     */
+    struct SelectionCacheStatistics
+    {
+        /// Selections answered from the cache.
+        NamedValue<n::hits, unsigned long> hits;
+
+        /// Cacheable selections that had to be calculated.
+        NamedValue<n::misses, unsigned long> misses;
+
+        /// Selections that could not be cached, for example because they use filter::ByFunction.
+        NamedValue<n::uncacheable, unsigned long> uncacheable;
+    };
+
+    /**
+     * How long a repository took to start up.
+     *
+     * \see Environment::repository_startup_times
+     * \ingroup g_environment
+     * \since 3.0
+     */
+    struct RepositoryStartupTime
+    {
+        /// Time spent in RepositoryFactory::create.
+        NamedValue<n::create_time, std::chrono::steady_clock::duration> create_time;
+
+        NamedValue<n::name, RepositoryName> name;
+
+        /// Time spent in Repository::preload.
+        NamedValue<n::preload_time, std::chrono::steady_clock::duration> preload_time;
+    };
+
+    extern template class PALUDIS_VISIBLE Sequence<RepositoryStartupTime>;
+    extern template class PALUDIS_VISIBLE WrappedForwardIterator<Sequence<RepositoryStartupTime>::ConstIteratorTag, const RepositoryStartupTime>;
+
     /**
      * Represents a working environment, which contains an available packages
      * database and provides various methods for querying package visibility
@@ -379,6 +432,32 @@ namespace paludis
             virtual std::shared_ptr<PackageIDSequence> operator[] (const Selection &) const
                 PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
 
+            ///\name Selection cache
+            ///\{
+
+            /**
+             * Should operator[] remember its results?
+             *
+             * Off by default. When on, a Selection whose cache_key is not
+             * empty is only calculated once, until a Repository is added,
+             * invalidated or merged to. Changes to configuration, such as
+             * masks, are not noticed, so this should only be turned on by
+             * clients that do not change configuration at runtime.
+             *
+             * \since 3.0
+             */
+            virtual void set_selection_cache_enabled(const bool) = 0;
+
+            /**
+             * Hit and miss counts for the selection cache.
+             *
+             * \since 3.0
+             */
+            virtual const SelectionCacheStatistics selection_cache_statistics() const
+                PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
+
+            ///\}
+
             /**
              * Create a repository from a particular file.
              *
@@ -678,6 +757,18 @@ namespace paludis
             virtual bool has_repository_named(const RepositoryName &) const
                 PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
 
+            /**
+             * How long did each of our repositories take to create and
+             * preload, in creation order?
+             *
+             * Only repositories created by the environment itself at startup
+             * are included.
+             *
+             * \since 3.0
+             */
+            virtual const std::shared_ptr<const RepositoryStartupTimes> repository_startup_times() const
+                PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
+
             /**
              * Disambiguate a package name.  If a filter is specified,
              * limit the potential results to packages that match.
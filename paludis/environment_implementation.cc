@@ -24,6 +24,7 @@
 #include <paludis/distribution.hh>
 #include <paludis/selection.hh>
 #include <paludis/repository.hh>
+#include <paludis/repository_factory.hh>
 #include <paludis/generator.hh>
 #include <paludis/filter.hh>
 #include <paludis/filtered_generator.hh>
@@ -44,12 +45,21 @@
 #include <paludis/util/join.hh>
 #include <paludis/util/sequence-impl.hh>
 #include <paludis/util/set-impl.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/thread_pool.hh>
+#include <paludis/util/hashes.hh>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
 #include <mutex>
 #include <map>
 #include <list>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "config.h"
 
@@ -109,6 +119,60 @@ namespace
     {
         return Cache<F_>(f);
     }
+
+    std::shared_ptr<PackageIDSequence> copy_ids(const std::shared_ptr<const PackageIDSequence> & ids)
+    {
+        auto result(std::make_shared<PackageIDSequence>());
+        std::copy(ids->begin(), ids->end(), result->back_inserter());
+        return result;
+    }
+
+    std::vector<unsigned long> generations_of(const std::list<std::shared_ptr<Repository> > & repositories)
+    {
+        std::vector<unsigned long> result;
+        result.reserve(repositories.size());
+        for (const auto & repository : repositories)
+            result.push_back(repository->generation());
+        return result;
+    }
+
+    /* run f(0) ... f(n - 1), shared between as many threads as will help */
+    void run_in_parallel(const unsigned n, const std::function<void (const unsigned)> & f)
+    {
+        unsigned n_threads(std::min(n, std::max(1u, std::thread::hardware_concurrency())));
+        if (n_threads <= 1)
+        {
+            for (unsigned i(0) ; i != n ; ++i)
+                f(i);
+            return;
+        }
+
+        std::atomic<unsigned> next(0);
+        ThreadPool pool;
+        for (unsigned t(0) ; t != n_threads ; ++t)
+            pool.create_thread([&] () {
+                    for (unsigned i(next++) ; i < n ; i = next++)
+                        f(i);
+                    });
+    }
+
+    struct PendingRepository
+    {
+        std::function<std::string (const std::string &)> config;
+        unsigned wave;
+        std::shared_ptr<Repository> repository;
+        std::exception_ptr exception;
+        std::chrono::steady_clock::duration create_time;
+        std::chrono::steady_clock::duration preload_time;
+    };
+
+    /* every entry was calculated when our repositories had the generations
+     * listed, so the whole lot goes as soon as any of those changes */
+    struct SelectionCache
+    {
+        std::vector<unsigned long> generations;
+        std::unordered_map<std::string, std::shared_ptr<const PackageIDSequence> > results;
+    };
 }
 
 namespace paludis
@@ -132,8 +196,22 @@ namespace paludis
         mutable std::shared_ptr<SetNameSet> set_names;
         mutable SetsStore sets;
 
+        std::shared_ptr<RepositoryStartupTimes> repository_startup_times;
+
+        mutable std::mutex selection_cache_mutex;
+        std::atomic<bool> selection_cache_enabled;
+        mutable SelectionCache selection_cache;
+        mutable SelectionCacheStatistics selection_cache_statistics;
+
         Imp() :
-            loaded_sets(false)
+            loaded_sets(false),
+            repository_startup_times(std::make_shared<RepositoryStartupTimes>()),
+            selection_cache_enabled(false),
+            selection_cache_statistics(make_named_values<SelectionCacheStatistics>(
+                        n::hits() = 0,
+                        n::misses() = 0,
+                        n::uncacheable() = 0
+                        ))
         {
         }
     };
@@ -193,7 +271,65 @@ EnvironmentImplementation::is_paludis_package(const QualifiedPackageName & n) co
 std::shared_ptr<PackageIDSequence>
 EnvironmentImplementation::operator[] (const Selection & selection) const
 {
-    return selection.perform_select(this);
+    if (! _imp->selection_cache_enabled)
+        return selection.perform_select(this);
+
+    std::string key(selection.cache_key());
+    if (key.empty())
+    {
+        std::unique_lock<std::mutex> lock(_imp->selection_cache_mutex);
+        ++_imp->selection_cache_statistics.uncacheable();
+        return selection.perform_select(this);
+    }
+
+    std::vector<unsigned long> generations(generations_of(_imp->repositories));
+
+    {
+        std::unique_lock<std::mutex> lock(_imp->selection_cache_mutex);
+        if (generations != _imp->selection_cache.generations)
+        {
+            _imp->selection_cache.results.clear();
+            _imp->selection_cache.generations = generations;
+        }
+        else
+        {
+            auto c(_imp->selection_cache.results.find(key));
+            if (c != _imp->selection_cache.results.end())
+            {
+                ++_imp->selection_cache_statistics.hits();
+                return copy_ids(c->second);
+            }
+        }
+
+        ++_imp->selection_cache_statistics.misses();
+    }
+
+    auto result(selection.perform_select(this));
+
+    /* something may have been invalidated whilst we were working */
+    if (generations != generations_of(_imp->repositories))
+        return result;
+
+    std::unique_lock<std::mutex> lock(_imp->selection_cache_mutex);
+    if (generations == _imp->selection_cache.generations)
+        _imp->selection_cache.results.emplace(key, copy_ids(result));
+
+    return result;
+}
+
+void
+EnvironmentImplementation::set_selection_cache_enabled(const bool v)
+{
+    std::unique_lock<std::mutex> lock(_imp->selection_cache_mutex);
+    _imp->selection_cache_enabled = v;
+    _imp->selection_cache = SelectionCache();
+}
+
+const SelectionCacheStatistics
+EnvironmentImplementation::selection_cache_statistics() const
+{
+    std::unique_lock<std::mutex> lock(_imp->selection_cache_mutex);
+    return _imp->selection_cache_statistics;
 }
 
 NotifierCallbackID
@@ -400,6 +536,98 @@ EnvironmentImplementation::has_repository_named(const RepositoryName & name) con
     return false;
 }
 
+void
+EnvironmentImplementation::add_repositories_from_config(const std::list<std::function<std::string (const std::string &)> > & configs)
+{
+    Context context("When creating repositories:");
+
+    /* a repository can be created once everything it depends upon has been
+     * added, so split them into waves, each depending only upon earlier waves */
+    std::vector<PendingRepository> pending;
+    std::unordered_map<RepositoryName, unsigned, Hash<RepositoryName> > waves;
+    unsigned n_waves(0);
+    for (const auto & config : configs)
+    {
+        unsigned wave(0);
+        const std::shared_ptr<const RepositoryNameSet> dependencies(RepositoryFactory::get_instance()->dependencies(this, config));
+        for (const auto & dependency : *dependencies)
+        {
+            auto w(waves.find(dependency));
+            if (w != waves.end())
+                wave = std::max(wave, w->second + 1);
+        }
+
+        waves.emplace(RepositoryFactory::get_instance()->name(this, config), wave);
+        n_waves = std::max(n_waves, wave + 1);
+        pending.push_back(PendingRepository{config, wave, nullptr, nullptr, { }, { }});
+    }
+
+    for (unsigned wave(0) ; wave != n_waves ; ++wave)
+    {
+        std::vector<PendingRepository *> this_wave;
+        for (auto & p : pending)
+            if (p.wave == wave)
+                this_wave.push_back(&p);
+
+        run_in_parallel(this_wave.size(), [&] (const unsigned i) {
+                PendingRepository & p(*this_wave[i]);
+                auto start(std::chrono::steady_clock::now());
+                try
+                {
+                    p.repository = RepositoryFactory::get_instance()->create(this, p.config);
+                }
+                catch (...)
+                {
+                    p.exception = std::current_exception();
+                }
+                p.create_time = std::chrono::steady_clock::now() - start;
+                });
+
+        for (auto & p : this_wave)
+        {
+            if (p->exception)
+                std::rethrow_exception(p->exception);
+            add_repository(RepositoryFactory::get_instance()->importance(this, p->config), p->repository);
+        }
+    }
+
+    /* failures here are not fatal, since anything that really needs the data
+     * will try again and report the problem properly */
+    run_in_parallel(pending.size(), [&] (const unsigned i) {
+            PendingRepository & p(pending[i]);
+            Context local_context("When preloading repository '" + stringify(p.repository->name()) + "':");
+            auto start(std::chrono::steady_clock::now());
+            try
+            {
+                p.repository->preload();
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("environment.preload_failed", ll_debug, lc_context)
+                    << "Ignoring exception '" << e.message() << "' (" << e.what() << ")";
+            }
+            catch (const std::exception & e)
+            {
+                Log::get_instance()->message("environment.preload_failed", ll_debug, lc_context)
+                    << "Ignoring exception '" << e.what() << "'";
+            }
+            p.preload_time = std::chrono::steady_clock::now() - start;
+            });
+
+    for (const auto & p : pending)
+        _imp->repository_startup_times->push_back(make_named_values<RepositoryStartupTime>(
+                    n::create_time() = p.create_time,
+                    n::name() = p.repository->name(),
+                    n::preload_time() = p.preload_time
+                    ));
+}
+
+const std::shared_ptr<const RepositoryStartupTimes>
+EnvironmentImplementation::repository_startup_times() const
+{
+    return _imp->repository_startup_times;
+}
+
 namespace
 {
     typedef std::map<const QualifiedPackageName, std::pair<bool, bool> > QPNIMap;
@@ -22,6 +22,9 @@
 
 #include <paludis/environment.hh>
 #include <paludis/package_id-fwd.hh>
+#include <functional>
+#include <list>
+#include <string>
 
 /** \file
  * Declarations for the Environment class.
@@ -60,6 +63,19 @@ namespace paludis
             virtual void populate_standard_sets() const;
             void set_always_exists(const SetName &) const;
 
+            /**
+             * Create and add repositories using RepositoryFactory.
+             *
+             * The configuration functions must be in dependency order.
+             * Repositories whose dependencies already exist are created in
+             * parallel, and once every repository has been added, each is
+             * preloaded in parallel. Timings are recorded for
+             * repository_startup_times.
+             *
+             * \since 3.0
+             */
+            void add_repositories_from_config(const std::list<std::function<std::string (const std::string &)> > &);
+
         public:
             ///\name Basic operations
             ///\{
@@ -87,6 +103,14 @@ namespace paludis
             std::shared_ptr<PackageIDSequence> operator[] (const Selection &) const
                 override PALUDIS_ATTRIBUTE((warn_unused_result));
 
+            const std::shared_ptr<const RepositoryStartupTimes> repository_startup_times() const
+                override PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            void set_selection_cache_enabled(const bool) override;
+
+            const SelectionCacheStatistics selection_cache_statistics() const
+                override PALUDIS_ATTRIBUTE((warn_unused_result));
+
             NotifierCallbackID add_notifier_callback(const NotifierCallbackFunction &) override;
 
             void remove_notifier_callback(const NotifierCallbackID) override;
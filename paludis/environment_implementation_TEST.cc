@@ -30,9 +30,13 @@
 #include <paludis/util/options.hh>
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/join.hh>
 
 #include <paludis/user_dep_spec.hh>
 #include <paludis/filter.hh>
+#include <paludis/filtered_generator.hh>
+#include <paludis/generator.hh>
+#include <paludis/selection.hh>
 
 #include <gtest/gtest.h>
 
@@ -181,3 +185,57 @@ TEST(EnvironmentImplementation, Disambiguation)
     EXPECT_THROW(auto pkg = e.fetch_unique_qualified_package_name(PackageNamePart("pkg-foo"), filter::All(), false), AmbiguousPackageNameError);
 }
 
+
+namespace
+{
+    std::string selected(const Environment & e, const Selection & s)
+    {
+        auto ids(e[s]);
+        return join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " ");
+    }
+}
+
+TEST(EnvironmentImplementation, SelectionCache)
+{
+    TestEnvironment e;
+
+    std::shared_ptr<FakeRepository> r1(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &e,
+                    n::name() = RepositoryName("repo1"))));
+    r1->add_version("cat", "pkg", "1");
+    e.add_repository(10, r1);
+
+    const Selection all_pkg(selection::AllVersionsSorted(generator::Package(QualifiedPackageName("cat/pkg"))));
+    const Selection by_function(selection::AllVersionsSorted(generator::Package(QualifiedPackageName("cat/pkg")) |
+                filter::ByFunction([] (const std::shared_ptr<const PackageID> &) { return false; }, "nothing")));
+
+    EXPECT_TRUE(all_pkg.cache_key() != "");
+    EXPECT_EQ("", by_function.cache_key());
+
+    EXPECT_EQ("cat/pkg-1:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ(0u, e.selection_cache_statistics().hits());
+    EXPECT_EQ(0u, e.selection_cache_statistics().misses());
+
+    e.set_selection_cache_enabled(true);
+
+    EXPECT_EQ("cat/pkg-1:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ("cat/pkg-1:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ(1u, e.selection_cache_statistics().hits());
+    EXPECT_EQ(1u, e.selection_cache_statistics().misses());
+
+    std::shared_ptr<PackageIDSequence> ids(e[all_pkg]);
+    ids->push_back(*ids->begin());
+    EXPECT_EQ("cat/pkg-1:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ(3u, e.selection_cache_statistics().hits());
+
+    r1->add_version("cat", "pkg", "2");
+    EXPECT_EQ("cat/pkg-1:0::repo1 cat/pkg-2:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ(2u, e.selection_cache_statistics().misses());
+
+    r1->invalidate();
+    EXPECT_EQ("cat/pkg-1:0::repo1 cat/pkg-2:0::repo1", selected(e, all_pkg));
+    EXPECT_EQ(3u, e.selection_cache_statistics().misses());
+
+    EXPECT_EQ("cat/pkg-1:0::repo1 cat/pkg-2:0::repo1", selected(e, by_function));
+    EXPECT_EQ(1u, e.selection_cache_statistics().uncacheable());
+}
@@ -23,7 +23,7 @@
 #include <paludis/dep_spec.hh>
 #include <paludis/spec_tree.hh>
 #include <paludis/user_dep_spec.hh>
-#include <paludis/match_package.hh>
+#include <paludis/spec_matcher_index.hh>
 #include <paludis/util/config_file.hh>
 #include <paludis/util/options.hh>
 #include <paludis/package_id.hh>
@@ -37,8 +37,7 @@
 #include <paludis/util/set.hh>
 #include <paludis/util/hashes.hh>
 #include <list>
-#include <map>
-#include <mutex>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
@@ -46,11 +45,8 @@ using namespace paludis;
 using namespace paludis::paludis_environment;
 
 typedef std::list<KeywordName> KeywordsList;
-typedef std::map<std::shared_ptr<const PackageDepSpec>, KeywordsList> PDSToKeywordsList;
-typedef std::pair<std::shared_ptr<const SetSpecTree>, KeywordsList> SetNameEntry;
+typedef std::pair<std::shared_ptr<const SetSpecMatcher>, KeywordsList> SetNameEntry;
 
-typedef std::unordered_map<QualifiedPackageName, PDSToKeywordsList, Hash<QualifiedPackageName> > SpecificMap;
-typedef PDSToKeywordsList UnspecificMap;
 typedef std::unordered_map<SetName, SetNameEntry, Hash<SetName> > NamedSetMap;
 
 namespace paludis
@@ -60,10 +56,11 @@ namespace paludis
     {
         const PaludisEnvironment * const env;
 
-        SpecificMap qualified;
-        UnspecificMap unqualified;
-        mutable NamedSetMap set;
-        mutable std::mutex set_mutex;
+        SpecMatcherIndex qualified;
+        std::vector<KeywordsList> qualified_keywords;
+        SpecMatcherIndex unqualified;
+        std::vector<KeywordsList> unqualified_keywords;
+        NamedSetMap set;
 
         Imp(const PaludisEnvironment * const e) :
             env(e)
@@ -72,6 +69,15 @@ namespace paludis
     };
 }
 
+namespace
+{
+    void unknown_set(const SetName & s)
+    {
+        Log::get_instance()->message("paludis_environment.keywords_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
+            << s << "' does not exist";
+    }
+}
+
 KeywordsConf::KeywordsConf(const PaludisEnvironment * const e) :
     _imp(e)
 {
@@ -100,25 +106,30 @@ KeywordsConf::add(const FSPath & filename)
         {
             std::shared_ptr<PackageDepSpec> d(std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
                             tokens.at(0), _imp->env, { updso_allow_wildcards, updso_no_disambiguation, updso_throw_if_set })));
+            KeywordsList k;
+            for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
+                    t != t_end ; ++t)
+                k.push_back(KeywordName(*t));
+
             if (d->package_ptr())
             {
-                KeywordsList & k(_imp->qualified[*d->package_ptr()][d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(KeywordName(*t));
+                _imp->qualified.add(d);
+                _imp->qualified_keywords.push_back(k);
             }
             else
             {
-                KeywordsList & k(_imp->unqualified[d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(KeywordName(*t));
+                _imp->unqualified.add(d);
+                _imp->unqualified_keywords.push_back(k);
             }
         }
         catch (const GotASetNotAPackageDepSpec &)
         {
-            NamedSetMap::iterator i(_imp->set.insert(std::make_pair(SetName(tokens.at(0)), std::make_pair(
-                                nullptr, KeywordsList()))).first);
+            SetName name(tokens.at(0));
+            NamedSetMap::iterator i(_imp->set.find(name));
+            if (i == _imp->set.end())
+                i = _imp->set.insert(std::make_pair(name, std::make_pair(
+                                std::make_shared<SetSpecMatcher>(_imp->env, name, std::bind(&unknown_set, name)),
+                                KeywordsList()))).first;
 
             for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
                     t != t_end ; ++t)
@@ -138,16 +149,8 @@ KeywordsConf::query(const std::shared_ptr<const KeywordNameSet> & k, const std::
 
     /* highest priority: specific */
     bool break_when_done(false);
-    {
-        SpecificMap::const_iterator i(_imp->qualified.find(e->name()));
-        if (i != _imp->qualified.end())
-        {
-            for (const auto & spec_to_keywords : i->second)
-            {
-                if (! match_package(*_imp->env, *spec_to_keywords.first, e, nullptr, { }))
-                    continue;
-
-                for (const auto & keyword : spec_to_keywords.second)
+    if (_imp->qualified.find_matches(*_imp->env, e, [&] (const unsigned n) {
+                for (const auto & keyword : _imp->qualified_keywords[n])
                 {
                     if (keyword == star_keyword)
                         return true;
@@ -158,66 +161,47 @@ KeywordsConf::query(const std::shared_ptr<const KeywordNameSet> & k, const std::
                     else if (k->end() != k->find(keyword))
                         return true;
                 }
-            }
-        }
-    }
+
+                return false;
+                }))
+        return true;
 
     if (break_when_done)
         return false;
 
     /* next: named sets */
+    for (const auto & name_to_entry : _imp->set)
     {
-        std::unique_lock<std::mutex> lock(_imp->set_mutex);
+        if (! name_to_entry.second.first->match(e))
+            continue;
 
-        for (auto & name_to_entry : _imp->set)
+        for (const auto & keyword : name_to_entry.second.second)
         {
-            if (! name_to_entry.second.first)
-            {
-                name_to_entry.second.first = _imp->env->set(name_to_entry.first);
-                if (! name_to_entry.second.first)
-                {
-                    Log::get_instance()->message("paludis_environment.keywords_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
-                        << name_to_entry.first << "' does not exist";
-                    name_to_entry.second.first = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
-                }
-            }
-
-            if (! match_package_in_set(*_imp->env, *name_to_entry.second.first, e, { }))
-                continue;
-
-            for (const auto & keyword : name_to_entry.second.second)
-            {
-                if (k->end() != k->find(keyword))
-                    return true;
+            if (k->end() != k->find(keyword))
+                return true;
 
-                if (keyword == star_keyword)
-                    return true;
+            if (keyword == star_keyword)
+                return true;
 
-                if (keyword == minus_star_keyword)
-                    break_when_done = true;
-            }
+            if (keyword == minus_star_keyword)
+                break_when_done = true;
         }
     }
 
-
     if (break_when_done)
         return false;
 
     /* last: unspecific */
-    for (const auto & spec_to_keywords : _imp->unqualified)
-    {
-        if (! match_package(*_imp->env, *spec_to_keywords.first, e, nullptr, { }))
-            continue;
-
-        for (const auto & keyword : spec_to_keywords.second)
-        {
-            if (k->end() != k->find(keyword))
-                return true;
+    return _imp->unqualified.find_matches(*_imp->env, e, [&] (const unsigned n) {
+            for (const auto & keyword : _imp->unqualified_keywords[n])
+            {
+                if (k->end() != k->find(keyword))
+                    return true;
 
-            if (keyword == star_keyword)
-                return true;
-        }
-    }
+                if (keyword == star_keyword)
+                    return true;
+            }
 
-    return false;
+            return false;
+            });
 }
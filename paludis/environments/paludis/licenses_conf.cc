@@ -23,7 +23,7 @@
 #include <paludis/dep_spec.hh>
 #include <paludis/spec_tree.hh>
 #include <paludis/user_dep_spec.hh>
-#include <paludis/match_package.hh>
+#include <paludis/spec_matcher_index.hh>
 #include <paludis/util/config_file.hh>
 #include <paludis/package_id.hh>
 #include <paludis/util/options.hh>
@@ -37,7 +37,7 @@
 #include <paludis/util/hashes.hh>
 #include <paludis/util/set.hh>
 #include <list>
-#include <map>
+#include <functional>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -46,11 +46,8 @@ using namespace paludis;
 using namespace paludis::paludis_environment;
 
 typedef std::list<std::string> LicensesList;
-typedef std::map<std::shared_ptr<const PackageDepSpec>, LicensesList> PDSToLicensesList;
-typedef std::pair<std::shared_ptr<const SetSpecTree>, LicensesList> SetNameEntry;
+typedef std::pair<std::shared_ptr<const SetSpecMatcher>, LicensesList> SetNameEntry;
 
-typedef std::unordered_map<QualifiedPackageName, PDSToLicensesList, Hash<QualifiedPackageName> > SpecificMap;
-typedef PDSToLicensesList UnspecificMap;
 typedef std::unordered_map<SetName, SetNameEntry, Hash<SetName> > NamedSetMap;
 
 namespace paludis
@@ -60,10 +57,11 @@ namespace paludis
     {
         const PaludisEnvironment * const env;
 
-        mutable SpecificMap qualified;
-        mutable UnspecificMap unqualified;
+        SpecMatcherIndex qualified;
+        mutable std::vector<LicensesList> qualified_licenses;
+        SpecMatcherIndex unqualified;
+        mutable std::vector<LicensesList> unqualified_licenses;
         mutable NamedSetMap set;
-        mutable std::mutex set_mutex;
         mutable std::mutex expanded_mutex;
         mutable bool expanded;
 
@@ -75,6 +73,15 @@ namespace paludis
     };
 }
 
+namespace
+{
+    void unknown_set(const SetName & s)
+    {
+        Log::get_instance()->message("paludis_environment.licenses_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
+            << s << "' does not exist";
+    }
+}
+
 LicensesConf::LicensesConf(const PaludisEnvironment * const e) :
     _imp(e)
 {
@@ -104,25 +111,30 @@ LicensesConf::add(const FSPath & filename)
             std::shared_ptr<PackageDepSpec> d(std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
                             tokens.at(0), _imp->env,
                             { updso_allow_wildcards, updso_no_disambiguation, updso_throw_if_set })));
+            LicensesList k;
+            for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
+                    t != t_end ; ++t)
+                k.push_back(*t);
+
             if (d->package_ptr())
             {
-                LicensesList & k(_imp->qualified[*d->package_ptr()][d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(*t);
+                _imp->qualified.add(d);
+                _imp->qualified_licenses.push_back(k);
             }
             else
             {
-                LicensesList & k(_imp->unqualified[d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(*t);
+                _imp->unqualified.add(d);
+                _imp->unqualified_licenses.push_back(k);
             }
         }
         catch (const GotASetNotAPackageDepSpec &)
         {
-            NamedSetMap::iterator i(_imp->set.insert(std::make_pair(SetName(tokens.at(0)), std::make_pair(
-                                nullptr, LicensesList()))).first);
+            SetName name(tokens.at(0));
+            NamedSetMap::iterator i(_imp->set.find(name));
+            if (i == _imp->set.end())
+                i = _imp->set.insert(std::make_pair(name, std::make_pair(
+                                std::make_shared<SetSpecMatcher>(_imp->env, name, std::bind(&unknown_set, name)),
+                                LicensesList()))).first;
 
             for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
                     t != t_end ; ++t)
@@ -166,14 +178,11 @@ LicensesConf::query(const std::string & t, const std::shared_ptr<const PackageID
         {
             _imp->expanded = true;
 
-            for (auto & q : _imp->qualified)
-            {
-                for (auto & p : q.second)
-                    expand(_imp->env, p.second);
-            }
+            for (auto & p : _imp->qualified_licenses)
+                expand(_imp->env, p);
 
-            for (auto & p : _imp->unqualified)
-                expand(_imp->env, p.second);
+            for (auto & p : _imp->unqualified_licenses)
+                expand(_imp->env, p);
 
             for (auto & p : _imp->set)
                 expand(_imp->env, p.second.second);
@@ -182,16 +191,8 @@ LicensesConf::query(const std::string & t, const std::shared_ptr<const PackageID
 
     /* highest priority: specific */
     bool break_when_done(false);
-    {
-        SpecificMap::const_iterator i(_imp->qualified.find(e->name()));
-        if (i != _imp->qualified.end())
-        {
-            for (const auto & j : i->second)
-            {
-                if (! match_package(*_imp->env, *j.first, e, nullptr, { }))
-                    continue;
-
-                for (const auto & l : j.second)
+    if (_imp->qualified.find_matches(*_imp->env, e, [&] (const unsigned n) {
+                for (const auto & l : _imp->qualified_licenses[n])
                 {
                     if (l == t)
                         return true;
@@ -202,66 +203,48 @@ LicensesConf::query(const std::string & t, const std::shared_ptr<const PackageID
                     if (l == "-*")
                         break_when_done = true;
                 }
-            }
-        }
-    }
+
+                return false;
+                }))
+        return true;
 
     if (break_when_done)
         return false;
 
     /* next: named sets */
+    for (const auto & i : _imp->set)
     {
-        std::unique_lock<std::mutex> lock(_imp->set_mutex);
-        for (auto & i : _imp->set)
-        {
-            if (! i.second.first)
-            {
-                i.second.first = _imp->env->set(i.first);
-                if (! i.second.first)
-                {
-                    Log::get_instance()->message("paludis_environment.licenses_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
-                        << i.first << "' does not exist";
-                    i.second.first = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
-                }
-            }
-
-            if (! match_package_in_set(*_imp->env, *i.second.first, e, { }))
-                continue;
+        if (! i.second.first->match(e))
+            continue;
 
-            for (const auto & l : i.second.second)
-            {
-                if (l == t)
-                    return true;
+        for (const auto & l : i.second.second)
+        {
+            if (l == t)
+                return true;
 
-                if (l == "*")
-                    return true;
+            if (l == "*")
+                return true;
 
-                if (l == "-*")
-                    break_when_done = true;
-            }
+            if (l == "-*")
+                break_when_done = true;
         }
     }
 
-
     if (break_when_done)
         return false;
 
     /* last: unspecific */
-    for (const auto & j : _imp->unqualified)
-    {
-        if (! match_package(*_imp->env, *j.first, e, nullptr, { }))
-            continue;
-
-        for (const auto & l : j.second)
-        {
-            if (l == t)
-                return true;
+    return _imp->unqualified.find_matches(*_imp->env, e, [&] (const unsigned n) {
+            for (const auto & l : _imp->unqualified_licenses[n])
+            {
+                if (l == t)
+                    return true;
 
-            if (l == "*")
-                return true;
-        }
-    }
+                if (l == "*")
+                    return true;
+            }
 
-    return false;
+            return false;
+            });
 }
 
@@ -23,7 +23,7 @@
 #include <paludis/dep_spec.hh>
 #include <paludis/spec_tree.hh>
 #include <paludis/user_dep_spec.hh>
-#include <paludis/match_package.hh>
+#include <paludis/spec_matcher_index.hh>
 #include <paludis/util/config_file.hh>
 #include <paludis/package_id.hh>
 #include <paludis/environments/paludis/paludis_environment.hh>
@@ -38,14 +38,13 @@
 #include <algorithm>
 #include <functional>
 #include <list>
-#include <mutex>
 #include <set>
 #include <vector>
 
 using namespace paludis;
 using namespace paludis::paludis_environment;
 
-typedef std::list<std::pair<SetName, std::pair<std::shared_ptr<const SetSpecTree>, std::set<std::string> > > > Sets;
+typedef std::list<std::pair<std::shared_ptr<const SetSpecMatcher>, std::set<std::string> > > Sets;
 
 namespace paludis
 {
@@ -54,9 +53,9 @@ namespace paludis
     {
         const PaludisEnvironment * const env;
         const bool allow_reasons;
-        std::list<std::pair<std::shared_ptr<const PackageDepSpec>, std::set<std::string> > > masks;
-        mutable Sets sets;
-        mutable std::mutex set_mutex;
+        SpecMatcherIndex masks;
+        std::vector<std::set<std::string> > mask_reasons;
+        Sets sets;
 
         Imp(const PaludisEnvironment * const e, const bool a) :
             env(e),
@@ -66,6 +65,23 @@ namespace paludis
     };
 }
 
+namespace
+{
+    bool reasons_match(const std::set<std::string> & reasons, const std::string & r)
+    {
+        if (r.empty())
+            return reasons.empty();
+        else
+            return reasons.empty() || (reasons.end() != reasons.find(r));
+    }
+
+    void unknown_set(const SetName & s)
+    {
+        Log::get_instance()->message("paludis_environment.package_mask.unknown_set", ll_warning, lc_no_context) << "Set name '"
+            << s << "' does not exist";
+    }
+}
+
 PackageMaskConf::PackageMaskConf(const PaludisEnvironment * const e, const bool a) :
     _imp(e, a)
 {
@@ -99,18 +115,18 @@ PackageMaskConf::add(const FSPath & filename)
 
         try
         {
-            _imp->masks.push_back(std::make_pair(
-                    std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
+            _imp->masks.add(std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
                             spec,
                             _imp->env,
                             { updso_allow_wildcards,
                               updso_no_disambiguation,
-                              updso_throw_if_set })),
-                    reasons));
+                              updso_throw_if_set })));
+            _imp->mask_reasons.push_back(reasons);
         }
         catch (const GotASetNotAPackageDepSpec &)
         {
-            _imp->sets.push_back(std::make_pair(SetName(spec), std::make_pair(nullptr, reasons)));
+            _imp->sets.push_back(std::make_pair(std::make_shared<SetSpecMatcher>(_imp->env, SetName(spec),
+                            std::bind(&unknown_set, SetName(spec))), reasons));
         }
     }
 }
@@ -118,54 +134,12 @@ PackageMaskConf::add(const FSPath & filename)
 bool
 PackageMaskConf::query(const std::shared_ptr<const PackageID> & e, const std::string & r) const
 {
-    using namespace std::placeholders;
+    if (_imp->masks.find_matches(*_imp->env, e, [&] (const unsigned n) { return reasons_match(_imp->mask_reasons[n], r); }))
+        return true;
 
-    for (const auto & mask : _imp->masks)
-        if (match_package(*_imp->env, *mask.first, e, nullptr, MatchPackageOptions()))
-        {
-            if (r.empty())
-            {
-                if (mask.second.empty())
-                    return true;
-            }
-            else
-            {
-                if (mask.second.empty() || (mask.second.end() != mask.second.find(r)))
-                    return true;
-            }
-        }
-
-    {
-        std::unique_lock<std::mutex> lock(_imp->set_mutex);
-
-        for (auto & set : _imp->sets)
-        {
-            if (! set.second.first)
-            {
-                set.second.first = _imp->env->set(set.first);
-                if (! set.second.first)
-                {
-                    Log::get_instance()->message("paludis_environment.package_mask.unknown_set", ll_warning, lc_no_context) << "Set name '"
-                        << set.first << "' does not exist";
-                    set.second.first = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
-                }
-            }
-
-            if (match_package_in_set(*_imp->env, *set.second.first, e, { }))
-            {
-                if (r.empty())
-                {
-                    if (set.second.second.empty())
-                        return true;
-                }
-                else
-                {
-                    if (set.second.second.empty() || (set.second.second.end() != set.second.second.find(r)))
-                        return true;
-                }
-            }
-        }
-    }
+    for (const auto & set : _imp->sets)
+        if (reasons_match(set.second, r) && set.first->match(e))
+            return true;
 
     return false;
 }
@@ -151,11 +151,8 @@ PaludisEnvironment::PaludisEnvironment(const std::string & s) :
 {
     Context context("When loading paludis environment:");
 
-    for (PaludisConfig::RepositoryConstIterator r(_imp->config->begin_repositories()),
-            r_end(_imp->config->end_repositories()) ; r != r_end ; ++r)
-        add_repository(
-                RepositoryFactory::get_instance()->importance(this, *r),
-                RepositoryFactory::get_instance()->create(this, *r));
+    add_repositories_from_config(std::list<std::function<std::string (const std::string &)> >(
+                _imp->config->begin_repositories(), _imp->config->end_repositories()));
 
     add_metadata_key(_imp->format_key);
     add_metadata_key(_imp->config_location_key);
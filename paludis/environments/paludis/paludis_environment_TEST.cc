@@ -36,7 +36,9 @@
 #include <paludis/metadata_key.hh>
 #include <paludis/choice.hh>
 
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 #include <gtest/gtest.h>
 
 using namespace paludis;
@@ -175,5 +177,13 @@ TEST(PaludisEnvironment, Repositories)
     EXPECT_TRUE(env->more_important_than(RepositoryName("fourth"), RepositoryName("third")));
     EXPECT_TRUE(env->more_important_than(RepositoryName("fourth"), RepositoryName("fifth")));
     EXPECT_TRUE(env->more_important_than(RepositoryName("second"), RepositoryName("fifth")));
+
+    std::vector<std::string> started;
+    for (const auto & t : *env->repository_startup_times())
+        started.push_back(stringify(t.name()));
+    ASSERT_EQ(5u, started.size());
+    EXPECT_TRUE(std::find(started.begin(), started.end(), "second") < std::find(started.begin(), started.end(), "first"));
+    EXPECT_TRUE(std::find(started.begin(), started.end(), "second") < std::find(started.begin(), started.end(), "third"));
+    EXPECT_TRUE(std::find(started.begin(), started.end(), "second") < std::find(started.begin(), started.end(), "fifth"));
 }
 
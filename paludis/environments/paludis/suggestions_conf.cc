@@ -34,12 +34,11 @@
 #include <paludis/dep_spec.hh>
 #include <paludis/spec_tree.hh>
 #include <paludis/user_dep_spec.hh>
-#include <paludis/match_package.hh>
+#include <paludis/spec_matcher_index.hh>
 #include <paludis/package_id.hh>
 #include <paludis/dep_spec_annotations.hh>
 #include <list>
-#include <map>
-#include <mutex>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
@@ -87,11 +86,8 @@ namespace
 }
 
 typedef std::list<ValueFlag> ValuesList;
-typedef std::map<std::shared_ptr<const PackageDepSpec>, ValuesList> PDSToValuesList;
-typedef std::pair<std::shared_ptr<const SetSpecTree>, ValuesList> SetNameEntry;
+typedef std::pair<std::shared_ptr<const SetSpecMatcher>, ValuesList> SetNameEntry;
 
-typedef std::unordered_map<QualifiedPackageName, PDSToValuesList, Hash<QualifiedPackageName> > SpecificMap;
-typedef PDSToValuesList UnspecificMap;
 typedef std::unordered_map<SetName, SetNameEntry, Hash<SetName> > NamedSetMap;
 
 namespace paludis
@@ -101,10 +97,11 @@ namespace paludis
     {
         const PaludisEnvironment * const env;
 
-        SpecificMap qualified;
-        UnspecificMap unqualified;
-        mutable NamedSetMap set;
-        mutable std::mutex set_mutex;
+        SpecMatcherIndex qualified;
+        std::vector<ValuesList> qualified_values;
+        SpecMatcherIndex unqualified;
+        std::vector<ValuesList> unqualified_values;
+        NamedSetMap set;
 
         Imp(const PaludisEnvironment * const e) :
             env(e)
@@ -113,6 +110,40 @@ namespace paludis
     };
 }
 
+namespace
+{
+    void unknown_set(const SetName & s)
+    {
+        Log::get_instance()->message("paludis_environment.suggestions_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
+            << s << "' does not exist";
+    }
+
+    Tribool check_values(const ValuesList & values, const PackageDepSpec & spec, const std::string & spec_group)
+    {
+        for (const auto & l : values)
+        {
+            if (! l.group_requirement.empty())
+            {
+                if (spec_group == l.group_requirement)
+                    return l.negated ? false : true;
+            }
+            else
+            {
+                if (! l.pkg_requirement.empty())
+                    if (stringify(spec.package_ptr()->package()) != l.pkg_requirement)
+                        continue;
+                if (! l.cat_requirement.empty())
+                    if (stringify(spec.package_ptr()->category()) != l.cat_requirement)
+                        continue;
+
+                return l.negated ? false : true;
+            }
+        }
+
+        return indeterminate;
+    }
+}
+
 SuggestionsConf::SuggestionsConf(const PaludisEnvironment * const e) :
     _imp(e)
 {
@@ -142,25 +173,30 @@ SuggestionsConf::add(const FSPath & filename)
             std::shared_ptr<PackageDepSpec> d(std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(
                             tokens.at(0), _imp->env,
                             { updso_allow_wildcards, updso_no_disambiguation, updso_throw_if_set })));
+            ValuesList k;
+            for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
+                    t != t_end ; ++t)
+                k.push_back(ValueFlag(*t));
+
             if (d->package_ptr())
             {
-                ValuesList & k(_imp->qualified[*d->package_ptr()][d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(ValueFlag(*t));
+                _imp->qualified.add(d);
+                _imp->qualified_values.push_back(k);
             }
             else
             {
-                ValuesList & k(_imp->unqualified[d]);
-                for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
-                        t != t_end ; ++t)
-                    k.push_back(ValueFlag(*t));
+                _imp->unqualified.add(d);
+                _imp->unqualified_values.push_back(k);
             }
         }
         catch (const GotASetNotAPackageDepSpec &)
         {
-            NamedSetMap::iterator i(_imp->set.insert(std::make_pair(SetName(tokens.at(0)), std::make_pair(
-                                nullptr, ValuesList()))).first);
+            SetName name(tokens.at(0));
+            NamedSetMap::iterator i(_imp->set.find(name));
+            if (i == _imp->set.end())
+                i = _imp->set.insert(std::make_pair(name, std::make_pair(
+                                std::make_shared<SetSpecMatcher>(_imp->env, name, std::bind(&unknown_set, name)),
+                                ValuesList()))).first;
 
             for (std::vector<std::string>::const_iterator t(next(tokens.begin())), t_end(tokens.end()) ;
                     t != t_end ; ++t)
@@ -182,107 +218,32 @@ SuggestionsConf::interest_in_suggestion(
             spec_group = a->value();
     }
 
+    Tribool result(indeterminate);
+
     /* highest priority: specific */
-    {
-        SpecificMap::const_iterator i(_imp->qualified.find(from_id->name()));
-        if (i != _imp->qualified.end())
-        {
-            for (const auto & j : i->second)
-            {
-                if (! match_package(*_imp->env, *j.first, from_id, nullptr, { }))
-                    continue;
-
-                for (const auto & l : j.second)
-                {
-                    if (! l.group_requirement.empty())
-                    {
-                        if (spec_group == l.group_requirement)
-                            return l.negated ? false : true;
-                    }
-                    else
-                    {
-                        if (! l.pkg_requirement.empty())
-                            if (stringify(spec.package_ptr()->package()) != l.pkg_requirement)
-                                continue;
-                        if (! l.cat_requirement.empty())
-                            if (stringify(spec.package_ptr()->category()) != l.cat_requirement)
-                                continue;
-
-                        return l.negated ? false : true;
-                    }
-                }
-            }
-        }
-    }
+    if (_imp->qualified.find_matches(*_imp->env, from_id, [&] (const unsigned n) {
+                result = check_values(_imp->qualified_values[n], spec, spec_group);
+                return ! result.is_indeterminate();
+                }))
+        return result;
 
     /* next: named sets */
+    for (const auto & i : _imp->set)
     {
-        std::unique_lock<std::mutex> lock(_imp->set_mutex);
-        for (auto & i : _imp->set)
-        {
-            if (! i.second.first)
-            {
-                i.second.first = _imp->env->set(i.first);
-                if (! i.second.first)
-                {
-                    Log::get_instance()->message("paludis_environment.suggestions_conf.unknown_set", ll_warning, lc_no_context) << "Set name '"
-                        << i.first << "' does not exist";
-                    i.second.first = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
-                }
-            }
-
-            if (! match_package_in_set(*_imp->env, *i.second.first, from_id, { }))
-                continue;
-
-            for (const auto & l : i.second.second)
-            {
-                if (! l.group_requirement.empty())
-                {
-                    if (spec_group == l.group_requirement)
-                        return l.negated ? false : true;
-                }
-                else
-                {
-                    if (! l.pkg_requirement.empty())
-                        if (stringify(spec.package_ptr()->package()) != l.pkg_requirement)
-                            continue;
-                    if (! l.cat_requirement.empty())
-                        if (stringify(spec.package_ptr()->category()) != l.cat_requirement)
-                            continue;
+        if (! i.second.first->match(from_id))
+            continue;
 
-                    return l.negated ? false : true;
-                }
-            }
-        }
+        result = check_values(i.second.second, spec, spec_group);
+        if (! result.is_indeterminate())
+            return result;
     }
 
-
     /* last: unspecific */
-    for (const auto & j : _imp->unqualified)
-    {
-        if (! match_package(*_imp->env, *j.first, from_id, nullptr, { }))
-            continue;
-
-        for (const auto & l : j.second)
-        {
-            if (! l.group_requirement.empty())
-            {
-                if (spec_group == l.group_requirement)
-                    return l.negated ? false : true;
-            }
-            else
-            {
-                if (! l.pkg_requirement.empty())
-                    if (stringify(spec.package_ptr()->package()) != l.pkg_requirement)
-                        continue;
-                if (! l.cat_requirement.empty())
-                    if (stringify(spec.package_ptr()->category()) != l.cat_requirement)
-                        continue;
-
-                return l.negated ? false : true;
-            }
-        }
-    }
+    if (_imp->unqualified.find_matches(*_imp->env, from_id, [&] (const unsigned n) {
+                result = check_values(_imp->unqualified_values[n], spec, spec_group);
+                return ! result.is_indeterminate();
+                }))
+        return result;
 
     return indeterminate;
 }
@@ -0,0 +1,568 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/file_owner_index.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/safe_ofstream.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace paludis;
+
+/*
+ * The file consists of a header, followed by two tables and then the text of
+ * every owner and path. As with the binary metadata cache, numbers are native
+ * endian and the header records the byte order.
+ *
+ *   Header
+ *   OwnerRecord[n_owners]      sorted by name
+ *   PathRecord[n_paths]        sorted by path, then by owner
+ *   text
+ *
+ * A path owned by several owners has one record per owner, all pointing at
+ * the same text.
+ */
+
+namespace
+{
+    const char magic[8] = { 'P', 'A', 'L', 'U', 'D', 'I', 'S', 'O' };
+    const uint32_t format_version(1);
+    const uint32_t byte_order_mark(0x01020304);
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t n_owners;
+        uint32_t n_paths;
+        uint32_t text_size;
+        uint32_t unused;
+    };
+
+    struct OwnerRecord
+    {
+        int64_t seconds;
+        int64_t nanoseconds;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct PathRecord
+    {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t owner;
+    };
+
+    int compare(const char * s, std::size_t length, const std::string & t)
+    {
+        int c(std::memcmp(s, t.data(), std::min(length, t.length())));
+        if (0 != c)
+            return c;
+        return length < t.length() ? -1 : length > t.length() ? 1 : 0;
+    }
+
+    struct Mapping
+    {
+        void * data;
+        std::size_t size;
+
+        const OwnerRecord * owners;
+        const PathRecord * paths;
+        const char * text;
+
+        uint32_t n_owners;
+        uint32_t n_paths;
+        uint32_t text_size;
+
+        Mapping() :
+            data(nullptr),
+            size(0),
+            owners(nullptr),
+            paths(nullptr),
+            text(nullptr),
+            n_owners(0),
+            n_paths(0),
+            text_size(0)
+        {
+        }
+
+        ~Mapping()
+        {
+            if (data)
+                ::munmap(data, size);
+        }
+
+        Mapping(const Mapping &) = delete;
+        Mapping & operator= (const Mapping &) = delete;
+
+        bool text_at(uint32_t offset, uint32_t length, const char * & s) const
+        {
+            if (offset > text_size || length > text_size - offset)
+                return false;
+            s = text + offset;
+            return true;
+        }
+
+        std::string owner_name(uint32_t i) const
+        {
+            const char * s;
+            if (i >= n_owners || ! text_at(owners[i].offset, owners[i].length, s))
+                return "";
+            return std::string(s, owners[i].length);
+        }
+
+        std::string path(const PathRecord & p) const
+        {
+            const char * s;
+            if (! text_at(p.offset, p.length, s))
+                return "";
+            return std::string(s, p.length);
+        }
+
+        int compare_path(const PathRecord & p, const std::string & t) const
+        {
+            const char * s;
+            if (! text_at(p.offset, p.length, s))
+                return -1;
+            return compare(s, p.length, t);
+        }
+
+        /* the first record whose path is not less than s */
+        const PathRecord * lower_bound(const std::string & s) const
+        {
+            const PathRecord * b(paths), * e(paths + n_paths);
+            while (b < e)
+            {
+                const PathRecord * m(b + (e - b) / 2);
+                if (compare_path(*m, s) < 0)
+                    b = m + 1;
+                else
+                    e = m;
+            }
+            return b;
+        }
+    };
+
+    std::shared_ptr<Mapping> map_file(const FSPath & filename)
+    {
+        Context context("When mapping file owner index '" + stringify(filename) + "':");
+
+        auto result(std::make_shared<Mapping>());
+
+        int fd(::open(stringify(filename).c_str(), O_RDONLY | O_CLOEXEC));
+        if (-1 == fd)
+        {
+            if (ENOENT != errno)
+                Log::get_instance()->message("file_owner_index.open", ll_warning, lc_context)
+                    << "Couldn't open '" << filename << "': " << std::strerror(errno);
+            return result;
+        }
+
+        struct ::stat st;
+        if (0 != ::fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(Header)))
+        {
+            ::close(fd);
+            Log::get_instance()->message("file_owner_index.truncated", ll_warning, lc_context)
+                << "File is too short to be a file owner index";
+            return result;
+        }
+
+        void * data(::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+        ::close(fd);
+        if (MAP_FAILED == data)
+        {
+            Log::get_instance()->message("file_owner_index.mmap", ll_warning, lc_context)
+                << "Couldn't mmap: " << std::strerror(errno);
+            return result;
+        }
+
+        std::shared_ptr<Mapping> m(std::make_shared<Mapping>());
+        m->data = data;
+        m->size = st.st_size;
+
+        const Header & h(*static_cast<const Header *>(data));
+        if (0 != std::memcmp(h.magic, magic, sizeof(magic)) || h.version != format_version || h.byte_order != byte_order_mark)
+        {
+            Log::get_instance()->message("file_owner_index.format", ll_warning, lc_context)
+                << "File is not a file owner index in a format we understand";
+            return result;
+        }
+
+        uint64_t needed(sizeof(Header));
+        needed += uint64_t(h.n_owners) * sizeof(OwnerRecord);
+        needed += uint64_t(h.n_paths) * sizeof(PathRecord);
+        needed += h.text_size;
+        if (needed != m->size)
+        {
+            Log::get_instance()->message("file_owner_index.truncated", ll_warning, lc_context)
+                << "File has size " << m->size << ", but expected " << needed;
+            return result;
+        }
+
+        const char * p(static_cast<const char *>(data) + sizeof(Header));
+        m->owners = reinterpret_cast<const OwnerRecord *>(p);
+        p += h.n_owners * sizeof(OwnerRecord);
+        m->paths = reinterpret_cast<const PathRecord *>(p);
+        p += h.n_paths * sizeof(PathRecord);
+        m->text = p;
+
+        m->n_owners = h.n_owners;
+        m->n_paths = h.n_paths;
+        m->text_size = h.text_size;
+
+        return m;
+    }
+
+    template <typename T_>
+    void append_records(std::string & s, const std::vector<T_> & v)
+    {
+        if (! v.empty())
+            s.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T_));
+    }
+
+    /* the paths p with lo <= p < hi, for an exact path or for everything
+     * beneath a directory */
+    std::pair<std::string, std::string> exact_range(const std::string & path)
+    {
+        return std::make_pair(path, path + '\0');
+    }
+
+    std::pair<std::string, std::string> beneath_range(const std::string & directory)
+    {
+        std::string prefix(directory);
+        if (prefix.empty() || '/' != prefix.at(prefix.length() - 1))
+            prefix.append("/");
+
+        std::string end(prefix);
+        end.at(end.length() - 1) = '/' + 1;
+        return std::make_pair(prefix, end);
+    }
+
+    struct Replacement
+    {
+        Timestamp stamp;
+        std::vector<std::string> paths;
+
+        Replacement(const Timestamp & s, const std::vector<std::string> & p) :
+            stamp(s),
+            paths(p)
+        {
+            std::sort(paths.begin(), paths.end());
+            paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+        }
+    };
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<FileOwnerIndex>
+    {
+        const FSPath filename;
+
+        mutable std::mutex mutex;
+
+        mutable bool loaded;
+        mutable std::shared_ptr<const Mapping> mapping;
+
+        /* owners that differ from what is in the file */
+        std::map<std::string, Replacement> replaced;
+        std::set<std::string> removed;
+
+        Imp(const FSPath & f) :
+            filename(f),
+            loaded(false)
+        {
+        }
+
+        void need_loaded() const
+        {
+            if (loaded)
+                return;
+
+            loaded = true;
+            mapping = map_file(filename);
+        }
+
+        bool shadowed(const std::string & owner) const
+        {
+            return replaced.end() != replaced.find(owner) || removed.end() != removed.find(owner);
+        }
+
+        void owners_in_range(const std::pair<std::string, std::string> & range, std::set<std::string> & result) const
+        {
+            need_loaded();
+
+            std::set<uint32_t> indices;
+            for (const PathRecord * p(mapping->lower_bound(range.first)), * p_end(mapping->paths + mapping->n_paths) ;
+                    p != p_end && mapping->compare_path(*p, range.second) < 0 ; ++p)
+                indices.insert(p->owner);
+
+            for (auto i : indices)
+            {
+                std::string owner(mapping->owner_name(i));
+                if (! owner.empty() && ! shadowed(owner))
+                    result.insert(owner);
+            }
+
+            for (const auto & r : replaced)
+            {
+                auto p(std::lower_bound(r.second.paths.begin(), r.second.paths.end(), range.first));
+                if (r.second.paths.end() != p && *p < range.second)
+                    result.insert(r.first);
+            }
+        }
+
+        void write(const LogLevel failure_log_level)
+        {
+            need_loaded();
+            if (replaced.empty() && removed.empty())
+                return;
+
+            Context context("When writing file owner index '" + stringify(filename) + "':");
+
+            if (! filename.dirname().stat().is_directory_or_symlink_to_directory())
+            {
+                Log::get_instance()->message("file_owner_index.save.no_dir", failure_log_level, lc_no_context) << "Directory '"
+                    << filename.dirname() << "' does not exist, so cannot save file owner index '" << filename << "'";
+                return;
+            }
+
+            /* everything in the file, less anything that has been removed or
+             * replaced, plus everything new, in name order */
+            std::map<std::string, Timestamp> owners;
+            std::vector<uint32_t> old_owner_indices(mapping->n_owners, UINT32_MAX);
+            for (uint32_t i(0) ; i < mapping->n_owners ; ++i)
+            {
+                std::string owner(mapping->owner_name(i));
+                if (! owner.empty() && ! shadowed(owner))
+                    owners.insert(std::make_pair(owner, Timestamp(mapping->owners[i].seconds, mapping->owners[i].nanoseconds)));
+            }
+
+            for (const auto & r : replaced)
+                owners.insert(std::make_pair(r.first, r.second.stamp));
+
+            std::string text;
+            std::vector<OwnerRecord> owner_records;
+            std::map<std::string, uint32_t> owner_indices;
+            for (const auto & o : owners)
+            {
+                if (text.length() + o.first.length() > UINT32_MAX)
+                    throw InternalError(PALUDIS_HERE, "file owner index is too large");
+
+                OwnerRecord r;
+                r.seconds = o.second.seconds();
+                r.nanoseconds = o.second.nanoseconds();
+                r.offset = text.length();
+                r.length = o.first.length();
+                text.append(o.first);
+
+                owner_indices.insert(std::make_pair(o.first, owner_records.size()));
+                owner_records.push_back(r);
+            }
+
+            for (uint32_t i(0) ; i < mapping->n_owners ; ++i)
+            {
+                auto o(owner_indices.find(mapping->owner_name(i)));
+                if (owner_indices.end() != o && ! shadowed(o->first))
+                    old_owner_indices[i] = o->second;
+            }
+
+            std::vector<std::pair<std::string, uint32_t> > paths;
+            for (const PathRecord * p(mapping->paths), * p_end(mapping->paths + mapping->n_paths) ; p != p_end ; ++p)
+                if (p->owner < old_owner_indices.size() && UINT32_MAX != old_owner_indices[p->owner])
+                    paths.push_back(std::make_pair(mapping->path(*p), old_owner_indices[p->owner]));
+
+            for (const auto & r : replaced)
+            {
+                uint32_t owner(owner_indices.find(r.first)->second);
+                for (const auto & p : r.second.paths)
+                    paths.push_back(std::make_pair(p, owner));
+            }
+
+            std::sort(paths.begin(), paths.end());
+
+            std::vector<PathRecord> path_records;
+            path_records.reserve(paths.size());
+            for (auto p(paths.begin()), p_end(paths.end()) ; p != p_end ; ++p)
+            {
+                PathRecord r;
+                if (p != paths.begin() && (p - 1)->first == p->first)
+                    r.offset = path_records.back().offset;
+                else
+                {
+                    if (text.length() + p->first.length() > UINT32_MAX)
+                        throw InternalError(PALUDIS_HERE, "file owner index is too large");
+
+                    r.offset = text.length();
+                    text.append(p->first);
+                }
+                r.length = p->first.length();
+                r.owner = p->second;
+                path_records.push_back(r);
+            }
+
+            Header h;
+            std::memcpy(h.magic, magic, sizeof(magic));
+            h.version = format_version;
+            h.byte_order = byte_order_mark;
+            h.n_owners = owner_records.size();
+            h.n_paths = path_records.size();
+            h.text_size = text.length();
+            h.unused = 0;
+
+            /* write to a new file and rename it over the old one, so that
+             * anyone who has the old one mapped carries on seeing a
+             * consistent file */
+            FSPath tmp(filename.dirname() / (filename.basename() + ".new." + stringify(::getpid())));
+            try
+            {
+                {
+                    std::string data(reinterpret_cast<const char *>(&h), sizeof(h));
+                    append_records(data, owner_records);
+                    append_records(data, path_records);
+                    data.append(text);
+
+                    SafeOFStream s(tmp, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, true);
+                    s << data;
+                }
+
+                tmp.rename(filename);
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("file_owner_index.save.failure", failure_log_level, lc_no_context)
+                    << "Couldn't write file owner index to '" << filename << "': " << e.message() << " (" << e.what() << ")";
+
+                try
+                {
+                    if (tmp.stat().exists())
+                        tmp.unlink();
+                }
+                catch (const FSError &)
+                {
+                }
+                return;
+            }
+
+            mapping = map_file(filename);
+            replaced.clear();
+            removed.clear();
+        }
+    };
+}
+
+FileOwnerIndex::FileOwnerIndex(const FSPath & f) :
+    _imp(f)
+{
+}
+
+FileOwnerIndex::~FileOwnerIndex() = default;
+
+const FSPath
+FileOwnerIndex::filename() const
+{
+    return _imp->filename;
+}
+
+std::map<std::string, Timestamp>
+FileOwnerIndex::stamps() const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    std::map<std::string, Timestamp> result;
+    for (uint32_t i(0) ; i < _imp->mapping->n_owners ; ++i)
+    {
+        std::string owner(_imp->mapping->owner_name(i));
+        if (! owner.empty() && ! _imp->shadowed(owner))
+            result.insert(std::make_pair(owner, Timestamp(_imp->mapping->owners[i].seconds, _imp->mapping->owners[i].nanoseconds)));
+    }
+
+    for (const auto & r : _imp->replaced)
+        result.insert(std::make_pair(r.first, r.second.stamp));
+
+    return result;
+}
+
+void
+FileOwnerIndex::replace(const std::string & owner, const Timestamp & stamp, const std::vector<std::string> & paths)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->removed.erase(owner);
+    _imp->replaced.erase(owner);
+    _imp->replaced.insert(std::make_pair(owner, Replacement(stamp, paths)));
+}
+
+void
+FileOwnerIndex::remove(const std::string & owner)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->replaced.erase(owner);
+    _imp->removed.insert(owner);
+}
+
+std::vector<std::string>
+FileOwnerIndex::owners_of(const FSPath & path) const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+
+    std::set<std::string> result;
+    _imp->owners_in_range(exact_range(stringify(path)), result);
+    return std::vector<std::string>(result.begin(), result.end());
+}
+
+std::vector<std::string>
+FileOwnerIndex::owners_within(const FSPath & directory) const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+
+    std::set<std::string> result;
+    std::string d(stringify(directory));
+    if ("/" != d)
+        _imp->owners_in_range(exact_range(d), result);
+    _imp->owners_in_range(beneath_range(d), result);
+    return std::vector<std::string>(result.begin(), result.end());
+}
+
+void
+FileOwnerIndex::write(const LogLevel failure_log_level)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->write(failure_log_level);
+}
+
+namespace paludis
+{
+    template class Pimp<FileOwnerIndex>;
+}
@@ -0,0 +1,124 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_FILE_OWNER_INDEX_HH
+#define PALUDIS_GUARD_PALUDIS_FILE_OWNER_INDEX_HH 1
+
+#include <paludis/file_owner_index-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/log.hh>
+#include <map>
+#include <string>
+#include <vector>
+
+/** \file
+ * Declarations for FileOwnerIndex, which is used by some Repository
+ * subclasses to implement RepositoryFileOwnerInterface.
+ *
+ * \ingroup g_repository
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * A persistent index from paths to the names of whatever owns them.
+     *
+     * Owners are opaque strings chosen by the repository (usually the
+     * location of an installed package's directory, relative to the
+     * repository). Each owner also has a stamp, which the repository can
+     * compare against the current state of its contents files to decide
+     * whether the owner's entries are stale.
+     *
+     * The file is memory mapped the first time it is needed, and lookups are
+     * done by a binary search of a sorted path table, so a query does not
+     * require the whole index to be read. Changes are kept in memory, and
+     * are visible to queries immediately, until write() is called.
+     *
+     * \see RepositoryFileOwnerInterface
+     * \ingroup g_repository
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE FileOwnerIndex
+    {
+        private:
+            Pimp<FileOwnerIndex> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit FileOwnerIndex(const FSPath & filename);
+            ~FileOwnerIndex();
+
+            FileOwnerIndex(const FileOwnerIndex &) = delete;
+            FileOwnerIndex & operator= (const FileOwnerIndex &) = delete;
+
+            ///\}
+
+            const FSPath filename() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            ///\name Index operations
+            ///\{
+
+            /**
+             * Every owner in the index, along with its stamp.
+             */
+            std::map<std::string, Timestamp> stamps() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Replace everything recorded for an owner.
+             */
+            void replace(const std::string & owner, const Timestamp & stamp, const std::vector<std::string> & paths);
+
+            /**
+             * Remove an owner.
+             */
+            void remove(const std::string & owner);
+
+            /**
+             * The owners of exactly the specified path, sorted.
+             */
+            std::vector<std::string> owners_of(const FSPath &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * The owners of the specified path or of anything beneath it,
+             * sorted.
+             */
+            std::vector<std::string> owners_within(const FSPath &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Write out the file, if anything has changed.
+             *
+             * Failure is logged at the specified level, and leaves the
+             * changes in memory.
+             */
+            void write(const LogLevel failure_log_level);
+
+            ///\}
+    };
+
+    extern template class Pimp<FileOwnerIndex>;
+}
+
+#endif
@@ -0,0 +1,122 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/file_owner_index.hh>
+
+#include <paludis/util/join.hh>
+#include <paludis/util/fs_stat.hh>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    std::string owners(const std::vector<std::string> & v)
+    {
+        return join(v.begin(), v.end(), " ");
+    }
+}
+
+TEST(FileOwnerIndex, NotExisting)
+{
+    FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/not_existing"));
+    EXPECT_TRUE(index.stamps().empty());
+    EXPECT_EQ("", owners(index.owners_of(FSPath("/usr"))));
+    EXPECT_EQ("", owners(index.owners_within(FSPath("/"))));
+}
+
+TEST(FileOwnerIndex, NotAnIndex)
+{
+    FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/not_an_index"));
+    EXPECT_TRUE(index.stamps().empty());
+    EXPECT_EQ("", owners(index.owners_of(FSPath("/usr"))));
+}
+
+TEST(FileOwnerIndex, Queries)
+{
+    FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/queries"));
+    index.replace("one", Timestamp(1, 0), { "/usr", "/usr/bin", "/usr/bin/one", "/usr/lib/libone.so" });
+    index.replace("two", Timestamp(2, 0), { "/usr", "/usr/bin", "/usr/bin/two", "/usrx/two" });
+    index.replace("three", Timestamp(3, 0), { "/opt/three" });
+
+    EXPECT_EQ("one two", owners(index.owners_of(FSPath("/usr"))));
+    EXPECT_EQ("one", owners(index.owners_of(FSPath("/usr/bin/one"))));
+    EXPECT_EQ("", owners(index.owners_of(FSPath("/usr/bin/on"))));
+    EXPECT_EQ("", owners(index.owners_of(FSPath("/usr/lib"))));
+
+    EXPECT_EQ("one", owners(index.owners_within(FSPath("/usr/lib"))));
+    EXPECT_EQ("one two", owners(index.owners_within(FSPath("/usr"))));
+    EXPECT_EQ("two", owners(index.owners_within(FSPath("/usrx"))));
+    EXPECT_EQ("one three two", owners(index.owners_within(FSPath("/"))));
+    EXPECT_EQ("", owners(index.owners_within(FSPath("/var"))));
+
+    index.write(ll_warning);
+    EXPECT_TRUE(FSPath("file_owner_index_TEST_dir/queries").stat().is_regular_file());
+
+    EXPECT_EQ("one two", owners(index.owners_of(FSPath("/usr"))));
+    EXPECT_EQ("one", owners(index.owners_within(FSPath("/usr/lib"))));
+    EXPECT_EQ("one three two", owners(index.owners_within(FSPath("/"))));
+}
+
+TEST(FileOwnerIndex, Persistence)
+{
+    {
+        FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/persistence"));
+        index.replace("one", Timestamp(1, 10), { "/bin/one", "/bin" });
+        index.replace("two", Timestamp(2, 20), { "/bin/two", "/bin" });
+        index.write(ll_warning);
+    }
+
+    {
+        FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/persistence"));
+        auto stamps(index.stamps());
+        ASSERT_EQ(2u, stamps.size());
+        EXPECT_TRUE(Timestamp(1, 10) == stamps.find("one")->second);
+        EXPECT_TRUE(Timestamp(2, 20) == stamps.find("two")->second);
+
+        EXPECT_EQ("one two", owners(index.owners_of(FSPath("/bin"))));
+        EXPECT_EQ("two", owners(index.owners_of(FSPath("/bin/two"))));
+
+        index.replace("one", Timestamp(3, 30), { "/sbin/one" });
+        index.remove("two");
+
+        EXPECT_EQ("", owners(index.owners_of(FSPath("/bin"))));
+        EXPECT_EQ("one", owners(index.owners_of(FSPath("/sbin/one"))));
+        index.write(ll_warning);
+    }
+
+    {
+        FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/persistence"));
+        auto stamps(index.stamps());
+        ASSERT_EQ(1u, stamps.size());
+        EXPECT_TRUE(Timestamp(3, 30) == stamps.find("one")->second);
+
+        EXPECT_EQ("", owners(index.owners_within(FSPath("/bin"))));
+        EXPECT_EQ("one", owners(index.owners_within(FSPath("/sbin"))));
+    }
+}
+
+TEST(FileOwnerIndex, NoDirectory)
+{
+    FileOwnerIndex index(FSPath("file_owner_index_TEST_dir/no_directory/index"));
+    index.replace("one", Timestamp(1, 0), { "/one" });
+    index.write(ll_debug);
+
+    EXPECT_TRUE(! FSPath("file_owner_index_TEST_dir/no_directory/index").stat().exists());
+    EXPECT_EQ("one", owners(index.owners_of(FSPath("/one"))));
+}
@@ -31,6 +31,7 @@ add(`dep_spec',                                    `hh', `cc', `gtest', `fwd')
 add(`dep_spec_annotations',                        `hh', `cc', `fwd', `se')
 add(`dep_spec_data',                               `hh', `cc', `fwd')
 add(`dep_spec_flattener',                          `hh', `cc')
+add(`dependents_index',                            `hh', `cc', `fwd', `gtest', `testscript')
 add(`distribution',                                `hh', `cc', `impl', `fwd')
 add(`elf_linkage_checker',                         `hh', `cc')
 add(`elike_blocker',                               `hh', `cc', `fwd', `se')
@@ -44,6 +45,7 @@ add(`environment',                                 `hh', `fwd', `cc')
 add(`environment_factory',                         `hh', `fwd', `cc')
 add(`environment_implementation',                  `hh', `cc', `gtest')
 add(`file_output_manager',                         `hh', `cc', `fwd')
+add(`file_owner_index',                            `hh', `cc', `fwd', `gtest', `testscript')
 add(`filter',                                      `hh', `cc', `fwd', `gtest')
 add(`filter_handler',                              `hh', `cc', `fwd')
 add(`filtered_generator',                          `hh', `cc', `fwd', `gtest')
@@ -79,6 +81,7 @@ add(`output_manager_from_environment',             `hh', `fwd', `cc')
 add(`package_dep_spec_collection',                 `hh', `cc', `fwd')
 add(`package_dep_spec_properties',                 `hh', `cc', `fwd')
 add(`package_id',                                  `hh', `cc', `fwd', `se')
+add(`packed_contents',                             `hh', `cc', `fwd', `gtest', `testscript')
 add(`paludis',                                     `hh')
 add(`paludislike_options_conf',                    `hh', `cc', `fwd')
 add(`partially_made_package_dep_spec',             `hh', `cc', `fwd', `se')
@@ -95,6 +98,7 @@ add(`serialise',                                   `hh', `cc', `fwd', `impl')
 add(`set_file',                                    `hh', `cc', `se', `gtest', `testscript')
 add(`slot',                                        `hh', `fwd', `cc')
 add(`slot_requirement',                            `hh', `fwd', `cc')
+add(`spec_matcher_index',                          `hh', `cc', `fwd', `gtest')
 add(`spec_tree',                                   `hh', `fwd', `cc')
 add(`standard_output_manager',                     `hh', `cc', `fwd')
 add(`stripper',                                    `hh', `cc', `fwd', `gtest', `testscript')
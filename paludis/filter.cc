@@ -118,6 +118,12 @@ Filter::as_string() const
     return _imp->handler->as_string();
 }
 
+std::string
+Filter::cache_key() const
+{
+    return _imp->handler->cache_key();
+}
+
 namespace
 {
     struct AllFilterHandler :
@@ -127,6 +133,11 @@ namespace
         {
             return "all matches";
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     template <typename A_>
@@ -161,6 +172,11 @@ namespace
         {
             return "supports action " + stringify(ActionNames<A_>::value);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct NotMaskedFilterHandler :
@@ -199,6 +215,11 @@ namespace
         {
             return "not masked";
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct InstalledAtFilterHandler :
@@ -248,6 +269,11 @@ namespace
         {
             return "installed " + std::string(equal ? "" : "not ") + "at root " + stringify(root);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct AndFilterHandler :
@@ -302,6 +328,14 @@ namespace
         {
             return stringify(f1) + " filtered through " + stringify(f2);
         }
+
+        std::string cache_key() const override
+        {
+            std::string k1(f1.cache_key()), k2(f2.cache_key());
+            if (k1.empty() || k2.empty())
+                return "";
+            return k1 + " filtered through " + k2;
+        }
     };
 
     struct SameSlotHandler :
@@ -345,6 +379,11 @@ namespace
         {
             return "same slot as " + stringify(*as_id);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct SlotHandler :
@@ -378,6 +417,11 @@ namespace
         {
             return "slot is " + stringify(slot);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct NoSlotHandler :
@@ -404,6 +448,11 @@ namespace
         {
             return "has no slot";
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct MatchesHandler :
@@ -447,6 +496,14 @@ namespace
                 suffix = " (ignoring additional requirements)";
             return "packages matching " + stringify(spec) + suffix;
         }
+
+        std::string cache_key() const override
+        {
+            /* spec may be relative to from_id, which as_string doesn't show */
+            if (from_id)
+                return "";
+            return as_string();
+        }
     };
 
     struct ByFunctionHandler :
@@ -24,6 +24,12 @@ using namespace paludis;
 
 FilterHandler::~FilterHandler() = default;
 
+std::string
+FilterHandler::cache_key() const
+{
+    return "";
+}
+
 std::shared_ptr<const RepositoryNameSet>
 AllFilterHandlerBase::repositories(const Environment * const,
         const std::shared_ptr<const RepositoryNameSet> & s) const
@@ -38,6 +38,14 @@ namespace paludis
 
             virtual std::string as_string() const = 0;
 
+            /**
+             * A string identifying our results, for use as a cache key, or an
+             * empty string if our results may not be remembered.
+             *
+             * \since 3.0
+             */
+            virtual std::string cache_key() const;
+
             virtual const RepositoryContentMayExcludes may_excludes() const = 0;
 
             virtual std::shared_ptr<const RepositoryNameSet> repositories(
@@ -81,6 +81,15 @@ FilteredGenerator::filter() const
     return _imp->filter;
 }
 
+std::string
+FilteredGenerator::cache_key() const
+{
+    std::string g(_imp->generator.cache_key()), f(_imp->filter.cache_key());
+    if (g.empty() || f.empty())
+        return "";
+    return g + " with filter " + f;
+}
+
 FilteredGenerator
 paludis::operator| (const FilteredGenerator & g, const Filter & f)
 {
@@ -71,6 +71,14 @@ namespace paludis
              * Return our Filter.
              */
             const Filter & filter() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * A string identifying our results, for use as a cache key, or an
+             * empty string if our generator or filter may not be remembered.
+             *
+             * \since 3.0
+             */
+            std::string cache_key() const PALUDIS_ATTRIBUTE((warn_unused_result));
     };
 
     extern template class Pimp<FilteredGenerator>;
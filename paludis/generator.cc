@@ -125,6 +125,12 @@ Generator::as_string() const
     return _imp->handler->as_string();
 }
 
+std::string
+Generator::cache_key() const
+{
+    return _imp->handler->cache_key();
+}
+
 namespace
 {
     struct InRepositoryGeneratorHandler :
@@ -151,6 +157,11 @@ namespace
         {
             return "packages with repository " + stringify(name);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct FromRepositoryGeneratorHandler :
@@ -193,6 +204,11 @@ namespace
         {
             return "packages originally from repository " + stringify(name);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct CategoryGeneratorHandler :
@@ -227,6 +243,11 @@ namespace
         {
             return "packages with category " + stringify(name);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct PackageGeneratorHandler :
@@ -275,6 +296,11 @@ namespace
         {
             return "packages named " + stringify(name);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct MatchesGeneratorHandler :
@@ -459,6 +485,14 @@ namespace
                 suffix = " (ignoring additional requirements)";
             return "packages matching " + stringify(spec) + suffix;
         }
+
+        std::string cache_key() const override
+        {
+            /* spec may be relative to from_id, which as_string doesn't show */
+            if (from_id)
+                return "";
+            return as_string();
+        }
     };
 
     struct IntersectionGeneratorHandler :
@@ -563,6 +597,14 @@ namespace
         {
             return stringify(g1) + " intersected with " + stringify(g2);
         }
+
+        std::string cache_key() const override
+        {
+            std::string k1(g1.cache_key()), k2(g2.cache_key());
+            if (k1.empty() || k2.empty())
+                return "";
+            return k1 + " intersected with " + k2;
+        }
     };
 
     struct UnionGeneratorHandler :
@@ -643,6 +685,14 @@ namespace
         {
             return stringify(g1) + " unioned with " + stringify(g2);
         }
+
+        std::string cache_key() const override
+        {
+            std::string k1(g1.cache_key()), k2(g2.cache_key());
+            if (k1.empty() || k2.empty())
+                return "";
+            return k1 + " unioned with " + k2;
+        }
     };
 
     struct AllGeneratorHandler :
@@ -652,6 +702,11 @@ namespace
         {
             return "all packages";
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     template <typename A_>
@@ -674,6 +729,11 @@ namespace
         {
             return "packages that might support action " + stringify(ActionNames<A_>::value);
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 
     struct NothingGeneratorHandler :
@@ -716,6 +776,11 @@ namespace
         {
             return "no packages";
         }
+
+        std::string cache_key() const override
+        {
+            return as_string();
+        }
     };
 }
 
@@ -88,6 +88,14 @@ namespace paludis
              */
             std::string as_string() const PALUDIS_ATTRIBUTE((warn_unused_result));
 
+            /**
+             * A string identifying our results, for use as a cache key, or an
+             * empty string if our results may not be remembered.
+             *
+             * \since 3.0
+             */
+            std::string cache_key() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
             ///\name For use by Selection
             ///\{
 
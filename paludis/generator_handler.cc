@@ -34,6 +34,12 @@ using namespace paludis;
 
 GeneratorHandler::~GeneratorHandler() = default;
 
+std::string
+GeneratorHandler::cache_key() const
+{
+    return "";
+}
+
 std::shared_ptr<const RepositoryNameSet>
 AllGeneratorHandlerBase::repositories(
         const Environment * const env,
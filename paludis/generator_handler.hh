@@ -62,6 +62,14 @@ namespace paludis
                 PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
 
             virtual std::string as_string() const = 0;
+
+            /**
+             * A string identifying our results, for use as a cache key, or an
+             * empty string if our results may not be remembered.
+             *
+             * \since 3.0
+             */
+            virtual std::string cache_key() const;
     };
 
     class PALUDIS_VISIBLE AllGeneratorHandlerBase :
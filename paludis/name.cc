@@ -241,7 +241,7 @@ namespace
     CategoryNamePart
     get_category_name_part(const std::string & s)
     {
-        Context c("When splitting out category and package names from '" + s + "':");
+        LazyContext c([&] () { return "When splitting out category and package names from '" + s + "':"; });
 
         std::string::size_type p(s.find('/'));
         if (std::string::npos == p)
@@ -254,7 +254,7 @@ namespace
     PackageNamePart
     get_package_name_part(const std::string & s)
     {
-        Context c("When splitting out category and package names from '" + s + "':");
+        LazyContext c([&] () { return "When splitting out category and package names from '" + s + "':"; });
 
         std::string::size_type p(s.find('/'));
         if (std::string::npos == p)
@@ -358,6 +358,6 @@ WrappedValueTraits<PartNameTag>::validate(const std::string & name)
 std::size_t
 QualifiedPackageName::hash() const
 {
-    return Hash<std::string>()(stringify(*this));
+    return (_cat.hash() << 8) ^ _pkg.hash();
 }
 
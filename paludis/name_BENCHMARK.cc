@@ -0,0 +1,138 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/name.hh>
+#include <paludis/repositories/fake/fake_repository.hh>
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/util/exception.hh>
+#include <paludis/util/interned_string.hh>
+#include <paludis/util/hashes.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/stringify.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <malloc.h>
+
+using namespace paludis;
+
+namespace
+{
+    const unsigned n_categories(150);
+    const unsigned n_packages(130);
+    const unsigned n_versions(3);
+
+    std::size_t heap_in_use()
+    {
+        return mallinfo2().uordblks;
+    }
+
+    template <typename F_>
+    double milliseconds(const F_ & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /* names are built from strings every time, as a repository does when it
+     * reads directory entries and cache files */
+    std::vector<std::pair<std::string, std::string> > tree_names()
+    {
+        std::vector<std::pair<std::string, std::string> > result;
+        for (unsigned c(0) ; c < n_categories ; ++c)
+            for (unsigned p(0) ; p < n_packages ; ++p)
+                for (unsigned v(0) ; v < n_versions ; ++v)
+                    result.push_back(std::make_pair("category-" + stringify(c), "package-name" + stringify(p)));
+        return result;
+    }
+
+    /* what every name used to cost: its own heap string per part */
+    typedef std::pair<std::shared_ptr<const std::string>, std::shared_ptr<const std::string> > UninternedName;
+}
+
+int main(int, char *[])
+{
+    const std::vector<std::pair<std::string, std::string> > names(tree_names());
+    std::cout << std::fixed << std::setprecision(1)
+        << names.size() << " IDs in " << n_categories * n_packages << " packages" << std::endl;
+
+    {
+        std::size_t before(heap_in_use());
+        std::vector<UninternedName> old_names;
+        old_names.reserve(names.size());
+        for (const auto & n : names)
+            old_names.push_back(std::make_pair(std::make_shared<const std::string>(n.first), std::make_shared<const std::string>(n.second)));
+        std::cout << "    name, one string per part:   " << double(heap_in_use() - before) / names.size() << " bytes" << std::endl;
+    }
+
+    std::vector<QualifiedPackageName> qpns;
+    {
+        std::size_t before(heap_in_use());
+        qpns.reserve(names.size());
+        for (const auto & n : names)
+            qpns.push_back(CategoryNamePart(n.first) + PackageNamePart(n.second));
+        std::cout << "    QualifiedPackageName:        " << double(heap_in_use() - before) / names.size()
+            << " bytes, " << InternedString::number_interned() << " strings interned" << std::endl;
+    }
+
+    {
+        std::unordered_set<QualifiedPackageName, Hash<QualifiedPackageName> > set;
+        unsigned found(0);
+        double hashed(milliseconds([&] () {
+                    set.insert(qpns.begin(), qpns.end());
+                    for (const auto & q : qpns)
+                        found += set.count(q);
+                    }));
+        std::vector<QualifiedPackageName> sorted(qpns);
+        std::reverse(sorted.begin(), sorted.end());
+        double ordered(milliseconds([&] () { std::sort(sorted.begin(), sorted.end()); }));
+        if (found != qpns.size())
+            throw InternalError(PALUDIS_HERE, "lost some names");
+        std::cout << "    hash insert and lookup:      " << hashed << "ms" << std::endl
+            << "    sort:                        " << ordered << "ms" << std::endl;
+    }
+
+    {
+        TestEnvironment env;
+        std::size_t before(heap_in_use());
+        std::shared_ptr<FakeRepository> repo;
+        double taken(milliseconds([&] () {
+                    repo = std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                                n::environment() = &env,
+                                n::name() = RepositoryName("benchmark")
+                                ));
+                    unsigned v(0);
+                    for (const auto & n : names)
+                        repo->add_version(n.first, n.second, "1." + stringify(v++ % n_versions));
+                    }));
+        std::cout << "    loading a fake tree:         " << taken << "ms, "
+            << double(heap_in_use() - before) / (1024 * 1024) << "MiB" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
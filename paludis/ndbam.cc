@@ -37,6 +37,7 @@
 #include <paludis/metadata_key.hh>
 #include <paludis/name.hh>
 #include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/literal_metadata_key.hh>
 #include <algorithm>
 #include <unordered_map>
@@ -450,6 +451,29 @@ NDBAM::parse_contents(const PackageID & id,
         return;
     }
 
+    PackedContents packed(ff.dirname() / "contents.packed", ff);
+    if (packed.usable())
+    {
+        packed.for_each([&] (const PackedContentsEntry & p) {
+                switch (p.type)
+                {
+                    case pcet_file:
+                        on_file(make_contents_entry(p));
+                        break;
+                    case pcet_dir:
+                        on_dir(make_contents_entry(p));
+                        break;
+                    case pcet_sym:
+                        on_sym(make_contents_entry(p));
+                        break;
+                    case pcet_other:
+                    case last_pcet:
+                        break;
+                }
+            });
+        return;
+    }
+
     LineConfigFile f(ff, { });
     for (const auto & line : f)
     {
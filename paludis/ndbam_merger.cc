@@ -44,6 +44,7 @@
 #include <paludis/version_spec.hh>
 #include <paludis/partitioning.hh>
 #include <paludis/slot.hh>
+#include <paludis/packed_contents.hh>
 
 #include <iomanip>
 #include <list>
@@ -58,6 +59,7 @@ namespace paludis
         NDBAMMergerParams params;
         FSPath realroot;
         std::shared_ptr<SafeOFStream> contents_file;
+        PackedContentsWriter packed_contents;
 
         std::list<std::string> config_protect;
         std::list<std::string> config_protect_mask;
@@ -189,6 +191,18 @@ NDBAMMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, con
     if (_imp->params.is_volatile()(FSPath(tidy)))
         *_imp->contents_file << " volatile=true";
     *_imp->contents_file << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_file;
+    packed.path = tidy_real;
+    packed.part = part;
+    packed.has_mtime = true;
+    packed.mtime = timestamp;
+    packed.set_md5_from_hexsum(md5.hexsum());
+    packed.has_size = true;
+    packed.size = dst_dir_name_stat.file_size();
+    packed.is_volatile = _imp->params.is_volatile()(FSPath(tidy));
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -200,6 +214,11 @@ NDBAMMerger::record_install_dir(const FSPath & src, const FSPath & dst_dir, cons
     display_merge(et_dir, dir, flags);
 
     *_imp->contents_file << "type=dir path=" << escape(tidy) << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_dir;
+    packed.path = tidy;
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -210,6 +229,11 @@ NDBAMMerger::record_install_under_dir(const FSPath & dst, const FSMergerStatusFl
     display_merge(et_dir, dst, flags);
 
     *_imp->contents_file << "type=dir path=" << escape(tidy) << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_dir;
+    packed.path = tidy;
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -228,6 +252,15 @@ NDBAMMerger::record_install_sym(const FSPath & src, const FSPath & dst_dir, cons
     if (_imp->params.is_volatile()(FSPath(tidy)))
         *_imp->contents_file << " volatile=true";
     *_imp->contents_file << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_sym;
+    packed.path = tidy;
+    packed.target = target;
+    packed.has_mtime = true;
+    packed.mtime = timestamp.seconds();
+    packed.is_volatile = _imp->params.is_volatile()(FSPath(tidy));
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -317,6 +350,11 @@ NDBAMMerger::merge()
     display_override(">>> Merging to " + stringify(_imp->params.root()));
     _imp->contents_file = std::make_shared<SafeOFStream>(_imp->params.contents_file(), -1, false);
     FSMerger::merge();
+
+    /* contents must be complete before the packed copy records its state */
+    _imp->contents_file.reset();
+    _imp->packed_contents.write(_imp->params.contents_file().dirname() / (_imp->params.contents_file().basename() + ".packed"),
+            _imp->params.contents_file(), ll_warning);
 }
 
 bool
@@ -29,6 +29,7 @@ namespace paludis
     class NotifierCallbackResolverStepEvent;
     class NotifierCallbackResolverStageEvent;
     class NotifierCallbackLinkageStepEvent;
+    class NotifierCallbackMetadataPhaseEvent;
 
     typedef std::function<void (const NotifierCallbackEvent &) > NotifierCallbackFunction;
 
@@ -57,6 +57,32 @@ NotifierCallbackLinkageStepEvent::location() const
     return _location;
 }
 
+NotifierCallbackMetadataPhaseEvent::NotifierCallbackMetadataPhaseEvent(const RepositoryName & r, const std::string & p,
+        const std::chrono::steady_clock::duration d) :
+    _repo(r),
+    _phase(p),
+    _duration(d)
+{
+}
+
+const RepositoryName
+NotifierCallbackMetadataPhaseEvent::repository() const
+{
+    return _repo;
+}
+
+const std::string
+NotifierCallbackMetadataPhaseEvent::phase() const
+{
+    return _phase;
+}
+
+std::chrono::steady_clock::duration
+NotifierCallbackMetadataPhaseEvent::duration() const
+{
+    return _duration;
+}
+
 namespace paludis
 {
     template <>
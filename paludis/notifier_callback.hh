@@ -27,6 +27,8 @@
 #include <paludis/util/fs_path.hh>
 #include <paludis/name.hh>
 #include <paludis/environment-fwd.hh>
+#include <chrono>
+#include <string>
 
 namespace paludis
 {
@@ -35,7 +37,8 @@ namespace paludis
             NotifierCallbackGeneratingMetadataEvent,
             NotifierCallbackResolverStepEvent,
             NotifierCallbackResolverStageEvent,
-            NotifierCallbackLinkageStepEvent>::Type>
+            NotifierCallbackLinkageStepEvent,
+            NotifierCallbackMetadataPhaseEvent>::Type>
     {
     };
 
@@ -84,6 +87,29 @@ namespace paludis
             const FSPath location() const PALUDIS_ATTRIBUTE((warn_unused_result));
     };
 
+    /**
+     * Triggered after each phase of loading or generating metadata for an
+     * ID (for example, validating a cache entry, running the metadata
+     * command, or writing a cache entry), with how long that phase took.
+     */
+    class PALUDIS_VISIBLE NotifierCallbackMetadataPhaseEvent :
+        public NotifierCallbackEvent,
+        public ImplementAcceptMethods<NotifierCallbackEvent, NotifierCallbackMetadataPhaseEvent>
+    {
+        private:
+            const RepositoryName _repo;
+            const std::string _phase;
+            const std::chrono::steady_clock::duration _duration;
+
+        public:
+            NotifierCallbackMetadataPhaseEvent(const RepositoryName &, const std::string &,
+                    const std::chrono::steady_clock::duration);
+
+            const RepositoryName repository() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            const std::string phase() const PALUDIS_ATTRIBUTE((warn_unused_result));
+            std::chrono::steady_clock::duration duration() const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
     class PALUDIS_VISIBLE ScopedNotifierCallback
     {
         private:
@@ -23,6 +23,7 @@
 #include <paludis/version_spec.hh>
 #include <paludis/repository.hh>
 #include <paludis/environment.hh>
+#include <paludis/packed_contents.hh>
 
 #include <paludis/util/pimp-impl.hh>
 #include <paludis/util/sequence.hh>
@@ -247,6 +248,17 @@ PackageID::can_drop_in_memory_cache() const
 {
 }
 
+bool
+PackageID::for_each_contents_entry(const PackedContentsEntryFunction & f) const
+{
+    auto c(contents());
+    if (! c)
+        return false;
+
+    for_each_packed_contents_entry(*c, f);
+    return true;
+}
+
 namespace paludis
 {
     template class Sequence<std::shared_ptr<const PackageID> >;
@@ -35,6 +35,7 @@
 #include <paludis/action-fwd.hh>
 #include <paludis/choice-fwd.hh>
 #include <paludis/contents-fwd.hh>
+#include <paludis/packed_contents-fwd.hh>
 #include <paludis/dep_spec-fwd.hh>
 #include <paludis/mask-fwd.hh>
 #include <paludis/metadata_key-fwd.hh>
@@ -325,6 +326,17 @@ namespace paludis
              */
             virtual const std::shared_ptr<const Contents> contents() const = 0;
 
+            /**
+             * Call the supplied function for every entry in our contents,
+             * returning false if we have no contents.
+             *
+             * This is intended for callers that walk the contents of many
+             * packages. The default implementation uses contents(), but
+             * installed repositories may be able to do it without creating
+             * a ContentsEntry for each entry.
+             */
+            virtual bool for_each_contents_entry(const PackedContentsEntryFunction &) const;
+
             ///\}
 
             ///\name Masks
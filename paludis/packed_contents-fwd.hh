@@ -0,0 +1,44 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_PACKED_CONTENTS_FWD_HH
+#define PALUDIS_GUARD_PALUDIS_PACKED_CONTENTS_FWD_HH 1
+
+#include <functional>
+
+/** \file
+ * Forward declarations for paludis/packed_contents.hh .
+ *
+ * \ingroup g_contents
+ */
+
+namespace paludis
+{
+    struct PackedContentsEntry;
+    class PackedContents;
+    class PackedContentsWriter;
+
+    /**
+     * Called for each entry by PackedContents::for_each and
+     * PackageID::for_each_contents_entry.
+     *
+     * \ingroup g_contents
+     */
+    typedef std::function<void (const PackedContentsEntry &)> PackedContentsEntryFunction;
+}
+
+#endif
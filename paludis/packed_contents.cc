@@ -0,0 +1,573 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/packed_contents.hh>
+#include <paludis/contents.hh>
+#include <paludis/literal_metadata_key.hh>
+#include <paludis/metadata_key.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/timestamp.hh>
+#include <paludis/util/visitor_cast.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace paludis;
+
+/*
+ * The file consists of a header, a table of records in the order the entries
+ * were added, and then the text of every path, target and part. Numbers are
+ * native endian and the header records the byte order, since the file is
+ * only ever read on the machine that wrote it.
+ *
+ *   Header
+ *   Record[n_entries]
+ *   text
+ *
+ * Strings in the text are followed by a '\0', which is not included in their
+ * lengths. Targets and parts that are used more than once are only stored
+ * once.
+ */
+
+namespace
+{
+    const char magic[8] = { 'P', 'A', 'L', 'U', 'D', 'I', 'S', 'C' };
+    const uint32_t format_version(1);
+    const uint32_t byte_order_mark(0x01020304);
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t n_entries;
+        uint64_t text_size;
+
+        /* the source file, as it was when we were written */
+        uint64_t source_size;
+        int64_t source_seconds;
+        int64_t source_nanoseconds;
+    };
+
+    enum RecordFlag
+    {
+        rf_mtime = 1 << 0,
+        rf_md5 = 1 << 1,
+        rf_size = 1 << 2,
+        rf_volatile = 1 << 3
+    };
+
+    struct Record
+    {
+        uint32_t path_offset;
+        uint32_t path_length;
+        uint32_t target_offset;
+        uint32_t target_length;
+        uint32_t part_offset;
+        uint32_t part_length;
+        int64_t mtime;
+        uint64_t size;
+        unsigned char md5[16];
+        uint8_t type;
+        uint8_t flags;
+        uint8_t unused[6];
+    };
+
+    struct Mapping
+    {
+        void * data;
+        std::size_t size;
+
+        const Record * records;
+        const char * text;
+
+        uint64_t n_entries;
+        uint64_t text_size;
+
+        Mapping() :
+            data(nullptr),
+            size(0),
+            records(nullptr),
+            text(nullptr),
+            n_entries(0),
+            text_size(0)
+        {
+        }
+
+        ~Mapping()
+        {
+            if (data)
+                ::munmap(data, size);
+        }
+
+        Mapping(const Mapping &) = delete;
+        Mapping & operator= (const Mapping &) = delete;
+
+        bool text_at(uint32_t offset, uint32_t length, std::string_view & s) const
+        {
+            if (offset > text_size || length > text_size - offset)
+                return false;
+            s = std::string_view(text + offset, length);
+            return true;
+        }
+    };
+
+    std::shared_ptr<const Mapping> map_file(const FSPath & filename, const FSPath & source)
+    {
+        Context context("When mapping packed contents file '" + stringify(filename) + "':");
+
+        int fd(::open(stringify(filename).c_str(), O_RDONLY | O_CLOEXEC));
+        if (-1 == fd)
+        {
+            if (ENOENT != errno)
+                Log::get_instance()->message("packed_contents.open", ll_warning, lc_context)
+                    << "Couldn't open '" << filename << "': " << std::strerror(errno);
+            return nullptr;
+        }
+
+        struct ::stat st;
+        if (0 != ::fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(Header)))
+        {
+            ::close(fd);
+            Log::get_instance()->message("packed_contents.truncated", ll_warning, lc_context)
+                << "File is too short to be a packed contents file";
+            return nullptr;
+        }
+
+        void * data(::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+        ::close(fd);
+        if (MAP_FAILED == data)
+        {
+            Log::get_instance()->message("packed_contents.mmap", ll_warning, lc_context)
+                << "Couldn't mmap: " << std::strerror(errno);
+            return nullptr;
+        }
+
+        auto m(std::make_shared<Mapping>());
+        m->data = data;
+        m->size = st.st_size;
+
+        const Header & h(*static_cast<const Header *>(data));
+        if (0 != std::memcmp(h.magic, magic, sizeof(magic)) || h.version != format_version || h.byte_order != byte_order_mark)
+        {
+            Log::get_instance()->message("packed_contents.format", ll_warning, lc_context)
+                << "File is not a packed contents file in a format we understand";
+            return nullptr;
+        }
+
+        if (h.n_entries > (m->size - sizeof(Header)) / sizeof(Record) ||
+                sizeof(Header) + h.n_entries * sizeof(Record) + h.text_size != m->size)
+        {
+            Log::get_instance()->message("packed_contents.truncated", ll_warning, lc_context)
+                << "File has size " << m->size << ", which does not match its header";
+            return nullptr;
+        }
+
+        /* the text file is the real record, so if it has been touched since
+         * we were written, we can't be trusted. this is not a warning,
+         * because other package managers will happily rewrite it. */
+        FSStat source_stat(source);
+        if ((! source_stat.is_regular_file_or_symlink_to_regular_file()) ||
+                uint64_t(source_stat.file_size()) != h.source_size ||
+                source_stat.mtim().seconds() != h.source_seconds ||
+                source_stat.mtim().nanoseconds() != h.source_nanoseconds)
+        {
+            Log::get_instance()->message("packed_contents.stale", ll_debug, lc_context)
+                << "Source file '" << source << "' has changed";
+            return nullptr;
+        }
+
+        const char * p(static_cast<const char *>(data) + sizeof(Header));
+        m->records = reinterpret_cast<const Record *>(p);
+        m->text = p + h.n_entries * sizeof(Record);
+        m->n_entries = h.n_entries;
+        m->text_size = h.text_size;
+
+        return m;
+    }
+
+    template <typename T_>
+    std::shared_ptr<const T_> find_key(const ContentsEntry & e, const std::string & raw_name)
+    {
+        auto k(e.find_metadata(raw_name));
+        if (e.end_metadata() == k)
+            return nullptr;
+        return visitor_cast<const T_>(**k) ? std::static_pointer_cast<const T_>(*k) : nullptr;
+    }
+
+    void fill_in_keys(PackedContentsEntry & p, const ContentsEntry & e)
+    {
+        auto mtime(find_key<MetadataTimeKey>(e, "mtime"));
+        if (mtime)
+        {
+            p.has_mtime = true;
+            p.mtime = mtime->parse_value().seconds();
+        }
+
+        auto md5(find_key<MetadataValueKey<std::string>>(e, "md5"));
+        if (md5)
+            p.set_md5_from_hexsum(md5->parse_value());
+
+        auto is_volatile(find_key<MetadataValueKey<bool>>(e, "volatile"));
+        if (is_volatile)
+            p.is_volatile = is_volatile->parse_value();
+    }
+}
+
+PackedContentsEntry::PackedContentsEntry() :
+    type(pcet_other),
+    has_mtime(false),
+    mtime(0),
+    has_md5(false),
+    md5(),
+    has_size(false),
+    size(0),
+    is_volatile(false)
+{
+}
+
+std::string
+PackedContentsEntry::md5_hexsum() const
+{
+    static const char digits[] = "0123456789abcdef";
+
+    std::string result(32, '0');
+    for (int i(0) ; i < 16 ; ++i)
+    {
+        result[2 * i] = digits[md5[i] >> 4];
+        result[2 * i + 1] = digits[md5[i] & 0xf];
+    }
+    return result;
+}
+
+bool
+PackedContentsEntry::set_md5_from_hexsum(const std::string & s)
+{
+    has_md5 = false;
+    if (32 != s.length())
+        return false;
+
+    for (int i(0) ; i < 32 ; ++i)
+    {
+        char c(s[i]);
+        int v;
+        if (c >= '0' && c <= '9')
+            v = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            v = c - 'A' + 10;
+        else
+            return false;
+
+        if (0 == i % 2)
+            md5[i / 2] = v << 4;
+        else
+            md5[i / 2] |= v;
+    }
+
+    has_md5 = true;
+    return true;
+}
+
+std::shared_ptr<ContentsEntry>
+paludis::make_contents_entry(const PackedContentsEntry & p)
+{
+    std::shared_ptr<ContentsEntry> result;
+    FSPath path{std::string(p.path)};
+
+    switch (p.type)
+    {
+        case pcet_file:
+            result = std::make_shared<ContentsFileEntry>(path, std::string(p.part));
+            break;
+        case pcet_dir:
+            return std::make_shared<ContentsDirEntry>(path);
+        case pcet_sym:
+            result = std::make_shared<ContentsSymEntry>(path, std::string(p.target), std::string(p.part));
+            break;
+        case pcet_other:
+            return std::make_shared<ContentsOtherEntry>(path);
+        case last_pcet:
+            break;
+    }
+
+    if (! result)
+        throw InternalError(PALUDIS_HERE, "Bad PackedContentsEntryType");
+
+    if (p.has_md5)
+        result->add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("md5", "md5", mkt_normal, p.md5_hexsum()));
+    if (p.has_mtime)
+        result->add_metadata_key(std::make_shared<LiteralMetadataTimeKey>("mtime", "mtime", mkt_normal, Timestamp(p.mtime, 0)));
+    if (p.is_volatile)
+        result->add_metadata_key(std::make_shared<LiteralMetadataValueKey<bool> >("volatile", "volatile", mkt_normal, true));
+
+    return result;
+}
+
+void
+paludis::for_each_packed_contents_entry(const Contents & contents, const PackedContentsEntryFunction & f)
+{
+    for (const auto & c : contents)
+    {
+        PackedContentsEntry p;
+        std::string path(stringify(c->location_key()->parse_value())), target, part;
+
+        c->make_accept(
+                [&] (const ContentsFileEntry & e) {
+                    p.type = pcet_file;
+                    if (e.part_key())
+                        part = e.part_key()->parse_value();
+                    fill_in_keys(p, e);
+                },
+                [&] (const ContentsDirEntry &) {
+                    p.type = pcet_dir;
+                },
+                [&] (const ContentsSymEntry & e) {
+                    p.type = pcet_sym;
+                    target = e.target_key()->parse_value();
+                    if (e.part_key())
+                        part = e.part_key()->parse_value();
+                    fill_in_keys(p, e);
+                },
+                [&] (const ContentsOtherEntry &) {
+                    p.type = pcet_other;
+                }
+                );
+
+        p.path = path;
+        p.target = target;
+        p.part = part;
+        f(p);
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<PackedContents>
+    {
+        const std::shared_ptr<const Mapping> mapping;
+
+        Imp(const FSPath & f, const FSPath & s) :
+            mapping(map_file(f, s))
+        {
+        }
+    };
+
+    template <>
+    struct Imp<PackedContentsWriter>
+    {
+        std::vector<Record> records;
+        std::string text;
+        std::unordered_map<std::string, uint32_t> shared_text;
+
+        void add_text(const std::string_view & s, uint32_t & offset, uint32_t & length, bool shared)
+        {
+            length = s.length();
+            if (s.empty())
+            {
+                offset = 0;
+                return;
+            }
+
+            if (shared)
+            {
+                auto i(shared_text.find(std::string(s)));
+                if (shared_text.end() != i)
+                {
+                    offset = i->second;
+                    return;
+                }
+            }
+
+            if (text.length() + s.length() + 1 > UINT32_MAX)
+                throw InternalError(PALUDIS_HERE, "packed contents file is too large");
+
+            offset = text.length();
+            text.append(s.data(), s.length());
+            text.append(1, '\0');
+
+            if (shared)
+                shared_text.insert(std::make_pair(std::string(s), offset));
+        }
+    };
+}
+
+PackedContents::PackedContents(const FSPath & f, const FSPath & s) :
+    _imp(f, s)
+{
+}
+
+PackedContents::~PackedContents() = default;
+
+bool
+PackedContents::usable() const
+{
+    return bool(_imp->mapping);
+}
+
+std::size_t
+PackedContents::size() const
+{
+    return _imp->mapping ? _imp->mapping->n_entries : 0;
+}
+
+void
+PackedContents::for_each(const PackedContentsEntryFunction & f) const
+{
+    if (! _imp->mapping)
+        return;
+
+    const Mapping & m(*_imp->mapping);
+    PackedContentsEntry p;
+    for (const Record * r(m.records), * r_end(m.records + m.n_entries) ; r != r_end ; ++r)
+    {
+        if (r->type >= last_pcet || ! m.text_at(r->path_offset, r->path_length, p.path) ||
+                ! m.text_at(r->target_offset, r->target_length, p.target) ||
+                ! m.text_at(r->part_offset, r->part_length, p.part))
+        {
+            Log::get_instance()->message("packed_contents.bad_record", ll_warning, lc_context)
+                << "Bad record " << (r - m.records) << " in packed contents file, skipping";
+            continue;
+        }
+
+        p.type = static_cast<PackedContentsEntryType>(r->type);
+        p.has_mtime = r->flags & rf_mtime;
+        p.mtime = r->mtime;
+        p.has_md5 = r->flags & rf_md5;
+        std::memcpy(p.md5, r->md5, sizeof(p.md5));
+        p.has_size = r->flags & rf_size;
+        p.size = r->size;
+        p.is_volatile = r->flags & rf_volatile;
+
+        f(p);
+    }
+}
+
+void
+PackedContents::add_to(Contents & contents) const
+{
+    for_each([&] (const PackedContentsEntry & p) { contents.add(make_contents_entry(p)); });
+}
+
+PackedContentsWriter::PackedContentsWriter() = default;
+
+PackedContentsWriter::~PackedContentsWriter() = default;
+
+void
+PackedContentsWriter::add(const PackedContentsEntry & p)
+{
+    Record r;
+    std::memset(&r, 0, sizeof(r));
+
+    _imp->add_text(p.path, r.path_offset, r.path_length, false);
+    _imp->add_text(p.target, r.target_offset, r.target_length, true);
+    _imp->add_text(p.part, r.part_offset, r.part_length, true);
+
+    r.type = p.type;
+    if (p.has_mtime)
+    {
+        r.flags |= rf_mtime;
+        r.mtime = p.mtime;
+    }
+    if (p.has_md5)
+    {
+        r.flags |= rf_md5;
+        std::memcpy(r.md5, p.md5, sizeof(r.md5));
+    }
+    if (p.has_size)
+    {
+        r.flags |= rf_size;
+        r.size = p.size;
+    }
+    if (p.is_volatile)
+        r.flags |= rf_volatile;
+
+    _imp->records.push_back(r);
+}
+
+void
+PackedContentsWriter::write(const FSPath & filename, const FSPath & source, const LogLevel failure_log_level)
+{
+    Context context("When writing packed contents file '" + stringify(filename) + "':");
+
+    FSPath tmp(filename.dirname() / (filename.basename() + ".new." + stringify(::getpid())));
+    try
+    {
+        FSStat source_stat(source);
+        if (! source_stat.is_regular_file_or_symlink_to_regular_file())
+            throw FSError("Source file '" + stringify(source) + "' is not a regular file");
+
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = format_version;
+        h.byte_order = byte_order_mark;
+        h.n_entries = _imp->records.size();
+        h.text_size = _imp->text.length();
+        h.source_size = source_stat.file_size();
+        h.source_seconds = source_stat.mtim().seconds();
+        h.source_nanoseconds = source_stat.mtim().nanoseconds();
+
+        {
+            std::string data(reinterpret_cast<const char *>(&h), sizeof(h));
+            if (! _imp->records.empty())
+                data.append(reinterpret_cast<const char *>(_imp->records.data()), _imp->records.size() * sizeof(Record));
+            data.append(_imp->text);
+
+            SafeOFStream s(tmp, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, true);
+            s << data;
+        }
+
+        tmp.rename(filename);
+    }
+    catch (const Exception & e)
+    {
+        Log::get_instance()->message("packed_contents.write.failure", failure_log_level, lc_no_context)
+            << "Couldn't write packed contents file '" << filename << "': " << e.message() << " (" << e.what() << ")";
+
+        try
+        {
+            if (tmp.stat().exists())
+                tmp.unlink();
+        }
+        catch (const FSError &)
+        {
+        }
+    }
+}
+
+namespace paludis
+{
+    template class Pimp<PackedContents>;
+    template class Pimp<PackedContentsWriter>;
+}
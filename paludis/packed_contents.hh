@@ -0,0 +1,224 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_PACKED_CONTENTS_HH
+#define PALUDIS_GUARD_PALUDIS_PACKED_CONTENTS_HH 1
+
+#include <paludis/packed_contents-fwd.hh>
+#include <paludis/contents-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/log.hh>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <ctime>
+
+/** \file
+ * Declarations for PackedContents, a compact binary form of an installed
+ * package's contents file.
+ *
+ * \ingroup g_contents
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * The kind of a PackedContentsEntry, corresponding to the ContentsEntry
+     * subclasses.
+     *
+     * \ingroup g_contents
+     */
+    enum PackedContentsEntryType
+    {
+        pcet_file,
+        pcet_dir,
+        pcet_sym,
+        pcet_other,
+        last_pcet
+    };
+
+    /**
+     * A contents entry that refers to, rather than holds, its strings.
+     *
+     * The strings are only valid for the duration of the call that supplies
+     * the entry, so anything that wants to keep them must copy them.
+     *
+     * \see PackedContents
+     * \see PackageID::for_each_contents_entry
+     * \ingroup g_contents
+     */
+    struct PALUDIS_VISIBLE PackedContentsEntry
+    {
+        PackedContentsEntryType type;
+
+        std::string_view path;
+
+        /// Only for pcet_sym.
+        std::string_view target;
+
+        /// Empty if there is no part.
+        std::string_view part;
+
+        bool has_mtime;
+        std::time_t mtime;
+
+        bool has_md5;
+        unsigned char md5[16];
+
+        /// The size of a file when it was merged, if known.
+        bool has_size;
+        unsigned long long size;
+
+        bool is_volatile;
+
+        PackedContentsEntry();
+
+        /**
+         * Our md5, in the form used by contents files.
+         */
+        std::string md5_hexsum() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+        /**
+         * Set our md5 from the form used by contents files, returning false
+         * if it is not valid.
+         */
+        bool set_md5_from_hexsum(const std::string &);
+    };
+
+    /**
+     * Make a ContentsEntry, with the same metadata keys that the text contents
+     * parsers add, from a PackedContentsEntry.
+     *
+     * \ingroup g_contents
+     */
+    std::shared_ptr<ContentsEntry> make_contents_entry(const PackedContentsEntry &) PALUDIS_VISIBLE;
+
+    /**
+     * Call the supplied function with a PackedContentsEntry for every entry in
+     * a Contents. Used where nothing faster is available.
+     *
+     * \ingroup g_contents
+     */
+    void for_each_packed_contents_entry(const Contents &, const PackedContentsEntryFunction &) PALUDIS_VISIBLE;
+
+    /**
+     * A packed contents file, written alongside an installed package's text
+     * contents file when it is merged.
+     *
+     * The text contents file remains the authoritative record of what was
+     * installed. The packed file records the size and modification time of
+     * the text file it was made from, and if these no longer match, usable()
+     * returns false and the text file must be used instead.
+     *
+     * The packed file holds a table of fixed width records, followed by the
+     * text of every path, symlink target and part. It is memory mapped, and
+     * for_each supplies entries that point straight into the mapping, so
+     * iterating over it does not allocate anything per entry.
+     *
+     * \ingroup g_contents
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE PackedContents
+    {
+        private:
+            Pimp<PackedContents> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            PackedContents(const FSPath & filename, const FSPath & source);
+            ~PackedContents();
+
+            PackedContents(const PackedContents &) = delete;
+            PackedContents & operator= (const PackedContents &) = delete;
+
+            ///\}
+
+            /**
+             * Does the file exist, is it in a format we understand, and was it
+             * made from the current source file?
+             */
+            bool usable() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * How many entries do we have?
+             */
+            std::size_t size() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Call the supplied function for every entry, in the order they
+             * appear in the source file.
+             */
+            void for_each(const PackedContentsEntryFunction &) const;
+
+            /**
+             * Add every entry to a Contents.
+             */
+            void add_to(Contents &) const;
+    };
+
+    /**
+     * Builds a packed contents file.
+     *
+     * \see PackedContents
+     * \ingroup g_contents
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE PackedContentsWriter
+    {
+        private:
+            Pimp<PackedContentsWriter> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            PackedContentsWriter();
+            ~PackedContentsWriter();
+
+            PackedContentsWriter(const PackedContentsWriter &) = delete;
+            PackedContentsWriter & operator= (const PackedContentsWriter &) = delete;
+
+            ///\}
+
+            /**
+             * Add an entry. Its strings are copied.
+             */
+            void add(const PackedContentsEntry &);
+
+            /**
+             * Write out the file, recording the current state of the source
+             * file, which must be complete by now.
+             *
+             * Failure is logged at the specified level, and any partially
+             * written file is removed.
+             */
+            void write(const FSPath & filename, const FSPath & source, const LogLevel failure_log_level);
+    };
+
+    extern template class Pimp<PackedContents>;
+    extern template class Pimp<PackedContentsWriter>;
+}
+
+#endif
@@ -0,0 +1,178 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/packed_contents.hh>
+#include <paludis/contents.hh>
+#include <paludis/metadata_key.hh>
+
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/safe_ofstream.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+
+#include <vector>
+
+#include <fcntl.h>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    std::string describe(const PackedContentsEntry & e)
+    {
+        std::string result(stringify(int(e.type)) + " " + std::string(e.path));
+        if (! e.target.empty())
+            result.append(" -> " + std::string(e.target));
+        if (! e.part.empty())
+            result.append(" part=" + std::string(e.part));
+        if (e.has_mtime)
+            result.append(" mtime=" + stringify(e.mtime));
+        if (e.has_md5)
+            result.append(" md5=" + e.md5_hexsum());
+        if (e.has_size)
+            result.append(" size=" + stringify(e.size));
+        if (e.is_volatile)
+            result.append(" volatile");
+        return result;
+    }
+
+    std::vector<std::string> describe_all(const PackedContents & p)
+    {
+        std::vector<std::string> result;
+        p.for_each([&] (const PackedContentsEntry & e) { result.push_back(describe(e)); });
+        return result;
+    }
+
+    void write_test_file(const FSPath & f)
+    {
+        PackedContentsWriter w;
+
+        PackedContentsEntry dir;
+        dir.type = pcet_dir;
+        dir.path = "/usr";
+        w.add(dir);
+
+        PackedContentsEntry file;
+        file.type = pcet_file;
+        file.path = "/usr/bin/one";
+        file.part = "binaries";
+        file.has_mtime = true;
+        file.mtime = 1234;
+        EXPECT_TRUE(file.set_md5_from_hexsum("0123456789abcdef0123456789abcdef"));
+        file.has_size = true;
+        file.size = 5678;
+        w.add(file);
+
+        PackedContentsEntry sym;
+        sym.type = pcet_sym;
+        sym.path = "/usr/bin/two";
+        sym.target = "one";
+        sym.part = "binaries";
+        sym.has_mtime = true;
+        sym.mtime = 1235;
+        sym.is_volatile = true;
+        w.add(sym);
+
+        w.write(f, FSPath("packed_contents_TEST_dir/CONTENTS"), ll_warning);
+    }
+}
+
+TEST(PackedContentsEntry, MD5)
+{
+    PackedContentsEntry e;
+    EXPECT_TRUE(! e.has_md5);
+    EXPECT_TRUE(e.set_md5_from_hexsum("d41d8cd98f00b204e9800998ecf8427e"));
+    EXPECT_TRUE(e.has_md5);
+    EXPECT_EQ("d41d8cd98f00b204e9800998ecf8427e", e.md5_hexsum());
+    EXPECT_TRUE(e.set_md5_from_hexsum("D41D8CD98F00B204E9800998ECF8427E"));
+    EXPECT_EQ("d41d8cd98f00b204e9800998ecf8427e", e.md5_hexsum());
+
+    EXPECT_TRUE(! e.set_md5_from_hexsum("d41d8cd98f00b204e9800998ecf8427"));
+    EXPECT_TRUE(! e.has_md5);
+    EXPECT_TRUE(! e.set_md5_from_hexsum("d41d8cd98f00b204e9800998ecf8427x"));
+    EXPECT_TRUE(! e.has_md5);
+}
+
+TEST(PackedContents, NotExisting)
+{
+    PackedContents p(FSPath("packed_contents_TEST_dir/not_existing"), FSPath("packed_contents_TEST_dir/CONTENTS"));
+    EXPECT_TRUE(! p.usable());
+    EXPECT_EQ(0u, p.size());
+    EXPECT_TRUE(describe_all(p).empty());
+}
+
+TEST(PackedContents, NotPacked)
+{
+    PackedContents p(FSPath("packed_contents_TEST_dir/not_packed"), FSPath("packed_contents_TEST_dir/CONTENTS"));
+    EXPECT_TRUE(! p.usable());
+}
+
+TEST(PackedContents, Works)
+{
+    write_test_file(FSPath("packed_contents_TEST_dir/works"));
+
+    PackedContents p(FSPath("packed_contents_TEST_dir/works"), FSPath("packed_contents_TEST_dir/CONTENTS"));
+    ASSERT_TRUE(p.usable());
+    EXPECT_EQ(3u, p.size());
+
+    auto d(describe_all(p));
+    ASSERT_EQ(3u, d.size());
+    EXPECT_EQ("1 /usr", d.at(0));
+    EXPECT_EQ("0 /usr/bin/one part=binaries mtime=1234 md5=0123456789abcdef0123456789abcdef size=5678", d.at(1));
+    EXPECT_EQ("2 /usr/bin/two -> one part=binaries mtime=1235 volatile", d.at(2));
+}
+
+TEST(PackedContents, Contents)
+{
+    write_test_file(FSPath("packed_contents_TEST_dir/contents"));
+
+    PackedContents p(FSPath("packed_contents_TEST_dir/contents"), FSPath("packed_contents_TEST_dir/CONTENTS"));
+    ASSERT_TRUE(p.usable());
+
+    Contents c;
+    p.add_to(c);
+
+    std::vector<std::string> d;
+    for (const auto & e : c)
+        d.push_back(stringify(e->location_key()->parse_value()));
+    ASSERT_EQ(3u, d.size());
+    EXPECT_EQ("/usr/bin/one", d.at(1));
+
+    /* going back loses only the size, which contents files don't have */
+    std::vector<std::string> r;
+    for_each_packed_contents_entry(c, [&] (const PackedContentsEntry & e) { r.push_back(describe(e)); });
+    ASSERT_EQ(3u, r.size());
+    EXPECT_EQ("1 /usr", r.at(0));
+    EXPECT_EQ("0 /usr/bin/one part=binaries mtime=1234 md5=0123456789abcdef0123456789abcdef", r.at(1));
+    EXPECT_EQ("2 /usr/bin/two -> one part=binaries mtime=1235 volatile", r.at(2));
+}
+
+TEST(PackedContents, Stale)
+{
+    write_test_file(FSPath("packed_contents_TEST_dir/stale"));
+    EXPECT_TRUE(PackedContents(FSPath("packed_contents_TEST_dir/stale"), FSPath("packed_contents_TEST_dir/CONTENTS")).usable());
+
+    {
+        SafeOFStream s(FSPath("packed_contents_TEST_dir/CONTENTS"), O_WRONLY | O_APPEND, false);
+        s << "dir /opt" << std::endl;
+    }
+
+    EXPECT_TRUE(! PackedContents(FSPath("packed_contents_TEST_dir/stale"), FSPath("packed_contents_TEST_dir/CONTENTS")).usable());
+    EXPECT_TRUE(! PackedContents(FSPath("packed_contents_TEST_dir/stale"), FSPath("packed_contents_TEST_dir/not_existing")).usable());
+}
@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+if [ -d packed_contents_TEST_dir ] ; then
+    rm -fr packed_contents_TEST_dir
+else
+    true
+fi
+
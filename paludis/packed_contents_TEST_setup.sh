@@ -0,0 +1,13 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir packed_contents_TEST_dir || exit 1
+cd packed_contents_TEST_dir || exit 1
+
+cat <<END > CONTENTS
+dir /usr
+obj /usr/bin/one 0123456789abcdef0123456789abcdef 1234
+sym /usr/bin/two -> one 1235
+END
+
+echo "not packed contents" > not_packed
@@ -30,13 +30,12 @@
 #include <paludis/util/iterator_funcs.hh>
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/set.hh>
-#include <paludis/util/active_object_ptr.hh>
-#include <paludis/util/deferred_construction_ptr.hh>
 #include <paludis/choice.hh>
 #include <paludis/dep_spec.hh>
 #include <paludis/name.hh>
 #include <paludis/user_dep_spec.hh>
 #include <paludis/match_package.hh>
+#include <paludis/spec_matcher_index.hh>
 #include <paludis/package_id.hh>
 #include <paludis/environment.hh>
 #include <paludis/spec_tree.hh>
@@ -46,6 +45,7 @@
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <functional>
 
 using namespace paludis;
 
@@ -122,7 +122,7 @@ namespace
     struct SetNameWithValuesGroups
     {
         NamedValue<n::set_name, SetName> set_name;
-        NamedValue<n::set_value, ActiveObjectPtr<DeferredConstructionPtr<std::shared_ptr<const SetSpecTree> > > > set_value;
+        NamedValue<n::set_value, std::shared_ptr<const SetSpecMatcher> > set_value;
         NamedValue<n::values_groups, ValuesGroups> values_groups;
     };
 
@@ -130,20 +130,12 @@ namespace
 
     typedef std::unordered_map<QualifiedPackageName, SpecsWithValuesGroups, Hash<QualifiedPackageName> > SpecificSpecs;
 
-    const std::shared_ptr<const SetSpecTree> make_set_value(
-            const Environment * const env,
+    void unknown_set(
             const FSPath & from,
             const SetName name)
     {
-        std::shared_ptr<const SetSpecTree> result(env->set(name));
-        if (! result)
-        {
-            Log::get_instance()->message("paludislike_options_conf.bad_set", ll_warning, lc_context)
-                << "Set '" << name << "' in '" << from << "' does not exist";
-            result = std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>());
-        }
-
-        return result;
+        Log::get_instance()->message("paludislike_options_conf.bad_set", ll_warning, lc_context)
+            << "Set '" << name << "' in '" << from << "' does not exist";
     }
 }
 
@@ -157,6 +149,8 @@ namespace paludis
         SpecificSpecs specific_specs;
         SetNamesWithValuesGroups set_specs;
         SpecsWithValuesGroups wildcard_specs;
+        SpecMatcherIndex wildcard_specs_index;
+        std::vector<const SpecWithValuesGroups *> wildcard_specs_by_number;
 
         Imp(const PaludisLikeOptionsConfParams & p) :
             params(p)
@@ -217,11 +211,14 @@ PaludisLikeOptionsConf::add_file(const FSPath & f)
             }
             else
             {
-                values_groups = &_imp->wildcard_specs.insert(_imp->wildcard_specs.end(),
-                        make_named_values<SpecWithValuesGroups>(
-                            n::spec() = *d,
-                            n::values_groups() = ValuesGroups()
-                            ))->values_groups();
+                auto i(_imp->wildcard_specs.insert(_imp->wildcard_specs.end(),
+                            make_named_values<SpecWithValuesGroups>(
+                                n::spec() = *d,
+                                n::values_groups() = ValuesGroups()
+                                )));
+                _imp->wildcard_specs_index.add(d);
+                _imp->wildcard_specs_by_number.push_back(&*i);
+                values_groups = &i->values_groups();
             }
         }
         catch (const GotASetNotAPackageDepSpec &)
@@ -231,8 +228,8 @@ PaludisLikeOptionsConf::add_file(const FSPath & f)
             values_groups = &_imp->set_specs.insert(_imp->set_specs.end(),
                     make_named_values<SetNameWithValuesGroups>(
                         n::set_name() = n,
-                        n::set_value() = DeferredConstructionPtr<std::shared_ptr<const SetSpecTree> >(
-                                std::bind(&make_set_value, _imp->params.environment(), f, n)),
+                        n::set_value() = std::make_shared<SetSpecMatcher>(_imp->params.environment(), n,
+                                std::bind(&unknown_set, f, n)),
                         n::values_groups() = ValuesGroups()
                         ))->values_groups();
         }
@@ -455,6 +452,22 @@ namespace
             collect_known_from_values_groups(env, maybe_id, prefix, specs_with_values_group.values_groups(), known);
         }
     }
+
+    void visit_wildcard_specs(
+            const Imp<PaludisLikeOptionsConf> & imp,
+            const std::shared_ptr<const PackageID> & maybe_id,
+            const std::function<void (const SpecWithValuesGroups &)> & f)
+    {
+        if (maybe_id)
+            imp.wildcard_specs_index.find_matches(*imp.params.environment(), maybe_id, [&] (const unsigned n) {
+                    f(*imp.wildcard_specs_by_number[n]);
+                    return false;
+                    });
+        else
+            for (const auto & specs_with_values_group : imp.wildcard_specs)
+                if (match_anything(specs_with_values_group.spec()))
+                    f(specs_with_values_group);
+    }
 }
 
 const std::pair<Tribool, bool>
@@ -490,8 +503,7 @@ PaludisLikeOptionsConf::want_choice_enabled_locked(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(),
-                        maybe_id, { }))
+            if (! set_spec.set_value()->match(maybe_id))
                 continue;
 
             check_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name, set_spec.values_groups(),
@@ -505,8 +517,10 @@ PaludisLikeOptionsConf::want_choice_enabled_locked(
     /* Wildcards? */
     if (! seen_minus_star)
     {
-        check_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name,
-                _imp->wildcard_specs, seen_minus_star, result, dummy);
+        visit_wildcard_specs(*_imp.get(), maybe_id, [&] (const SpecWithValuesGroups & s) {
+                check_values_groups(_imp->params.environment(), maybe_id, prefix, unprefixed_name, s.values_groups(),
+                    seen_minus_star, result, dummy);
+                });
 
         if (! result.first.is_indeterminate())
             return result;
@@ -549,7 +563,7 @@ PaludisLikeOptionsConf::value_for_choice_parameter(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(), id, { }))
+            if (! set_spec.set_value()->match(id))
                 continue;
 
             check_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, set_spec.values_groups(),
@@ -562,8 +576,10 @@ PaludisLikeOptionsConf::value_for_choice_parameter(
 
     /* Wildcards? */
     {
-        check_specs_with_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, _imp->wildcard_specs,
-                dummy_seen_minus_star, dummy_result, equals_value);
+        visit_wildcard_specs(*_imp.get(), id, [&] (const SpecWithValuesGroups & s) {
+                check_values_groups(_imp->params.environment(), id, prefix, unprefixed_name, s.values_groups(),
+                    dummy_seen_minus_star, dummy_result, equals_value);
+                });
 
         if (! equals_value.empty())
             return equals_value;
@@ -593,8 +609,7 @@ PaludisLikeOptionsConf::known_choice_value_names(
     {
         for (const auto & set_spec : _imp->set_specs)
         {
-            if (! match_package_in_set(*_imp->params.environment(), *set_spec.set_value().value().value(),
-                        maybe_id, { }))
+            if (! set_spec.set_value()->match(maybe_id))
                 continue;
 
             collect_known_from_values_groups(_imp->params.environment(), maybe_id, prefix, set_spec.values_groups(), result);
@@ -603,8 +618,9 @@ PaludisLikeOptionsConf::known_choice_value_names(
 
     /* Wildcards? */
     {
-        collect_known_from_specs_with_values_groups(_imp->params.environment(), maybe_id, prefix,
-                _imp->wildcard_specs, result);
+        visit_wildcard_specs(*_imp.get(), maybe_id, [&] (const SpecWithValuesGroups & s) {
+                collect_known_from_values_groups(_imp->params.environment(), maybe_id, prefix, s.values_groups(), result);
+                });
     }
 
     return result;
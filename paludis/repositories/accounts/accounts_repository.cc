@@ -108,8 +108,10 @@ AccountsRepository::AccountsRepository(const AccountsRepositoryParams & p) :
             p.environment(),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(nullptr),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(p.name(), p)
@@ -122,8 +124,10 @@ AccountsRepository::AccountsRepository(const InstalledAccountsRepositoryParams &
             p.environment(),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = this,
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(p.name(), p)
@@ -269,11 +273,13 @@ AccountsRepository::invalidate()
     else
         _imp.reset(new Imp<AccountsRepository>(name(), *_imp->params_if_installed));
     _add_metadata_keys();
+    bump_generation();
 }
 
-void
+RegenerateCacheStatistics
 AccountsRepository::regenerate_cache() const
 {
+    return Repository::regenerate_cache();
 }
 
 const bool
@@ -383,6 +389,8 @@ AccountsRepository::merge(const MergeParams & m)
         return;
 
     _imp->handler_if_installed->merge(m);
+
+    bump_generation();
 }
 
 void
@@ -139,7 +139,7 @@ namespace paludis
                 ///\{
 
                 void invalidate() override;
-                void regenerate_cache() const override;
+                RegenerateCacheStatistics regenerate_cache() const override;
 
                 HookResult perform_hook(
                         const Hook & hook,
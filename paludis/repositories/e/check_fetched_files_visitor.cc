@@ -243,8 +243,7 @@ CheckFetchedFilesVisitor::check_distfile_manifest(const FSPath & distfile)
         {
             SafeIFStream file_stream(distfile);
 
-            MemoisedHashes * hashes = MemoisedHashes::get_instance();
-
+            std::vector<std::string> algos;
             for (const auto & hash : *entry.hashes())
             {
                 if (! DigestRegistry::get_instance()->get(hash.first))
@@ -254,7 +253,19 @@ CheckFetchedFilesVisitor::check_distfile_manifest(const FSPath & distfile)
                     continue;
                 }
 
-                std::string hexsum(hashes->get(hash.first, distfile, file_stream));
+                algos.push_back(hash.first);
+            }
+
+            /* read the file once, however many hashes the Manifest has for it */
+            auto hexsums(MemoisedHashes::get_instance()->get(algos, distfile, file_stream));
+
+            for (const auto & hash : *entry.hashes())
+            {
+                auto h(hexsums.find(hash.first));
+                if (h == hexsums.end())
+                    continue;
+
+                const std::string & hexsum(h->second);
 
                 if (hexsum != hash.second)
                 {
@@ -318,7 +329,7 @@ CheckFetchedFilesVisitor::check_distfile_manifest(const FSPath & distfile)
 void
 CheckFetchedFilesVisitor::visit(const FetchableURISpecTree::NodeType<FetchableURIDepSpec>::Type & node)
 {
-    Context context("When visiting URI dep spec '" + stringify(node.spec()->text()) + "':");
+    LazyContext context([&] () { return "When visiting URI dep spec '" + stringify(node.spec()->text()) + "':"; });
 
     if (_imp->done.end() != _imp->done.find(node.spec()->filename()))
     {
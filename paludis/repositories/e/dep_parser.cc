@@ -33,6 +33,8 @@
 #include <paludis/util/log.hh>
 #include <paludis/util/visitor_cast.hh>
 #include <paludis/util/singleton-impl.hh>
+#include <paludis/util/hashes.hh>
+#include <paludis/util/set.hh>
 #include <paludis/elike_dep_parser.hh>
 #include <paludis/elike_conditional_dep_spec.hh>
 #include <paludis/elike_package_dep_spec.hh>
@@ -54,6 +56,9 @@
 #include <ostream>
 #include <algorithm>
 #include <functional>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 
 using namespace paludis;
 using namespace paludis::erepository;
@@ -101,6 +106,50 @@ namespace
         typedef std::function<void (const std::list<std::shared_ptr<DepSpec> > &)> StarAnnotationsGoHere;
     };
 
+    typedef std::tuple<std::string, std::string, bool> PackageDepSpecStoreIndex;
+
+    /* The same dependency strings turn up over and over again across a
+     * repository, so parse each one once and hand out copies which share
+     * its data. */
+    class PackageDepSpecStore
+    {
+        private:
+            std::mutex _mutex;
+            std::unordered_map<PackageDepSpecStoreIndex, std::shared_ptr<const PackageDepSpec>, Hash<PackageDepSpecStoreIndex> > _store;
+
+        public:
+            static PackageDepSpecStore & get()
+            {
+                static PackageDepSpecStore result;
+                return result;
+            }
+
+            const std::shared_ptr<const PackageDepSpec> fetch(
+                    const std::string & s,
+                    const EAPI & eapi,
+                    bool add_explicit_choices_requirement)
+            {
+                PackageDepSpecStoreIndex x(eapi.name(), s, add_explicit_choices_requirement);
+
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    auto i(_store.find(x));
+                    if (i != _store.end())
+                        return i->second;
+                }
+
+                auto mentioned(std::make_shared<Set<std::string> >());
+                auto data(partial_parse_elike_package_dep_spec(s, eapi.supported()->package_dep_spec_parse_options(),
+                            eapi.supported()->version_spec_options(), mentioned));
+                if (add_explicit_choices_requirement)
+                    data.additional_requirement(make_elike_presumed_choices_requirement(mentioned));
+                auto spec(std::make_shared<const PackageDepSpec>(data));
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                return _store.insert(std::make_pair(x, spec)).first->second;
+            }
+    };
+
     template <typename T_>
     void package_dep_spec_string_handler(
             typename ParseStackTypes<T_>::Stack & h,
@@ -109,12 +158,8 @@ namespace
             const EAPI & eapi,
             bool add_explicit_choices_requirement)
     {
-        auto mentioned(std::make_shared<Set<std::string> >());
-        auto data(partial_parse_elike_package_dep_spec(s, eapi.supported()->package_dep_spec_parse_options(),
-                    eapi.supported()->version_spec_options(), mentioned));
-        if (add_explicit_choices_requirement)
-            data.additional_requirement(make_elike_presumed_choices_requirement(mentioned));
-        std::shared_ptr<PackageDepSpec> spec(std::make_shared<PackageDepSpec>(data));
+        std::shared_ptr<PackageDepSpec> spec(std::make_shared<PackageDepSpec>(
+                    *PackageDepSpecStore::get().fetch(s, eapi, add_explicit_choices_requirement)));
         h.begin()->item()->append(spec);
         h.begin()->children().push_back(spec);
         annotations_go_here(spec);
@@ -157,9 +202,7 @@ namespace
 
                     std::shared_ptr<BlockDepSpec> spec(std::make_shared<BlockDepSpec>(
                                 s,
-                                parse_elike_package_dep_spec(std::get<2>(p),
-                                    eapi.supported()->package_dep_spec_parse_options(),
-                                    eapi.supported()->version_spec_options())));
+                                *PackageDepSpecStore::get().fetch(std::get<2>(p), eapi, false)));
                     h.begin()->item()->append(spec);
                     h.begin()->block_children().push_back(std::make_pair(spec, op));
                     h.begin()->children().push_back(spec);
@@ -27,11 +27,15 @@
 #include <paludis/repositories/fake/fake_package_id.hh>
 
 #include <paludis/unformatted_pretty_printer.hh>
+#include <paludis/dep_spec.hh>
 
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/indirect_iterator-impl.hh>
 
 #include <sstream>
+#include <list>
+#include <algorithm>
 
 #include <gtest/gtest.h>
 
@@ -401,3 +405,47 @@ TEST(DepParser, StarAnnotations)
             "[[ *note = [ second-inner ] ]] cat/mid3 [[ description = [ mid ] ]] ) [[ *description = [ mid ] ]] cat/outer2", stringify(d));
 }
 
+
+TEST(DepParser, SharedPackages)
+{
+    TestEnvironment env;
+
+    std::list<std::shared_ptr<const PackageDepSpec> > specs;
+    auto collect([&] (const std::shared_ptr<const DependencySpecTree> & tree) {
+            tree->top()->make_accept(
+                [&] (const DependencySpecTree::NodeType<PackageDepSpec>::Type & node) {
+                    specs.push_back(node.spec());
+                },
+                [&] (const DependencySpecTree::NodeType<NamedSetDepSpec>::Type &) { },
+                [&] (const DependencySpecTree::NodeType<BlockDepSpec>::Type &) { },
+                [&] (const DependencySpecTree::NodeType<DependenciesLabelsDepSpec>::Type &) { },
+                [&] (const DependencySpecTree::NodeType<AllDepSpec>::Type & node, const Revisit<void, DependencySpecTree::BasicNode> & revisit) {
+                    std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), revisit);
+                },
+                [&] (const DependencySpecTree::NodeType<AnyDepSpec>::Type & node, const Revisit<void, DependencySpecTree::BasicNode> & revisit) {
+                    std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), revisit);
+                },
+                [&] (const DependencySpecTree::NodeType<ConditionalDepSpec>::Type & node, const Revisit<void, DependencySpecTree::BasicNode> & revisit) {
+                    std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), revisit);
+                }
+                );
+            });
+
+    collect(parse_depend(">=cat/shared-1.2:2 [[ foo = bar ]] >=cat/shared-1.2:2",
+                &env, *EAPIData::get_instance()->eapi_from_string("paludis-1"), false));
+    collect(parse_depend("foo? ( >=cat/shared-1.2:2 )",
+                &env, *EAPIData::get_instance()->eapi_from_string("paludis-1"), false));
+
+    ASSERT_EQ(3u, specs.size());
+    auto first(specs.begin()), second(std::next(first)), third(std::next(second));
+
+    EXPECT_EQ(">=cat/shared-1.2:2", stringify(**first));
+    EXPECT_EQ(">=cat/shared-1.2:2", stringify(**second));
+    EXPECT_EQ(">=cat/shared-1.2:2", stringify(**third));
+    EXPECT_EQ((*first)->data(), (*second)->data());
+    EXPECT_EQ((*first)->data(), (*third)->data());
+
+    EXPECT_TRUE(bool((*first)->maybe_annotations()));
+    EXPECT_FALSE(bool((*second)->maybe_annotations()));
+    EXPECT_FALSE(bool((*third)->maybe_annotations()));
+}
@@ -144,7 +144,7 @@ namespace
             if (node.spec()->text().empty())
                 return;
 
-            Context context("When handling item '" + stringify(*node.spec()) + "':");
+            LazyContext context([&] () { return "When handling item '" + stringify(*node.spec()) + "':"; });
 
             Prefixes::iterator p(prefixes.find(*current_prefix_stack.begin()));
             if (p == prefixes.end())
@@ -279,7 +279,7 @@ EChoicesKey::parse_value() const
     if (_imp->value)
         return _imp->value;
 
-    Context context("When making Choices key for '" + stringify(*_imp->id) + "':");
+    LazyContext context([&] () { return "When making Choices key for '" + stringify(*_imp->id) + "':"; });
 
     _imp->value = std::make_shared<Choices>();
     if (! _imp->id->eapi()->supported())
@@ -18,6 +18,7 @@
  */
 
 #include <paludis/repositories/e/e_installed_repository.hh>
+#include <paludis/repositories/e/e_installed_repository_id.hh>
 #include <paludis/repositories/e/e_repository_id.hh>
 #include <paludis/repositories/e/e_repository_params.hh>
 #include <paludis/repositories/e/eapi.hh>
@@ -39,6 +40,8 @@
 #include <paludis/util/safe_ifstream.hh>
 #include <paludis/util/process.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/file_lock.hh>
 #include <paludis/util/join.hh>
 #include <paludis/util/is_file_with_extension.hh>
 
@@ -55,6 +58,19 @@
 #include <paludis/selection.hh>
 #include <paludis/common_sets.hh>
 #include <paludis/output_manager.hh>
+#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
+#include <paludis/file_owner_index.hh>
+#include <paludis/dependents_index.hh>
+#include <paludis/spec_tree.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/util/fs_iterator.hh>
+#include <paludis/util/indirect_iterator-impl.hh>
+#include <paludis/util/visitor.hh>
+
+#include <atomic>
+#include <map>
+#include <mutex>
 
 using namespace paludis;
 using namespace paludis::erepository;
@@ -66,11 +82,158 @@ namespace paludis
     {
         EInstalledRepositoryParams params;
 
+        mutable std::once_flag file_owner_index_once;
+        mutable std::shared_ptr<FileOwnerIndex> file_owner_index;
+
+        /* the IDs for every owner in the index, which is only filled in once
+         * the index has been checked against them */
+        mutable std::mutex file_owner_mutex;
+        mutable std::atomic<bool> file_owner_index_checked;
+        mutable std::map<std::string, std::shared_ptr<const PackageID> > file_owner_ids;
+
+        mutable std::once_flag dependents_index_once;
+        mutable std::shared_ptr<DependentsIndex> dependents_index;
+
+        /* likewise, for the dependents index */
+        mutable std::mutex dependents_mutex;
+        mutable std::atomic<bool> dependents_index_checked;
+        mutable std::map<std::string, std::shared_ptr<const PackageID> > dependents_ids;
+
         Imp(const EInstalledRepositoryParams & p) :
-            params(p)
+            params(p),
+            file_owner_index_checked(false),
+            dependents_index_checked(false)
+        {
+        }
+    };
+}
+
+namespace
+{
+    std::string file_owner_name(const std::shared_ptr<const PackageID> & id)
+    {
+        return stringify(id->fs_location_key()->parse_value());
+    }
+
+    Timestamp file_owner_stamp(const std::shared_ptr<const PackageID> & id)
+    {
+        FSStat f(id->fs_location_key()->parse_value() /
+                std::static_pointer_cast<const EInstalledRepositoryID>(id)->contents_filename());
+        return f.exists() ? f.mtim() : Timestamp(0, 0);
+    }
+
+    std::vector<std::string> file_owner_paths(const std::shared_ptr<const PackageID> & id)
+    {
+        std::vector<std::string> result;
+
+        id->for_each_contents_entry([&] (const PackedContentsEntry & e) { result.push_back(std::string(e.path)); });
+
+        return result;
+    }
+}
+
+namespace
+{
+    /* a dependency's metadata can be changed behind our back by rewriting
+     * any file in the ID's directory, so go by the newest of them */
+    Timestamp dependents_stamp(const std::shared_ptr<const PackageID> & id)
+    {
+        Timestamp result(0, 0);
+        FSPath dir(id->fs_location_key()->parse_value());
+        if (! dir.stat().is_directory())
+            return result;
+
+        for (FSIterator f(dir, { }), f_end ; f != f_end ; ++f)
+        {
+            FSStat f_stat(*f);
+            if (f_stat.is_regular_file() && result < f_stat.mtim())
+                result = f_stat.mtim();
+        }
+
+        return result;
+    }
+
+    /* every name that appears anywhere in an ID's dependencies, whatever
+     * conditions it is behind, since those can change */
+    struct DependentsNamesCollector
+    {
+        std::vector<std::string> names;
+        bool anything;
+
+        DependentsNamesCollector() :
+            anything(false)
+        {
+        }
+
+        void visit(const DependencySpecTree::NodeType<PackageDepSpec>::Type & node)
+        {
+            if (node.spec()->package_ptr())
+                names.push_back(stringify(*node.spec()->package_ptr()));
+            else
+                anything = true;
+        }
+
+        void visit(const DependencySpecTree::NodeType<NamedSetDepSpec>::Type &)
+        {
+            /* sets can change, so we can't say what these match */
+            anything = true;
+        }
+
+        void visit(const DependencySpecTree::NodeType<BlockDepSpec>::Type &)
+        {
+        }
+
+        void visit(const DependencySpecTree::NodeType<DependenciesLabelsDepSpec>::Type &)
+        {
+        }
+
+        void visit(const DependencySpecTree::NodeType<ConditionalDepSpec>::Type & node)
+        {
+            std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), accept_visitor(*this));
+        }
+
+        void visit(const DependencySpecTree::NodeType<AnyDepSpec>::Type & node)
+        {
+            std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), accept_visitor(*this));
+        }
+
+        void visit(const DependencySpecTree::NodeType<AllDepSpec>::Type & node)
         {
+            std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), accept_visitor(*this));
         }
     };
+
+    DependentsNamesCollector dependents_names(const std::shared_ptr<const PackageID> & id)
+    {
+        DependentsNamesCollector result;
+
+        try
+        {
+            if (id->dependencies_key())
+                id->dependencies_key()->parse_value()->top()->accept(result);
+            else
+                for (auto & fn : { &PackageID::build_dependencies_key, &PackageID::run_dependencies_key, &PackageID::post_dependencies_key })
+                {
+                    auto key(((*id).*fn)());
+                    if (key)
+                        key->parse_value()->top()->accept(result);
+                }
+        }
+        catch (const InternalError &)
+        {
+            throw;
+        }
+        catch (const Exception & e)
+        {
+            /* whoever looks at the dependencies properly will complain, so
+             * just make sure they do get looked at */
+            Log::get_instance()->message("e.installed.dependents.bad_dependencies", ll_debug, lc_context)
+                << "Couldn't work out what '" << *id << "' depends upon: '" << e.message() << "' (" << e.what() << ")";
+            result.anything = true;
+        }
+
+        return result;
+    }
 }
 
 EInstalledRepository::EInstalledRepository(const EInstalledRepositoryParams & p,
@@ -116,6 +279,302 @@ EInstalledRepository::want_pre_post_phases() const
     return true;
 }
 
+std::shared_ptr<FileLock>
+EInstalledRepository::lock_for_merge() const
+{
+    FSPath cache_dir(location_key()->parse_value() / ".cache");
+    try
+    {
+        cache_dir.mkdir(0755, { fspmkdo_ok_if_exists });
+    }
+    catch (const FSError &)
+    {
+        /* FileLock will complain when it can't create the lock file */
+    }
+
+    return std::make_shared<FileLock>(cache_dir / "merge_lock");
+}
+
+FileOwnerIndex &
+EInstalledRepository::_file_owner_index() const
+{
+    std::call_once(_imp->file_owner_index_once, [&] () {
+            _imp->file_owner_index = std::make_shared<FileOwnerIndex>(location_key()->parse_value() / ".cache" / "file_owners");
+            });
+    return *_imp->file_owner_index;
+}
+
+void
+EInstalledRepository::_write_file_owner_index(const LogLevel failure_log_level) const
+{
+    FSPath cache_dir(_file_owner_index().filename().dirname());
+    try
+    {
+        cache_dir.mkdir(0755, { fspmkdo_ok_if_exists });
+    }
+    catch (const FSError & e)
+    {
+        Log::get_instance()->message("e.installed.file_owners.no_dir", failure_log_level, lc_context)
+            << "Couldn't create '" << cache_dir << "': " << e.message();
+        return;
+    }
+
+    _file_owner_index().write(failure_log_level);
+}
+
+void
+EInstalledRepository::_need_file_owner_index_checked() const
+{
+    if (_imp->file_owner_index_checked)
+        return;
+
+    Context context("When checking the file owner index for repository '" + stringify(name()) + "':");
+
+    /* any ID whose contents file has changed since it was indexed gets
+     * indexed again, and anything that has gone away is dropped, which when
+     * there is no index at all means building it from scratch */
+    std::map<std::string, Timestamp> stamps(_file_owner_index().stamps());
+    std::map<std::string, std::shared_ptr<const PackageID> > ids;
+    unsigned changed(0);
+
+    auto categories(category_names({ }));
+    for (const auto & c : *categories)
+    {
+        auto packages(package_names(c, { }));
+        for (const auto & p : *packages)
+        {
+            auto package_ids_for_name(package_ids(p, { }));
+            for (const auto & id : *package_ids_for_name)
+            {
+                std::string owner(file_owner_name(id));
+                Timestamp stamp(file_owner_stamp(id));
+                ids.insert(std::make_pair(owner, id));
+
+                auto s(stamps.find(owner));
+                if (stamps.end() != s && s->second == stamp)
+                    stamps.erase(s);
+                else
+                {
+                    if (stamps.end() != s)
+                        stamps.erase(s);
+                    _file_owner_index().replace(owner, stamp, file_owner_paths(id));
+                    id->can_drop_in_memory_cache();
+                    ++changed;
+                }
+            }
+        }
+    }
+
+    for (const auto & s : stamps)
+    {
+        _file_owner_index().remove(s.first);
+        ++changed;
+    }
+
+    if (0 != changed)
+    {
+        Log::get_instance()->message("e.installed.file_owners.stale", ll_debug, lc_context)
+            << "Updated " << changed << " entries in the file owner index";
+
+        /* we're usually not root here, so failing to save is normal */
+        _write_file_owner_index(ll_debug);
+    }
+
+    _imp->file_owner_ids = ids;
+    _imp->file_owner_index_checked = true;
+}
+
+void
+EInstalledRepository::add_to_file_owner_index(const std::shared_ptr<const ERepositoryID> & id) const
+{
+    Context context("When adding '" + stringify(*id) + "' to the file owner index:");
+
+    _file_owner_index().replace(file_owner_name(id), file_owner_stamp(id), file_owner_paths(id));
+    _write_file_owner_index(ll_warning);
+    _imp->file_owner_index_checked = false;
+}
+
+void
+EInstalledRepository::remove_from_file_owner_index(const std::shared_ptr<const ERepositoryID> & id) const
+{
+    Context context("When removing '" + stringify(*id) + "' from the file owner index:");
+
+    _file_owner_index().remove(file_owner_name(id));
+    _write_file_owner_index(ll_warning);
+    _imp->file_owner_index_checked = false;
+}
+
+void
+EInstalledRepository::invalidate_file_owner_index() const
+{
+    _imp->file_owner_index_checked = false;
+}
+
+std::shared_ptr<const PackageIDSequence>
+EInstalledRepository::file_owners(const FSPath & f) const
+{
+    std::unique_lock<std::mutex> lock(_imp->file_owner_mutex);
+    _need_file_owner_index_checked();
+
+    auto result(std::make_shared<PackageIDSequence>());
+    for (const auto & owner : _file_owner_index().owners_of(f))
+    {
+        auto i(_imp->file_owner_ids.find(owner));
+        if (_imp->file_owner_ids.end() != i)
+            result->push_back(i->second);
+    }
+
+    return result;
+}
+
+std::shared_ptr<const PackageIDSequence>
+EInstalledRepository::file_owners_within(const FSPath & f) const
+{
+    std::unique_lock<std::mutex> lock(_imp->file_owner_mutex);
+    _need_file_owner_index_checked();
+
+    auto result(std::make_shared<PackageIDSequence>());
+    for (const auto & owner : _file_owner_index().owners_within(f))
+    {
+        auto i(_imp->file_owner_ids.find(owner));
+        if (_imp->file_owner_ids.end() != i)
+            result->push_back(i->second);
+    }
+
+    return result;
+}
+
+DependentsIndex &
+EInstalledRepository::_dependents_index() const
+{
+    std::call_once(_imp->dependents_index_once, [&] () {
+            _imp->dependents_index = std::make_shared<DependentsIndex>(location_key()->parse_value() / ".cache" / "dependents");
+            });
+    return *_imp->dependents_index;
+}
+
+void
+EInstalledRepository::_write_dependents_index(const LogLevel failure_log_level) const
+{
+    FSPath cache_dir(_dependents_index().filename().dirname());
+    try
+    {
+        cache_dir.mkdir(0755, { fspmkdo_ok_if_exists });
+    }
+    catch (const FSError & e)
+    {
+        Log::get_instance()->message("e.installed.dependents.no_dir", failure_log_level, lc_context)
+            << "Couldn't create '" << cache_dir << "': " << e.message();
+        return;
+    }
+
+    _dependents_index().write(failure_log_level);
+}
+
+void
+EInstalledRepository::_need_dependents_index_checked() const
+{
+    if (_imp->dependents_index_checked)
+        return;
+
+    Context context("When checking the dependents index for repository '" + stringify(name()) + "':");
+
+    /* as for the file owner index */
+    std::map<std::string, Timestamp> stamps(_dependents_index().stamps());
+    std::map<std::string, std::shared_ptr<const PackageID> > ids;
+    unsigned changed(0);
+
+    auto categories(category_names({ }));
+    for (const auto & c : *categories)
+    {
+        auto packages(package_names(c, { }));
+        for (const auto & p : *packages)
+        {
+            auto package_ids_for_name(package_ids(p, { }));
+            for (const auto & id : *package_ids_for_name)
+            {
+                std::string dependent(file_owner_name(id));
+                Timestamp stamp(dependents_stamp(id));
+                ids.insert(std::make_pair(dependent, id));
+
+                auto s(stamps.find(dependent));
+                if (stamps.end() != s && s->second == stamp)
+                    stamps.erase(s);
+                else
+                {
+                    if (stamps.end() != s)
+                        stamps.erase(s);
+                    auto names(dependents_names(id));
+                    _dependents_index().replace(dependent, stamp, names.names, names.anything);
+                    ++changed;
+                }
+            }
+        }
+    }
+
+    for (const auto & s : stamps)
+    {
+        _dependents_index().remove(s.first);
+        ++changed;
+    }
+
+    if (0 != changed)
+    {
+        Log::get_instance()->message("e.installed.dependents.stale", ll_debug, lc_context)
+            << "Updated " << changed << " entries in the dependents index";
+
+        /* we're usually not root here, so failing to save is normal */
+        _write_dependents_index(ll_debug);
+    }
+
+    _imp->dependents_ids = ids;
+    _imp->dependents_index_checked = true;
+}
+
+void
+EInstalledRepository::add_to_dependents_index(const std::shared_ptr<const ERepositoryID> & id) const
+{
+    Context context("When adding '" + stringify(*id) + "' to the dependents index:");
+
+    auto names(dependents_names(id));
+    _dependents_index().replace(file_owner_name(id), dependents_stamp(id), names.names, names.anything);
+    _write_dependents_index(ll_warning);
+    _imp->dependents_index_checked = false;
+}
+
+void
+EInstalledRepository::remove_from_dependents_index(const std::shared_ptr<const ERepositoryID> & id) const
+{
+    Context context("When removing '" + stringify(*id) + "' from the dependents index:");
+
+    _dependents_index().remove(file_owner_name(id));
+    _write_dependents_index(ll_warning);
+    _imp->dependents_index_checked = false;
+}
+
+void
+EInstalledRepository::invalidate_dependents_index() const
+{
+    _imp->dependents_index_checked = false;
+}
+
+std::shared_ptr<const PackageIDSequence>
+EInstalledRepository::possible_dependents(const QualifiedPackageName & q) const
+{
+    std::unique_lock<std::mutex> lock(_imp->dependents_mutex);
+    _need_dependents_index_checked();
+
+    auto result(std::make_shared<PackageIDSequence>());
+    for (const auto & dependent : _dependents_index().dependents_of(stringify(q)))
+    {
+        auto i(_imp->dependents_ids.find(dependent));
+        if (_imp->dependents_ids.end() != i)
+            result->push_back(i->second);
+    }
+
+    return result;
+}
+
 HookResult
 EInstalledRepository::perform_hook(const Hook & hook, const std::shared_ptr<OutputManager> &)
 {
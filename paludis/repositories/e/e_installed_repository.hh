@@ -21,7 +21,11 @@
 #define PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_E_INSTALLED_REPOSITORY_HH 1
 
 #include <paludis/repository.hh>
+#include <paludis/file_owner_index-fwd.hh>
+#include <paludis/dependents_index-fwd.hh>
 #include <paludis/repositories/e/e_repository_id.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/file_lock-fwd.hh>
 
 namespace paludis
 {
@@ -44,11 +48,21 @@ namespace paludis
         class EInstalledRepository :
             public Repository,
             public RepositoryEnvironmentVariableInterface,
-            public RepositoryDestinationInterface
+            public RepositoryDestinationInterface,
+            public RepositoryFileOwnerInterface,
+            public RepositoryDependentsInterface
         {
             private:
                 Pimp<EInstalledRepository> _imp;
 
+                FileOwnerIndex & _file_owner_index() const;
+                void _write_file_owner_index(const LogLevel) const;
+                void _need_file_owner_index_checked() const;
+
+                DependentsIndex & _dependents_index() const;
+                void _write_dependents_index(const LogLevel) const;
+                void _need_dependents_index_checked() const;
+
             protected:
                 EInstalledRepository(const EInstalledRepositoryParams &, const RepositoryName &, const RepositoryCapabilities &);
                 ~EInstalledRepository() override;
@@ -58,6 +72,58 @@ namespace paludis
                         const std::string & var) const
                     PALUDIS_ATTRIBUTE((warn_unused_result));
 
+                ///\name File owner index
+                ///\{
+
+                /**
+                 * Record a newly merged ID's contents in the file owner
+                 * index. Must be called after anything the merge has
+                 * uninstalled has been removed.
+                 */
+                void add_to_file_owner_index(const std::shared_ptr<const ERepositoryID> &) const;
+
+                /**
+                 * Remove an uninstalled ID from the file owner index.
+                 */
+                void remove_from_file_owner_index(const std::shared_ptr<const ERepositoryID> &) const;
+
+                /**
+                 * Our IDs have been replaced, so the file owner index must
+                 * be checked again before it is next used.
+                 */
+                void invalidate_file_owner_index() const;
+
+                ///\}
+
+                ///\name Dependents index
+                ///\{
+
+                /**
+                 * Record a newly merged ID's dependencies in the dependents
+                 * index.
+                 */
+                void add_to_dependents_index(const std::shared_ptr<const ERepositoryID> &) const;
+
+                /**
+                 * Remove an uninstalled ID from the dependents index.
+                 */
+                void remove_from_dependents_index(const std::shared_ptr<const ERepositoryID> &) const;
+
+                /**
+                 * Our IDs have been replaced, so the dependents index must be
+                 * checked again before it is next used.
+                 */
+                void invalidate_dependents_index() const;
+
+                ///\}
+
+                /**
+                 * Keep anything else, including other processes, from merging
+                 * to or uninstalling from us until the returned lock is
+                 * destroyed.
+                 */
+                std::shared_ptr<FileLock> lock_for_merge() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
             public:
                 /* RepositoryEnvironmentVariableInterface */
 
@@ -74,6 +140,19 @@ namespace paludis
                 bool want_pre_post_phases() const
                     override PALUDIS_ATTRIBUTE((warn_unused_result));
 
+                /* RepositoryFileOwnerInterface */
+
+                std::shared_ptr<const PackageIDSequence> file_owners(const FSPath &) const
+                    override PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                std::shared_ptr<const PackageIDSequence> file_owners_within(const FSPath &) const
+                    override PALUDIS_ATTRIBUTE((warn_unused_result));
+
+                /* RepositoryDependentsInterface */
+
+                std::shared_ptr<const PackageIDSequence> possible_dependents(const QualifiedPackageName &) const
+                    override PALUDIS_ATTRIBUTE((warn_unused_result));
+
                 /* Repository */
 
                 std::shared_ptr<const CategoryNamePartSet> unimportant_category_names(
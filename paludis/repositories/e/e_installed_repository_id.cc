@@ -198,7 +198,7 @@ EInstalledRepositoryID::need_keys_added() const
         add_metadata_key(_imp->fs_location);
     }
 
-    Context context("When loading ID keys from '" + stringify(_imp->dir) + "':");
+    LazyContext context([&] () { return "When loading ID keys from '" + stringify(_imp->dir) + "':"; });
 
     add_metadata_key(std::make_shared<LiteralMetadataValueKey<std::string>>("EAPI", "EAPI", mkt_internal, eapi()->name()));
 
@@ -679,7 +679,7 @@ EInstalledRepositoryID::eapi() const
     if (_imp->eapi)
         return _imp->eapi;
 
-    Context context("When finding EAPI for '" + canonical_form(idcf_full) + "':");
+    LazyContext context([&] () { return "When finding EAPI for '" + canonical_form(idcf_full) + "':"; });
 
     if ((_imp->dir / "EAPI").stat().exists())
         _imp->eapi = EAPIData::get_instance()->eapi_from_string(file_contents(_imp->dir / "EAPI"));
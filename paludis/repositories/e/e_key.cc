@@ -52,6 +52,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <mutex>
 
 using namespace paludis;
 using namespace paludis::erepository;
@@ -64,6 +65,8 @@ namespace paludis
         const Environment * const env;
         const std::shared_ptr<const ERepositoryID> id;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const DependencySpecTree> value;
         const std::shared_ptr<const DependenciesLabelSequence> labels;
 
         const std::string raw_name;
@@ -101,8 +104,14 @@ EDependenciesKey::~EDependenciesKey() = default;
 const std::shared_ptr<const DependencySpecTree>
 EDependenciesKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':");
-    return parse_depend(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':"; });
+        _imp->value = parse_depend(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    }
+
+    return _imp->value;
 }
 
 const std::shared_ptr<const DependenciesLabelSequence>
@@ -146,6 +155,8 @@ namespace paludis
     {
         const Environment * const env;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const LicenseSpecTree> value;
 
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::shared_ptr<const EAPI> eapi;
@@ -184,8 +195,14 @@ ELicenseKey::~ELicenseKey() = default;
 const std::shared_ptr<const LicenseSpecTree>
 ELicenseKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_license(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "':"; });
+        _imp->value = parse_license(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    }
+
+    return _imp->value;
 }
 
 const std::string
@@ -225,6 +242,8 @@ namespace paludis
         const std::shared_ptr<const ERepositoryID> id;
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const FetchableURISpecTree> value;
         const MetadataKeyType type;
 
         Imp(const Environment * const e, const std::shared_ptr<const ERepositoryID> & i,
@@ -252,8 +271,14 @@ EFetchableURIKey::~EFetchableURIKey() = default;
 const std::shared_ptr<const FetchableURISpecTree>
 EFetchableURIKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':");
-    return parse_fetchable_uri(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "' from '" + stringify(*_imp->id) + "':"; });
+        _imp->value = parse_fetchable_uri(_imp->string_value, _imp->env, *_imp->id->eapi(), _imp->id->is_installed());
+    }
+
+    return _imp->value;
 }
 
 const std::string
@@ -347,6 +372,8 @@ namespace paludis
     {
         const Environment * const env;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const SimpleURISpecTree> value;
 
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::shared_ptr<const EAPI> eapi;
@@ -382,7 +409,13 @@ ESimpleURIKey::~ESimpleURIKey() = default;
 const std::shared_ptr<const SimpleURISpecTree>
 ESimpleURIKey::parse_value() const
 {
-    return parse_simple_uri(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        _imp->value = parse_simple_uri(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    }
+
+    return _imp->value;
 }
 
 const std::string
@@ -420,6 +453,8 @@ namespace paludis
     {
         const Environment * const env;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const PlainTextSpecTree> value;
 
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::shared_ptr<const EAPI> eapi;
@@ -454,8 +489,14 @@ EPlainTextSpecKey::~EPlainTextSpecKey() = default;
 const std::shared_ptr<const PlainTextSpecTree>
 EPlainTextSpecKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_plain_text(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "':"; });
+        _imp->value = parse_plain_text(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    }
+
+    return _imp->value;
 }
 
 const std::string
@@ -493,6 +534,8 @@ namespace paludis
     {
         const Environment * const env;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const PlainTextSpecTree> value;
 
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::shared_ptr<const EAPI> eapi;
@@ -530,8 +573,14 @@ EMyOptionsKey::~EMyOptionsKey() = default;
 const std::shared_ptr<const PlainTextSpecTree>
 EMyOptionsKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_myoptions(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "':"; });
+        _imp->value = parse_myoptions(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    }
+
+    return _imp->value;
 }
 
 const std::string
@@ -569,6 +618,8 @@ namespace paludis
     {
         const Environment * const env;
         const std::string string_value;
+        mutable std::mutex value_mutex;
+        mutable std::shared_ptr<const RequiredUseSpecTree> value;
 
         const std::shared_ptr<const EAPIMetadataVariable> variable;
         const std::shared_ptr<const EAPI> eapi;
@@ -607,8 +658,14 @@ ERequiredUseKey::~ERequiredUseKey() = default;
 const std::shared_ptr<const RequiredUseSpecTree>
 ERequiredUseKey::parse_value() const
 {
-    Context context("When parsing metadata key '" + raw_name() + "':");
-    return parse_required_use(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    std::unique_lock<std::mutex> lock(_imp->value_mutex);
+    if (! _imp->value)
+    {
+        LazyContext context([&] () { return "When parsing metadata key '" + raw_name() + "':"; });
+        _imp->value = parse_required_use(_imp->string_value, _imp->env, *_imp->eapi, _imp->is_installed);
+    }
+
+    return _imp->value;
 }
 
 const std::string
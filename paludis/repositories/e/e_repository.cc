@@ -28,6 +28,8 @@
 #include <paludis/repositories/e/e_repository_exceptions.hh>
 #include <paludis/repositories/e/eapi.hh>
 #include <paludis/repositories/e/eclass_mtimes.hh>
+#include <paludis/repositories/e/ebuild_metadata_worker_pool.hh>
+#include <paludis/repositories/e/ebuild_binary_metadata_cache.hh>
 #include <paludis/repositories/e/use_desc.hh>
 #include <paludis/repositories/e/layout.hh>
 #include <paludis/repositories/e/info_metadata_key.hh>
@@ -104,6 +106,7 @@
 #include <set>
 #include <algorithm>
 #include <vector>
+#include <iterator>
 #include <list>
 #include <ctime>
 
@@ -199,6 +202,7 @@ namespace paludis
             std::mutex profile_ptr_mutex;
             std::mutex news_ptr_mutex;
             std::mutex eapi_for_file_mutex;
+            std::mutex binary_metadata_cache_mutex;
         };
 
         ERepository * const repo;
@@ -226,6 +230,9 @@ namespace paludis
 
         mutable EAPIForFileMap eapi_for_file_map;
 
+        mutable std::shared_ptr<EbuildBinaryMetadataCache> binary_metadata_cache;
+        mutable std::shared_ptr<EbuildBinaryMetadataCache> binary_write_metadata_cache;
+
         Imp(ERepository * const, const ERepositoryParams &, std::shared_ptr<Mutexes> = std::make_shared<Mutexes>());
         ~Imp();
 
@@ -237,7 +244,9 @@ namespace paludis
         std::shared_ptr<const MetadataValueKey<FSPath> > location_key;
         std::shared_ptr<const MetadataCollectionKey<FSPathSequence> > profiles_key;
         std::shared_ptr<const MetadataValueKey<FSPath> > cache_key;
+        std::shared_ptr<const MetadataValueKey<std::string> > cache_format_key;
         std::shared_ptr<const MetadataValueKey<FSPath> > write_cache_key;
+        std::shared_ptr<const MetadataValueKey<std::string> > write_cache_format_key;
         std::shared_ptr<const MetadataValueKey<bool> > append_repository_name_to_write_cache_key;
         std::shared_ptr<const MetadataValueKey<bool> > ignore_deprecated_profiles;
         std::shared_ptr<const MetadataValueKey<FSPath> > names_cache_key;
@@ -272,6 +281,8 @@ namespace paludis
         std::shared_ptr<EclassMtimes> eclass_mtimes;
         time_t master_mtime;
 
+        const std::shared_ptr<EbuildMetadataWorkerPool> metadata_worker_pool;
+
         const ActiveObjectPtr<DeferredConstructionPtr<std::shared_ptr<LicenceGroups> > > licence_groups;
     };
 
@@ -297,8 +308,12 @@ namespace paludis
                     "profiles", "profiles", mkt_normal, params.profiles())),
         cache_key(std::make_shared<LiteralMetadataValueKey<FSPath> >("cache", "cache",
                     mkt_normal, params.cache())),
+        cache_format_key(std::make_shared<LiteralMetadataValueKey<std::string> >("cache_format", "cache_format",
+                    mkt_normal, stringify(params.cache_format()))),
         write_cache_key(std::make_shared<LiteralMetadataValueKey<FSPath> >("write_cache", "write_cache",
                     mkt_normal, params.write_cache())),
+        write_cache_format_key(std::make_shared<LiteralMetadataValueKey<std::string> >("write_cache_format", "write_cache_format",
+                    mkt_normal, stringify(params.write_cache_format()))),
         append_repository_name_to_write_cache_key(std::make_shared<LiteralMetadataValueKey<bool> >(
                     "append_repository_name_to_write_cache", "append_repository_name_to_write_cache",
                     mkt_internal, params.append_repository_name_to_write_cache())),
@@ -372,6 +387,8 @@ namespace paludis
         sync_host_key(std::make_shared<LiteralMetadataStringStringMapKey>("sync_host", "sync_host", mkt_internal, sync_hosts)),
         eclass_mtimes(std::make_shared<EclassMtimes>(r, params.eclassdirs())),
         master_mtime(0),
+        metadata_worker_pool(EbuildMetadataWorkerPool::max_workers_per_key_from_environment() > 0 ?
+                std::make_shared<EbuildMetadataWorkerPool>(EbuildMetadataWorkerPool::max_workers_per_key_from_environment()) : nullptr),
         licence_groups(DeferredConstructionPtr<std::shared_ptr<LicenceGroups> > (
                     std::bind(&make_licence_groups, std::cref(licence_groups_location_key))))
     {
@@ -524,8 +541,10 @@ ERepository::ERepository(const ERepositoryParams & p) :
             p.environment(),
             fetch_repo_name(p.location()),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = p.binary_destination() ? this : nullptr,
                 n::environment_variable_interface() = this,
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = this
                 )),
     _imp(this, p)
@@ -545,7 +564,9 @@ ERepository::_add_metadata_keys() const
     add_metadata_key(_imp->location_key);
     add_metadata_key(_imp->profiles_key);
     add_metadata_key(_imp->cache_key);
+    add_metadata_key(_imp->cache_format_key);
     add_metadata_key(_imp->write_cache_key);
+    add_metadata_key(_imp->write_cache_format_key);
     add_metadata_key(_imp->append_repository_name_to_write_cache_key);
     add_metadata_key(_imp->ignore_deprecated_profiles);
     add_metadata_key(_imp->names_cache_key);
@@ -757,6 +778,17 @@ ERepository::invalidate()
 {
     _imp.reset(new Imp<ERepository>(this, _imp->params, _imp->mutexes));
     _add_metadata_keys();
+    bump_generation();
+}
+
+void
+ERepository::preload() const
+{
+    /* each of these loads lazily, under its own mutex */
+    _imp->need_profiles();
+    need_mirrors();
+    const std::shared_ptr<const Set<UnprefixedChoiceName> > arch(arch_flags());
+    const std::shared_ptr<const UseDesc> desc(use_desc());
 }
 
 void
@@ -768,15 +800,61 @@ ERepository::purge_invalid_cache() const
     if (write_cache == FSPath("/var/empty"))
         return;
 
+    const std::shared_ptr<const EAPI> eapi(EAPIData::get_instance()->eapi_from_string(
+                _imp->params.eapi_when_unknown()));
+
+    if (auto binary_write_cache = binary_write_metadata_cache())
+    {
+        for (const auto & entry : binary_write_cache->names())
+        {
+            try
+            {
+                std::string::size_type p(entry.find('/'));
+                if (std::string::npos == p)
+                {
+                    binary_write_cache->remove(entry);
+                    continue;
+                }
+
+                CategoryNamePart cnp(entry.substr(0, p));
+                std::string pv(entry.substr(p + 1));
+                VersionSpec v(elike_get_remove_trailing_version(pv, eapi->supported()->version_spec_options()));
+                PackageNamePart pnp(pv);
+
+                std::shared_ptr<const PackageIDSequence> ids(_imp->layout->package_ids(cnp + pnp));
+                bool found(false);
+                for (const auto & i : *ids)
+                {
+                    /* 00 is *not* equal to 0 here */
+                    if (stringify(i->version()) != stringify(v))
+                        continue;
+
+                    std::static_pointer_cast<const ERepositoryID>(i)->purge_invalid_cache();
+
+                    found = true;
+                    break;
+                }
+
+                if (! found)
+                    binary_write_cache->remove(entry);
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("e.ebuild.purge_write_cache.ignoring", ll_warning, lc_context)
+                    << "Ignoring exception '" << e.message() << "' (" << e.what() << ") when purging invalid write_cache entries";
+            }
+        }
+
+        binary_write_cache->write();
+        return;
+    }
+
     if (_imp->params.append_repository_name_to_write_cache())
         write_cache /= stringify(name());
 
     if (! write_cache.stat().is_directory_or_symlink_to_directory())
         return;
 
-    const std::shared_ptr<const EAPI> eapi(EAPIData::get_instance()->eapi_from_string(
-                _imp->params.eapi_when_unknown()));
-
     std::shared_ptr<EclassMtimes> eclass_mtimes(std::make_shared<EclassMtimes>(this, _imp->params.eclassdirs()));
 
     for (FSIterator dc(write_cache, { fsio_inode_sort, fsio_want_directories, fsio_deref_symlinks_for_wants }), dc_end ; dc != dc_end ; ++dc)
@@ -840,6 +918,44 @@ ERepository::profile() const
     return _imp->profile_ptr;
 }
 
+const std::shared_ptr<EbuildMetadataWorkerPool>
+ERepository::metadata_worker_pool() const
+{
+    return _imp->metadata_worker_pool;
+}
+
+const std::shared_ptr<EbuildBinaryMetadataCache>
+ERepository::binary_metadata_cache() const
+{
+    if (_imp->params.cache_format() != cf_binary || _imp->params.cache().basename() == "empty")
+        return nullptr;
+
+    std::unique_lock<std::mutex> lock(_imp->mutexes->binary_metadata_cache_mutex);
+    if (! _imp->binary_metadata_cache)
+        _imp->binary_metadata_cache = std::make_shared<EbuildBinaryMetadataCache>(_imp->params.cache() / "metadata.pbmc");
+    return _imp->binary_metadata_cache;
+}
+
+const std::shared_ptr<EbuildBinaryMetadataCache>
+ERepository::binary_write_metadata_cache() const
+{
+    if (_imp->params.write_cache_format() != cf_binary || _imp->params.write_cache().basename() == "empty")
+        return nullptr;
+
+    std::unique_lock<std::mutex> lock(_imp->mutexes->binary_metadata_cache_mutex);
+    if (! _imp->binary_write_metadata_cache)
+    {
+        /* one file per repository, rather than a directory per repository */
+        if (_imp->params.append_repository_name_to_write_cache())
+            _imp->binary_write_metadata_cache = std::make_shared<EbuildBinaryMetadataCache>(
+                    _imp->params.write_cache() / (stringify(name()) + ".pbmc"));
+        else
+            _imp->binary_write_metadata_cache = std::make_shared<EbuildBinaryMetadataCache>(
+                    _imp->params.write_cache() / "metadata.pbmc");
+    }
+    return _imp->binary_write_metadata_cache;
+}
+
 std::string
 ERepository::profile_variable(const std::string & s) const
 {
@@ -865,10 +981,15 @@ ERepository::environment_updated_profile_variable(const std::string & var) const
     return join(values.begin(), last, " ");
 }
 
-void
+RegenerateCacheStatistics
 ERepository::regenerate_cache() const
 {
-    _imp->names_cache->regenerate_cache();
+    RegenerateCacheStatistics result(_imp->names_cache->regenerate_cache());
+
+    if (auto binary_write_cache = binary_write_metadata_cache())
+        binary_write_cache->write();
+
+    return result;
 }
 
 std::shared_ptr<const CategoryNamePartSet>
@@ -962,6 +1083,8 @@ ERepository::make_manifest(const QualifiedPackageName & qpn)
         if (! DigestRegistry::get_instance()->get(hash))
             throw ERepositoryConfigurationError("Manifest hash function '" + hash + "' is not supported");
 
+    const std::vector<std::string> manifest_hashes(_imp->params.manifest_hashes()->begin(), _imp->params.manifest_hashes()->end());
+
     FSPath package_dir = _imp->layout->package_directory(qpn);
 
     std::vector<std::pair<std::pair<std::string, std::string>, std::string> > lines;
@@ -969,6 +1092,11 @@ ERepository::make_manifest(const QualifiedPackageName & qpn)
 
     if (! _imp->params.thin_manifests())
     {
+        /* ebuilds and things in files/ are small, so read them all in and
+         * hash them together, which some digests can do much more quickly */
+        std::vector<std::pair<std::pair<std::string, std::string>, std::string> > unhashed_lines;
+        std::vector<std::string> contents;
+
         for (const auto & path_to_type : *files)
         {
             FSPath file(path_to_type.first);
@@ -982,17 +1110,20 @@ ERepository::make_manifest(const QualifiedPackageName & qpn)
             }
 
             SafeIFStream file_stream(file);
+            contents.push_back(std::string((std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>()));
 
-            std::string line(file_type + " " + filename + " " + stringify(file.stat().file_size()));
+            unhashed_lines.push_back(std::make_pair(std::make_pair(file_type, filename),
+                        file_type + " " + filename + " " + stringify(file.stat().file_size())));
+        }
 
-            for (const auto & hash : *_imp->params.manifest_hashes())
-            {
-                file_stream.clear();
-                file_stream.seekg(0, std::ios::beg);
-                line += " " + hash + " " + DigestRegistry::get_instance()->get(hash)(file_stream);
-            }
+        auto hexsums(DigestRegistry::get_instance()->get_multiple(manifest_hashes, contents));
+        for (std::size_t i(0) ; i < unhashed_lines.size() ; ++i)
+        {
+            std::string line(unhashed_lines[i].second);
+            for (const auto & hash : manifest_hashes)
+                line += " " + hash + " " + hexsums[i][hash];
 
-            lines.push_back(std::make_pair(std::make_pair(file_type, filename), line));
+            lines.push_back(std::make_pair(unhashed_lines[i].first, line));
         }
     }
 
@@ -1022,12 +1153,11 @@ ERepository::make_manifest(const QualifiedPackageName & qpn)
 
             SafeIFStream file_stream(f);
 
-            MemoisedHashes * hashes = MemoisedHashes::get_instance();
-
             std::string line("DIST " + f.basename() + " " + stringify(f_stat.file_size()));
 
-            for (const auto & hash : *_imp->params.manifest_hashes())
-                line += " " + hash + " " + hashes->get(hash, f, file_stream);
+            auto hexsums(MemoisedHashes::get_instance()->get(manifest_hashes, f, file_stream));
+            for (const auto & hash : manifest_hashes)
+                line += " " + hash + " " + hexsums[hash];
 
             lines.push_back(std::make_pair(std::make_pair("DIST", f.basename()), line));
         }
@@ -1270,6 +1400,20 @@ ERepository::repository_factory_create(
         append_repository_name_to_write_cache = destringify<bool>(f("append_repository_name_to_write_cache"));
     }
 
+    CacheFormat cache_format(cf_flat);
+    if (! f("cache_format").empty())
+    {
+        Context item_context("When handling cache_format key:");
+        cache_format = destringify<CacheFormat>(f("cache_format"));
+    }
+
+    CacheFormat write_cache_format(cf_flat);
+    if (! f("write_cache_format").empty())
+    {
+        Context item_context("When handling write_cache_format key:");
+        write_cache_format = destringify<CacheFormat>(f("write_cache_format"));
+    }
+
     bool ignore_deprecated_profiles(false);
     if (! f("ignore_deprecated_profiles").empty())
     {
@@ -1452,6 +1596,7 @@ ERepository::repository_factory_create(
                 n::binary_uri_prefix() = binary_uri_prefix,
                 n::builddir() = FSPath(builddir).realpath_if_exists(),
                 n::cache() = cache,
+                n::cache_format() = cache_format,
                 n::distdir() = FSPath(distdir).realpath_if_exists(),
                 n::eapi_when_unknown() = eapi_when_unknown,
                 n::eapi_when_unspecified() = eapi_when_unspecified,
@@ -1476,7 +1621,8 @@ ERepository::repository_factory_create(
                 n::thin_manifests() = thin_manifests,
                 n::use_manifest() = use_manifest,
                 n::write_bin_uri_prefix() = "",
-                n::write_cache() = FSPath(write_cache).realpath_if_exists()
+                n::write_cache() = FSPath(write_cache).realpath_if_exists(),
+                n::write_cache_format() = write_cache_format
                     ));
 }
 
@@ -1535,7 +1681,7 @@ ERepository::eapi_for_file(const FSPath & f) const
     EAPIForFileMap::const_iterator i(_imp->eapi_for_file_map.find(dir));
     if (i == _imp->eapi_for_file_map.end())
     {
-        Context context("When finding the EAPI to use for file '" + stringify(f) + "':");
+        LazyContext context([&] () { return "When finding the EAPI to use for file '" + stringify(f) + "':"; });
         if ((dir / "eapi").stat().is_regular_file_or_symlink_to_regular_file())
         {
             LineConfigFile file(dir / "eapi", { lcfo_disallow_continuations });
@@ -1613,7 +1759,7 @@ ERepository::sync_host_key() const
 const std::shared_ptr<const ERepositoryID>
 ERepository::make_id(const QualifiedPackageName & q, const FSPath & f) const
 {
-    Context context("When creating ID for '" + stringify(q) + "' from '" + stringify(f) + "':");
+    LazyContext context([&] () { return "When creating ID for '" + stringify(q) + "' from '" + stringify(f) + "':"; });
 
     std::string suffix_eapi(FileSuffixes::get_instance()->guess_eapi_from_filename(q, f));
     std::string eapi(suffix_eapi.empty() ? _imp->params.eapi_when_unknown() : suffix_eapi);
@@ -1826,7 +1972,10 @@ ERepository::merge(const MergeParams & m)
         replaces.push_back(r);
     }
 
-    if (_imp->params.write_cache() != FSPath("/var/empty"))
+    if (auto binary_write_cache = binary_write_metadata_cache())
+        for (auto & replace : replaces)
+            binary_write_cache->remove(stringify(replace->name()) + "-" + stringify(replace->version()));
+    else if (_imp->params.write_cache() != FSPath("/var/empty"))
         for (auto & replace : replaces)
         {
             FSPath cache(_imp->params.write_cache());
@@ -1849,12 +1998,14 @@ ERepository::merge(const MergeParams & m)
         SafeOFStream s(_imp->layout->categories_file(), O_CREAT | O_WRONLY | O_CLOEXEC | O_APPEND, true);
         s << m.package_id()->name().category() << std::endl;
     }
+
+    bump_generation();
 }
 
 VersionSpec
 ERepository::extract_package_file_version(const QualifiedPackageName & n, const FSPath & e, const std::string & eapi) const
 {
-    Context context("When extracting version from '" + stringify(e) + "':");
+    LazyContext context([&] () { return "When extracting version from '" + stringify(e) + "':"; });
     std::string::size_type p(e.basename().rfind('.'));
     if (std::string::npos == p)
         throw InternalError(PALUDIS_HERE, "got npos");
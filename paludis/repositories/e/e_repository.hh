@@ -41,6 +41,12 @@ namespace paludis
 {
     class ERepositoryNews;
 
+    namespace erepository
+    {
+        class EbuildMetadataWorkerPool;
+        class EbuildBinaryMetadataCache;
+    }
+
     /**
      * A ERepository is a Repository that handles the layout used by
      * Portage for the main Gentoo tree.
@@ -80,6 +86,8 @@ namespace paludis
 
             void purge_invalid_cache() const override;
 
+            void preload() const override;
+
             /* RepositoryDestinationInterface */
 
             bool is_suitable_destination_for(const std::shared_ptr<const PackageID> &) const
@@ -155,7 +163,24 @@ namespace paludis
             const std::shared_ptr<const erepository::Layout> layout() const;
             const std::shared_ptr<const erepository::Profile> profile() const;
 
-            void regenerate_cache() const override;
+            /**
+             * The pool of long-lived metadata generation processes to use,
+             * or null if we should start a new process for every ebuild.
+             */
+            const std::shared_ptr<erepository::EbuildMetadataWorkerPool> metadata_worker_pool() const;
+
+            /**
+             * The binary metadata caches to use for reading and writing, or
+             * null if the cache or write_cache is not in the binary format.
+             */
+            ///\{
+
+            const std::shared_ptr<erepository::EbuildBinaryMetadataCache> binary_metadata_cache() const;
+            const std::shared_ptr<erepository::EbuildBinaryMetadataCache> binary_write_metadata_cache() const;
+
+            ///\}
+
+            RegenerateCacheStatistics regenerate_cache() const override;
 
             /* Keys */
 
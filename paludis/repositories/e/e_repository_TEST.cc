@@ -49,13 +49,16 @@
 #include <paludis/repository_factory.hh>
 #include <paludis/choice.hh>
 #include <paludis/unformatted_pretty_printer.hh>
+#include <paludis/notifier_callback.hh>
 
 #include <paludis/util/indirect_iterator-impl.hh>
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "config.h"
 
@@ -472,6 +475,112 @@ TEST(ERepository, MetadataUnparsable)
     }
 }
 
+namespace
+{
+    std::shared_ptr<Repository> make_repo7(TestEnvironment & env)
+    {
+        std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+        keys->insert("format", "e");
+        keys->insert("names_cache", "/var/empty");
+        keys->insert("write_cache", "/var/empty");
+        keys->insert("location", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "repo7"));
+        keys->insert("profiles", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "repo7/profiles/profile"));
+        keys->insert("builddir", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "build"));
+        std::shared_ptr<Repository> repo(ERepository::repository_factory_create(&env,
+                    std::bind(from_keys, keys, std::placeholders::_1)));
+        env.add_repository(1, repo);
+        return repo;
+    }
+
+    std::string describe_for_workers_test(const Environment & env, const std::string & spec)
+    {
+        const std::shared_ptr<const PackageID> id(*env[selection::RequireExactlyOne(generator::Matches(
+                        PackageDepSpec(parse_user_package_dep_spec(spec, &env, { })), nullptr, { }))]->begin());
+
+        std::string result(std::static_pointer_cast<const erepository::ERepositoryID>(id)->eapi()->name());
+        if (id->short_description_key())
+            result.append(" short='" + id->short_description_key()->parse_value() + "'");
+        if (id->long_description_key())
+            result.append(" long='" + id->long_description_key()->parse_value() + "'");
+        if (id->build_dependencies_key())
+        {
+            UnformattedPrettyPrinter ff;
+            erepository::SpecTreePrettyPrinter p(ff, { });
+            id->build_dependencies_key()->parse_value()->top()->accept(p);
+            result.append(" build='" + stringify(p) + "'");
+        }
+        return result;
+    }
+}
+
+TEST(ERepository, MetadataWorkers)
+{
+    const std::vector<std::string> specs({ "=cat-one/pkg-one-1", "=cat-one/pkg-one-2", "=cat-one/pkg-one-3", "=cat-one/pkg-two-1" });
+
+    TestEnvironment env;
+    make_repo7(env);
+
+    ::setenv("PALUDIS_METADATA_WORKERS", "2", 1);
+    TestEnvironment workers_env;
+    make_repo7(workers_env);
+    ::unsetenv("PALUDIS_METADATA_WORKERS");
+
+    for (const auto & spec : specs)
+        EXPECT_EQ(describe_for_workers_test(env, spec), describe_for_workers_test(workers_env, spec)) << spec;
+
+    EXPECT_EQ("0 short='The Description' build='foo/bar'", describe_for_workers_test(workers_env, "=cat-one/pkg-one-1"));
+    EXPECT_EQ("UNKNOWN", describe_for_workers_test(workers_env, "=cat-one/pkg-two-1"));
+}
+
+TEST(ERepository, MetadataBinaryCache)
+{
+    FSPath cache_dir(FSPath::cwd() / "e_repository_TEST_dir" / "binary_cache");
+
+    for (int opass = 1 ; opass <= 2 ; ++opass)
+    {
+        TestEnvironment env;
+        int generated(0);
+        env.add_notifier_callback([&] (const NotifierCallbackEvent & e) {
+                if (visitor_cast<const NotifierCallbackGeneratingMetadataEvent>(e))
+                    ++generated;
+                });
+
+        std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+        keys->insert("format", "e");
+        keys->insert("names_cache", "/var/empty");
+        keys->insert("cache", "/var/empty");
+        keys->insert("write_cache", stringify(cache_dir));
+        keys->insert("write_cache_format", "binary");
+        keys->insert("append_repository_name_to_write_cache", "false");
+        keys->insert("location", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "repo7"));
+        keys->insert("profiles", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "repo7/profiles/profile"));
+        keys->insert("builddir", stringify(FSPath::cwd() / "e_repository_TEST_dir" / "build"));
+        std::shared_ptr<Repository> repo(ERepository::repository_factory_create(&env,
+                    std::bind(from_keys, keys, std::placeholders::_1)));
+        env.add_repository(1, repo);
+
+        EXPECT_EQ("0 short='The Description' build='foo/bar'", describe_for_workers_test(env, "=cat-one/pkg-one-1"));
+
+        const std::shared_ptr<const PackageID> id3(*env[selection::RequireExactlyOne(generator::Matches(
+                        PackageDepSpec(parse_user_package_dep_spec("=cat-one/pkg-one-3",
+                                &env, { })), nullptr, { }))]->begin());
+        ASSERT_TRUE(bool(id3->long_description_key()));
+        EXPECT_EQ("This is the long description", id3->long_description_key()->parse_value());
+
+        if (1 == opass)
+        {
+            EXPECT_EQ(2, generated);
+            EXPECT_TRUE((cache_dir / "metadata.pbmc.journal").stat().is_regular_file());
+
+            repo->regenerate_cache();
+            EXPECT_TRUE((cache_dir / "metadata.pbmc").stat().is_regular_file());
+            EXPECT_TRUE(! (cache_dir / "metadata.pbmc.journal").stat().exists());
+        }
+        else
+            EXPECT_EQ(0, generated);
+    }
+}
+
 namespace
 {
     struct ERepositoryQueryUseTest :
@@ -10,6 +10,7 @@ mkdir -p vdb
 touch vdb/THISISTHEVDB
 
 mkdir -p build
+mkdir -p binary_cache
 ln -s build symlinked_build
 
 mkdir -p distdir
@@ -49,6 +49,7 @@ namespace paludis
         typedef Name<struct name_binary_uri_prefix> binary_uri_prefix;
         typedef Name<struct name_builddir> builddir;
         typedef Name<struct name_cache> cache;
+        typedef Name<struct name_cache_format> cache_format;
         typedef Name<struct name_distdir> distdir;
         typedef Name<struct name_eapi_when_unknown> eapi_when_unknown;
         typedef Name<struct name_eapi_when_unspecified> eapi_when_unspecified;
@@ -74,6 +75,7 @@ namespace paludis
         typedef Name<struct name_use_manifest> use_manifest;
         typedef Name<struct name_write_bin_uri_prefix> write_bin_uri_prefix;
         typedef Name<struct name_write_cache> write_cache;
+        typedef Name<struct name_write_cache_format> write_cache_format;
     }
 
     namespace erepository
@@ -90,6 +92,7 @@ namespace paludis
             NamedValue<n::binary_uri_prefix, std::string> binary_uri_prefix;
             NamedValue<n::builddir, FSPath> builddir;
             NamedValue<n::cache, FSPath> cache;
+            NamedValue<n::cache_format, erepository::CacheFormat> cache_format;
             NamedValue<n::distdir, FSPath> distdir;
             NamedValue<n::eapi_when_unknown, std::string> eapi_when_unknown;
             NamedValue<n::eapi_when_unspecified, std::string> eapi_when_unspecified;
@@ -115,6 +118,7 @@ namespace paludis
             NamedValue<n::use_manifest, erepository::UseManifest> use_manifest;
             NamedValue<n::write_bin_uri_prefix, std::string> write_bin_uri_prefix;
             NamedValue<n::write_cache, FSPath> write_cache;
+            NamedValue<n::write_cache_format, erepository::CacheFormat> write_cache_format;
         };
     }
 
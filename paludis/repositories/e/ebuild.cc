@@ -23,6 +23,7 @@
 #include <paludis/repositories/e/eapi.hh>
 #include <paludis/repositories/e/dep_parser.hh>
 #include <paludis/repositories/e/pipe_command_handler.hh>
+#include <paludis/repositories/e/ebuild_metadata_worker_pool.hh>
 
 #include <paludis/util/system.hh>
 #include <paludis/util/process.hh>
@@ -426,12 +427,46 @@ EbuildMetadataCommand::do_run_command(Process & process)
         std::stringstream prog;
         std::stringstream prog_err;
         std::stringstream metadata;
-        process
-            .capture_stdout(prog)
-            .capture_stderr(prog_err)
-            .capture_output_to_fd(metadata, -1, "PALUDIS_METADATA_FD");
+        int exit_status;
 
-        int exit_status(process.run().wait());
+        auto repo(params.environment()->fetch_repository(params.package_id()->repository_name()));
+        auto pool(std::static_pointer_cast<const ERepository>(repo)->metadata_worker_pool());
+        if (pool)
+        {
+            using namespace std::placeholders;
+
+            std::string key(params.package_id()->eapi()->name() + " " + commands());
+            if (params.clearenv())
+                key.append(" clearenv");
+            if (params.sandbox())
+                key.append(" sandbox");
+            if (params.sydbox())
+                key.append(" sydbox");
+
+            auto result(pool->run(key, process, ebuild_file(), commands(),
+                        std::bind(&pipe_command_handler,
+                            params.environment(),
+                            params.package_id(),
+                            params.permitted_directories(),
+                            params.parts(),
+                            params.volatile_files(),
+                            in_metadata_generation(), _1,
+                            params.maybe_output_manager())));
+
+            exit_status = result.exit_status();
+            metadata << result.metadata();
+            prog << result.captured_stdout();
+            prog_err << result.captured_stderr();
+        }
+        else
+        {
+            process
+                .capture_stdout(prog)
+                .capture_stderr(prog_err)
+                .capture_output_to_fd(metadata, -1, "PALUDIS_METADATA_FD");
+
+            exit_status = process.run().wait();
+        }
 
         KeyValueConfigFile f(metadata, { kvcfo_disallow_continuations, kvcfo_disallow_comments , kvcfo_disallow_space_around_equals,
                 kvcfo_disallow_unquoted_values, kvcfo_disallow_source , kvcfo_disallow_variables, kvcfo_preserve_whitespace },
@@ -61,7 +61,7 @@ inherit()
         done
 
         [[ -z "${location}" ]] && die "Error finding eclass ${e}"
-        source "${location}" || die "Error sourcing eclass ${e}"
+        ebuild_source_cached "${location}" || die "Error sourcing eclass ${e}"
         hasq "${ECLASS}" ${INHERITED} || export INHERITED="${INHERITED} ${ECLASS}"
 
         for v in ${PALUDIS_SOURCE_MERGED_VARIABLES} ; do
@@ -114,8 +114,11 @@ EBUILD_MODULES_DIRS="${EBUILD_MODULES_DIRS} ${EBUILD_MODULES_DIR}"
 
 export PALUDIS_EBUILD_MODULES_DIR="${EBUILD_MODULES_DIR}"
 
-export EBUILD_KILL_PID=$$
-declare -r EBUILD_KILL_PID
+# Metadata workers run each ebuild in a subshell, which sets this itself.
+if [[ -z "${PALUDIS_METADATA_WORKER}" ]] ; then
+    export EBUILD_KILL_PID=$$
+    declare -r EBUILD_KILL_PID
+fi
 
 ebuild_load_module()
 {
@@ -712,5 +715,45 @@ ebuild_main()
     fi
 }
 
-ebuild_main "$@"
+ebuild_metadata_worker()
+{
+    local paludis_worker_dir paludis_request paludis_status paludis_l
+
+    paludis_worker_dir=$(mktemp -d -t paludis-metadata-worker.XXXXXX ) \
+        || die "Couldn't create a directory for the metadata worker"
+    trap "rm -fr '${paludis_worker_dir}'" EXIT
+
+    while paludis_request=$(paludis_pipe_command METADATA_WORKER_NEXT "$$" ) && [[ -n "${paludis_request}" ]] ; do
+        (
+            trap 'echo "die trap: exiting with error." 1>&2 ; exit 250' SIGUSR1
+            export EBUILD_KILL_PID=${BASHPID}
+            readonly EBUILD_KILL_PID
+
+            eval "${paludis_request}"
+            unset -v paludis_worker_dir paludis_request paludis_status paludis_l
+            ebuild_cleanup_slashes ROOT
+
+            export PALUDIS_METADATA_FD=9 PALUDIS_SOURCED_FD=8
+            ebuild_main "${PALUDIS_METADATA_WORKER_EBUILD}" ${PALUDIS_METADATA_WORKER_COMMANDS}
+        ) >"${paludis_worker_dir}"/stdout 2>"${paludis_worker_dir}"/stderr \
+            9>"${paludis_worker_dir}"/metadata 8>"${paludis_worker_dir}"/sourced
+        paludis_status=${?}
+
+        # Keep anything the ebuild inherited around for the next one.
+        while read -r paludis_l ; do
+            [[ -n ${PALUDIS_SOURCE_CACHE[${paludis_l}]+set} ]] && continue
+            [[ -f ${paludis_l} ]] && PALUDIS_SOURCE_CACHE[${paludis_l}]=$(< "${paludis_l}" )
+        done <"${paludis_worker_dir}"/sourced
+
+        paludis_pipe_command METADATA_WORKER_DONE "$$" "${paludis_status}" "${paludis_worker_dir}" >/dev/null
+    done
+}
+
+if [[ -n "${PALUDIS_METADATA_WORKER}" ]] ; then
+    # Eclass and exlib text, for ebuild_source_cached.
+    declare -A PALUDIS_SOURCE_CACHE
+    ebuild_metadata_worker
+else
+    ebuild_main "$@"
+fi
 
@@ -199,7 +199,7 @@ require()
         done
 
         [[ -z "${location}" ]] && die "Error finding exlib ${e} in ${EXLIBSDIRS}"
-        source "${location}" || die "Error sourcing exlib ${e}"
+        ebuild_source_cached "${location}" || die "Error sourcing exlib ${e}"
         hasq "${CURRENT_EXLIB}" ${INHERITED} || export INHERITED="${INHERITED} ${CURRENT_EXLIB}"
 
         local f e_f
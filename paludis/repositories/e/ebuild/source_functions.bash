@@ -122,6 +122,17 @@ ebuild_safe_source()
 }
 ebuild_need_extglob ebuild_safe_source
 
+ebuild_source_cached()
+{
+    [[ -n ${PALUDIS_SOURCED_FD} ]] && echo "${1}" >&${PALUDIS_SOURCED_FD}
+
+    if [[ -n ${PALUDIS_METADATA_WORKER} ]] && [[ -n ${PALUDIS_SOURCE_CACHE[${1}]+set} ]] ; then
+        eval "${PALUDIS_SOURCE_CACHE[${1}]}"
+    else
+        source "${1}"
+    fi
+}
+
 ebuild_verify_not_changed_from_global_scope()
 {
     local v vv_orig
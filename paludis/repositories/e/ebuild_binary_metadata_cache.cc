@@ -0,0 +1,734 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/ebuild_binary_metadata_cache.hh>
+
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/fs_error.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/safe_ofstream.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+/*
+ * The file consists of a header, followed by three tables and then the text
+ * of every string. All numbers are native endian, since the file is only
+ * ever read by the machine that wrote it, and the header records the byte
+ * order so that a copied file is rejected rather than misread.
+ *
+ *   Header
+ *   StringRecord[n_strings]    where each string's text lives
+ *   EntryRecord[n_entries]     one per ID, sorted by name
+ *   PairRecord[n_pairs]        the keys and values of each entry
+ *   text
+ */
+
+namespace
+{
+    const char magic[8] = { 'P', 'A', 'L', 'U', 'D', 'I', 'S', 'M' };
+    const uint32_t format_version(1);
+    const uint32_t byte_order_mark(0x01020304);
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t n_strings;
+        uint32_t n_entries;
+        uint32_t n_pairs;
+        uint32_t text_size;
+    };
+
+    struct StringRecord
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct EntryRecord
+    {
+        uint32_t name;
+        uint32_t first_pair;
+        uint32_t n_pairs;
+    };
+
+    struct PairRecord
+    {
+        uint32_t key;
+        uint32_t value;
+    };
+
+    struct Mapping
+    {
+        void * data;
+        std::size_t size;
+
+        const StringRecord * strings;
+        const EntryRecord * entries;
+        const PairRecord * pairs;
+        const char * text;
+
+        uint32_t n_strings;
+        uint32_t n_entries;
+        uint32_t n_pairs;
+        uint32_t text_size;
+
+        Mapping() :
+            data(nullptr),
+            size(0),
+            strings(nullptr),
+            entries(nullptr),
+            pairs(nullptr),
+            text(nullptr),
+            n_strings(0),
+            n_entries(0),
+            n_pairs(0),
+            text_size(0)
+        {
+        }
+
+        ~Mapping()
+        {
+            if (data)
+                ::munmap(data, size);
+        }
+
+        Mapping(const Mapping &) = delete;
+        Mapping & operator= (const Mapping &) = delete;
+
+        bool string_at(uint32_t i, const char * & s, std::size_t & length) const
+        {
+            if (i >= n_strings)
+                return false;
+
+            const StringRecord & r(strings[i]);
+            if (r.offset > text_size || r.length > text_size - r.offset)
+                return false;
+
+            s = text + r.offset;
+            length = r.length;
+            return true;
+        }
+
+        std::string string_at(uint32_t i) const
+        {
+            const char * s;
+            std::size_t length;
+            if (! string_at(i, s, length))
+                return "";
+            return std::string(s, length);
+        }
+
+        int compare_name(const EntryRecord & e, const std::string & name) const
+        {
+            const char * s;
+            std::size_t length;
+            if (! string_at(e.name, s, length))
+                return -1;
+
+            int c(std::memcmp(s, name.data(), std::min(length, name.length())));
+            if (0 != c)
+                return c;
+            return length < name.length() ? -1 : length > name.length() ? 1 : 0;
+        }
+
+        const EntryRecord * find(const std::string & name) const
+        {
+            const EntryRecord * b(entries), * e(entries + n_entries);
+            while (b < e)
+            {
+                const EntryRecord * m(b + (e - b) / 2);
+                int c(compare_name(*m, name));
+                if (0 == c)
+                    return m;
+                else if (c < 0)
+                    b = m + 1;
+                else
+                    e = m;
+            }
+            return nullptr;
+        }
+
+        EbuildBinaryMetadataCache::Entry entry(const EntryRecord & e) const
+        {
+            EbuildBinaryMetadataCache::Entry result;
+            if (e.first_pair > n_pairs || e.n_pairs > n_pairs - e.first_pair)
+                return result;
+
+            for (const PairRecord * p(pairs + e.first_pair), * p_end(p + e.n_pairs) ; p != p_end ; ++p)
+                result.push_back(std::make_pair(string_at(p->key), string_at(p->value)));
+            return result;
+        }
+    };
+
+    std::shared_ptr<Mapping> map_file(const FSPath & filename)
+    {
+        Context context("When mapping binary metadata cache file '" + stringify(filename) + "':");
+
+        auto result(std::make_shared<Mapping>());
+
+        int fd(::open(stringify(filename).c_str(), O_RDONLY | O_CLOEXEC));
+        if (-1 == fd)
+        {
+            if (ENOENT != errno)
+                Log::get_instance()->message("e.cache.binary.open", ll_warning, lc_context)
+                    << "Couldn't open '" << filename << "': " << std::strerror(errno);
+            return result;
+        }
+
+        struct ::stat st;
+        if (0 != ::fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(Header)))
+        {
+            ::close(fd);
+            Log::get_instance()->message("e.cache.binary.truncated", ll_warning, lc_context)
+                << "File is too short to be a binary metadata cache";
+            return result;
+        }
+
+        void * data(::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+        ::close(fd);
+        if (MAP_FAILED == data)
+        {
+            Log::get_instance()->message("e.cache.binary.mmap", ll_warning, lc_context)
+                << "Couldn't mmap: " << std::strerror(errno);
+            return result;
+        }
+
+        std::shared_ptr<Mapping> m(std::make_shared<Mapping>());
+        m->data = data;
+        m->size = st.st_size;
+
+        const Header & h(*static_cast<const Header *>(data));
+        if (0 != std::memcmp(h.magic, magic, sizeof(magic)) || h.version != format_version || h.byte_order != byte_order_mark)
+        {
+            Log::get_instance()->message("e.cache.binary.format", ll_warning, lc_context)
+                << "File is not a binary metadata cache in a format we understand";
+            return result;
+        }
+
+        uint64_t needed(sizeof(Header));
+        needed += uint64_t(h.n_strings) * sizeof(StringRecord);
+        needed += uint64_t(h.n_entries) * sizeof(EntryRecord);
+        needed += uint64_t(h.n_pairs) * sizeof(PairRecord);
+        needed += h.text_size;
+        if (needed != m->size)
+        {
+            Log::get_instance()->message("e.cache.binary.truncated", ll_warning, lc_context)
+                << "File has size " << m->size << ", but expected " << needed;
+            return result;
+        }
+
+        const char * p(static_cast<const char *>(data) + sizeof(Header));
+        m->strings = reinterpret_cast<const StringRecord *>(p);
+        p += h.n_strings * sizeof(StringRecord);
+        m->entries = reinterpret_cast<const EntryRecord *>(p);
+        p += h.n_entries * sizeof(EntryRecord);
+        m->pairs = reinterpret_cast<const PairRecord *>(p);
+        p += h.n_pairs * sizeof(PairRecord);
+        m->text = p;
+
+        m->n_strings = h.n_strings;
+        m->n_entries = h.n_entries;
+        m->n_pairs = h.n_pairs;
+        m->text_size = h.text_size;
+
+        return m;
+    }
+
+    /* hands out one index per distinct string, in the order they are first
+     * seen */
+    struct StringInterner
+    {
+        std::unordered_map<std::string, uint32_t> indices;
+        std::vector<StringRecord> records;
+        std::string text;
+
+        uint32_t intern(const std::string & s)
+        {
+            auto i(indices.find(s));
+            if (indices.end() != i)
+                return i->second;
+
+            if (text.length() + s.length() > UINT32_MAX || records.size() >= UINT32_MAX)
+                throw InternalError(PALUDIS_HERE, "binary metadata cache is too large");
+
+            StringRecord r;
+            r.offset = text.length();
+            r.length = s.length();
+            text.append(s);
+            records.push_back(r);
+
+            uint32_t result(records.size() - 1);
+            indices.insert(std::make_pair(s, result));
+            return result;
+        }
+    };
+
+    template <typename T_>
+    void append_records(std::string & s, const std::vector<T_> & v)
+    {
+        if (! v.empty())
+            s.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T_));
+    }
+
+    /* journal records are a length, an operation, the name and then (for
+     * saves) the keys and values, all as length prefixed strings */
+    enum JournalOperation
+    {
+        jo_save = 1,
+        jo_remove = 2
+    };
+
+    void append_uint32(std::string & s, uint32_t n)
+    {
+        s.append(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    void append_string(std::string & s, const std::string & v)
+    {
+        append_uint32(s, v.length());
+        s.append(v);
+    }
+
+    bool read_uint32(const std::string & s, std::string::size_type & p, uint32_t & n)
+    {
+        if (s.length() - p < sizeof(n))
+            return false;
+        std::memcpy(&n, s.data() + p, sizeof(n));
+        p += sizeof(n);
+        return true;
+    }
+
+    bool read_string(const std::string & s, std::string::size_type & p, std::string & v)
+    {
+        uint32_t length;
+        if (! read_uint32(s, p, length) || s.length() - p < length)
+            return false;
+        v.assign(s, p, length);
+        p += length;
+        return true;
+    }
+
+    std::string read_whole_file(const FSPath & f)
+    {
+        std::string result;
+
+        int fd(::open(stringify(f).c_str(), O_RDONLY | O_CLOEXEC));
+        if (-1 == fd)
+            return result;
+
+        char buf[65536];
+        ssize_t n;
+        while (0 < (n = ::read(fd, buf, sizeof(buf))))
+            result.append(buf, n);
+
+        ::close(fd);
+        return result;
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<EbuildBinaryMetadataCache>
+    {
+        const FSPath filename;
+        const FSPath journal_filename;
+        const FSStat filename_stat;
+
+        mutable std::mutex mutex;
+
+        mutable bool loaded;
+        mutable std::shared_ptr<const Mapping> mapping;
+
+        /* entries that differ from what is in the file */
+        mutable std::map<std::string, EbuildBinaryMetadataCache::Entry> saved;
+        mutable std::set<std::string> removed;
+
+        mutable unsigned journal_records;
+        mutable int journal_fd;
+        mutable bool dirty;
+
+        Imp(const FSPath & f) :
+            filename(f),
+            journal_filename(f.dirname() / (f.basename() + ".journal")),
+            filename_stat(f.stat()),
+            loaded(false),
+            journal_records(0),
+            journal_fd(-1),
+            dirty(false)
+        {
+        }
+
+        ~Imp()
+        {
+            if (-1 != journal_fd)
+                ::close(journal_fd);
+        }
+
+        void replay_journal() const
+        {
+            std::string journal(read_whole_file(journal_filename));
+            std::string::size_type p(0);
+            while (p < journal.length())
+            {
+                uint32_t length, op;
+                if (! read_uint32(journal, p, length) || journal.length() - p < length)
+                    break;
+
+                std::string record(journal, p, length);
+                p += length;
+
+                std::string::size_type q(0);
+                std::string name;
+                if (! read_uint32(record, q, op) || ! read_string(record, q, name))
+                    break;
+
+                if (jo_save == op)
+                {
+                    uint32_t n_pairs;
+                    if (! read_uint32(record, q, n_pairs))
+                        break;
+
+                    EbuildBinaryMetadataCache::Entry entry;
+                    std::string k, v;
+                    for ( ; n_pairs > 0 ; --n_pairs)
+                    {
+                        if (! read_string(record, q, k) || ! read_string(record, q, v))
+                            break;
+                        entry.push_back(std::make_pair(k, v));
+                    }
+                    if (0 != n_pairs)
+                        break;
+
+                    removed.erase(name);
+                    saved[name] = entry;
+                }
+                else if (jo_remove == op)
+                {
+                    saved.erase(name);
+                    removed.insert(name);
+                }
+                else
+                    break;
+
+                ++journal_records;
+            }
+
+            if (0 != journal_records)
+                dirty = true;
+        }
+
+        void need_loaded() const
+        {
+            if (loaded)
+                return;
+
+            loaded = true;
+            mapping = map_file(filename);
+            replay_journal();
+
+            /* once the journal has grown to a fair fraction of the file,
+             * fold it in, so that we aren't parsing it every time */
+            if (journal_records > std::max(64u, mapping->n_entries / 4))
+                write(ll_debug);
+        }
+
+        void append_journal(const std::string & record) const
+        {
+            if (-1 == journal_fd)
+            {
+                journal_fd = ::open(stringify(journal_filename).c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+                if (-1 == journal_fd)
+                {
+                    Log::get_instance()->message("e.cache.binary.save.failure", ll_warning, lc_no_context)
+                        << "Couldn't open '" << journal_filename << "' for appending: " << std::strerror(errno);
+                    return;
+                }
+            }
+
+            std::string data;
+            append_uint32(data, record.length());
+            data.append(record);
+
+            /* a single write, so that other processes appending at the same
+             * time don't interleave with us */
+            if (static_cast<ssize_t>(data.length()) != ::write(journal_fd, data.data(), data.length()))
+                Log::get_instance()->message("e.cache.binary.save.failure", ll_warning, lc_no_context)
+                    << "Couldn't append to '" << journal_filename << "': " << std::strerror(errno);
+            else
+                ++journal_records;
+        }
+
+        void write(const LogLevel failure_log_level) const
+        {
+            if (! dirty)
+                return;
+
+            Context context("When writing binary metadata cache '" + stringify(filename) + "':");
+
+            if (! filename.dirname().stat().is_directory_or_symlink_to_directory())
+            {
+                Log::get_instance()->message("e.cache.binary.save.no_dir", ll_warning, lc_no_context) << "Directory '"
+                    << filename.dirname() << "' does not exist, so cannot save binary metadata cache '" << filename << "' "
+                    << "(see the faq for why this directory will not be created automatically)";
+                dirty = false;
+                return;
+            }
+
+            /* everything in the file, less anything that has been removed or
+             * replaced, plus everything new, in name order */
+            std::map<std::string, EbuildBinaryMetadataCache::Entry> entries;
+            for (const EntryRecord * e(mapping->entries), * e_end(mapping->entries + mapping->n_entries) ; e != e_end ; ++e)
+            {
+                std::string name(mapping->string_at(e->name));
+                if (removed.end() == removed.find(name))
+                    entries.insert(std::make_pair(name, mapping->entry(*e)));
+            }
+
+            for (const auto & s : saved)
+                entries[s.first] = s.second;
+
+            StringInterner strings;
+            std::vector<EntryRecord> entry_records;
+            std::vector<PairRecord> pair_records;
+            for (const auto & e : entries)
+            {
+                EntryRecord r;
+                r.name = strings.intern(e.first);
+                r.first_pair = pair_records.size();
+                r.n_pairs = e.second.size();
+                entry_records.push_back(r);
+
+                for (const auto & kv : e.second)
+                {
+                    PairRecord p;
+                    p.key = strings.intern(kv.first);
+                    p.value = strings.intern(kv.second);
+                    pair_records.push_back(p);
+                }
+            }
+
+            Header h;
+            std::memcpy(h.magic, magic, sizeof(magic));
+            h.version = format_version;
+            h.byte_order = byte_order_mark;
+            h.n_strings = strings.records.size();
+            h.n_entries = entry_records.size();
+            h.n_pairs = pair_records.size();
+            h.text_size = strings.text.length();
+
+            /* write to a new file and rename it over the old one, so that
+             * anyone who has the old one mapped carries on seeing a
+             * consistent file */
+            FSPath tmp(filename.dirname() / (filename.basename() + ".new." + stringify(::getpid())));
+            try
+            {
+                {
+                    std::string data(reinterpret_cast<const char *>(&h), sizeof(h));
+                    append_records(data, strings.records);
+                    append_records(data, entry_records);
+                    append_records(data, pair_records);
+                    data.append(strings.text);
+
+                    SafeOFStream s(tmp, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, true);
+                    s << data;
+                }
+
+                tmp.rename(filename);
+
+                if (-1 != journal_fd)
+                {
+                    ::close(journal_fd);
+                    journal_fd = -1;
+                }
+
+                if (journal_filename.stat().exists())
+                    journal_filename.unlink();
+            }
+            catch (const Exception & e)
+            {
+                Log::get_instance()->message("e.cache.binary.save.failure", failure_log_level, lc_no_context)
+                    << "Couldn't write binary metadata cache to '" << filename << "': " << e.message() << " (" << e.what() << ")";
+
+                if (tmp.stat().exists())
+                    tmp.unlink();
+                return;
+            }
+
+            mapping = map_file(filename);
+            saved.clear();
+            removed.clear();
+            journal_records = 0;
+            dirty = false;
+        }
+    };
+}
+
+EbuildBinaryMetadataCache::EbuildBinaryMetadataCache(const FSPath & f) :
+    _imp(f)
+{
+}
+
+EbuildBinaryMetadataCache::~EbuildBinaryMetadataCache()
+{
+    try
+    {
+        write();
+    }
+    catch (const Exception & e)
+    {
+        Log::get_instance()->message("e.cache.binary.save.failure", ll_warning, lc_no_context)
+            << "Couldn't write binary metadata cache to '" << _imp->filename << "': " << e.message() << " (" << e.what() << ")";
+    }
+}
+
+const FSPath
+EbuildBinaryMetadataCache::filename() const
+{
+    return _imp->filename;
+}
+
+const FSStat &
+EbuildBinaryMetadataCache::filename_stat() const
+{
+    return _imp->filename_stat;
+}
+
+bool
+EbuildBinaryMetadataCache::load(const std::string & name, std::map<std::string, std::string> & keys) const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    auto s(_imp->saved.find(name));
+    if (_imp->saved.end() != s)
+    {
+        keys.insert(s->second.begin(), s->second.end());
+        return true;
+    }
+
+    if (_imp->removed.end() != _imp->removed.find(name))
+        return false;
+
+    const Mapping & m(*_imp->mapping);
+    const EntryRecord * e(m.find(name));
+    if (! e)
+        return false;
+
+    if (e->first_pair > m.n_pairs || e->n_pairs > m.n_pairs - e->first_pair)
+        return false;
+
+    for (const PairRecord * p(m.pairs + e->first_pair), * p_end(p + e->n_pairs) ; p != p_end ; ++p)
+        keys.insert(std::make_pair(m.string_at(p->key), m.string_at(p->value)));
+
+    return true;
+}
+
+void
+EbuildBinaryMetadataCache::save(const std::string & name, const Entry & entry)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    _imp->removed.erase(name);
+    _imp->saved[name] = entry;
+    _imp->dirty = true;
+
+    std::string record;
+    append_uint32(record, jo_save);
+    append_string(record, name);
+    append_uint32(record, entry.size());
+    for (const auto & kv : entry)
+    {
+        append_string(record, kv.first);
+        append_string(record, kv.second);
+    }
+    _imp->append_journal(record);
+}
+
+void
+EbuildBinaryMetadataCache::remove(const std::string & name)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    bool had_entry(0 != _imp->saved.erase(name));
+    if (_imp->removed.insert(name).second && _imp->mapping->find(name))
+        had_entry = true;
+
+    if (! had_entry)
+        return;
+
+    _imp->dirty = true;
+
+    std::string record;
+    append_uint32(record, jo_remove);
+    append_string(record, name);
+    _imp->append_journal(record);
+}
+
+std::vector<std::string>
+EbuildBinaryMetadataCache::names() const
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->need_loaded();
+
+    std::set<std::string> result;
+    const Mapping & m(*_imp->mapping);
+    for (const EntryRecord * e(m.entries), * e_end(m.entries + m.n_entries) ; e != e_end ; ++e)
+        result.insert(m.string_at(e->name));
+
+    for (const auto & r : _imp->removed)
+        result.erase(r);
+
+    for (const auto & s : _imp->saved)
+        result.insert(s.first);
+
+    return std::vector<std::string>(result.begin(), result.end());
+}
+
+void
+EbuildBinaryMetadataCache::write()
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    if (_imp->loaded)
+        _imp->write(ll_warning);
+}
+
+namespace paludis
+{
+    template class Pimp<EbuildBinaryMetadataCache>;
+}
@@ -0,0 +1,124 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_EBUILD_BINARY_METADATA_CACHE_HH
+#define PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_EBUILD_BINARY_METADATA_CACHE_HH 1
+
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_stat-fwd.hh>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace paludis
+{
+    namespace erepository
+    {
+        /**
+         * A single file holding the metadata cache entries for every ID in
+         * a repository.
+         *
+         * Each entry is the same set of keys and values that would be
+         * written to a flat_hash cache file, including the validation keys
+         * (_mtime_, _md5_, _eclasses_, _exlibs_ and _guessed_eapi_), so the
+         * rules for deciding whether an entry is stale are shared with
+         * EbuildFlatMetadataCache.
+         *
+         * The file is memory mapped the first time an entry is needed, and
+         * entries are found by a binary search of a sorted index, so loading
+         * an entry does not involve opening any files. Every string in the
+         * file is stored only once, which keeps dependency strings and
+         * eclass lists that are common to many IDs from bloating it.
+         *
+         * Entries that are stored or removed are appended to a journal file
+         * next to the cache file, which is replayed when the cache is
+         * loaded. The journal is folded into a rewritten cache file when it
+         * gets large, when the cache is destroyed, or when write() is called
+         * (which ERepository does when it is asked to regenerate its
+         * caches).
+         *
+         * \see EbuildFlatMetadataCache
+         * \ingroup grperepository
+         * \nosubgrouping
+         */
+        class EbuildBinaryMetadataCache
+        {
+            private:
+                Pimp<EbuildBinaryMetadataCache> _imp;
+
+            public:
+                typedef std::vector<std::pair<std::string, std::string> > Entry;
+
+                ///\name Basic operations
+                ///\{
+
+                explicit EbuildBinaryMetadataCache(const FSPath & filename);
+                ~EbuildBinaryMetadataCache();
+
+                EbuildBinaryMetadataCache(const EbuildBinaryMetadataCache &) = delete;
+                EbuildBinaryMetadataCache & operator= (const EbuildBinaryMetadataCache &) = delete;
+
+                ///\}
+
+                const FSPath filename() const;
+
+                /**
+                 * The result of calling stat on our file, as it was when we
+                 * were created.
+                 */
+                const FSStat & filename_stat() const;
+
+                ///\name Cache operations
+                ///\{
+
+                /**
+                 * Find the entry for an ID (identified as cat/pkg-ver),
+                 * putting its keys into the supplied map.
+                 */
+                bool load(const std::string & name, std::map<std::string, std::string> & keys) const;
+
+                /**
+                 * Replace the entry for an ID.
+                 */
+                void save(const std::string & name, const Entry & entry);
+
+                /**
+                 * Remove the entry for an ID.
+                 */
+                void remove(const std::string & name);
+
+                /**
+                 * The names of every ID that has an entry.
+                 */
+                std::vector<std::string> names() const;
+
+                /**
+                 * Write out the file, if anything has changed.
+                 */
+                void write();
+
+                ///\}
+        };
+    }
+
+    extern template class Pimp<erepository::EbuildBinaryMetadataCache>;
+}
+
+#endif
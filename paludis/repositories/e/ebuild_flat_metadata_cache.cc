@@ -70,6 +70,9 @@ namespace paludis
         std::shared_ptr<const EclassMtimes> eclass_mtimes;
         bool silent;
 
+        const std::shared_ptr<EbuildBinaryMetadataCache> binary_cache;
+        const std::string entry_name;
+
         Imp(const Environment * const e, const FSPath & f, const FSPath & eb,
                 std::time_t m, const std::shared_ptr<const EclassMtimes> em, bool s) :
             env(e),
@@ -82,6 +85,29 @@ namespace paludis
             silent(s)
         {
         }
+
+        Imp(const Environment * const e, const std::shared_ptr<EbuildBinaryMetadataCache> & b, const std::string & n,
+                const FSPath & eb, std::time_t m, const std::shared_ptr<const EclassMtimes> em, bool s) :
+            env(e),
+            filename(b->filename()),
+            filename_stat(b->filename_stat()),
+            ebuild(eb),
+            ebuild_stat(ebuild.stat()),
+            master_mtime(m),
+            eclass_mtimes(em),
+            silent(s),
+            binary_cache(b),
+            entry_name(n)
+        {
+        }
+
+        std::string description() const
+        {
+            if (binary_cache)
+                return "entry '" + entry_name + "' in '" + stringify(filename) + "'";
+            else
+                return "file at '" + stringify(filename) + "'";
+        }
     };
 }
 
@@ -303,63 +329,12 @@ namespace
     }
 }
 
-EbuildFlatMetadataCache::EbuildFlatMetadataCache(const Environment * const v, const FSPath & f,
-        const FSPath & e, std::time_t t, const std::shared_ptr<const EclassMtimes> & m, bool s) :
-    _imp(v, f, e, t, m, s)
-{
-}
-
-EbuildFlatMetadataCache::~EbuildFlatMetadataCache() = default;
-
-bool
-EbuildFlatMetadataCache::load(const std::shared_ptr<const EbuildID> & id, const bool silent_on_stale)
+namespace
 {
-    using namespace std::placeholders;
-
-    Context context("When loading version metadata from '" + stringify(_imp->filename) + "':");
-
-    if (! _imp->filename_stat.exists())
-    {
-        Log::get_instance()->message("e.cache.failure", _imp->silent ? ll_debug : ll_warning, lc_no_context)
-                << "Couldn't use the cache file at '" << _imp->filename << "': " << std::strerror(errno);
-        return false;
-    }
-
-    SafeIFStream cache(_imp->filename);
-
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(cache, line))
-        lines.push_back(line);
-
-    try
+    bool load_flat_hash(
+        const std::shared_ptr<const EbuildID> & id, std::map<std::string, std::string> & keys,
+        const bool silent_on_stale, Imp<EbuildFlatMetadataCache> * _imp)
     {
-        std::map<std::string, std::string> keys;
-        std::string duplicate;
-        for (std::vector<std::string>::const_iterator it(lines.begin()),
-                 it_end(lines.end()); it_end != it; ++it)
-        {
-            std::string::size_type equals(it->find('='));
-            if (std::string::npos == equals)
-            {
-                Log::get_instance()->message("e.cache.flat_hash.not", ll_debug, lc_context)
-                    << "cache file lacks = on line " << ((it - lines.begin()) + 1) << ", assuming flat_list";
-                return load_flat_list(id, lines, _imp.get());
-            }
-
-            if (! keys.insert(std::make_pair(it->substr(0, equals), it->substr(equals + 1))).second)
-                duplicate = it->substr(0, equals);
-        }
-
-        Context ctx("When loading flat_hash format cache file:");
-
-        if (! duplicate.empty())
-        {
-            Log::get_instance()->message("e.cache.flat_hash.broken", ll_warning, lc_context)
-                << "cache file contains duplicate key '" << duplicate << "'";
-            return false;
-        }
-
         std::map<std::string, std::string>::const_iterator eapi(keys.find("EAPI"));
         if (keys.end() == eapi)
             id->set_eapi("0");
@@ -559,7 +534,7 @@ EbuildFlatMetadataCache::load(const std::shared_ptr<const EbuildID> & id, const
                 {
                     if (! silent_on_stale)
                         Log::get_instance()->message("e.cache.stale", ll_warning, lc_no_context)
-                            << "Stale cache file at '" << _imp->filename << "'";
+                            << "Stale cache " << _imp->description();
                     return false;
                 }
             }
@@ -684,21 +659,106 @@ EbuildFlatMetadataCache::load(const std::shared_ptr<const EbuildID> & id, const
         Log::get_instance()->message("e.cache.success", ll_debug, lc_context) << "Successfully loaded cache file";
         return true;
     }
+}
+
+EbuildFlatMetadataCache::EbuildFlatMetadataCache(const Environment * const v, const FSPath & f,
+        const FSPath & e, std::time_t t, const std::shared_ptr<const EclassMtimes> & m, bool s) :
+    _imp(v, f, e, t, m, s)
+{
+}
+
+EbuildFlatMetadataCache::EbuildFlatMetadataCache(const Environment * const v, const std::shared_ptr<EbuildBinaryMetadataCache> & b,
+        const std::string & n, const FSPath & e, std::time_t t, const std::shared_ptr<const EclassMtimes> & m, bool s) :
+    _imp(v, b, n, e, t, m, s)
+{
+}
+
+EbuildFlatMetadataCache::~EbuildFlatMetadataCache() = default;
+
+bool
+EbuildFlatMetadataCache::load(const std::shared_ptr<const EbuildID> & id, const bool silent_on_stale)
+{
+    using namespace std::placeholders;
+
+    Context context(_imp->binary_cache ?
+            "When loading version metadata for '" + _imp->entry_name + "' from '" + stringify(_imp->filename) + "':" :
+            "When loading version metadata from '" + stringify(_imp->filename) + "':");
+
+    std::map<std::string, std::string> keys;
+    std::vector<std::string> lines;
+
+    if (_imp->binary_cache)
+    {
+        if (! _imp->binary_cache->load(_imp->entry_name, keys))
+        {
+            Log::get_instance()->message("e.cache.failure", _imp->silent ? ll_debug : ll_warning, lc_no_context)
+                    << "Couldn't find an entry for '" << _imp->entry_name << "' in the cache file at '" << _imp->filename << "'";
+            return false;
+        }
+    }
+    else
+    {
+        if (! _imp->filename_stat.exists())
+        {
+            Log::get_instance()->message("e.cache.failure", _imp->silent ? ll_debug : ll_warning, lc_no_context)
+                    << "Couldn't use the cache file at '" << _imp->filename << "': " << std::strerror(errno);
+            return false;
+        }
+
+        SafeIFStream cache(_imp->filename);
+
+        std::string line;
+        while (std::getline(cache, line))
+            lines.push_back(line);
+    }
+
+    try
+    {
+        if (! _imp->binary_cache)
+        {
+            std::string duplicate;
+            for (std::vector<std::string>::const_iterator it(lines.begin()),
+                     it_end(lines.end()); it_end != it; ++it)
+            {
+                std::string::size_type equals(it->find('='));
+                if (std::string::npos == equals)
+                {
+                    Log::get_instance()->message("e.cache.flat_hash.not", ll_debug, lc_context)
+                        << "cache file lacks = on line " << ((it - lines.begin()) + 1) << ", assuming flat_list";
+                    return load_flat_list(id, lines, _imp.get());
+                }
+
+                if (! keys.insert(std::make_pair(it->substr(0, equals), it->substr(equals + 1))).second)
+                    duplicate = it->substr(0, equals);
+            }
+
+            if (! duplicate.empty())
+            {
+                Log::get_instance()->message("e.cache.flat_hash.broken", ll_warning, lc_context)
+                    << "cache file contains duplicate key '" << duplicate << "'";
+                return false;
+            }
+        }
+
+        Context ctx(_imp->binary_cache ? "When loading binary format cache entry:" : "When loading flat_hash format cache file:");
+
+        return load_flat_hash(id, keys, silent_on_stale, _imp.get());
+    }
     catch (const InternalError &)
     {
         throw;
     }
     catch (const DestringifyError & e)
     {
-        Log::get_instance()->message("e.cache.failure", ll_warning, lc_no_context) << "Not using cache file at '"
-            << _imp->filename << "' due to destringify exception '" << e.message() << "' (" << e.what() << ")";
+        Log::get_instance()->message("e.cache.failure", ll_warning, lc_no_context) << "Not using cache " << _imp->description()
+            << " due to destringify exception '" << e.message() << "' (" << e.what() << ")";
 
         return false;
     }
     catch (const Exception & e)
     {
-        Log::get_instance()->message("e.cache.failure", ll_warning, lc_no_context) << "Not using cache file at '"
-            << _imp->filename << "' due to exception '" << e.message() << "' (" << e.what() << ")";
+        Log::get_instance()->message("e.cache.failure", ll_warning, lc_no_context) << "Not using cache " << _imp->description()
+            << " due to exception '" << e.message() << "' (" << e.what() << ")";
 
         id->set_eapi(EAPIData::get_instance()->unknown_eapi()->name());
 
@@ -726,44 +786,49 @@ namespace
     }
 
     template <typename T_>
-    void write_kv(std::ostream & stream, const std::string & key, const T_ & value)
+    void write_kv(EbuildBinaryMetadataCache::Entry & entry, const std::string & key, const T_ & value)
     {
         std::string str_value(stringify(value));
         if (! str_value.empty())
-            stream << key << "=" << str_value << std::endl;
+            entry.push_back(std::make_pair(key, str_value));
     }
 }
 
 void
 EbuildFlatMetadataCache::save(const std::shared_ptr<const EbuildID> & id)
 {
-    Context context("When saving version metadata to '" + stringify(_imp->filename) + "':");
+    Context context(_imp->binary_cache ?
+            "When saving version metadata for '" + _imp->entry_name + "' to '" + stringify(_imp->filename) + "':" :
+            "When saving version metadata to '" + stringify(_imp->filename) + "':");
 
-    try
+    if (! _imp->binary_cache)
     {
-        FSPath cat_dir(_imp->filename.dirname());
-        FSPath repo_dir(cat_dir.dirname());
-        FSPath main_dir(repo_dir.dirname());
-        FSStat main_dir_stat(main_dir);
+        try
+        {
+            FSPath cat_dir(_imp->filename.dirname());
+            FSPath repo_dir(cat_dir.dirname());
+            FSPath main_dir(repo_dir.dirname());
+            FSStat main_dir_stat(main_dir);
 
-        if (! main_dir_stat.exists())
+            if (! main_dir_stat.exists())
+            {
+                Log::get_instance()->message("e.cache.save.no_dir", ll_warning, lc_no_context) << "Directory '"
+                    << main_dir << "' does not exist, so cannot save cache file '" << _imp->filename << "' "
+                    << "(see the faq for why this directory will not be created automatically)";
+                return;
+            }
+
+            if (repo_dir.mkdir(main_dir_stat.permissions(), { fspmkdo_ok_if_exists }))
+                repo_dir.chmod(main_dir_stat.permissions());
+
+            if (cat_dir.mkdir(main_dir_stat.permissions(), { fspmkdo_ok_if_exists }))
+                cat_dir.chmod(main_dir_stat.permissions());
+        }
+        catch (const FSError & e)
         {
-            Log::get_instance()->message("e.cache.save.no_dir", ll_warning, lc_no_context) << "Directory '"
-                << main_dir << "' does not exist, so cannot save cache file '" << _imp->filename << "' "
-                << "(see the faq for why this directory will not be created automatically)";
+            Log::get_instance()->message("e.cache.save.failure", ll_warning, lc_no_context) << "Couldn't create cache directory: " << e.message();
             return;
         }
-
-        if (repo_dir.mkdir(main_dir_stat.permissions(), { fspmkdo_ok_if_exists }))
-            repo_dir.chmod(main_dir_stat.permissions());
-
-        if (cat_dir.mkdir(main_dir_stat.permissions(), { fspmkdo_ok_if_exists }))
-            cat_dir.chmod(main_dir_stat.permissions());
-    }
-    catch (const FSError & e)
-    {
-        Log::get_instance()->message("e.cache.save.failure", ll_warning, lc_no_context) << "Couldn't create cache directory: " << e.message();
-        return;
     }
 
     if (! id->eapi()->supported())
@@ -773,7 +838,7 @@ EbuildFlatMetadataCache::save(const std::shared_ptr<const EbuildID> & id)
         return;
     }
 
-    std::ostringstream cache;
+    EbuildBinaryMetadataCache::Entry cache;
     write_kv(cache, "_mtime_", _imp->ebuild_stat.mtim().seconds());
     write_kv(cache, "_guessed_eapi_", id->guessed_eapi_name());
 
@@ -934,8 +999,14 @@ EbuildFlatMetadataCache::save(const std::shared_ptr<const EbuildID> & id)
     }
     catch (const Exception & e)
     {
-        Log::get_instance()->message("e.cache.save.failure", ll_warning, lc_no_context) << "Not writing cache file to '"
-            << _imp->filename << "' due to exception '" << e.message() << "' (" << e.what() << ")";
+        Log::get_instance()->message("e.cache.save.failure", ll_warning, lc_no_context) << "Not writing cache "
+            << _imp->description() << " due to exception '" << e.message() << "' (" << e.what() << ")";
+        return;
+    }
+
+    if (_imp->binary_cache)
+    {
+        _imp->binary_cache->save(_imp->entry_name, cache);
         return;
     }
 
@@ -943,7 +1014,8 @@ EbuildFlatMetadataCache::save(const std::shared_ptr<const EbuildID> & id)
     {
         {
             SafeOFStream cache_file(_imp->filename, -1, true);
-            cache_file << cache.str();
+            for (const auto & kv : cache)
+                cache_file << kv.first << "=" << kv.second << "\n";
         }
         _imp->filename.utime(Timestamp(_imp->ebuild_stat.mtim().seconds(), 0));
     }
@@ -23,6 +23,7 @@
 #include <paludis/repositories/e/ebuild.hh>
 #include <paludis/repositories/e/ebuild_id.hh>
 #include <paludis/repositories/e/eclass_mtimes.hh>
+#include <paludis/repositories/e/ebuild_binary_metadata_cache.hh>
 #include <paludis/util/pimp.hh>
 
 namespace paludis
@@ -33,6 +34,10 @@ namespace paludis
          * Implements metadata cache handling for a ERepository using
          * EbuildEntries.
          *
+         * Normally each ID has its own cache file. If we are given an
+         * EbuildBinaryMetadataCache instead, the ID's entry in that is used,
+         * with the same rules for whether it is stale.
+         *
          * \see EbuildEntries
          * \see ERepository
          * \ingroup grperepository
@@ -49,6 +54,9 @@ namespace paludis
 
                 EbuildFlatMetadataCache(const Environment * const, const FSPath & filename, const FSPath & ebuild,
                         time_t master_mtime, const std::shared_ptr<const EclassMtimes> & eclass_mtimes, bool silent);
+                EbuildFlatMetadataCache(const Environment * const, const std::shared_ptr<EbuildBinaryMetadataCache> & binary_cache,
+                        const std::string & entry_name, const FSPath & ebuild,
+                        time_t master_mtime, const std::shared_ptr<const EclassMtimes> & eclass_mtimes, bool silent);
                 ~EbuildFlatMetadataCache();
 
                 ///\}
@@ -74,6 +74,7 @@
 #include <iterator>
 #include <algorithm>
 #include <ctime>
+#include <chrono>
 
 using namespace paludis;
 using namespace paludis::erepository;
@@ -124,6 +125,17 @@ namespace
         return std::make_shared<LiteralMetadataValueKey<FSPath>>(
                 "FS_LOCATION", "FS Location", mkt_internal, p);
     }
+
+    std::shared_ptr<EbuildFlatMetadataCache> make_metadata_cache(
+            const Environment * const env, const std::shared_ptr<EbuildBinaryMetadataCache> & binary_cache,
+            const FSPath & cache_file, const std::string & entry_name, const FSPath & ebuild, std::time_t master_mtime,
+            const std::shared_ptr<const EclassMtimes> & eclass_mtimes, bool silent)
+    {
+        if (binary_cache)
+            return std::make_shared<EbuildFlatMetadataCache>(env, binary_cache, entry_name, ebuild, master_mtime, eclass_mtimes, silent);
+        else
+            return std::make_shared<EbuildFlatMetadataCache>(env, cache_file, ebuild, master_mtime, eclass_mtimes, silent);
+    }
 }
 
 namespace paludis
@@ -232,7 +244,7 @@ EbuildID::need_non_xml_keys_added() const
 
     _imp->has_non_xml_keys = true;
 
-    Context context("When generating metadata for ID '" + canonical_form(idcf_full) + "':");
+    LazyContext context([&] () { return "When generating metadata for ID '" + canonical_form(idcf_full) + "':"; });
 
     add_metadata_key(_imp->fs_location);
 
@@ -248,21 +260,33 @@ EbuildID::need_non_xml_keys_added() const
     write_cache_file /= stringify(name().category());
     write_cache_file /= stringify(name().package()) + "-" + stringify(version());
 
+    std::string cache_entry_name(stringify(name()) + "-" + stringify(version()));
+    auto binary_cache(e_repo->binary_metadata_cache());
+    auto binary_write_cache(e_repo->binary_write_metadata_cache());
+
+    auto phase_start(std::chrono::steady_clock::now());
+    auto end_phase = [&] (const std::string & phase) {
+        auto now(std::chrono::steady_clock::now());
+        _imp->environment->trigger_notifier_callback(NotifierCallbackMetadataPhaseEvent(repository_name(), phase, now - phase_start));
+        phase_start = now;
+    };
+
     bool ok(false);
     if (e_repo->params().cache().basename() != "empty")
     {
-        EbuildFlatMetadataCache metadata_cache(_imp->environment, cache_file, _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, false);
-        if (metadata_cache.load(shared_from_this(), false))
+        auto metadata_cache(make_metadata_cache(_imp->environment, binary_cache, cache_file, cache_entry_name,
+                    _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, false));
+        if (metadata_cache->load(shared_from_this(), false))
             ok = true;
     }
 
     if ((! ok) && e_repo->params().write_cache().basename() != "empty")
     {
-        EbuildFlatMetadataCache write_metadata_cache(_imp->environment,
-                write_cache_file, _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, true);
-        if (write_metadata_cache.load(shared_from_this(), false))
+        auto write_metadata_cache(make_metadata_cache(_imp->environment, binary_write_cache, write_cache_file, cache_entry_name,
+                    _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, true));
+        if (write_metadata_cache->load(shared_from_this(), false))
             ok = true;
-        else if (write_cache_file.stat().exists())
+        else if ((! binary_write_cache) && write_cache_file.stat().exists())
         {
             try
             {
@@ -276,6 +300,9 @@ EbuildID::need_non_xml_keys_added() const
         }
     }
 
+    if (e_repo->params().cache().basename() != "empty" || e_repo->params().write_cache().basename() != "empty")
+        end_phase("cache validate");
+
     if (! ok)
     {
         if (e_repo->params().cache().basename() != "empty")
@@ -329,15 +356,17 @@ EbuildID::need_non_xml_keys_added() const
                     stringify(canonical_form(idcf_full)) << "'";
 
             cmd.load(shared_from_this());
+            end_phase("generate");
 
             Log::get_instance()->message("e.ebuild.metadata.generated_eapi", ll_debug, lc_context) << "Generated metadata for '"
                 << canonical_form(idcf_full) << "' has EAPI '" << _imp->eapi->name() << "'";
 
             if (e_repo->params().write_cache().basename() != "empty" && _imp->eapi->supported())
             {
-                EbuildFlatMetadataCache metadata_cache(_imp->environment, write_cache_file, _imp->fs_location->parse_value(), _imp->master_mtime,
-                        _imp->eclass_mtimes, false);
-                metadata_cache.save(shared_from_this());
+                auto metadata_cache(make_metadata_cache(_imp->environment, binary_write_cache, write_cache_file, cache_entry_name,
+                            _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, false));
+                metadata_cache->save(shared_from_this());
+                end_phase("cache write");
             }
         }
         else
@@ -429,7 +458,7 @@ EbuildID::presource_eapi() const
     if (_imp->eapi_from_suffix || ! guessed->supported())
         return guessed;
 
-    Context ctx("When parsing EAPI from '" + stringify(_imp->fs_location->parse_value()) + "':");
+    LazyContext ctx([&] () { return "When parsing EAPI from '" + stringify(_imp->fs_location->parse_value()) + "':"; });
 
     std::string eapi_assign(guessed->supported()->ebuild_metadata_variables()->eapi()->name());
     eapi_assign += '=';
@@ -499,7 +528,7 @@ EbuildID::need_xml_keys_added() const
 
     _imp->has_xml_keys = true;
 
-    Context context("When generating XML-related metadata for ID '" + canonical_form(idcf_full) + "':");
+    LazyContext context([&] () { return "When generating XML-related metadata for ID '" + canonical_form(idcf_full) + "':"; });
 
     need_non_xml_keys_added();
 
@@ -618,7 +647,7 @@ EbuildID::need_masks_added() const
 
     _imp->has_masks = true;
 
-    Context context("When generating masks for ID '" + canonical_form(idcf_full) + "':");
+    LazyContext context([&] () { return "When generating masks for ID '" + canonical_form(idcf_full) + "':"; });
 
     if (! eapi()->supported())
     {
@@ -1689,7 +1718,15 @@ EbuildID::purge_invalid_cache() const
     write_cache_file /= stringify(name().category());
     write_cache_file /= stringify(name().package()) + "-" + stringify(version());
 
-    if (write_cache_file.stat().exists())
+    if (auto binary_write_cache = e_repo->binary_write_metadata_cache())
+    {
+        std::string cache_entry_name(stringify(name()) + "-" + stringify(version()));
+        EbuildFlatMetadataCache write_metadata_cache(_imp->environment,
+                binary_write_cache, cache_entry_name, _imp->fs_location->parse_value(), _imp->master_mtime, _imp->eclass_mtimes, true);
+        if (! write_metadata_cache.load(shared_from_this(), true))
+            binary_write_cache->remove(cache_entry_name);
+    }
+    else if (write_cache_file.stat().exists())
     {
         if (e_repo->params().write_cache().basename() != "empty")
         {
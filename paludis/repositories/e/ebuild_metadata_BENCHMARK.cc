@@ -0,0 +1,106 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/e_repository.hh>
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/util/map.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/indirect_iterator-impl.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/sequence.hh>
+
+#include <paludis/package_id.hh>
+#include <paludis/metadata_key.hh>
+#include <paludis/generator.hh>
+#include <paludis/filtered_generator.hh>
+#include <paludis/selection.hh>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace paludis;
+
+namespace
+{
+    std::string from_keys(const std::shared_ptr<const Map<std::string, std::string> > & m,
+            const std::string & k)
+    {
+        Map<std::string, std::string>::ConstIterator mm(m->find(k));
+        if (m->end() == mm)
+            return "";
+        else
+            return mm->second;
+    }
+
+    /* generate metadata for every ebuild in the benchmark repository,
+     * returning the mean per-ebuild time in microseconds */
+    double generate_all(const std::string & workers)
+    {
+        if (workers.empty())
+            ::unsetenv("PALUDIS_METADATA_WORKERS");
+        else
+            ::setenv("PALUDIS_METADATA_WORKERS", workers.c_str(), 1);
+
+        TestEnvironment env;
+        std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+        keys->insert("format", "e");
+        keys->insert("names_cache", "/var/empty");
+        keys->insert("write_cache", "/var/empty");
+        keys->insert("location", stringify(FSPath::cwd() / "ebuild_metadata_BENCHMARK_dir" / "repo"));
+        keys->insert("profiles", stringify(FSPath::cwd() / "ebuild_metadata_BENCHMARK_dir" / "repo/profiles/profile"));
+        keys->insert("builddir", stringify(FSPath::cwd() / "ebuild_metadata_BENCHMARK_dir" / "build"));
+        std::shared_ptr<Repository> repo(ERepository::repository_factory_create(&env,
+                    std::bind(from_keys, keys, std::placeholders::_1)));
+        env.add_repository(1, repo);
+        ::unsetenv("PALUDIS_METADATA_WORKERS");
+
+        std::shared_ptr<const PackageIDSequence> ids(env[selection::AllVersionsUnsorted(generator::All())]);
+
+        auto start(std::chrono::steady_clock::now());
+        unsigned count(0);
+        for (const auto & id : *ids)
+        {
+            if ((! id->short_description_key()) || id->short_description_key()->parse_value().empty())
+                throw InternalError(PALUDIS_HERE, "no description for " + stringify(*id));
+            ++count;
+        }
+        auto taken(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+
+        if (0 == count)
+            throw InternalError(PALUDIS_HERE, "no ebuilds found");
+
+        return double(taken.count()) / count;
+    }
+}
+
+int main(int, char *[])
+{
+    double fork_per_entry(generate_all(""));
+    double worker_per_entry(generate_all("1"));
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "metadata generation, one process per ebuild: " << fork_per_entry << "us per ebuild" << std::endl
+        << "metadata generation, persistent workers:     " << worker_per_entry << "us per ebuild" << std::endl
+        << "speedup: " << std::setprecision(2) << (fork_per_entry / worker_per_entry) << "x" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,8 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+if [ -d ebuild_metadata_BENCHMARK_dir ] ; then
+    rm -fr ebuild_metadata_BENCHMARK_dir
+else
+    true
+fi
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir ebuild_metadata_BENCHMARK_dir || exit 1
+cd ebuild_metadata_BENCHMARK_dir || exit 1
+
+mkdir -p build
+mkdir -p repo/{eclass,profiles/profile,cat-one} || exit 1
+cd repo || exit 1
+echo "benchmark-repo" > profiles/repo_name || exit 1
+echo "cat-one" > profiles/categories || exit 1
+cat <<END > profiles/profile/make.defaults
+ARCH=test
+END
+
+cat <<"END" > eclass/bench-base.eclass
+DEPEND="bench/base-dep"
+
+bench-base_src_compile() {
+    echo "compiling"
+}
+
+EXPORT_FUNCTIONS src_compile
+END
+
+cat <<"END" > eclass/bench-extra.eclass
+inherit bench-base
+RDEPEND="bench/extra-dep"
+IUSE="extra"
+END
+
+for p in $(seq 1 200) ; do
+    mkdir -p cat-one/pkg${p} || exit 1
+    cat <<END > cat-one/pkg${p}/pkg${p}-1.ebuild || exit 1
+EAPI=5
+inherit bench-extra
+
+DESCRIPTION="Benchmark package ${p}"
+HOMEPAGE="https://example.org/"
+SRC_URI="https://example.org/pkg${p}-1.tar.bz2"
+SLOT="0"
+IUSE="foo bar"
+LICENSE="GPL-2"
+KEYWORDS="test"
+DEPEND="foo? ( cat-one/pkg1 )"
+END
+done
+cd ..
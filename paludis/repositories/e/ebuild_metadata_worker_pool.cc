@@ -0,0 +1,377 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/ebuild_metadata_worker_pool.hh>
+
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/destringify.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/env_var_names.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/safe_ifstream.hh>
+
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+namespace
+{
+    std::string quote(const std::string & s)
+    {
+        std::string result("'");
+        for (char c : s)
+            if ('\'' == c)
+                result.append("'\\''");
+            else
+                result.append(1, c);
+        result.append("'");
+        return result;
+    }
+
+    std::vector<std::string> split_pipe_command(const std::string & s)
+    {
+        std::vector<std::string> tokens;
+        std::string::size_type b(0), p(s.find('\2'));
+        while (std::string::npos != p)
+        {
+            tokens.push_back(s.substr(b, p - b));
+            b = p + 1;
+            p = s.find('\2', b);
+        }
+        return tokens;
+    }
+
+    std::string read_file(const FSPath & f)
+    {
+        SafeIFStream s(f);
+        return std::string((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+    }
+
+    struct Job
+    {
+        const std::string request;
+        const ProcessPipeCommandFunction pipe_command_handler;
+
+        bool taken;
+        bool done;
+
+        int exit_status;
+        std::string metadata;
+        std::string captured_stdout;
+        std::string captured_stderr;
+
+        Job(const std::string & r, const ProcessPipeCommandFunction & h) :
+            request(r),
+            pipe_command_handler(h),
+            taken(false),
+            done(false),
+            exit_status(-1)
+        {
+        }
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        Job * job;
+        bool quit;
+        bool dead;
+
+        std::stringstream captured_stdout;
+        std::stringstream captured_stderr;
+
+        std::thread reaper;
+
+        Worker() :
+            job(nullptr),
+            quit(false),
+            dead(false)
+        {
+        }
+
+        ~Worker()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                quit = true;
+                condition.notify_all();
+            }
+
+            if (reaper.joinable())
+                reaper.join();
+        }
+
+        std::string handle_pipe_command(const std::string & s)
+        {
+            std::vector<std::string> tokens(split_pipe_command(s));
+
+            if ((! tokens.empty()) && tokens[0] == "METADATA_WORKER_NEXT")
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (! quit && ! (job && ! job->taken))
+                    condition.wait(lock);
+
+                if (quit)
+                    return "O";
+
+                job->taken = true;
+                return "O" + job->request;
+            }
+            else if ((! tokens.empty()) && tokens[0] == "METADATA_WORKER_DONE")
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (tokens.size() != 4 || ! job)
+                {
+                    Log::get_instance()->message("e.ebuild.metadata_worker.bad_done", ll_warning, lc_context)
+                        << "Got bad METADATA_WORKER_DONE pipe command";
+                    return "Ebad METADATA_WORKER_DONE command";
+                }
+
+                /* the worker leaves the output of the job in files, rather
+                 * than sending it over the pipe, so that it doesn't have to
+                 * be escaped */
+                try
+                {
+                    FSPath dir(tokens[3]);
+                    job->exit_status = destringify<int>(tokens[2]);
+                    job->metadata = read_file(dir / "metadata");
+                    job->captured_stdout = read_file(dir / "stdout");
+                    job->captured_stderr = read_file(dir / "stderr");
+                }
+                catch (const Exception & e)
+                {
+                    job->exit_status = 1;
+                    job->captured_stderr = "couldn't read metadata worker output: " + e.message() + " (" + e.what() + ")";
+                }
+                job->done = true;
+                job = nullptr;
+                condition.notify_all();
+                return "O";
+            }
+            else
+            {
+                ProcessPipeCommandFunction handler;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (job)
+                        handler = job->pipe_command_handler;
+                }
+
+                if (! handler)
+                    return "Egot pipe command '" + s + "' with no active metadata job";
+
+                return handler(s);
+            }
+        }
+
+        void wait_for(RunningProcessHandle & handle)
+        {
+            int exit_status(handle.wait());
+
+            std::unique_lock<std::mutex> lock(mutex);
+            dead = true;
+            condition.notify_all();
+
+            if (0 != exit_status)
+                Log::get_instance()->message("e.ebuild.metadata_worker.exited", ll_debug, lc_no_context)
+                    << "Metadata worker exited with status " << exit_status << ", stderr says '"
+                    << captured_stderr.str() << "'";
+        }
+    };
+
+    struct Slot
+    {
+        std::list<std::shared_ptr<Worker> > idle;
+        unsigned started;
+
+        Slot() :
+            started(0)
+        {
+        }
+    };
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<EbuildMetadataWorkerPool>
+    {
+        const unsigned max_workers_per_key;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::map<std::string, Slot> slots;
+
+        Imp(const unsigned m) :
+            max_workers_per_key(m)
+        {
+        }
+    };
+}
+
+EbuildMetadataWorkerPool::EbuildMetadataWorkerPool(const unsigned m) :
+    _imp(m)
+{
+}
+
+EbuildMetadataWorkerPool::~EbuildMetadataWorkerPool() = default;
+
+unsigned
+EbuildMetadataWorkerPool::max_workers_per_key_from_environment()
+{
+    std::string s(getenv_with_default(env_vars::metadata_workers, ""));
+    if (s.empty())
+        return 0;
+
+    try
+    {
+        return destringify<unsigned>(s);
+    }
+    catch (const DestringifyError &)
+    {
+        Log::get_instance()->message("e.ebuild.metadata_worker.bad_env", ll_warning, lc_context)
+            << "Ignoring bad value '" << s << "' for " << env_vars::metadata_workers;
+        return 0;
+    }
+}
+
+EbuildMetadataWorkerResult
+EbuildMetadataWorkerPool::run(
+        const std::string & key,
+        Process & process,
+        const std::string & ebuild_file,
+        const std::string & commands,
+        const ProcessPipeCommandFunction & pipe_command_handler)
+{
+    std::string request;
+    for (const auto & e : process.setenvs())
+        request.append("export " + e.first + "=" + quote(e.second) + "\n");
+    request.append("PALUDIS_METADATA_WORKER_EBUILD=" + quote(ebuild_file) + "\n");
+    request.append("PALUDIS_METADATA_WORKER_COMMANDS=" + quote(commands) + "\n");
+
+    Job job(request, pipe_command_handler);
+
+    std::shared_ptr<Worker> worker;
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        Slot & slot(_imp->slots[key]);
+        while (slot.idle.empty() && slot.started >= _imp->max_workers_per_key)
+            _imp->condition.wait(lock);
+
+        if (! slot.idle.empty())
+        {
+            worker = slot.idle.front();
+            slot.idle.pop_front();
+        }
+        else
+            ++slot.started;
+    }
+
+    if (! worker)
+    {
+        Log::get_instance()->message("e.ebuild.metadata_worker.starting", ll_debug, lc_context)
+            << "Starting a new metadata worker for '" << key << "'";
+
+        try
+        {
+            worker = std::make_shared<Worker>();
+
+            /* a new worker talks to us before it asks for work, so it must
+             * already have somewhere to send its pipe commands */
+            worker->job = &job;
+
+            using namespace std::placeholders;
+            process
+                .setenv("PALUDIS_METADATA_WORKER", "yes")
+                .pipe_command_handler("PALUDIS_PIPE_COMMAND", std::bind(&Worker::handle_pipe_command, worker.get(), _1))
+                .capture_stdout(worker->captured_stdout)
+                .capture_stderr(worker->captured_stderr);
+
+            /* the reaper owns the handle, so that the worker's output
+             * threads live for exactly as long as the worker does */
+            auto handle(std::make_shared<RunningProcessHandle>(process.run()));
+            worker->reaper = std::thread([w = worker.get(), handle] () { w->wait_for(*handle); });
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(_imp->mutex);
+            --_imp->slots[key].started;
+            _imp->condition.notify_all();
+            throw;
+        }
+    }
+
+    bool worker_died(false);
+    {
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        worker->job = &job;
+        worker->condition.notify_all();
+
+        while (! job.done && ! worker->dead)
+            worker->condition.wait(lock);
+
+        if (! job.done)
+        {
+            worker->job = nullptr;
+            worker_died = true;
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        if (worker_died)
+            --_imp->slots[key].started;
+        else
+            _imp->slots[key].idle.push_back(worker);
+        _imp->condition.notify_all();
+    }
+
+    if (worker_died)
+        return make_named_values<EbuildMetadataWorkerResult>(
+                n::captured_stderr() = "metadata worker exited unexpectedly: " + worker->captured_stderr.str(),
+                n::captured_stdout() = worker->captured_stdout.str(),
+                n::exit_status() = 1,
+                n::metadata() = ""
+                );
+
+    return make_named_values<EbuildMetadataWorkerResult>(
+            n::captured_stderr() = job.captured_stderr,
+            n::captured_stdout() = job.captured_stdout,
+            n::exit_status() = job.exit_status,
+            n::metadata() = job.metadata
+            );
+}
+
+namespace paludis
+{
+    template class Pimp<EbuildMetadataWorkerPool>;
+}
@@ -0,0 +1,122 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_EBUILD_METADATA_WORKER_POOL_HH
+#define PALUDIS_GUARD_PALUDIS_REPOSITORIES_E_EBUILD_METADATA_WORKER_POOL_HH 1
+
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/util/named_value.hh>
+#include <paludis/util/process.hh>
+#include <string>
+
+namespace paludis
+{
+    namespace n
+    {
+        typedef Name<struct name_captured_stderr> captured_stderr;
+        typedef Name<struct name_captured_stdout> captured_stdout;
+        typedef Name<struct name_exit_status> exit_status;
+        typedef Name<struct name_metadata> metadata;
+    }
+
+    namespace erepository
+    {
+        /**
+         * The outcome of generating metadata for one ebuild using an
+         * EbuildMetadataWorkerPool.
+         *
+         * \see EbuildMetadataWorkerPool
+         * \ingroup grpebuildinterface
+         * \nosubgrouping
+         */
+        struct EbuildMetadataWorkerResult
+        {
+            NamedValue<n::captured_stderr, std::string> captured_stderr;
+            NamedValue<n::captured_stdout, std::string> captured_stdout;
+            NamedValue<n::exit_status, int> exit_status;
+            NamedValue<n::metadata, std::string> metadata;
+        };
+
+        /**
+         * A pool of long-lived ebuild.bash processes used to generate
+         * metadata.
+         *
+         * Starting a fresh bash, and loading ebuild.bash and the EAPI
+         * function libraries, dominates the cost of generating metadata for
+         * a single ebuild. A worker does that once, and then asks us for work
+         * over the pipe command channel, sourcing each ebuild in a forked
+         * subshell. Workers also keep the text of every eclass and exlib
+         * they have seen, so that later ebuilds do not have to read them
+         * again.
+         *
+         * Workers are grouped by a key, which must identify everything that
+         * ebuild.bash looks at when it starts up (in practice, the EAPI and
+         * the phase options). Up to a fixed number of workers exist for each
+         * key.
+         *
+         * \ingroup grpebuildinterface
+         * \nosubgrouping
+         */
+        class PALUDIS_VISIBLE EbuildMetadataWorkerPool
+        {
+            private:
+                Pimp<EbuildMetadataWorkerPool> _imp;
+
+            public:
+                ///\name Basic operations
+                ///\{
+
+                explicit EbuildMetadataWorkerPool(const unsigned max_workers_per_key);
+                ~EbuildMetadataWorkerPool();
+
+                EbuildMetadataWorkerPool(const EbuildMetadataWorkerPool &) = delete;
+                EbuildMetadataWorkerPool & operator= (const EbuildMetadataWorkerPool &) = delete;
+
+                ///\}
+
+                /**
+                 * How many workers per key to use, as requested by the
+                 * PALUDIS_METADATA_WORKERS environment variable. Zero means
+                 * that workers should not be used.
+                 */
+                static unsigned max_workers_per_key_from_environment();
+
+                /**
+                 * Generate metadata for an ebuild.
+                 *
+                 * The process must be a fully set up, but not yet run,
+                 * ebuild.bash metadata process. Its environment is sent to
+                 * the worker. If a new worker needs to be started for this
+                 * key, the process itself is turned into that worker.
+                 *
+                 * Any pipe commands other than those used by the worker
+                 * protocol are handed to the supplied handler.
+                 */
+                EbuildMetadataWorkerResult run(
+                        const std::string & key,
+                        Process & process,
+                        const std::string & ebuild_file,
+                        const std::string & commands,
+                        const ProcessPipeCommandFunction & pipe_command_handler);
+        };
+    }
+
+    extern template class Pimp<erepository::EbuildMetadataWorkerPool>;
+}
+
+#endif
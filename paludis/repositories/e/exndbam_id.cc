@@ -21,8 +21,11 @@
 #include <paludis/util/stringify.hh>
 #include <paludis/util/set.hh>
 #include <paludis/util/sequence.hh>
+#include <paludis/util/fs_path.hh>
 #include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/ndbam.hh>
+#include <paludis/metadata_key.hh>
 #include <functional>
 
 using namespace paludis;
@@ -67,3 +70,14 @@ ExndbamID::contents() const
     return v;
 }
 
+bool
+ExndbamID::for_each_contents_entry(const PackedContentsEntryFunction & f) const
+{
+    PackedContents packed(fs_location_key()->parse_value() / "contents.packed", fs_location_key()->parse_value() / "contents");
+    if (! packed.usable())
+        return EInstalledRepositoryID::for_each_contents_entry(f);
+
+    packed.for_each(f);
+    return true;
+}
+
@@ -44,6 +44,7 @@ namespace paludis
                 std::string fs_location_human_name() const override;
                 std::string contents_filename() const override;
                 const std::shared_ptr<const Contents> contents() const override;
+                bool for_each_contents_entry(const PackedContentsEntryFunction &) const override;
         };
     }
 }
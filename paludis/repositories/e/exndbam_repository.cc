@@ -36,6 +36,7 @@
 #include <paludis/util/make_named_values.hh>
 #include <paludis/util/safe_ifstream.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/file_lock.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/join.hh>
 #include <paludis/util/return_literal_function.hh>
@@ -111,8 +112,10 @@ ExndbamRepository::ExndbamRepository(const RepositoryName & n, const ExndbamRepo
                 ),
             n,
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = this,
                 n::destination_interface() = this,
                 n::environment_variable_interface() = this,
+                n::file_owner_interface() = this,
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
             )),
     _imp(p)
@@ -200,6 +203,9 @@ ExndbamRepository::invalidate()
 {
     _imp.reset(new Imp<ExndbamRepository>(_imp->params));
     _add_metadata_keys();
+    invalidate_file_owner_index();
+    invalidate_dependents_index();
+    bump_generation();
 }
 
 std::shared_ptr<const PackageIDSequence>
@@ -361,6 +367,9 @@ ExndbamRepository::merge(const MergeParams & m)
     if (! is_suitable_destination_for(m.package_id()))
         throw ActionFailedError("Not a suitable destination for '" + stringify(*m.package_id()) + "'");
 
+    /* other jobs may be merging at the same time as us */
+    auto merge_lock(lock_for_merge());
+
     std::shared_ptr<const PackageID> if_overwritten_id;
     std::shared_ptr<const PackageID> if_same_name_id;
     {
@@ -543,6 +552,8 @@ ExndbamRepository::merge(const MergeParams & m)
                 n::root() = installed_root_key()->parse_value()
             ));
     post_merge_command();
+
+    bump_generation();
 }
 
 void
@@ -560,6 +571,8 @@ ExndbamRepository::perform_uninstall(
         throw ActionFailedError("Couldn't uninstall '" + stringify(*id) +
                 "' because EAPI is unsupported");
 
+    auto merge_lock(lock_for_merge());
+
     std::shared_ptr<OutputManager> output_manager(a.options.make_output_manager()(a));
 
     FSPath ver_dir(id->fs_location_key()->parse_value().realpath());
@@ -706,11 +719,17 @@ ExndbamRepository::perform_uninstall(
 
         _imp->ndbam.deindex(id->name());
     }
+
+    remove_from_file_owner_index(id);
+    remove_from_dependents_index(id);
+
+    bump_generation();
 }
 
-void
+RegenerateCacheStatistics
 ExndbamRepository::regenerate_cache() const
 {
+    return Repository::regenerate_cache();
 }
 
 void
@@ -77,7 +77,7 @@ namespace paludis
 
             void invalidate() override;
 
-            void regenerate_cache() const override;
+            RegenerateCacheStatistics regenerate_cache() const override;
 
             /* RepositoryDestinationInterface */
 
@@ -152,7 +152,7 @@ namespace
 void
 FetchVisitor::visit(const FetchableURISpecTree::NodeType<FetchableURIDepSpec>::Type & node)
 {
-    Context context("When visiting URI dep spec '" + stringify(node.spec()->text()) + "':");
+    LazyContext context([&] () { return "When visiting URI dep spec '" + stringify(node.spec()->text()) + "':"; });
 
     if (! *_imp->labels.begin())
         throw ActionFailedError("No fetch action label available");
@@ -163,7 +163,7 @@ FetchVisitor::visit(const FetchableURISpecTree::NodeType<FetchableURIDepSpec>::T
     (*_imp->labels.begin())->accept(source_uri_finder);
     for (const auto & uri_to_filename : source_uri_finder)
     {
-        Context local_context("When fetching URI '" + stringify(uri_to_filename.first) + "' to '" + stringify(uri_to_filename.second) + ":");
+        LazyContext local_context([&] () { return "When fetching URI '" + stringify(uri_to_filename.first) + "' to '" + stringify(uri_to_filename.second) + ":"; });
 
         FSPath destination(_imp->distdir / node.spec()->filename());
 
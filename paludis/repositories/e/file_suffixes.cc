@@ -95,7 +95,7 @@ FileSuffixes::manifest_key(const std::string & s) const
 bool
 FileSuffixes::is_package_file(const QualifiedPackageName & n, const FSPath & e) const
 {
-    Context context("When working out whether '" + stringify(e) + "' is a package file for '" + stringify(n) + "':");
+    LazyContext context([&] () { return "When working out whether '" + stringify(e) + "' is a package file for '" + stringify(n) + "':"; });
 
     if (0 != e.basename().compare(0, stringify(n.package()).length() + 1, stringify(n.package()) + "-"))
         return false;
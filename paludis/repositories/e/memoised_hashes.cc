@@ -34,7 +34,7 @@ using namespace paludis::erepository;
 
 namespace paludis
 {
-    typedef std::map<std::pair<std::string, std::string>, std::pair<Timestamp, std::string> > HashesMap;
+    typedef std::map<std::string, std::pair<Timestamp, std::map<std::string, std::string> > > HashesMap;
 
     template <>
     struct Imp<MemoisedHashes>
@@ -58,26 +58,60 @@ MemoisedHashes::~MemoisedHashes() = default;
 const std::string
 MemoisedHashes::get(const std::string & algo, const FSPath & file, SafeIFStream & stream) const
 {
-    std::pair<std::string, std::string> key(stringify(file), algo);
+    auto result(get(std::vector<std::string>{ algo }, file, stream));
+    auto r(result.find(algo));
+    if (r == result.end())
+        return "";
+    return r->second;
+}
+
+const std::map<std::string, std::string>
+MemoisedHashes::get(const std::vector<std::string> & algos, const FSPath & file, SafeIFStream & stream) const
+{
+    std::string key(stringify(file));
     Timestamp mtime(file.stat().mtim());
 
+    std::vector<std::string> missing;
+    std::map<std::string, std::string> result;
+
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+
+        HashesMap::const_iterator i(_imp->hashes.find(key));
+        const std::map<std::string, std::string> * known(
+                (i != _imp->hashes.end() && i->second.first == mtime) ? &i->second.second : nullptr);
+
+        for (const auto & algo : algos)
+        {
+            auto h(known ? known->find(algo) : std::map<std::string, std::string>::const_iterator());
+            if (known && h != known->end())
+                result.insert(*h);
+            else
+                missing.push_back(algo);
+        }
+    }
+
+    if (missing.empty())
+        return result;
+
+    /* don't hold the lock whilst reading, since the file could be huge */
+    std::map<std::string, std::string> calculated(DigestRegistry::get_instance()->get_multiple(missing, stream));
+    stream.clear();
+    stream.seekg(0, std::ios::beg);
+
     std::unique_lock<std::mutex> lock(_imp->mutex);
 
     HashesMap::iterator i(_imp->hashes.find(key));
-
     if (i == _imp->hashes.end() || i->second.first != mtime)
+        i = _imp->hashes.insert_or_assign(key, std::make_pair(mtime, std::map<std::string, std::string>())).first;
+
+    for (const auto & c : calculated)
     {
-        std::pair<Timestamp, std::string> value(std::make_pair(mtime, DigestRegistry::get_instance()->get(algo)(stream)));
-        stream.clear();
-        stream.seekg(0, std::ios::beg);
-
-        if (i != _imp->hashes.end())
-            i->second = value;
-        else
-            i = _imp->hashes.insert(std::make_pair(key, value)).first;
+        i->second.second[c.first] = c.second;
+        result.insert(c);
     }
 
-    return i->second.second;
+    return result;
 }
 
 namespace paludis
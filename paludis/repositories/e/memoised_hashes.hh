@@ -25,6 +25,8 @@
 #include <paludis/util/fs_path-fwd.hh>
 #include <paludis/util/safe_ifstream-fwd.hh>
 #include <string>
+#include <map>
+#include <vector>
 
 namespace paludis
 {
@@ -40,6 +42,14 @@ namespace paludis
 
                 const std::string get(const std::string & algo, const FSPath & file, SafeIFStream & stream) const;
 
+                /**
+                 * Get several hashes of a file. Any that aren't already known
+                 * are calculated together, from a single read of the file.
+                 * Unsupported algorithms are left out of the result.
+                 */
+                const std::map<std::string, std::string> get(const std::vector<std::string> & algos,
+                        const FSPath & file, SafeIFStream & stream) const;
+
             private:
                 MemoisedHashes();
                 ~MemoisedHashes();
@@ -0,0 +1,152 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/repositories/e/dep_parser.hh>
+#include <paludis/repositories/e/eapi.hh>
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/util/exception.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/stringify.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+using namespace paludis::erepository;
+
+namespace
+{
+    struct Entry
+    {
+        std::string id;
+        std::string depend;
+    };
+
+    /* something shaped like the DEPEND of a typical ebuild */
+    std::vector<Entry> make_entries(const unsigned n)
+    {
+        std::vector<Entry> result;
+        for (unsigned i(0) ; i < n ; ++i)
+        {
+            std::string c("cat-" + stringify(i % 40));
+            result.push_back(Entry{
+                    "=" + c + "/pkg-" + stringify(i) + "-1." + stringify(i % 7) + ":0::benchmark",
+                    ">=dev-libs/lib" + stringify(i % 13) + "-2.1 foo? ( " + c + "/dep" + stringify(i % 17) + " ) "
+                    "|| ( app-misc/alt" + stringify(i % 3) + " app-misc/b ) bar? ( !baz? ( sys-libs/zlib:= ) ) "
+                    "virtual/pkgconfig dev-util/tool[foo,-bar]"
+                    });
+        }
+        return result;
+    }
+
+    template <typename F_>
+    double nanoseconds_per(const unsigned n, const F_ & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    }
+
+    /* the per-key bookkeeping that used to be paid for every metadata key,
+     * doing a token amount of real work so the optimiser can't drop it */
+    double eager_contexts(const std::vector<Entry> & entries, const std::string & key)
+    {
+        unsigned long words(0);
+        double result(nanoseconds_per(entries.size(), [&] () {
+                    for (const auto & entry : entries)
+                    {
+                        Context context("When parsing metadata key '" + key + "' from '" + entry.id + "':");
+                        words += std::count(entry.depend.begin(), entry.depend.end(), ' ');
+                    }
+                    }));
+        if (0 == words)
+            throw InternalError(PALUDIS_HERE, "no words");
+        return result;
+    }
+
+    double lazy_contexts(const std::vector<Entry> & entries, const std::string & key)
+    {
+        unsigned long words(0);
+        double result(nanoseconds_per(entries.size(), [&] () {
+                    for (const auto & entry : entries)
+                    {
+                        LazyContext context([&] () { return "When parsing metadata key '" + key + "' from '" + entry.id + "':"; });
+                        words += std::count(entry.depend.begin(), entry.depend.end(), ' ');
+                    }
+                    }));
+        if (0 == words)
+            throw InternalError(PALUDIS_HERE, "no words");
+        return result;
+    }
+
+    double debug_messages(const std::vector<Entry> & entries, const LogLevel level)
+    {
+        Log::get_instance()->set_log_level(level);
+        double result(nanoseconds_per(entries.size(), [&] () {
+                    for (const auto & entry : entries)
+                        Log::get_instance()->message("e.benchmark.debug", ll_debug, lc_no_context)
+                            << "Loaded '" << entry.id << "' with " << entry.depend.length() << " bytes of DEPEND";
+                    }));
+        Log::get_instance()->set_log_level(ll_qa);
+        return result;
+    }
+
+    double parse_some(const std::vector<Entry> & entries, const unsigned n)
+    {
+        TestEnvironment env;
+        const std::shared_ptr<const EAPI> eapi(EAPIData::get_instance()->eapi_from_string("6"));
+        return nanoseconds_per(n, [&] () {
+                for (unsigned i(0) ; i < n ; ++i)
+                    if (! parse_depend(entries[i].depend, &env, *eapi, false))
+                        throw InternalError(PALUDIS_HERE, "parse failed");
+                });
+    }
+}
+
+int main(int, char *[])
+{
+    std::vector<Entry> entries(make_entries(200000));
+
+    /* messages that do get through go nowhere, so that the ll_debug run
+     * measures formatting rather than terminal speed */
+    std::ostream null_stream(nullptr);
+    Log::get_instance()->set_log_stream(&null_stream);
+
+    double eager(eager_contexts(entries, "DEPEND"));
+    double lazy(lazy_contexts(entries, "DEPEND"));
+    double discarded(debug_messages(entries, ll_qa));
+    double formatted(debug_messages(entries, ll_debug));
+    double parse(parse_some(entries, 2000));
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "per metadata key, " << entries.size() << " keys:" << std::endl
+        << "    scan with eager Context:            " << eager << "ns" << std::endl
+        << "    scan with LazyContext:              " << lazy << "ns" << std::endl
+        << "    saving:                             " << (eager - lazy) << "ns" << std::endl
+        << "    ll_debug message, log level debug:  " << formatted << "ns" << std::endl
+        << "    ll_debug message, log level qa:     " << discarded << "ns" << std::endl
+        << "    saving:                             " << (formatted - discarded) << "ns" << std::endl
+        << "    parse_depend, for scale:            " << parse << "ns" << std::endl;
+
+    return EXIT_SUCCESS;
+}
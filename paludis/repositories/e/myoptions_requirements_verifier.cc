@@ -233,7 +233,7 @@ MyOptionsRequirementsVerifier::verify_one(
 void
 MyOptionsRequirementsVerifier::visit(const PlainTextSpecTree::NodeType<PlainTextDepSpec>::Type & node)
 {
-    Context context("When verifying requirements for item '" + stringify(*node.spec()) + "':");
+    LazyContext context([&] () { return "When verifying requirements for item '" + stringify(*node.spec()) + "':"; });
 
     for (auto & children : _imp->current_children_stack)
         children.push_back(std::make_pair(*_imp->current_prefix_stack.begin(), node.spec()->text()));
@@ -164,7 +164,7 @@ paludis::erepository::parse_dependency_label(const Environment * const,
                                              const std::string & s,
                                              const EAPI & e)
 {
-    Context context("When parsing label string '" + s + "' using EAPI '" + e.name() + "':");
+    LazyContext context([&] () { return "When parsing label string '" + s + "' using EAPI '" + e.name() + "':"; });
 
     if (s.empty())
         throw EDepParseError(s, "Empty label");
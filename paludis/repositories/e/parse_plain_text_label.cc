@@ -34,7 +34,7 @@ using namespace paludis::erepository;
 std::shared_ptr<PlainTextLabelDepSpec>
 paludis::erepository::parse_plain_text_label(const std::string & s)
 {
-    Context context("When parsing label string '" + s + "':");
+    LazyContext context([&] () { return "When parsing label string '" + s + "':"; });
 
     if (s.empty())
         throw EDepParseError(s, "Empty label");
@@ -303,7 +303,7 @@ TraditionalLayout::has_category_named(const CategoryNamePart & c) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':");
+    LazyContext context([&] () { return "When checking for category '" + stringify(c) + "' in '" + stringify(_imp->repository->name()) + "':"; });
 
     need_category_names();
     return _imp->category_names.end() != _imp->category_names.find(c);
@@ -314,7 +314,7 @@ TraditionalLayout::has_package_named(const QualifiedPackageName & q) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":");
+    LazyContext context([&] () { return "When checking for package '" + stringify(q) + "' in '" + stringify(_imp->repository->name()) + ":"; });
 
     need_category_names();
 
@@ -424,7 +424,7 @@ TraditionalLayout::package_ids(const QualifiedPackageName & n) const
 {
     std::unique_lock<std::recursive_mutex> lock(_imp->big_nasty_mutex);
 
-    Context context("When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":");
+    LazyContext context([&] () { return "When fetching versions of '" + stringify(n) + "' in " + stringify(_imp->repository->name()) + ":"; });
 
     if (has_package_named(n))
     {
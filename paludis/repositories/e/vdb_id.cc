@@ -28,6 +28,7 @@
 #include <paludis/util/destringify.hh>
 #include <paludis/util/timestamp.hh>
 #include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/literal_metadata_key.hh>
 
 #include <vector>
@@ -72,6 +73,13 @@ VDBID::contents() const
 
     auto value(std::make_shared<Contents>());
 
+    PackedContents packed(fs_location_key()->parse_value() / "CONTENTS.packed", contents_location);
+    if (packed.usable())
+    {
+        packed.add_to(*value);
+        return value;
+    }
+
     if (! contents_location.stat().is_regular_file_or_symlink_to_regular_file())
     {
         Log::get_instance()->message("e.contents.not_a_file", ll_warning, lc_context) << "Could not read CONTENTS file '" <<
@@ -127,3 +135,13 @@ VDBID::contents() const
     return value;
 }
 
+bool
+VDBID::for_each_contents_entry(const PackedContentsEntryFunction & f) const
+{
+    PackedContents packed(fs_location_key()->parse_value() / "CONTENTS.packed", fs_location_key()->parse_value() / "CONTENTS");
+    if (! packed.usable())
+        return EInstalledRepositoryID::for_each_contents_entry(f);
+
+    packed.for_each(f);
+    return true;
+}
@@ -45,6 +45,7 @@
 #include <paludis/metadata_key.hh>
 #include <paludis/version_spec.hh>
 #include <paludis/slot.hh>
+#include <paludis/packed_contents.hh>
 
 #include <iomanip>
 #include <list>
@@ -59,6 +60,7 @@ namespace paludis
         VDBMergerParams params;
         FSPath realroot;
         std::shared_ptr<SafeOFStream> contents_file;
+        PackedContentsWriter packed_contents;
 
         std::list<std::string> config_protect;
         std::list<std::string> config_protect_mask;
@@ -152,7 +154,8 @@ VDBMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, const
 
     const std::string tidy(stringify(renamed_file.strip_leading(_imp->realroot)));
     const std::string tidy_real(stringify(file.strip_leading(_imp->realroot)));
-    const Timestamp timestamp(renamed_file.stat().mtim());
+    const FSStat renamed_file_stat(renamed_file);
+    const Timestamp timestamp(renamed_file_stat.mtim());
 
     SafeIFStream infile(renamed_file);
     if (! infile)
@@ -164,6 +167,16 @@ VDBMerger::record_install_file(const FSPath & src, const FSPath & dst_dir, const
                   src.basename() == dst_name ? "" : dst_name);
 
     *_imp->contents_file << "obj " << tidy_real << " " << md5.hexsum() << " " << timestamp.seconds() << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_file;
+    packed.path = tidy_real;
+    packed.has_mtime = true;
+    packed.mtime = timestamp.seconds();
+    packed.set_md5_from_hexsum(md5.hexsum());
+    packed.has_size = true;
+    packed.size = renamed_file_stat.file_size();
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -175,6 +188,11 @@ VDBMerger::record_install_dir(const FSPath & src, const FSPath & dst_dir, const
     display_merge(et_dir, dir, flags);
 
     *_imp->contents_file << "dir " << tidy << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_dir;
+    packed.path = tidy;
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -185,6 +203,11 @@ VDBMerger::record_install_under_dir(const FSPath & dst_dir, const FSMergerStatus
     display_merge(et_dir, dst_dir, flags);
 
     *_imp->contents_file << "dir " << tidy << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_dir;
+    packed.path = tidy;
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -198,6 +221,14 @@ VDBMerger::record_install_sym(const FSPath & src, const FSPath & dst_dir, const
     display_merge(et_sym, sym, flags);
 
     *_imp->contents_file << "sym " << tidy << " -> " << target << " " << timestamp.seconds() << std::endl;
+
+    PackedContentsEntry packed;
+    packed.type = pcet_sym;
+    packed.path = tidy;
+    packed.target = target;
+    packed.has_mtime = true;
+    packed.mtime = timestamp.seconds();
+    _imp->packed_contents.add(packed);
 }
 
 void
@@ -289,6 +320,11 @@ VDBMerger::merge()
     display_override(">>> Merging to " + stringify(_imp->params.root()));
     _imp->contents_file = std::make_shared<SafeOFStream>(_imp->params.contents_file(), -1, false);
     FSMerger::merge();
+
+    /* CONTENTS must be complete before the packed copy records its state */
+    _imp->contents_file.reset();
+    _imp->packed_contents.write(_imp->params.contents_file().dirname() / (_imp->params.contents_file().basename() + ".packed"),
+            _imp->params.contents_file(), ll_warning);
 }
 
 bool
@@ -74,6 +74,7 @@
 #include <paludis/util/timestamp.hh>
 #include <paludis/util/destringify.hh>
 #include <paludis/util/fs_stat.hh>
+#include <paludis/util/file_lock.hh>
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/join.hh>
 #include <paludis/util/return_literal_function.hh>
@@ -146,6 +147,9 @@ namespace paludis
         eapi_when_unknown_key(std::make_shared<LiteralMetadataValueKey<std::string> >(
                     "eapi_when_unknown", "eapi_when_unknown", mkt_normal, params.eapi_when_unknown()))
     {
+        /* every version is its own directory, so a category's mtime changes
+         * whenever anything in it is merged or unmerged */
+        names_cache->use_category_timestamps(params.location());
     }
 
     Imp<VDBRepository>::~Imp() = default;
@@ -160,8 +164,10 @@ VDBRepository::VDBRepository(const VDBRepositoryParams & p) :
                 ),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = this,
                 n::destination_interface() = this,
                 n::environment_variable_interface() = this,
+                n::file_owner_interface() = this,
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
             )),
     _imp(this, p)
@@ -386,6 +392,8 @@ VDBRepository::perform_uninstall(
         throw ActionFailedError("Couldn't uninstall '" + stringify(*id) +
                 "' because EAPI is unsupported");
 
+    auto merge_lock(lock_for_merge());
+
     std::shared_ptr<OutputManager> output_manager(a.options.make_output_manager()(a));
 
     std::string reinstalling_str(a.options.is_overwrite() ? "-reinstalling-" : "");
@@ -556,6 +564,11 @@ VDBRepository::perform_uninstall(
         if (only)
             _imp->names_cache->remove(id->name());
     }
+
+    remove_from_file_owner_index(id);
+    remove_from_dependents_index(id);
+
+    bump_generation();
 }
 
 void
@@ -564,14 +577,17 @@ VDBRepository::invalidate()
     std::unique_lock<std::recursive_mutex> lock(*_imp->big_nasty_mutex);
     _imp.reset(new Imp<VDBRepository>(this, _imp->params, _imp->big_nasty_mutex));
     _add_metadata_keys();
+    invalidate_file_owner_index();
+    invalidate_dependents_index();
+    bump_generation();
 }
 
-void
+RegenerateCacheStatistics
 VDBRepository::regenerate_cache() const
 {
     std::unique_lock<std::recursive_mutex> lock(*_imp->big_nasty_mutex);
 
-    _imp->names_cache->regenerate_cache();
+    return _imp->names_cache->regenerate_cache();
 }
 
 std::shared_ptr<const CategoryNamePartSet>
@@ -614,6 +630,9 @@ VDBRepository::merge(const MergeParams & m)
     if (! is_suitable_destination_for(m.package_id()))
         throw ActionFailedError("Not a suitable destination for '" + stringify(*m.package_id()) + "'");
 
+    /* other jobs may be merging at the same time as us */
+    auto merge_lock(lock_for_merge());
+
     std::shared_ptr<const ERepositoryID> is_replace(package_id_if_exists(m.package_id()->name(), m.package_id()->version()));
 
     std::string config_protect;
@@ -791,7 +810,13 @@ VDBRepository::merge(const MergeParams & m)
             ));
     post_merge_command();
 
+    auto merged_id(make_id(m.package_id()->name(), m.package_id()->version(), vdb_dir));
+    add_to_file_owner_index(merged_id);
+    add_to_dependents_index(merged_id);
+
     _imp->names_cache->add(m.package_id()->name());
+
+    bump_generation();
 }
 
 void
@@ -869,7 +894,7 @@ VDBRepository::make_id(const QualifiedPackageName & q, const VersionSpec & v, co
 {
     std::unique_lock<std::recursive_mutex> lock(*_imp->big_nasty_mutex);
 
-    Context context("When creating ID for '" + stringify(q) + "-" + stringify(v) + "' from '" + stringify(f) + "':");
+    LazyContext context([&] () { return "When creating ID for '" + stringify(q) + "-" + stringify(v) + "' from '" + stringify(f) + "':"; });
 
     std::shared_ptr<VDBID> result(std::make_shared<VDBID>(q, v, _imp->params.environment(), name(), f));
     return result;
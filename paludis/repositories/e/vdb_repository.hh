@@ -106,7 +106,7 @@ namespace paludis
 
             void invalidate() override;
 
-            void regenerate_cache() const override;
+            RegenerateCacheStatistics regenerate_cache() const override;
 
             void perform_uninstall(
                     const std::shared_ptr<const erepository::ERepositoryID> & id,
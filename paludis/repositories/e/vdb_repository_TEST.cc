@@ -43,6 +43,7 @@
 #include <paludis/choice.hh>
 #include <paludis/unformatted_pretty_printer.hh>
 #include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 
 #include <paludis/util/indirect_iterator-impl.hh>
 
@@ -248,6 +249,67 @@ TEST(VDBRepository, Contents)
         gatherer._str);
 }
 
+TEST(VDBRepository, FileOwners)
+{
+    TestEnvironment env;
+    std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+    keys->insert("format", "vdb");
+    keys->insert("names_cache", "/var/empty");
+    keys->insert("location", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "repo1"));
+    keys->insert("builddir", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "build"));
+    std::shared_ptr<Repository> repo(VDBRepository::VDBRepository::repository_factory_create(&env,
+                std::bind(from_keys, keys, std::placeholders::_1)));
+    env.add_repository(1, repo);
+
+    ASSERT_TRUE(bool(repo->file_owner_interface()));
+
+    std::shared_ptr<const PackageIDSequence> ids(repo->file_owner_interface()->file_owners(FSPath("/directory/file")));
+    EXPECT_EQ("cat-one/pkg-one-1::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->file_owner_interface()->file_owners(FSPath("/directory"));
+    EXPECT_EQ("cat-one/pkg-one-1::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->file_owner_interface()->file_owners(FSPath("/directory/nothing"));
+    EXPECT_TRUE(ids->empty());
+
+    ids = repo->file_owner_interface()->file_owners_within(FSPath("/directory"));
+    EXPECT_EQ("cat-one/pkg-one-1::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->file_owner_interface()->file_owners_within(FSPath("/dir"));
+    EXPECT_TRUE(ids->empty());
+
+    EXPECT_TRUE((FSPath::cwd() / "vdb_repository_TEST_dir" / "repo1" / ".cache" / "file_owners").stat().is_regular_file());
+}
+
+TEST(VDBRepository, Dependents)
+{
+    TestEnvironment env;
+    std::shared_ptr<Map<std::string, std::string> > keys(std::make_shared<Map<std::string, std::string>>());
+    keys->insert("format", "vdb");
+    keys->insert("names_cache", "/var/empty");
+    keys->insert("location", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "dependents"));
+    keys->insert("builddir", stringify(FSPath::cwd() / "vdb_repository_TEST_dir" / "build"));
+    std::shared_ptr<Repository> repo(VDBRepository::VDBRepository::repository_factory_create(&env,
+                std::bind(from_keys, keys, std::placeholders::_1)));
+    env.add_repository(1, repo);
+
+    ASSERT_TRUE(bool(repo->dependents_interface()));
+
+    std::shared_ptr<const PackageIDSequence> ids(repo->dependents_interface()->possible_dependents(QualifiedPackageName("cat-a/lib")));
+    EXPECT_EQ("cat-b/other-1:0::installed cat-b/user-1:0::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->dependents_interface()->possible_dependents(QualifiedPackageName("cat-b/user"));
+    EXPECT_EQ("cat-b/other-1:0::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->dependents_interface()->possible_dependents(QualifiedPackageName("cat-b/other"));
+    EXPECT_EQ("cat-c/none-1:0::installed", join(indirect_iterator(ids->begin()), indirect_iterator(ids->end()), " "));
+
+    ids = repo->dependents_interface()->possible_dependents(QualifiedPackageName("cat-c/none"));
+    EXPECT_TRUE(ids->empty());
+
+    EXPECT_TRUE((FSPath::cwd() / "vdb_repository_TEST_dir" / "dependents" / ".cache" / "dependents").stat().is_regular_file());
+}
+
 TEST(VDBRepository, Reinstall)
 {
     TestEnvironment env;
@@ -490,6 +552,26 @@ TEST(VDBRepository, RemoveStaleFiles)
     EXPECT_TRUE((FSPath("vdb_repository_TEST_dir/root") / "stale-first").stat().exists());
     EXPECT_TRUE((FSPath("vdb_repository_TEST_dir/root") / "stale-both").stat().exists());
 
+    {
+        const std::shared_ptr<const PackageID> id(*vdb_repo->package_ids(QualifiedPackageName("cat/pkg"), { })->begin());
+        EXPECT_TRUE((id->fs_location_key()->parse_value() / "CONTENTS.packed").stat().is_regular_file());
+
+        std::vector<std::string> packed;
+        EXPECT_TRUE(id->for_each_contents_entry([&] (const PackedContentsEntry & e) {
+                    packed.push_back(std::string(e.path) + (e.has_size ? " size=" + stringify(e.size) : "") + (e.has_md5 ? " " + e.md5_hexsum() : ""));
+                    }));
+        std::sort(packed.begin(), packed.end());
+        EXPECT_EQ("/stale-both size=0 d41d8cd98f00b204e9800998ecf8427e, /stale-first size=0 d41d8cd98f00b204e9800998ecf8427e",
+                join(packed.begin(), packed.end(), ", "));
+
+        auto contents(id->contents());
+        std::vector<std::string> text;
+        for (const auto & e : *contents)
+            text.push_back(stringify(e->location_key()->parse_value()));
+        std::sort(text.begin(), text.end());
+        EXPECT_EQ("/stale-both, /stale-first", join(text.begin(), text.end(), ", "));
+    }
+
     {
         ::setenv("VDB_REPOSITORY_TEST_STALE", "false", 1);
         install(env, vdb_repo, "=cat/pkg-0::removestalefiles", "=cat/pkg-0::installed");
@@ -176,3 +176,16 @@ src_install() {
 }
 END
 
+
+mkdir -p dependents/cat-{a/lib-1,b/user-1,b/other-1,c/none-1} || exit 1
+for i in cat-a/lib-1 cat-b/user-1 cat-b/other-1 cat-c/none-1; do
+    for j in SLOT EAPI; do
+        echo "0" >dependents/${i}/${j}
+    done
+    for j in DEPEND RDEPEND PDEPEND LICENSE INHERITED IUSE USE; do
+        touch dependents/${i}/${j}
+    done
+done
+echo "cat-a/lib" >dependents/cat-b/user-1/RDEPEND
+echo "flag? ( >=cat-a/lib-1 ) || ( cat-b/user cat-b/missing )" >dependents/cat-b/other-1/DEPEND
+echo "!cat-a/lib cat-b/other" >dependents/cat-c/none-1/PDEPEND
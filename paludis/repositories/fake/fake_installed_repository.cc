@@ -58,8 +58,10 @@ namespace paludis
 
 FakeInstalledRepository::FakeInstalledRepository(const FakeInstalledRepositoryParams & p) :
     FakeRepositoryBase(p.environment(), p.name(), make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = this,
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(p.supports_uninstall(), p.suitable_destination())
@@ -51,8 +51,10 @@ namespace paludis
 
 FakeRepository::FakeRepository(const FakeRepositoryParams & params) :
     FakeRepositoryBase(params.environment(), params.name(), make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(nullptr),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp()
@@ -158,6 +158,7 @@ FakeRepositoryBase::add_version(const QualifiedPackageName & q, const VersionSpe
 
     std::shared_ptr<FakePackageID> id(std::make_shared<FakePackageID>(_imp->env, name(), q, v));
     _imp->ids.find(q)->second->push_back(id);
+    bump_generation();
     return id;
 }
 
@@ -171,6 +172,7 @@ FakeRepositoryBase::add_version(const std::string & c, const std::string & p,
 void
 FakeRepositoryBase::invalidate()
 {
+    bump_generation();
 }
 
 const Environment *
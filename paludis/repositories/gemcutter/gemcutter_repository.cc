@@ -83,8 +83,10 @@ GemcutterRepository::GemcutterRepository(const GemcutterRepositoryParams & p) :
             p.environment(),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(nullptr),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(this, p)
@@ -138,6 +140,7 @@ GemcutterRepository::invalidate()
 {
     _imp.reset(new Imp<GemcutterRepository>(this, _imp->params));
     _add_metadata_keys();
+    bump_generation();
 }
 
 bool
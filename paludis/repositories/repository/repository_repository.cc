@@ -92,8 +92,10 @@ RepositoryRepository::RepositoryRepository(const RepositoryRepositoryParams & p)
             p.environment(),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(this),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(this, p)
@@ -147,6 +149,7 @@ RepositoryRepository::invalidate()
 {
     _imp.reset(new Imp<RepositoryRepository>(this, _imp->params));
     _add_metadata_keys();
+    bump_generation();
 }
 
 bool
@@ -100,8 +100,10 @@ UnavailableRepository::UnavailableRepository(const UnavailableRepositoryParams &
             p.environment(),
             p.name(),
             make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(nullptr),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
                 )),
     _imp(this, p)
@@ -156,6 +158,7 @@ UnavailableRepository::invalidate()
 {
     _imp.reset(new Imp<UnavailableRepository>(this, _imp->params));
     _add_metadata_keys();
+    bump_generation();
 }
 
 bool
@@ -95,8 +95,10 @@ namespace paludis
 InstalledUnpackagedRepository::InstalledUnpackagedRepository(
         const RepositoryName & n, const InstalledUnpackagedRepositoryParams & p) :
     Repository(p.environment(), n, make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = this,
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
             )),
     _imp(p)
@@ -365,6 +367,8 @@ InstalledUnpackagedRepository::merge(const MergeParams & m)
         std::static_pointer_cast<const InstalledUnpackagedID>(if_overwritten_id)->uninstall(true,
                 if_overwritten_id, m.output_manager());
     }
+
+    bump_generation();
 }
 
 bool
@@ -386,6 +390,7 @@ InstalledUnpackagedRepository::invalidate()
 {
     _imp.reset(new Imp<InstalledUnpackagedRepository>(_imp->params));
     _add_metadata_keys();
+    bump_generation();
 }
 
 void
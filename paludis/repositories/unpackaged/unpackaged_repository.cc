@@ -94,8 +94,10 @@ namespace paludis
 UnpackagedRepository::UnpackagedRepository(const RepositoryName & n,
         const UnpackagedRepositoryParams & params) :
     Repository(params.environment(), n, make_named_values<RepositoryCapabilities>(
+                n::dependents_interface() = static_cast<RepositoryDependentsInterface *>(nullptr),
                 n::destination_interface() = static_cast<RepositoryDestinationInterface *>(nullptr),
                 n::environment_variable_interface() = static_cast<RepositoryEnvironmentVariableInterface *>(nullptr),
+                n::file_owner_interface() = static_cast<RepositoryFileOwnerInterface *>(nullptr),
                 n::manifest_interface() = static_cast<RepositoryManifestInterface *>(nullptr)
             )),
     _imp(n, params)
@@ -179,6 +181,7 @@ UnpackagedRepository::invalidate()
 {
     _imp.reset(new Imp<UnpackagedRepository>(name(), _imp->params));
     _add_metadata_keys();
+    bump_generation();
 }
 
 void
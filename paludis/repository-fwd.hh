@@ -43,8 +43,11 @@ namespace paludis
     class RepositoryEnvironmentVariableInterface;
     class RepositoryDestinationInterface;
     class RepositoryManifestInterface;
+    class RepositoryFileOwnerInterface;
+    class RepositoryDependentsInterface;
 
     struct MergeParams;
+    struct RegenerateCacheStatistics;
 
 #include <paludis/repository-se.hh>
 
@@ -34,6 +34,7 @@
 #include <paludis/metadata_key.hh>
 #include <paludis/distribution-impl.hh>
 #include <paludis/environment.hh>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <list>
@@ -99,15 +100,24 @@ namespace paludis
     };
 }
 
+namespace
+{
+    /* shared between repositories, so that a generation is never reused, even
+     * by a replacement repository with the same name */
+    std::atomic<unsigned long> next_generation(0);
+}
+
 namespace paludis
 {
     template <>
     struct Imp<Repository>
     {
         const RepositoryName name;
+        mutable std::atomic<unsigned long> generation;
 
         Imp(const RepositoryName & n) :
-            name(n)
+            name(n),
+            generation(++next_generation)
         {
         }
     };
@@ -138,6 +148,18 @@ Repository::name() const noexcept
     return _imp->name;
 }
 
+unsigned long
+Repository::generation() const noexcept
+{
+    return _imp->generation.load();
+}
+
+void
+Repository::bump_generation() const
+{
+    _imp->generation = ++next_generation;
+}
+
 std::shared_ptr<const CategoryNamePartSet>
 Repository::category_names_containing_package(const PackageNamePart & p, const RepositoryContentMayExcludes &) const
 {
@@ -152,9 +174,13 @@ Repository::category_names_containing_package(const PackageNamePart & p, const R
     return result;
 }
 
-void
+RegenerateCacheStatistics
 Repository::regenerate_cache() const
 {
+    return make_named_values<RegenerateCacheStatistics>(
+            n::rebuilt() = 0,
+            n::reused() = 0
+            );
 }
 
 void
@@ -162,12 +188,21 @@ Repository::purge_invalid_cache() const
 {
 }
 
+void
+Repository::preload() const
+{
+}
+
 RepositoryEnvironmentVariableInterface::~RepositoryEnvironmentVariableInterface() = default;
 
 RepositoryDestinationInterface::~RepositoryDestinationInterface() = default;
 
 RepositoryManifestInterface::~RepositoryManifestInterface() = default;
 
+RepositoryFileOwnerInterface::~RepositoryFileOwnerInterface() = default;
+
+RepositoryDependentsInterface::~RepositoryDependentsInterface() = default;
+
 std::shared_ptr<const CategoryNamePartSet>
 Repository::unimportant_category_names(const RepositoryContentMayExcludes &) const
 {
@@ -62,9 +62,11 @@ namespace paludis
         typedef Name<struct name_arch> arch;
         typedef Name<struct name_build_start_time> build_start_time;
         typedef Name<struct name_check> check;
+        typedef Name<struct name_dependents_interface> dependents_interface;
         typedef Name<struct name_destination_interface> destination_interface;
         typedef Name<struct name_environment_file> environment_file;
         typedef Name<struct name_environment_variable_interface> environment_variable_interface;
+        typedef Name<struct name_file_owner_interface> file_owner_interface;
         typedef Name<struct name_image_dir> image_dir;
         typedef Name<struct name_is_volatile> is_volatile;
         typedef Name<struct name_manifest_interface> manifest_interface;
@@ -77,7 +79,9 @@ namespace paludis
         typedef Name<struct name_perform_uninstall> perform_uninstall;
         typedef Name<struct name_permit_destination> permit_destination;
         typedef Name<struct name_profile> profile;
+        typedef Name<struct name_rebuilt> rebuilt;
         typedef Name<struct name_replacing> replacing;
+        typedef Name<struct name_reused> reused;
         typedef Name<struct name_status> status;
         typedef Name<struct name_used_this_for_config_protect> used_this_for_config_protect;
         typedef Name<struct name_want_phase> want_phase;
@@ -92,8 +96,10 @@ namespace paludis
      */
     struct RepositoryCapabilities
     {
+        NamedValue<n::dependents_interface, RepositoryDependentsInterface *> dependents_interface;
         NamedValue<n::destination_interface, RepositoryDestinationInterface *> destination_interface;
         NamedValue<n::environment_variable_interface, RepositoryEnvironmentVariableInterface *> environment_variable_interface;
+        NamedValue<n::file_owner_interface, RepositoryFileOwnerInterface *> file_owner_interface;
         NamedValue<n::manifest_interface, RepositoryManifestInterface *> manifest_interface;
     };
 
@@ -178,6 +184,23 @@ namespace paludis
         NamedValue<n::want_phase, std::function<WantPhase (const std::string &)> > want_phase;
     };
 
+    /**
+     * Returned by Repository::regenerate_cache, to say how much of a cache
+     * had to be rebuilt.
+     *
+     * What an entry is depends upon the cache. For names caches it is a
+     * category.
+     *
+     * \see Repository
+     * \ingroup g_repository
+     * \since 3.0
+     */
+    struct RegenerateCacheStatistics
+    {
+        NamedValue<n::rebuilt, unsigned long> rebuilt;
+        NamedValue<n::reused, unsigned long> reused;
+    };
+
     /**
      * Thrown if a Set does not exist
      *
@@ -258,6 +281,15 @@ namespace paludis
 
             ///\}
 
+            /**
+             * Note that our content may have changed, for example because we
+             * have been invalidated or merged to.
+             *
+             * \see generation
+             * \since 3.0
+             */
+            void bump_generation() const;
+
         public:
             ///\name Basic operations
             ///\{
@@ -277,6 +309,16 @@ namespace paludis
              */
             const RepositoryName name() const noexcept PALUDIS_ATTRIBUTE((warn_unused_result));
 
+            /**
+             * A value that changes whenever our content may have changed.
+             *
+             * Generations are unique across all repositories. Used by Environment to decide whether a remembered Selection
+             * result is still usable.
+             *
+             * \since 3.0
+             */
+            unsigned long generation() const noexcept PALUDIS_ATTRIBUTE((warn_unused_result));
+
             ///\}
 
             ///\name Specific metadata keys
@@ -423,14 +465,28 @@ namespace paludis
 
             /**
              * Regenerate any on disk cache.
+             *
+             * \since 3.0 returns statistics
              */
-            virtual void regenerate_cache() const;
+            virtual RegenerateCacheStatistics regenerate_cache() const;
 
             /**
              * Purge any invalid on-disk cache entries.
              */
             virtual void purge_invalid_cache() const;
 
+            /**
+             * Load anything we will almost certainly need later, such as
+             * profiles.
+             *
+             * Environments call this for every repository in parallel at
+             * startup, so it must be safe to call alongside other
+             * repositories' preload. Does nothing by default.
+             *
+             * \since 3.0
+             */
+            virtual void preload() const;
+
             /**
              * Perform a hook.
              *
@@ -572,6 +628,84 @@ namespace paludis
 
             ///\}
     };
+
+    /**
+     * Interface for repositories that can quickly find out which of their
+     * IDs own a file, without going through every ID's contents.
+     *
+     * Paths are as they appear in PackageID::contents(), that is, without
+     * the installed root.
+     *
+     * \see Repository
+     * \ingroup g_repository
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE RepositoryFileOwnerInterface
+    {
+        public:
+            ///\name File owner functions
+            ///\{
+
+            /**
+             * The IDs whose contents include exactly the specified path.
+             */
+            virtual std::shared_ptr<const PackageIDSequence> file_owners(const FSPath &) const
+                PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
+
+            /**
+             * The IDs whose contents include the specified path, or
+             * anything beneath it.
+             */
+            virtual std::shared_ptr<const PackageIDSequence> file_owners_within(const FSPath &) const
+                PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
+
+            ///\}
+
+            ///\name Basic operations
+            ///\{
+
+            virtual ~RepositoryFileOwnerInterface();
+
+            ///\}
+    };
+
+    /**
+     * Interface for repositories that can quickly narrow down which of their
+     * IDs might depend upon a package, without going through every ID's
+     * dependencies.
+     *
+     * \see Repository
+     * \ingroup g_repository
+     * \nosubgrouping
+     * \since 3.0
+     */
+    class PALUDIS_VISIBLE RepositoryDependentsInterface
+    {
+        public:
+            ///\name Dependents functions
+            ///\{
+
+            /**
+             * The IDs that might have a dependency upon something with the
+             * specified name.
+             *
+             * This can include IDs whose dependencies turn out not to match
+             * (for example, because they are behind a disabled condition),
+             * so callers must still check, but it never leaves out an ID
+             * that does depend upon the name.
+             */
+            virtual std::shared_ptr<const PackageIDSequence> possible_dependents(const QualifiedPackageName &) const
+                PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
+
+            ///\}
+
+            ///\name Basic operations
+            ///\{
+
+            virtual ~RepositoryDependentsInterface();
+
+            ///\}
+    };
 }
 
 #endif
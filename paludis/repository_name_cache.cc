@@ -31,9 +31,14 @@
 #include <paludis/util/fs_iterator.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/fs_error.hh>
+#include <paludis/util/tokeniser.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/timestamp.hh>
 #include <unordered_map>
 #include <memory>
+#include <map>
 #include <set>
+#include <vector>
 #include <mutex>
 #include <cstring>
 #include <cerrno>
@@ -44,6 +49,16 @@ namespace paludis
 {
     typedef std::unordered_map<PackageNamePart, std::set<CategoryNamePart>, Hash<PackageNamePart> > NameCacheMap;
 
+    /* what a category directory looked like, and the package names that were
+     * in it, the last time we regenerated */
+    struct CategoryState
+    {
+        std::string timestamp;
+        std::set<std::string> packages;
+    };
+
+    typedef std::map<std::string, CategoryState> CategoryStates;
+
     template<>
     struct Imp<RepositoryNameCache>
     {
@@ -56,6 +71,8 @@ namespace paludis
         mutable NameCacheMap name_cache_map;
         mutable bool checked_name_cache_map;
 
+        std::shared_ptr<const FSPath> category_timestamps_location;
+
         Imp(const FSPath & l, const Repository * const r) :
             usable(l != FSPath("/var/empty")),
             location(l == FSPath("/var/empty") ? l : l / stringify(r->name())),
@@ -66,9 +83,86 @@ namespace paludis
 
         NameCacheMap::iterator find(const PackageNamePart &) const;
         void update(const PackageNamePart & p, NameCacheMap::iterator r);
+
+        bool load_category_states(CategoryStates &) const;
+        void save_category_states(const CategoryStates &) const;
     };
 }
 
+namespace
+{
+    std::string category_timestamp(const FSPath & dir)
+    {
+        FSStat s(dir);
+        if (! s.is_directory())
+            return "";
+        return stringify(s.mtim().seconds()) + "." + stringify(s.mtim().nanoseconds());
+    }
+
+    typedef std::map<std::string, std::string> PackageFiles;
+
+    /* the contents of each package's file, given the packages in each
+     * category */
+    PackageFiles package_files(const CategoryStates & states)
+    {
+        PackageFiles result;
+        for (const auto & c : states)
+            for (const auto & p : c.second.packages)
+                result[p].append(c.first + "\n");
+        return result;
+    }
+}
+
+bool
+Imp<RepositoryNameCache>::load_category_states(CategoryStates & states) const
+{
+    FSPath version_file(location / "_VERSION_"), state_file(location / "_STATE_");
+    if (! (version_file.stat().is_regular_file() && state_file.stat().is_regular_file()))
+        return false;
+
+    /* only trust a state written alongside a cache we understand */
+    SafeIFStream vvf(version_file);
+    std::string line;
+    if (! (std::getline(vvf, line) && line == "paludis-2" && std::getline(vvf, line) && line == stringify(repo->name())))
+        return false;
+
+    SafeIFStream f(state_file);
+    while (std::getline(f, line))
+    {
+        std::vector<std::string> tokens;
+        tokenise_whitespace(line, std::back_inserter(tokens));
+        if (tokens.size() < 2)
+            return false;
+
+        CategoryState & state(states[tokens[0]]);
+        state.timestamp = tokens[1];
+        state.packages.insert(std::next(tokens.begin(), 2), tokens.end());
+    }
+
+    return true;
+}
+
+void
+Imp<RepositoryNameCache>::save_category_states(const CategoryStates & states) const
+{
+    try
+    {
+        SafeOFStream f(location / "_STATE_", -1, true);
+        for (const auto & c : states)
+        {
+            f << c.first << " " << c.second.timestamp;
+            for (const auto & p : c.second.packages)
+                f << " " << p;
+            f << std::endl;
+        }
+    }
+    catch (const SafeOFStreamError & e)
+    {
+        Log::get_instance()->message("repository.names_cache.write_failed", ll_warning, lc_context)
+            << "Cannot write to '" << location << "': '" << e.message() << "' (" << e.what() << ")";
+    }
+}
+
 NameCacheMap::iterator
 Imp<RepositoryNameCache>::find(const PackageNamePart & p) const
 {
@@ -205,18 +299,29 @@ RepositoryNameCache::category_names_containing_package(const PackageNamePart & p
     return result;
 }
 
-void
+RegenerateCacheStatistics
 RepositoryNameCache::regenerate_cache() const
 {
     std::unique_lock<std::mutex> l(_imp->mutex);
 
+    RegenerateCacheStatistics result(make_named_values<RegenerateCacheStatistics>(
+                n::rebuilt() = 0,
+                n::reused() = 0
+                ));
+
     if (_imp->location == FSPath("/var/empty"))
-        return;
+        return result;
 
     Context context("When generating repository names cache at '"
             + stringify(_imp->location) + "':");
 
-    if (_imp->location.stat().is_directory())
+    /* if we know what every category looked like last time, we only need to
+     * look at the ones that have changed since, and only rewrite the files for
+     * packages in those */
+    CategoryStates old_states;
+    bool incremental(_imp->category_timestamps_location && _imp->load_category_states(old_states));
+
+    if ((! incremental) && _imp->location.stat().is_directory())
         for (FSIterator i(_imp->location, { fsio_inode_sort }), i_end ; i != i_end ; ++i)
             i->unlink();
 
@@ -230,18 +335,50 @@ RepositoryNameCache::regenerate_cache() const
     if (_imp->location.mkdir(main_cache_dir_stat.permissions(), { fspmkdo_ok_if_exists }))
         _imp->location.chmod(main_cache_dir_stat.permissions());
 
-    std::unordered_map<std::string, std::string, Hash<std::string> > m;
+    CategoryStates new_states;
+    std::set<std::string> dirty;
 
     std::shared_ptr<const CategoryNamePartSet> cats(_imp->repo->category_names({ }));
     for (const auto & category : *cats)
     {
-        std::shared_ptr<const QualifiedPackageNameSet> pkgs(_imp->repo->package_names(category, { }));
-        for (const auto & qpn : *pkgs)
-            m[stringify(qpn.package())].append(stringify(category) + "\n");
+        CategoryState & state(new_states[stringify(category)]);
+
+        /* look at the timestamp before the contents, so that anything that
+         * changes while we're looking gets picked up next time */
+        if (_imp->category_timestamps_location)
+            state.timestamp = category_timestamp(*_imp->category_timestamps_location / stringify(category));
+
+        auto old_state(old_states.find(stringify(category)));
+        if (old_states.end() != old_state && (! state.timestamp.empty()) && old_state->second.timestamp == state.timestamp)
+        {
+            state.packages = old_state->second.packages;
+            ++result.reused();
+        }
+        else
+        {
+            std::shared_ptr<const QualifiedPackageNameSet> pkgs(_imp->repo->package_names(category, { }));
+            for (const auto & qpn : *pkgs)
+                state.packages.insert(stringify(qpn.package()));
+            ++result.rebuilt();
+
+            /* any package that was or is in here needs its file rewriting */
+            dirty.insert(state.packages.begin(), state.packages.end());
+            if (old_states.end() != old_state)
+                dirty.insert(old_state->second.packages.begin(), old_state->second.packages.end());
+        }
     }
 
-    for (const auto & e : m)
+    for (const auto & c : old_states)
+        if (new_states.end() == new_states.find(c.first))
+            dirty.insert(c.second.packages.begin(), c.second.packages.end());
+
+    PackageFiles new_files(package_files(new_states));
+
+    for (const auto & e : new_files)
     {
+        if (dirty.end() == dirty.find(e.first))
+            continue;
+
         try
         {
             SafeOFStream f(_imp->location / stringify(e.first), -1, true);
@@ -255,6 +392,14 @@ RepositoryNameCache::regenerate_cache() const
         }
     }
 
+    for (const auto & d : dirty)
+        if (new_files.end() == new_files.find(d))
+        {
+            FSPath ff(_imp->location / d);
+            if (ff.stat().exists())
+                ff.unlink();
+        }
+
     try
     {
         SafeOFStream f(_imp->location / "_VERSION_", -1, true);;
@@ -266,6 +411,20 @@ RepositoryNameCache::regenerate_cache() const
         Log::get_instance()->message("repository.names_cache.write_failed", ll_warning, lc_context)
             << "Cannot write to '" << _imp->location << "': '" << e.message() << "' (" << e.what() << ")";
     }
+
+    if (_imp->category_timestamps_location)
+        _imp->save_category_states(new_states);
+
+    _imp->name_cache_map.clear();
+
+    return result;
+}
+
+void
+RepositoryNameCache::use_category_timestamps(const FSPath & l)
+{
+    std::unique_lock<std::mutex> lock(_imp->mutex);
+    _imp->category_timestamps_location = std::make_shared<FSPath>(l);
 }
 
 void
@@ -23,6 +23,7 @@
 #include <paludis/util/pimp.hh>
 #include <paludis/util/fs_path-fwd.hh>
 #include <paludis/name.hh>
+#include <paludis/repository-fwd.hh>
 #include <memory>
 
 /** \file
@@ -88,8 +89,23 @@ namespace paludis
 
             /**
              * Implement cache regeneration.
+             *
+             * \since 3.0 returns statistics
+             */
+            RegenerateCacheStatistics regenerate_cache() const;
+
+            /**
+             * When regenerating, only rescan categories whose directory
+             * under the specified location has been modified since the
+             * last regeneration.
+             *
+             * This is only safe if adding or removing a package always
+             * changes its category directory, as it does for installed
+             * repositories that use a directory per package version.
+             *
+             * \since 3.0
              */
-            void regenerate_cache() const;
+            void use_category_timestamps(const FSPath &);
 
             /**
              * Add a new package to the cache.
@@ -23,6 +23,9 @@
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/set.hh>
 #include <paludis/util/make_named_values.hh>
+#include <paludis/util/fs_path.hh>
+
+#include <paludis/repository.hh>
 
 #include <paludis/environments/test/test_environment.hh>
 #include <paludis/repositories/fake/fake_repository.hh>
@@ -155,3 +158,43 @@ TEST(RepositoryNameCache, Generate)
     EXPECT_TRUE(moo->empty());
 }
 
+
+TEST(RepositoryNameCache, Incremental)
+{
+    TestEnvironment env;
+    const std::shared_ptr<FakeRepository> repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo")
+                    )));
+    env.add_repository(10, repo);
+
+    FSPath categories(FSPath::cwd() / "repository_name_cache_TEST_dir" / "incremental_categories");
+    RepositoryNameCache cache(FSPath("repository_name_cache_TEST_dir/incremental"), repo.get());
+    cache.use_category_timestamps(categories);
+    repo->add_package(QualifiedPackageName("bar/foo"));
+    repo->add_package(QualifiedPackageName("baz/foo"));
+
+    RegenerateCacheStatistics first(cache.regenerate_cache());
+    EXPECT_EQ(2u, first.rebuilt());
+    EXPECT_EQ(0u, first.reused());
+
+    RegenerateCacheStatistics second(cache.regenerate_cache());
+    EXPECT_EQ(0u, second.rebuilt());
+    EXPECT_EQ(2u, second.reused());
+
+    repo->add_package(QualifiedPackageName("baz/moo"));
+    (categories / "baz" / "moo-1").mkdir(0755, { });
+
+    RegenerateCacheStatistics third(cache.regenerate_cache());
+    EXPECT_EQ(1u, third.rebuilt());
+    EXPECT_EQ(1u, third.reused());
+
+    std::shared_ptr<const CategoryNamePartSet> foo(cache.category_names_containing_package(PackageNamePart("foo")));
+    EXPECT_TRUE(cache.usable());
+    ASSERT_TRUE(bool(foo));
+    EXPECT_EQ("bar baz", join(foo->begin(), foo->end(), " "));
+
+    std::shared_ptr<const CategoryNamePartSet> moo(cache.category_names_containing_package(PackageNamePart("moo")));
+    ASSERT_TRUE(bool(moo));
+    EXPECT_EQ("baz", join(moo->begin(), moo->end(), " "));
+}
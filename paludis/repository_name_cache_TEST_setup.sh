@@ -20,3 +20,6 @@ echo "repo" >> good_repo/repo/_VERSION_
 echo "bar" > good_repo/repo/foo
 echo "baz" >> good_repo/repo/foo
 
+
+mkdir -p incremental
+mkdir -p incremental_categories/{bar,baz}
@@ -25,6 +25,7 @@
 #include <paludis/resolver/change_by_resolvent-fwd.hh>
 #include <paludis/package_id-fwd.hh>
 #include <paludis/environment-fwd.hh>
+#include <paludis/name-fwd.hh>
 #include <memory>
 
 namespace paludis
@@ -52,6 +53,18 @@ namespace paludis
                 const Environment * const,
                 const std::shared_ptr<const PackageID> &,
                 const std::shared_ptr<const PackageIDSequence> &) PALUDIS_ATTRIBUTE((warn_unused_result));
+
+        /**
+         * Those of the specified IDs that might depend upon something with
+         * one of the specified names, which is all of them unless their
+         * repository has a RepositoryDependentsInterface.
+         *
+         * \since 3.0
+         */
+        const std::shared_ptr<const PackageIDSequence> possible_dependents(
+                const Environment * const,
+                const std::shared_ptr<const QualifiedPackageNameSet> &,
+                const std::shared_ptr<const PackageIDSequence> &) PALUDIS_ATTRIBUTE((warn_unused_result));
     }
 }
 
@@ -39,9 +39,13 @@
 #include <paludis/version_spec.hh>
 #include <paludis/serialise-impl.hh>
 #include <paludis/slot.hh>
+#include <paludis/repository.hh>
+#include <paludis/name.hh>
 
 #include <algorithm>
 #include <initializer_list>
+#include <map>
+#include <set>
 #include <sstream>
 
 using namespace paludis;
@@ -286,9 +290,12 @@ paludis::resolver::collect_dependents(
     auto going_away_as_ids(std::make_shared<PackageIDSequence>());
     going_away_as_ids->push_back(going_away);
 
+    auto going_away_names(std::make_shared<QualifiedPackageNameSet>());
+    going_away_names->insert(going_away->name());
+
     auto result(std::make_shared<PackageIDSet>());
 
-    for (const auto & id : *installed_ids)
+    for (const auto & id : *possible_dependents(env, going_away_names, installed_ids))
     {
         DependentChecker<PackageIDSequence, PackageIDSequence> c(env, id, going_away_as_ids,
                 std::make_shared<PackageIDSequence>(), std::make_shared<PackageIDSequence>());
@@ -312,6 +319,46 @@ paludis::resolver::collect_dependents(
     return result;
 }
 
+const std::shared_ptr<const PackageIDSequence>
+paludis::resolver::possible_dependents(
+        const Environment * const env,
+        const std::shared_ptr<const QualifiedPackageNameSet> & names,
+        const std::shared_ptr<const PackageIDSequence> & ids)
+{
+    /* for each repository that can tell us, everything it says might depend
+     * upon any of the names */
+    typedef std::set<std::shared_ptr<const PackageID>, PackageIDSetComparator> Candidates;
+    std::map<RepositoryName, std::shared_ptr<Candidates> > candidates_by_repository;
+
+    auto result(std::make_shared<PackageIDSequence>());
+    for (const auto & id : *ids)
+    {
+        auto c(candidates_by_repository.find(id->repository_name()));
+        if (candidates_by_repository.end() == c)
+        {
+            std::shared_ptr<Candidates> candidates;
+
+            auto repository(env->fetch_repository(id->repository_name()));
+            if (repository->dependents_interface())
+            {
+                candidates = std::make_shared<Candidates>();
+                for (const auto & name : *names)
+                {
+                    auto dependents(repository->dependents_interface()->possible_dependents(name));
+                    candidates->insert(dependents->begin(), dependents->end());
+                }
+            }
+
+            c = candidates_by_repository.insert(std::make_pair(id->repository_name(), candidates)).first;
+        }
+
+        if ((! c->second) || c->second->end() != c->second->find(id))
+            result->push_back(id);
+    }
+
+    return result;
+}
+
 void
 DependentPackageID::serialise(Serialiser & s) const
 {
@@ -53,6 +53,7 @@
 #include <paludis/util/tribool.hh>
 #include <paludis/util/log.hh>
 #include <paludis/util/visitor_cast.hh>
+#include <paludis/util/hashes.hh>
 #include <paludis/environment.hh>
 #include <paludis/notifier_callback.hh>
 #include <paludis/repository.hh>
@@ -80,6 +81,8 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace paludis;
 using namespace paludis::resolver;
@@ -213,7 +216,12 @@ Decider::_resolve_dependents()
 
     const std::shared_ptr<const PackageIDSequence> staying(_collect_staying(changing.first));
 
-    for (const auto & package : *staying)
+    /* only things that mention something going away can be dependent upon it */
+    auto going_away_names(std::make_shared<QualifiedPackageNameSet>());
+    for (const auto & c : *changing.first)
+        going_away_names->insert(c.package_id()->name());
+
+    for (const auto & package : *possible_dependents(_imp->env, going_away_names, staying))
     {
         _imp->env->trigger_notifier_callback(NotifierCallbackResolverStepEvent());
 
@@ -1970,6 +1978,107 @@ Decider::resolve()
     _resolve_confirmations();
 }
 
+namespace
+{
+    typedef std::unordered_set<Resolvent, Hash<Resolvent> > ResolventsSet;
+
+    std::shared_ptr<const Resolvent> constraint_source(const Constraint & constraint)
+    {
+        return constraint.reason()->make_accept_returning(
+                [&] (const TargetReason &)                     { return std::shared_ptr<const Resolvent>(); },
+                [&] (const DependencyReason & r)               { return std::make_shared<const Resolvent>(r.from_resolvent()); },
+                [&] (const DependentReason &)                  { return std::shared_ptr<const Resolvent>(); },
+                [&] (const WasUsedByReason &)                  { return std::shared_ptr<const Resolvent>(); },
+                [&] (const PresetReason &)                     { return std::shared_ptr<const Resolvent>(); },
+                [&] (const SetReason &)                        { return std::shared_ptr<const Resolvent>(); },
+                [&] (const LikeOtherDestinationTypeReason & r) { return std::make_shared<const Resolvent>(r.other_resolvent()); },
+                [&] (const ViaBinaryReason & r)                { return std::make_shared<const Resolvent>(r.other_resolvent()); }
+                );
+    }
+}
+
+bool
+Decider::restart_from(const SuggestRestart & e)
+{
+    Context context("When working out what to keep when restarting because of '" + stringify(e.resolvent()) + "':");
+
+    /* the restart happened part way through adding the dependencies of
+     * something. if it happened anywhere else, we don't know what was left
+     * half done. */
+    auto dependency_reason(visitor_cast<const DependencyReason>(*e.problematic_constraint()->reason()));
+    if (! dependency_reason)
+        return false;
+
+    /* dependents and purges are worked out from everything that is changing,
+     * not from any one resolution, so anything could have affected them */
+    std::unordered_map<Resolvent, std::list<Resolvent>, Hash<Resolvent> > constrained_by;
+    for (const auto & resolution : *_imp->resolutions_by_resolvent)
+        for (const auto & constraint : *resolution->constraints())
+        {
+            if (visitor_cast<const DependentReason>(*constraint->reason()) || visitor_cast<const WasUsedByReason>(*constraint->reason()))
+                return false;
+
+            auto source(constraint_source(*constraint));
+            if (source)
+                constrained_by[*source].push_back(resolution->resolvent());
+        }
+
+    /* throw away the bad decision, the half done one, and everything that was
+     * constrained by anything we're throwing away */
+    ResolventsSet discard;
+    std::list<Resolvent> todo{ e.resolvent(), dependency_reason->from_resolvent() };
+    while (! todo.empty())
+    {
+        Resolvent r(todo.front());
+        todo.pop_front();
+
+        if (! discard.insert(r).second)
+            continue;
+
+        auto c(constrained_by.find(r));
+        if (c != constrained_by.end())
+            std::copy(c->second.begin(), c->second.end(), std::back_inserter(todo));
+    }
+
+    std::list<std::shared_ptr<Resolution> > keep;
+    for (const auto & resolution : *_imp->resolutions_by_resolvent)
+    {
+        if (discard.end() == discard.find(resolution->resolvent()))
+        {
+            keep.push_back(resolution);
+            continue;
+        }
+
+        /* start again from the initial constraints, which now include the
+         * suggested preset, plus anything from things we're keeping. if there
+         * isn't anything, we'll only need it again if something we're
+         * redoing asks for it. */
+        const std::shared_ptr<Resolution> redo(_create_resolution_for_resolvent(resolution->resolvent()));
+        bool wanted(false);
+        for (const auto & constraint : *resolution->constraints())
+        {
+            if (visitor_cast<const PresetReason>(*constraint->reason()))
+                continue;
+
+            auto source(constraint_source(*constraint));
+            if (source && discard.end() != discard.find(*source))
+                continue;
+
+            redo->constraints()->add(constraint);
+            wanted = true;
+        }
+
+        if (wanted)
+            keep.push_back(redo);
+    }
+
+    _imp->resolutions_by_resolvent->clear();
+    for (const auto & resolution : keep)
+        _imp->resolutions_by_resolvent->insert_new(resolution);
+
+    return true;
+}
+
 bool
 Decider::_package_dep_spec_already_met(const PackageDepSpec & spec, const std::shared_ptr<const PackageID> & from_id) const
 {
@@ -38,6 +38,7 @@
 #include <paludis/resolver/resolutions_by_resolvent-fwd.hh>
 #include <paludis/resolver/change_by_resolvent-fwd.hh>
 #include <paludis/resolver/why_changed_choices-fwd.hh>
+#include <paludis/resolver/suggest_restart-fwd.hh>
 #include <paludis/util/attributes.hh>
 #include <paludis/util/pimp.hh>
 #include <paludis/util/tribool-fwd.hh>
@@ -243,6 +244,17 @@ namespace paludis
 
                 void purge();
 
+                /**
+                 * After resolve() throws SuggestRestart, throw away only the
+                 * resolutions that could have been affected by the bad
+                 * decision, so that resolve() can be called again without
+                 * starting from scratch.
+                 *
+                 * Returns false, having changed nothing, if we can't tell what
+                 * was affected, in which case the caller must start again.
+                 */
+                bool restart_from(const SuggestRestart &) PALUDIS_ATTRIBUTE((warn_unused_result));
+
                 std::pair<AnyChildScore, OperatorScore> find_any_score(
                         const std::shared_ptr<const Resolution> &,
                         const std::shared_ptr<const PackageID> &,
@@ -33,6 +33,7 @@
 #include <paludis/util/hashes.hh>
 #include <paludis/util/timestamp.hh>
 #include <paludis/util/enum_iterator.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/dep_spec.hh>
 #include <paludis/package_id.hh>
 #include <paludis/selection.hh>
@@ -137,7 +138,12 @@ GetInitialConstraintsForHelper::operator() (const Resolvent & resolvent) const
     auto i(_imp->initial_constraints.find(resolvent));
     if (i == _imp->initial_constraints.end())
         return _make_initial_constraints_for(resolvent);
-    return i->second;
+
+    /* the resolution adds to what we return, so it mustn't be our copy */
+    auto result(std::make_shared<Constraints>());
+    for (const auto & constraint : *i->second)
+        result->add(constraint);
+    return result;
 }
 
 namespace
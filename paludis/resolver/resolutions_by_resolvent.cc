@@ -94,6 +94,13 @@ ResolutionsByResolvent::insert_new(const std::shared_ptr<Resolution> & r)
     return ConstIterator(i);
 }
 
+void
+ResolutionsByResolvent::clear()
+{
+    _imp->resolution_list_index.clear();
+    _imp->resolution_list.clear();
+}
+
 void
 ResolutionsByResolvent::serialise(Serialiser & s) const
 {
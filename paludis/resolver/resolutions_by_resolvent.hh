@@ -49,6 +49,8 @@ namespace paludis
 
                 ConstIterator insert_new(const std::shared_ptr<Resolution> &);
 
+                void clear();
+
                 void serialise(Serialiser &) const;
 
                 static const std::shared_ptr<ResolutionsByResolvent> deserialise(
@@ -165,6 +165,12 @@ Resolver::purge()
     _imp->decider->purge();
 }
 
+bool
+Resolver::restart_from(const SuggestRestart & e)
+{
+    return _imp->decider->restart_from(e);
+}
+
 void
 Resolver::resolve()
 {
@@ -27,6 +27,7 @@
 #include <paludis/resolver/resolved-fwd.hh>
 #include <paludis/resolver/sanitised_dependencies-fwd.hh>
 #include <paludis/resolver/package_or_block_dep_spec-fwd.hh>
+#include <paludis/resolver/suggest_restart-fwd.hh>
 #include <paludis/util/pimp.hh>
 #include <paludis/package_id-fwd.hh>
 #include <paludis/dep_spec-fwd.hh>
@@ -59,6 +60,16 @@ namespace paludis
 
                 void resolve();
 
+                /**
+                 * Carry on after resolve() throws SuggestRestart, keeping any
+                 * decisions it couldn't have affected. The suggested preset
+                 * must already have been added to the initial constraints.
+                 *
+                 * If this returns false, a new Resolver must be used, and
+                 * targets must be added again.
+                 */
+                bool restart_from(const SuggestRestart &) PALUDIS_ATTRIBUTE((warn_unused_result));
+
                 const std::shared_ptr<const Resolved> resolved() const PALUDIS_ATTRIBUTE((warn_unused_result));
         };
     }
@@ -0,0 +1,632 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/resolver/resolver.hh>
+#include <paludis/resolver/resolver_functions.hh>
+#include <paludis/resolver/resolved.hh>
+#include <paludis/resolver/decisions.hh>
+#include <paludis/resolver/decision.hh>
+#include <paludis/resolver/suggest_restart.hh>
+#include <paludis/resolver/package_or_block_dep_spec.hh>
+#include <paludis/resolver/allow_choice_changes_helper.hh>
+#include <paludis/resolver/allowed_to_remove_helper.hh>
+#include <paludis/resolver/allowed_to_restart_helper.hh>
+#include <paludis/resolver/always_via_binary_helper.hh>
+#include <paludis/resolver/can_use_helper.hh>
+#include <paludis/resolver/confirm_helper.hh>
+#include <paludis/resolver/find_replacing_helper.hh>
+#include <paludis/resolver/find_repository_for_helper.hh>
+#include <paludis/resolver/get_constraints_for_dependent_helper.hh>
+#include <paludis/resolver/get_constraints_for_purge_helper.hh>
+#include <paludis/resolver/get_constraints_for_via_binary_helper.hh>
+#include <paludis/resolver/get_destination_types_for_blocker_helper.hh>
+#include <paludis/resolver/get_destination_types_for_error_helper.hh>
+#include <paludis/resolver/get_initial_constraints_for_helper.hh>
+#include <paludis/resolver/get_resolvents_for_helper.hh>
+#include <paludis/resolver/get_use_existing_nothing_helper.hh>
+#include <paludis/resolver/interest_in_spec_helper.hh>
+#include <paludis/resolver/make_destination_filtered_generator_helper.hh>
+#include <paludis/resolver/make_origin_filtered_generator_helper.hh>
+#include <paludis/resolver/make_unmaskable_filter_helper.hh>
+#include <paludis/resolver/order_early_helper.hh>
+#include <paludis/resolver/prefer_or_avoid_helper.hh>
+#include <paludis/resolver/promote_binaries_helper.hh>
+#include <paludis/resolver/remove_hidden_helper.hh>
+#include <paludis/resolver/remove_if_dependent_helper.hh>
+
+#include <paludis/repositories/fake/fake_repository.hh>
+#include <paludis/repositories/fake/fake_installed_repository.hh>
+#include <paludis/repositories/fake/fake_package_id.hh>
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/util/exception.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/sequence.hh>
+#include <paludis/util/visitor_cast.hh>
+#include <paludis/util/wrapped_forward_iterator-impl.hh>
+
+#include <paludis/action.hh>
+#include <paludis/filter.hh>
+#include <paludis/filtered_generator.hh>
+#include <paludis/generator.hh>
+#include <paludis/notifier_callback.hh>
+#include <paludis/selection.hh>
+#include <paludis/user_dep_spec.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+using namespace paludis::resolver;
+
+/*
+ * Times the resolver, the orderer and common selections against a
+ * synthetic tree held in fake repositories. The size and shape of the tree
+ * can be set on the command line, for example:
+ *
+ *     resolver_BENCHMARK --packages 100000 --fan-out 6 --any-depth 3 --format json
+ *
+ * With no arguments a small tree is used, so that the benchmark is cheap to
+ * run from ctest.
+ */
+
+namespace
+{
+    struct TreeShape
+    {
+        unsigned packages = 1000;
+        unsigned fan_out = 4;
+        unsigned slotted = 10;
+        unsigned any_depth = 1;
+        unsigned cycles = 5;
+        unsigned installed = 30;
+        unsigned targets = 5;
+        unsigned repeat = 3;
+        unsigned seed = 42;
+        bool json = false;
+    };
+
+    struct Result
+    {
+        std::string name;
+        unsigned long operations;
+        double milliseconds;
+    };
+
+    void usage(std::ostream & s)
+    {
+        s << "Usage: resolver_BENCHMARK [options]" << std::endl
+            << "    --packages N     number of packages in the tree (default 1000)" << std::endl
+            << "    --fan-out N      dependencies per package (default 4)" << std::endl
+            << "    --slotted N      percentage of packages with several slots and subslots (default 10)" << std::endl
+            << "    --any-depth N    nesting depth of a || ( ) group in each package, 0 for none (default 1)" << std::endl
+            << "    --cycles N       percentage of packages with a run dependency back up the tree (default 5)" << std::endl
+            << "    --installed N    percentage of packages with an older version installed (default 30)" << std::endl
+            << "    --targets N      number of packages to resolve at once (default 5)" << std::endl
+            << "    --repeat N       number of times to run each resolution, keeping the fastest (default 3)" << std::endl
+            << "    --seed N         seed for the tree generator (default 42)" << std::endl
+            << "    --format F       text or json (default text)" << std::endl;
+    }
+
+    bool parse_arguments(int argc, char * argv[], TreeShape & shape)
+    {
+        const std::pair<const char *, unsigned *> numbers[] = {
+            { "--packages", &shape.packages },
+            { "--fan-out", &shape.fan_out },
+            { "--slotted", &shape.slotted },
+            { "--any-depth", &shape.any_depth },
+            { "--cycles", &shape.cycles },
+            { "--installed", &shape.installed },
+            { "--targets", &shape.targets },
+            { "--repeat", &shape.repeat },
+            { "--seed", &shape.seed }
+        };
+
+        for (int a(1) ; a < argc ; a += 2)
+        {
+            if (a + 1 >= argc)
+                return false;
+
+            if (0 == std::strcmp(argv[a], "--format"))
+            {
+                if (0 == std::strcmp(argv[a + 1], "json"))
+                    shape.json = true;
+                else if (0 != std::strcmp(argv[a + 1], "text"))
+                    return false;
+                continue;
+            }
+
+            bool found(false);
+            for (const auto & n : numbers)
+                if (0 == std::strcmp(argv[a], n.first))
+                {
+                    char * end(nullptr);
+                    *n.second = std::strtoul(argv[a + 1], &end, 10);
+                    if (*end)
+                        return false;
+                    found = true;
+                }
+
+            if (! found)
+                return false;
+        }
+
+        return shape.packages >= 2 && shape.repeat >= 1 && shape.slotted <= 100 && shape.cycles <= 100 && shape.installed <= 100;
+    }
+
+    std::string package_name(const unsigned i)
+    {
+        return "cat-" + stringify(i / 100) + "/pkg-" + stringify(i);
+    }
+
+    /* The tree is a DAG, with package i only depending upon packages after
+     * it, plus optional back edges in run dependencies to make cycles. Every
+     * package has two versions; slotted packages have a third, and each of
+     * their versions sits in its own slot and subslot. */
+    class Tree
+    {
+        private:
+            const TreeShape & _shape;
+            std::mt19937 _random;
+            std::vector<bool> _slotted;
+
+            unsigned _pick_after(const unsigned i)
+            {
+                return i + 1 + _random() % (_shape.packages - i - 1);
+            }
+
+            std::string _atom(const unsigned j)
+            {
+                if (_slotted[j])
+                    switch (_random() % 3)
+                    {
+                        case 0:
+                            return package_name(j) + ":2";
+                        case 1:
+                            return package_name(j) + ":=";
+                        default:
+                            return ">=" + package_name(j) + "-2";
+                    }
+                return ">=" + package_name(j) + "-1";
+            }
+
+            std::string _any(const unsigned i, const unsigned depth)
+            {
+                std::string result("|| ( " + _atom(_pick_after(i)) + " ");
+                if (depth > 1)
+                    result.append(_any(i, depth - 1));
+                else
+                    result.append(_atom(_pick_after(i)));
+                return result + " )";
+            }
+
+        public:
+            Tree(const TreeShape & s) :
+                _shape(s),
+                _random(s.seed),
+                _slotted(s.packages, false)
+            {
+                for (unsigned i(0) ; i < _shape.packages ; ++i)
+                    _slotted[i] = (_random() % 100) < _shape.slotted;
+            }
+
+            bool slotted(const unsigned i) const
+            {
+                return _slotted[i];
+            }
+
+            std::string build_dependencies(const unsigned i)
+            {
+                std::string result;
+                const unsigned remaining(_shape.packages - i - 1);
+                if (0 == remaining)
+                    return result;
+
+                unsigned n(std::min(_shape.fan_out, remaining));
+                if (n > 0 && _shape.any_depth > 0 && remaining >= 2)
+                {
+                    result.append(_any(i, _shape.any_depth));
+                    --n;
+                }
+
+                for ( ; n > 0 ; --n)
+                    result.append(" " + _atom(_pick_after(i)));
+
+                return result;
+            }
+
+            std::string run_dependencies(const unsigned i, const std::string & build)
+            {
+                if (i > 0 && (_random() % 100) < _shape.cycles)
+                    return build + " " + package_name(_random() % i);
+                return build;
+            }
+
+            bool installed(const unsigned)
+            {
+                return (_random() % 100) < _shape.installed;
+            }
+    };
+
+    struct BenchmarkData
+    {
+        TestEnvironment env;
+        std::shared_ptr<FakeRepository> repo;
+        std::shared_ptr<FakeInstalledRepository> inst_repo;
+
+        AllowChoiceChangesHelper allow_choice_changes_helper;
+        AllowedToRemoveHelper allowed_to_remove_helper;
+        AllowedToRestartHelper allowed_to_restart_helper;
+        AlwaysViaBinaryHelper always_via_binary_helper;
+        CanUseHelper can_use_helper;
+        ConfirmHelper confirm_helper;
+        FindReplacingHelper find_replacing_helper;
+        FindRepositoryForHelper find_repository_for_helper;
+        GetConstraintsForDependentHelper get_constraints_for_dependent_helper;
+        GetConstraintsForPurgeHelper get_constraints_for_purge_helper;
+        GetConstraintsForViaBinaryHelper get_constraints_for_via_binary_helper;
+        GetDestinationTypesForBlockerHelper get_destination_types_for_blocker_helper;
+        GetDestinationTypesForErrorHelper get_destination_types_for_error_helper;
+        GetInitialConstraintsForHelper get_initial_constraints_for_helper;
+        GetUseExistingNothingHelper get_use_existing_nothing_helper;
+        InterestInSpecHelper interest_in_spec_helper;
+        MakeDestinationFilteredGeneratorHelper make_destination_filtered_generator_helper;
+        MakeOriginFilteredGeneratorHelper make_origin_filtered_generator_helper;
+        MakeUnmaskableFilterHelper make_unmaskable_filter_helper;
+        OrderEarlyHelper order_early_helper;
+        PreferOrAvoidHelper prefer_or_avoid_helper;
+        PromoteBinariesHelper promote_binaries_helper;
+        RemoveHiddenHelper remove_hidden_helper;
+        RemoveIfDependentHelper remove_if_dependent_helper;
+        GetResolventsForHelper get_resolvents_for_helper;
+
+        BenchmarkData() :
+            repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                            n::environment() = &env,
+                            n::name() = RepositoryName("repo")
+                            ))),
+            inst_repo(std::make_shared<FakeInstalledRepository>(make_named_values<FakeInstalledRepositoryParams>(
+                            n::environment() = &env,
+                            n::name() = RepositoryName("installed"),
+                            n::suitable_destination() = true,
+                            n::supports_uninstall() = true
+                            ))),
+            allow_choice_changes_helper(&env),
+            allowed_to_remove_helper(&env),
+            allowed_to_restart_helper(&env),
+            always_via_binary_helper(&env),
+            can_use_helper(&env),
+            confirm_helper(&env),
+            find_replacing_helper(&env),
+            find_repository_for_helper(&env),
+            get_constraints_for_dependent_helper(&env),
+            get_constraints_for_purge_helper(&env),
+            get_constraints_for_via_binary_helper(&env),
+            get_destination_types_for_blocker_helper(&env),
+            get_destination_types_for_error_helper(&env),
+            get_initial_constraints_for_helper(&env),
+            get_use_existing_nothing_helper(&env),
+            interest_in_spec_helper(&env),
+            make_destination_filtered_generator_helper(&env),
+            make_origin_filtered_generator_helper(&env),
+            make_unmaskable_filter_helper(&env),
+            order_early_helper(&env),
+            prefer_or_avoid_helper(&env),
+            promote_binaries_helper(&env),
+            remove_hidden_helper(&env),
+            remove_if_dependent_helper(&env),
+            get_resolvents_for_helper(&env, std::cref(remove_hidden_helper))
+        {
+            env.add_repository(1, repo);
+            env.add_repository(2, inst_repo);
+
+            interest_in_spec_helper.set_follow_installed_dependencies(true);
+            interest_in_spec_helper.set_follow_installed_build_dependencies(true);
+            make_unmaskable_filter_helper.set_override_masks(false);
+        }
+
+        ResolverFunctions get_resolver_functions()
+        {
+            return make_named_values<ResolverFunctions>(
+                    n::allow_choice_changes_fn() = std::cref(allow_choice_changes_helper),
+                    n::allowed_to_remove_fn() = std::cref(allowed_to_remove_helper),
+                    n::allowed_to_restart_fn() = std::cref(allowed_to_restart_helper),
+                    n::always_via_binary_fn() = std::cref(always_via_binary_helper),
+                    n::can_use_fn() = std::cref(can_use_helper),
+                    n::confirm_fn() = std::cref(confirm_helper),
+                    n::find_replacing_fn() = std::cref(find_replacing_helper),
+                    n::find_repository_for_fn() = std::cref(find_repository_for_helper),
+                    n::get_constraints_for_dependent_fn() = std::cref(get_constraints_for_dependent_helper),
+                    n::get_constraints_for_purge_fn() = std::cref(get_constraints_for_purge_helper),
+                    n::get_constraints_for_via_binary_fn() = std::cref(get_constraints_for_via_binary_helper),
+                    n::get_destination_types_for_blocker_fn() = std::cref(get_destination_types_for_blocker_helper),
+                    n::get_destination_types_for_error_fn() = std::cref(get_destination_types_for_error_helper),
+                    n::get_initial_constraints_for_fn() = std::cref(get_initial_constraints_for_helper),
+                    n::get_resolvents_for_fn() = std::cref(get_resolvents_for_helper),
+                    n::get_use_existing_nothing_fn() = std::cref(get_use_existing_nothing_helper),
+                    n::interest_in_spec_fn() = std::cref(interest_in_spec_helper),
+                    n::make_destination_filtered_generator_fn() = std::cref(make_destination_filtered_generator_helper),
+                    n::make_origin_filtered_generator_fn() = std::cref(make_origin_filtered_generator_helper),
+                    n::make_unmaskable_filter_fn() = std::cref(make_unmaskable_filter_helper),
+                    n::order_early_fn() = std::cref(order_early_helper),
+                    n::prefer_or_avoid_fn() = std::cref(prefer_or_avoid_helper),
+                    n::promote_binaries_fn() = std::cref(promote_binaries_helper),
+                    n::remove_hidden_fn() = std::cref(remove_hidden_helper),
+                    n::remove_if_dependent_fn() = std::cref(remove_if_dependent_helper)
+                    );
+        }
+    };
+
+    template <typename F_>
+    double milliseconds(const F_ & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    unsigned long populate(BenchmarkData & data, const TreeShape & shape)
+    {
+        Tree tree(shape);
+        unsigned long ids(0);
+
+        for (unsigned i(0) ; i < shape.packages ; ++i)
+        {
+            const std::string name(package_name(i));
+            const std::string::size_type slash(name.find('/'));
+            const std::string build(tree.build_dependencies(i));
+            const std::string run(tree.run_dependencies(i, build));
+
+            std::vector<std::pair<std::string, std::shared_ptr<FakePackageID> > > versions;
+            for (const auto & v : { "1", "2" })
+                versions.push_back(std::make_pair(v, data.repo->add_version(name.substr(0, slash), name.substr(slash + 1), v)));
+            if (tree.slotted(i))
+            {
+                versions.push_back(std::make_pair("2.1", data.repo->add_version(name.substr(0, slash), name.substr(slash + 1), "2.1")));
+                versions.at(0).second->set_slot(SlotName("1"), SlotName("1"));
+                versions.at(1).second->set_slot(SlotName("2"), SlotName("2.0"));
+                versions.at(2).second->set_slot(SlotName("2"), SlotName("2.1"));
+            }
+
+            for (const auto & v : versions)
+            {
+                v.second->build_dependencies_key()->set_from_string(build);
+                v.second->run_dependencies_key()->set_from_string(run);
+                ++ids;
+            }
+
+            if (tree.installed(i))
+            {
+                auto id(data.inst_repo->add_version(name.substr(0, slash), name.substr(slash + 1), "1"));
+                if (tree.slotted(i))
+                    id->set_slot(SlotName("1"), SlotName("1"));
+                id->run_dependencies_key()->set_from_string(run);
+                ++ids;
+            }
+        }
+
+        return ids;
+    }
+
+    struct StageTimes
+    {
+        std::chrono::steady_clock::time_point start, ordering, done;
+    };
+
+    /* the decider and orderer run back to back inside Resolver::resolve, so
+     * we tell them apart using the stage notifications */
+    void stage_notified(StageTimes & times, const NotifierCallbackEvent & event)
+    {
+        auto stage(visitor_cast<const NotifierCallbackResolverStageEvent>(event));
+        if (! stage)
+            return;
+
+        if (stage->stage() == "Nodifying Decisions")
+            times.ordering = std::chrono::steady_clock::now();
+        else if (stage->stage() == "Done")
+            times.done = std::chrono::steady_clock::now();
+    }
+
+    std::shared_ptr<const Resolved> resolve(BenchmarkData & data, const TreeShape & shape,
+            double & decide_ms, double & order_ms, unsigned & restarts)
+    {
+        StageTimes times;
+        auto callback(data.env.add_notifier_callback(std::bind(&stage_notified, std::ref(times), std::placeholders::_1)));
+
+        std::shared_ptr<Resolver> resolver;
+        std::shared_ptr<const Resolved> result;
+        restarts = 0;
+        times.start = std::chrono::steady_clock::now();
+        while (! result)
+        {
+            try
+            {
+                if (! resolver)
+                {
+                    resolver = std::make_shared<Resolver>(&data.env, data.get_resolver_functions());
+                    for (unsigned i(0) ; i < std::min(shape.targets, shape.packages) ; ++i)
+                        resolver->add_target(PackageOrBlockDepSpec(parse_user_package_dep_spec(package_name(i), &data.env, { })), "");
+                }
+                resolver->resolve();
+                result = resolver->resolved();
+            }
+            catch (const SuggestRestart & e)
+            {
+                ++restarts;
+                data.get_initial_constraints_for_helper.add_suggested_restart(e);
+                if (! resolver->restart_from(e))
+                    resolver = nullptr;
+            }
+        }
+
+        data.env.remove_notifier_callback(callback);
+
+        decide_ms = std::chrono::duration<double, std::milli>(times.ordering - times.start).count();
+        order_ms = std::chrono::duration<double, std::milli>(times.done - times.ordering).count();
+        return result;
+    }
+
+    void selections(BenchmarkData & data, const TreeShape & shape, std::vector<Result> & results)
+    {
+        std::vector<QualifiedPackageName> names;
+        for (unsigned i(0) ; i < shape.packages ; ++i)
+            names.push_back(QualifiedPackageName(package_name(i)));
+
+        std::vector<PackageDepSpec> specs;
+        for (unsigned i(0) ; i < shape.packages ; i += std::max(1u, shape.packages / 1000))
+            specs.push_back(parse_user_package_dep_spec(">=" + package_name(i) + "-2", &data.env, { }));
+
+        unsigned long found(0);
+        results.push_back(Result{"selection_best_version_of_package", names.size(), milliseconds([&] () {
+                        for (const auto & q : names)
+                            found += data.env[selection::BestVersionOnly(generator::Package(q))]->size();
+                        })});
+
+        results.push_back(Result{"selection_matches_installable", specs.size(), milliseconds([&] () {
+                        for (const auto & s : specs)
+                            found += data.env[selection::AllVersionsSorted(generator::Matches(s, nullptr, { }) |
+                                    filter::SupportsAction<InstallAction>())]->size();
+                        })});
+
+        results.push_back(Result{"selection_all_versions_sorted", 1, milliseconds([&] () {
+                        found += data.env[selection::AllVersionsSorted(generator::All())]->size();
+                        })});
+
+        results.push_back(Result{"selection_installed_at_root", 1, milliseconds([&] () {
+                        found += data.env[selection::AllVersionsGroupedBySlot(generator::All() |
+                                    filter::InstalledAtRoot(FSPath("/")))]->size();
+                        })});
+
+        if (0 == found)
+            throw InternalError(PALUDIS_HERE, "selections found nothing");
+    }
+
+    template <typename Decisions_>
+    unsigned long count(const Decisions_ & decisions)
+    {
+        return std::distance(decisions.begin(), decisions.end());
+    }
+
+    void write_text(const TreeShape & shape, const unsigned long ids, const std::vector<Result> & results,
+            const std::vector<std::pair<std::string, unsigned long> > & counts)
+    {
+        std::cout << std::fixed << std::setprecision(3)
+            << shape.packages << " packages, " << ids << " IDs, fan-out " << shape.fan_out
+            << ", || depth " << shape.any_depth << ", " << shape.slotted << "% slotted, "
+            << shape.cycles << "% back edges:" << std::endl;
+
+        for (const auto & r : results)
+        {
+            std::cout << "    " << std::left << std::setw(40) << (r.name + ":") << std::right << r.milliseconds << "ms";
+            if (r.operations > 1)
+                std::cout << ", " << r.milliseconds * 1000.0 / r.operations << "us each";
+            std::cout << std::endl;
+        }
+
+        for (const auto & c : counts)
+            std::cout << "    " << std::left << std::setw(40) << (c.first + ":") << std::right << c.second << std::endl;
+    }
+
+    void write_json(const TreeShape & shape, const unsigned long ids, const std::vector<Result> & results,
+            const std::vector<std::pair<std::string, unsigned long> > & counts)
+    {
+        std::cout << std::fixed << std::setprecision(3)
+            << "{\"benchmark\":\"resolver\",\"shape\":{"
+            << "\"packages\":" << shape.packages << ",\"ids\":" << ids << ",\"fan_out\":" << shape.fan_out
+            << ",\"slotted\":" << shape.slotted << ",\"any_depth\":" << shape.any_depth
+            << ",\"cycles\":" << shape.cycles << ",\"installed\":" << shape.installed
+            << ",\"targets\":" << shape.targets << ",\"seed\":" << shape.seed << "},\"results\":[";
+
+        bool first(true);
+        for (const auto & r : results)
+        {
+            std::cout << (first ? "" : ",") << "{\"name\":\"" << r.name << "\",\"operations\":" << r.operations
+                << ",\"ms\":" << r.milliseconds << "}";
+            first = false;
+        }
+
+        std::cout << "],\"counts\":{";
+        first = true;
+        for (const auto & c : counts)
+        {
+            std::cout << (first ? "" : ",") << "\"" << c.first << "\":" << c.second;
+            first = false;
+        }
+        std::cout << "}}" << std::endl;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    TreeShape shape;
+    if (! parse_arguments(argc, argv, shape))
+    {
+        usage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    BenchmarkData data;
+    std::vector<Result> results;
+    std::vector<std::pair<std::string, unsigned long> > counts;
+
+    unsigned long ids(0);
+    results.push_back(Result{"generate_tree", shape.packages, milliseconds([&] () { ids = populate(data, shape); })});
+
+    selections(data, shape, results);
+
+    double best_decide(0), best_order(0);
+    std::shared_ptr<const Resolved> resolved;
+    unsigned restarts(0);
+    for (unsigned r(0) ; r < shape.repeat ; ++r)
+    {
+        double decide_ms, order_ms;
+        resolved = resolve(data, shape, decide_ms, order_ms, restarts);
+        if (0 == r || decide_ms + order_ms < best_decide + best_order)
+        {
+            best_decide = decide_ms;
+            best_order = order_ms;
+        }
+    }
+
+    results.push_back(Result{"resolve_decide", 1, best_decide});
+    results.push_back(Result{"resolve_order", 1, best_order});
+
+    counts.push_back(std::make_pair("restarts", restarts));
+    counts.push_back(std::make_pair("taken_change_or_remove_decisions", count(*resolved->taken_change_or_remove_decisions())));
+    counts.push_back(std::make_pair("taken_unable_to_make_decisions", count(*resolved->taken_unable_to_make_decisions())));
+    counts.push_back(std::make_pair("taken_unorderable_decisions", count(*resolved->taken_unorderable_decisions())));
+
+    if (resolved->taken_change_or_remove_decisions()->empty())
+        throw InternalError(PALUDIS_HERE, "resolution decided nothing");
+
+    if (shape.json)
+        write_json(shape, ids, results, counts);
+    else
+        write_text(shape, ids, results, counts);
+
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,9 @@
 #include <paludis/resolver/constraint.hh>
 #include <paludis/resolver/resolvent.hh>
 #include <paludis/resolver/suggest_restart.hh>
+#include <paludis/resolver/resolutions_by_resolvent.hh>
+#include <paludis/resolver/resolved.hh>
+#include <paludis/resolver/decision_utils.hh>
 
 #include <paludis/environments/test/test_environment.hh>
 
@@ -34,8 +37,11 @@
 #include <paludis/util/map.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/make_shared_copy.hh>
+#include <paludis/util/stringify.hh>
 
 #include <paludis/user_dep_spec.hh>
+#include <paludis/package_id.hh>
+#include <paludis/version_spec.hh>
 #include <paludis/repository_factory.hh>
 
 #include <paludis/resolver/resolver_test.hh>
@@ -159,3 +165,35 @@ TEST_F(ResolverSimpleTestCase, PostDeps)
             );
 }
 
+
+TEST_F(ResolverSimpleTestCase, Restart)
+{
+    std::shared_ptr<const Resolved> resolved(data->get_resolved("restart/target"));
+
+    this->check_resolved(resolved,
+            n::taken_change_or_remove_decisions() = make_shared_copy(DecisionChecks()
+                .change(QualifiedPackageName("restart/a-dep"))
+                .change(QualifiedPackageName("restart/c-dep"))
+                .change(QualifiedPackageName("restart/b-dep"))
+                .change(QualifiedPackageName("restart/z-dep"))
+                .change(QualifiedPackageName("restart/target"))
+                .finished()),
+            n::taken_unable_to_make_decisions() = make_shared_copy(DecisionChecks()
+                .finished()),
+            n::taken_unconfirmed_decisions() = make_shared_copy(DecisionChecks()
+                .change(QualifiedPackageName("restart/a-dep"))
+                .finished()),
+            n::taken_unorderable_decisions() = make_shared_copy(DecisionChecks()
+                .finished()),
+            n::untaken_change_or_remove_decisions() = make_shared_copy(DecisionChecks()
+                .finished()),
+            n::untaken_unable_to_make_decisions() = make_shared_copy(DecisionChecks()
+                .finished())
+            );
+
+    auto a_dep(resolved->resolutions_by_resolvent()->find(Resolvent(QualifiedPackageName("restart/a-dep"), SlotName("0"), dt_install_to_slash)));
+    ASSERT_TRUE(a_dep != resolved->resolutions_by_resolvent()->end());
+    auto id(get_decided_id_or_null((*a_dep)->decision()));
+    ASSERT_TRUE(bool(id));
+    EXPECT_EQ("1", stringify(id->version()));
+}
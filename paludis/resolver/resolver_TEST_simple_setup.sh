@@ -130,5 +130,55 @@ SLOT="0"
 DEPENDENCIES=""
 END
 
+# restart
+echo 'restart' >> metadata/categories.conf
+
+mkdir -p 'packages/restart/target'
+cat <<END > packages/restart/target/target-1.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES="build: restart/a-dep restart/b-dep restart/z-dep"
+END
+
+mkdir -p 'packages/restart/a-dep'
+cat <<END > packages/restart/a-dep/a-dep-1.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES=""
+END
+
+cat <<END > packages/restart/a-dep/a-dep-2.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES=""
+END
+
+mkdir -p 'packages/restart/b-dep'
+cat <<END > packages/restart/b-dep/b-dep-1.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES="build: restart/c-dep"
+END
+
+mkdir -p 'packages/restart/c-dep'
+cat <<END > packages/restart/c-dep/c-dep-1.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES=""
+END
+
+mkdir -p 'packages/restart/z-dep'
+cat <<END > packages/restart/z-dep/z-dep-1.exheres-0
+SUMMARY="target"
+PLATFORMS="test"
+SLOT="0"
+DEPENDENCIES="build: restart/a-dep[<2]"
+END
+
 cd ..
 
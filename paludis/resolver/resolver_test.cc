@@ -197,18 +197,24 @@ ResolverTestData::get_resolver_functions()
 const std::shared_ptr<const Resolved>
 ResolverTestData::get_resolved(const PackageOrBlockDepSpec & target)
 {
+    std::shared_ptr<Resolver> resolver;
     while (true)
     {
         try
         {
-            Resolver resolver(&env, get_resolver_functions());
-            resolver.add_target(target, "");
-            resolver.resolve();
-            return resolver.resolved();
+            if (! resolver)
+            {
+                resolver = std::make_shared<Resolver>(&env, get_resolver_functions());
+                resolver->add_target(target, "");
+            }
+            resolver->resolve();
+            return resolver->resolved();
         }
         catch (const SuggestRestart & e)
         {
             get_initial_constraints_for_helper.add_suggested_restart(e);
+            if (! resolver->restart_from(e))
+                resolver = nullptr;
         }
     }
 }
@@ -97,6 +97,12 @@ Selection::as_string() const
     return _imp->handler->as_string();
 }
 
+std::string
+Selection::cache_key() const
+{
+    return _imp->handler->cache_key();
+}
+
 namespace
 {
     std::string slot_as_string(const std::shared_ptr<const PackageID> & id)
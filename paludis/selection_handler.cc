@@ -23,3 +23,12 @@ using namespace paludis;
 
 SelectionHandler::~SelectionHandler() = default;
 
+std::string
+SelectionHandler::cache_key() const
+{
+    std::string k(_fg.cache_key());
+    if (k.empty())
+        return "";
+    return as_string() + " [" + k + "]";
+}
+
@@ -48,6 +48,17 @@ namespace paludis
 
             virtual std::string as_string() const = 0;
 
+            /**
+             * A string identifying our results, for use as a cache key, or an
+             * empty string if our results may not be remembered.
+             *
+             * By default this combines our as_string with the cache key of
+             * our FilteredGenerator.
+             *
+             * \since 3.0
+             */
+            virtual std::string cache_key() const;
+
             virtual std::shared_ptr<PackageIDSequence> perform_select(const Environment * const) const
                 PALUDIS_ATTRIBUTE((warn_unused_result)) = 0;
     };
@@ -0,0 +1,220 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/spec_matcher_index.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/dep_spec_flattener.hh>
+#include <paludis/environment.hh>
+#include <paludis/match_package.hh>
+#include <paludis/name.hh>
+#include <paludis/package_id.hh>
+#include <paludis/spec_tree.hh>
+#include <paludis/util/pimp-impl.hh>
+#include <paludis/util/options.hh>
+#include <paludis/util/hashes.hh>
+#include <paludis/util/wrapped_forward_iterator.hh>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    typedef std::vector<unsigned> Numbers;
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<SpecMatcherIndex>
+    {
+        std::vector<std::shared_ptr<const PackageDepSpec> > specs;
+
+        std::unordered_map<QualifiedPackageName, Numbers, Hash<QualifiedPackageName> > by_package;
+        std::unordered_map<CategoryNamePart, Numbers, Hash<CategoryNamePart> > by_category;
+        std::unordered_map<PackageNamePart, Numbers, Hash<PackageNamePart> > by_package_name_part;
+        Numbers others;
+    };
+
+    template <>
+    struct Imp<SetSpecMatcher>
+    {
+        const Environment * const env;
+        const SetName name;
+        const std::function<void ()> unknown_set;
+
+        mutable std::mutex mutex;
+        mutable bool compiled;
+        mutable std::shared_ptr<const SetSpecTree> compiled_from;
+        mutable std::shared_ptr<const SpecMatcherIndex> index;
+
+        Imp(const Environment * const e, const SetName & n, const std::function<void ()> & u) :
+            env(e),
+            name(n),
+            unknown_set(u),
+            compiled(false)
+        {
+        }
+    };
+}
+
+SpecMatcherIndex::SpecMatcherIndex() :
+    _imp()
+{
+}
+
+SpecMatcherIndex::~SpecMatcherIndex() = default;
+
+unsigned
+SpecMatcherIndex::add(const std::shared_ptr<const PackageDepSpec> & spec)
+{
+    unsigned number(_imp->specs.size());
+    _imp->specs.push_back(spec);
+
+    if (spec->package_ptr())
+        _imp->by_package[*spec->package_ptr()].push_back(number);
+    else if (spec->category_name_part_ptr())
+        _imp->by_category[*spec->category_name_part_ptr()].push_back(number);
+    else if (spec->package_name_part_ptr())
+        _imp->by_package_name_part[*spec->package_name_part_ptr()].push_back(number);
+    else
+        _imp->others.push_back(number);
+
+    return number;
+}
+
+void
+SpecMatcherIndex::add_set(const Environment * const env, const SetSpecTree & set)
+{
+    DepSpecFlattener<SetSpecTree, PackageDepSpec> f(env);
+    set.top()->accept(f);
+
+    for (const auto & spec : f)
+        add(spec);
+}
+
+unsigned
+SpecMatcherIndex::size() const
+{
+    return _imp->specs.size();
+}
+
+const std::shared_ptr<const PackageDepSpec>
+SpecMatcherIndex::spec(const unsigned number) const
+{
+    return _imp->specs.at(number);
+}
+
+bool
+SpecMatcherIndex::find_matches(
+        const Environment & env,
+        const std::shared_ptr<const PackageID> & id,
+        const std::function<bool (const unsigned)> & f) const
+{
+    /* every spec that can match is in one of these, and each is in
+     * ascending order, so merge them to keep to the order things were added */
+    std::array<const Numbers *, 4> lists{ { nullptr, nullptr, nullptr, nullptr } };
+    std::array<Numbers::size_type, 4> positions{ { 0, 0, 0, 0 } };
+    std::size_t n_lists(0);
+
+    auto p(_imp->by_package.find(id->name()));
+    if (p != _imp->by_package.end())
+        lists[n_lists++] = &p->second;
+
+    auto c(_imp->by_category.find(id->name().category()));
+    if (c != _imp->by_category.end())
+        lists[n_lists++] = &c->second;
+
+    auto n(_imp->by_package_name_part.find(id->name().package()));
+    if (n != _imp->by_package_name_part.end())
+        lists[n_lists++] = &n->second;
+
+    if (! _imp->others.empty())
+        lists[n_lists++] = &_imp->others;
+
+    while (true)
+    {
+        std::size_t best(n_lists);
+        for (std::size_t l(0) ; l < n_lists ; ++l)
+            if (positions[l] < lists[l]->size() &&
+                    (best == n_lists || (*lists[l])[positions[l]] < (*lists[best])[positions[best]]))
+                best = l;
+
+        if (best == n_lists)
+            return false;
+
+        unsigned number((*lists[best])[positions[best]++]);
+        if (match_package(env, *_imp->specs[number], id, nullptr, { }) && f(number))
+            return true;
+    }
+}
+
+bool
+SpecMatcherIndex::any_match(
+        const Environment & env,
+        const std::shared_ptr<const PackageID> & id) const
+{
+    return find_matches(env, id, [] (const unsigned) { return true; });
+}
+
+SetSpecMatcher::SetSpecMatcher(const Environment * const e, const SetName & n, const std::function<void ()> & u) :
+    _imp(e, n, u)
+{
+}
+
+SetSpecMatcher::~SetSpecMatcher() = default;
+
+const SetName
+SetSpecMatcher::name() const
+{
+    return _imp->name;
+}
+
+bool
+SetSpecMatcher::match(const std::shared_ptr<const PackageID> & id) const
+{
+    std::shared_ptr<const SetSpecTree> set(_imp->env->set(_imp->name));
+    std::shared_ptr<const SpecMatcherIndex> index;
+
+    {
+        std::unique_lock<std::mutex> lock(_imp->mutex);
+        if ((! _imp->compiled) || set != _imp->compiled_from)
+        {
+            auto new_index(std::make_shared<SpecMatcherIndex>());
+            if (set)
+                new_index->add_set(_imp->env, *set);
+            else
+                _imp->unknown_set();
+
+            _imp->compiled = true;
+            _imp->compiled_from = set;
+            _imp->index = new_index;
+        }
+
+        index = _imp->index;
+    }
+
+    return index->any_match(*_imp->env, id);
+}
+
+namespace paludis
+{
+    template class Pimp<SpecMatcherIndex>;
+    template class Pimp<SetSpecMatcher>;
+}
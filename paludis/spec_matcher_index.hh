@@ -0,0 +1,159 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_SPEC_MATCHER_INDEX_HH
+#define PALUDIS_GUARD_PALUDIS_SPEC_MATCHER_INDEX_HH 1
+
+#include <paludis/spec_matcher_index-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+#include <paludis/dep_spec-fwd.hh>
+#include <paludis/spec_tree-fwd.hh>
+#include <paludis/environment-fwd.hh>
+#include <paludis/package_id-fwd.hh>
+#include <paludis/name-fwd.hh>
+#include <functional>
+#include <memory>
+
+/** \file
+ * Declarations for the SpecMatcherIndex and SetSpecMatcher classes.
+ *
+ * \ingroup g_query
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * Holds a collection of PackageDepSpecs, bucketed by qualified package
+     * name, category, package name part and everything else, so that finding
+     * the specs that match a PackageID only looks at those that could apply.
+     *
+     * Specs are numbered in the order they are added, starting from zero, and
+     * callers keep anything associated with a spec in a sequence indexed by
+     * that number.
+     *
+     * \ingroup g_query
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE SpecMatcherIndex
+    {
+        private:
+            Pimp<SpecMatcherIndex> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            SpecMatcherIndex();
+            ~SpecMatcherIndex();
+
+            SpecMatcherIndex(const SpecMatcherIndex &) = delete;
+            SpecMatcherIndex & operator= (const SpecMatcherIndex &) = delete;
+
+            ///\}
+
+            /**
+             * Add a spec, returning its number.
+             */
+            unsigned add(const std::shared_ptr<const PackageDepSpec> &);
+
+            /**
+             * Add every PackageDepSpec in a set, including those in any named
+             * sets it contains.
+             */
+            void add_set(const Environment * const, const SetSpecTree &);
+
+            /**
+             * How many specs we hold.
+             */
+            unsigned size() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * The spec with a given number.
+             */
+            const std::shared_ptr<const PackageDepSpec> spec(const unsigned) const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Call a function with the number of each spec that matches the ID, in
+             * the order they were added. If the function returns true we stop, and
+             * return true.
+             */
+            bool find_matches(
+                    const Environment &,
+                    const std::shared_ptr<const PackageID> &,
+                    const std::function<bool (const unsigned)> &) const;
+
+            /**
+             * Does any spec match the ID?
+             */
+            bool any_match(
+                    const Environment &,
+                    const std::shared_ptr<const PackageID> &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    /**
+     * Matches IDs against a named set, which is flattened and bucketed using a
+     * SpecMatcherIndex the first time it is needed, rather than on every match.
+     *
+     * The set is fetched from the Environment on each match, and compiled
+     * again if the Environment starts handing out a different set by that
+     * name.
+     *
+     * \ingroup g_query
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE SetSpecMatcher
+    {
+        private:
+            Pimp<SetSpecMatcher> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            /**
+             * The function is called whenever we find that the set does not
+             * exist, which is treated as being empty.
+             */
+            SetSpecMatcher(const Environment * const, const SetName &, const std::function<void ()> & unknown_set);
+            ~SetSpecMatcher();
+
+            SetSpecMatcher(const SetSpecMatcher &) = delete;
+            SetSpecMatcher & operator= (const SetSpecMatcher &) = delete;
+
+            ///\}
+
+            /**
+             * Our set's name.
+             */
+            const SetName name() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
+            /**
+             * Is the ID in our set? Safe to call from several threads at once.
+             */
+            bool match(const std::shared_ptr<const PackageID> &) const PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+
+    extern template class Pimp<SpecMatcherIndex>;
+    extern template class Pimp<SetSpecMatcher>;
+}
+
+#endif
@@ -0,0 +1,133 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/spec_matcher_index.hh>
+#include <paludis/user_dep_spec.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/spec_tree.hh>
+#include <paludis/name.hh>
+
+#include <paludis/environments/test/test_environment.hh>
+
+#include <paludis/repositories/fake/fake_package_id.hh>
+#include <paludis/repositories/fake/fake_repository.hh>
+
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/join.hh>
+#include <paludis/util/stringify.hh>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    std::shared_ptr<const PackageDepSpec> make_spec(const Environment * const env, const std::string & s)
+    {
+        return std::make_shared<PackageDepSpec>(parse_user_package_dep_spec(s, env, { updso_allow_wildcards }));
+    }
+
+    std::string matches(const Environment & env, const SpecMatcherIndex & index, const std::shared_ptr<const PackageID> & id)
+    {
+        std::vector<unsigned> result;
+        index.find_matches(env, id, [&] (const unsigned n) { result.push_back(n); return false; });
+        return join(result.begin(), result.end(), " ");
+    }
+}
+
+TEST(SpecMatcherIndex, Works)
+{
+    TestEnvironment env;
+    auto repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo")
+                    )));
+    env.add_repository(1, repo);
+
+    auto one(repo->add_version("cat", "one", "1"));
+    auto one_two(repo->add_version("cat", "one", "2"));
+    auto two(repo->add_version("cat", "two", "1"));
+    auto other_one(repo->add_version("other", "one", "1"));
+    auto other_two(repo->add_version("other", "two", "1"));
+
+    SpecMatcherIndex index;
+    EXPECT_EQ(0u, index.add(make_spec(&env, "*/*")));
+    EXPECT_EQ(1u, index.add(make_spec(&env, ">=cat/one-2")));
+    EXPECT_EQ(2u, index.add(make_spec(&env, "cat/*")));
+    EXPECT_EQ(3u, index.add(make_spec(&env, "*/one")));
+    EXPECT_EQ(4u, index.add(make_spec(&env, "cat/one")));
+    EXPECT_EQ(5u, index.add(make_spec(&env, "*/*::repo")));
+    EXPECT_EQ(6u, index.size());
+    EXPECT_EQ("cat/*", stringify(*index.spec(2)));
+
+    EXPECT_EQ("0 2 3 4 5", matches(env, index, one));
+    EXPECT_EQ("0 1 2 3 4 5", matches(env, index, one_two));
+    EXPECT_EQ("0 2 5", matches(env, index, two));
+    EXPECT_EQ("0 3 5", matches(env, index, other_one));
+    EXPECT_EQ("0 5", matches(env, index, other_two));
+
+    std::vector<unsigned> first;
+    EXPECT_TRUE(index.find_matches(env, one, [&] (const unsigned n) { first.push_back(n); return n >= 2; }));
+    EXPECT_EQ("0 2", join(first.begin(), first.end(), " "));
+
+    SpecMatcherIndex just_cat;
+    just_cat.add(make_spec(&env, "cat/two"));
+    EXPECT_FALSE(just_cat.any_match(env, one));
+    EXPECT_TRUE(just_cat.any_match(env, two));
+}
+
+TEST(SetSpecMatcher, Works)
+{
+    TestEnvironment env;
+    auto repo(std::make_shared<FakeRepository>(make_named_values<FakeRepositoryParams>(
+                    n::environment() = &env,
+                    n::name() = RepositoryName("repo")
+                    )));
+    env.add_repository(1, repo);
+
+    auto one(repo->add_version("cat", "one", "1"));
+    auto two(repo->add_version("cat", "two", "1"));
+    auto three(repo->add_version("cat", "three", "1"));
+
+    env.add_set(SetName("inner"), SetName("inner"), [&] () {
+            auto result(std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>()));
+            result->top()->append(make_spec(&env, "cat/two"));
+            return result;
+            }, false);
+
+    env.add_set(SetName("outer"), SetName("outer"), [&] () {
+            auto result(std::make_shared<SetSpecTree>(std::make_shared<AllDepSpec>()));
+            result->top()->append(make_spec(&env, "cat/one"));
+            result->top()->append(std::make_shared<NamedSetDepSpec>(SetName("inner")));
+            return result;
+            }, false);
+
+    int unknown(0);
+    SetSpecMatcher outer(&env, SetName("outer"), [&] () { ++unknown; });
+    EXPECT_EQ("outer", stringify(outer.name()));
+    EXPECT_TRUE(outer.match(one));
+    EXPECT_TRUE(outer.match(two));
+    EXPECT_FALSE(outer.match(three));
+    EXPECT_EQ(0, unknown);
+
+    SetSpecMatcher missing(&env, SetName("missing"), [&] () { ++unknown; });
+    EXPECT_FALSE(missing.match(one));
+    EXPECT_FALSE(missing.match(two));
+    EXPECT_EQ(1, unknown);
+}
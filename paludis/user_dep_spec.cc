@@ -227,7 +227,7 @@ namespace
                     {
                         flag.erase(0, exclude.size());
 
-                        Context cc("When parsing exclude requirement '" + flag + "':");
+                        LazyContext cc([&] () { return "When parsing exclude requirement '" + flag + "':"; });
                         if (!env) throw PackageDepSpecError("Environment is null");
 
                         std::shared_ptr<const AdditionalPackageDepSpecRequirement> req(std::make_shared<ExcludeRequirement>(
@@ -360,7 +360,7 @@ paludis::parse_user_package_dep_spec(const std::string & ss, const Environment *
 {
     using namespace std::placeholders;
 
-    Context context("When parsing user package dep spec '" + ss + "':");
+    LazyContext context([&] () { return "When parsing user package dep spec '" + ss + "':"; });
 
     bool had_bracket_version_requirements(false);
     PartiallyMadePackageDepSpecOptions o;
@@ -388,7 +388,7 @@ paludis::envless_parse_package_dep_spec_for_tests(const std::string & ss)
 {
     using namespace std::placeholders;
 
-    Context context("When parsing test package dep spec '" + ss + "':");
+    LazyContext context([&] () { return "When parsing test package dep spec '" + ss + "':"; });
 
     bool had_bracket_version_requirements(false);
     PartiallyMadePackageDepSpecOptions o;
@@ -999,7 +999,7 @@ UserKeyRequirement::requirement_met(
         const std::shared_ptr<const PackageID> & from_id,
         const ChangedChoices * const) const
 {
-    Context context("When working out whether '" + stringify(*id) + "' matches " + as_raw_string() + ":");
+    LazyContext context([&] () { return "When working out whether '" + stringify(*id) + "' matches " + as_raw_string() + ":"; });
 
     const MetadataKey * key_requirement(nullptr);
     const Mask * mask_requirement(nullptr);
@@ -1168,7 +1168,7 @@ ExcludeRequirement::requirement_met(
         const std::shared_ptr<const PackageID> & from_id,
         const ChangedChoices * const) const
 {
-    Context context("When working out whether '" + stringify(*id) + "' matches " + as_raw_string() + ":");
+    LazyContext context([&] () { return "When working out whether '" + stringify(*id) + "' matches " + as_raw_string() + ":"; });
 
     return std::make_pair(!match_package(*env, _s, id, from_id, { }), as_human_string(from_id));
 }
@@ -0,0 +1,132 @@
+/*
+   BLAKE2b compression function using AVX2, for use by blake2b-ref.c on CPUs
+   that have it.
+
+   This file is part of the Paludis package manager. Paludis is free software;
+   you can redistribute it and/or modify it under the terms of the GNU General
+   Public License version 2, as published by the Free Software Foundation.
+
+   Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+   details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+   Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "blake2.h"
+#include "blake2-impl.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+static const uint64_t blake2b_avx2_IV[8] =
+{
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+  0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint8_t blake2b_avx2_sigma[12][16] =
+{
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 } ,
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 } ,
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 } ,
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 } ,
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 } ,
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 } ,
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 } ,
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 } ,
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 } ,
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+/*
+   The sixteen words of state are kept as four rows of four, so each G step
+   works on all four columns (or, after rotating rows b, c and d, all four
+   diagonals) at once.
+*/
+
+#define ROTR32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define ROTR24(x) _mm256_shuffle_epi8((x), rotr24)
+#define ROTR16(x) _mm256_shuffle_epi8((x), rotr16)
+#define ROTR63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define G(a, b, c, d, mx, my)                               \
+  do {                                                      \
+    a = _mm256_add_epi64(_mm256_add_epi64(a, b), mx);       \
+    d = ROTR32(_mm256_xor_si256(d, a));                     \
+    c = _mm256_add_epi64(c, d);                             \
+    b = ROTR24(_mm256_xor_si256(b, c));                     \
+    a = _mm256_add_epi64(_mm256_add_epi64(a, b), my);       \
+    d = ROTR16(_mm256_xor_si256(d, a));                     \
+    c = _mm256_add_epi64(c, d);                             \
+    b = ROTR63(_mm256_xor_si256(b, c));                     \
+  } while(0)
+
+#define MSG(s, i, j, k, l) \
+  _mm256_set_epi64x((int64_t) m[s[l]], (int64_t) m[s[k]], (int64_t) m[s[j]], (int64_t) m[s[i]])
+
+__attribute__((target("avx2")))
+void blake2b_compress_avx2( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+  const __m256i rotr24 = _mm256_setr_epi8(
+      3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+      3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+  const __m256i rotr16 = _mm256_setr_epi8(
+      2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+      2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+  uint64_t m[16];
+  size_t r;
+  __m256i a, b, c, d;
+  const __m256i h0 = _mm256_loadu_si256((const __m256i *) &S->h[0]);
+  const __m256i h1 = _mm256_loadu_si256((const __m256i *) &S->h[4]);
+
+  for( r = 0; r < 16; ++r ) {
+    m[r] = load64( block + r * sizeof( m[r] ) );
+  }
+
+  a = h0;
+  b = h1;
+  c = _mm256_loadu_si256((const __m256i *) &blake2b_avx2_IV[0]);
+  d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &blake2b_avx2_IV[4]),
+      _mm256_set_epi64x((int64_t) S->f[1], (int64_t) S->f[0], (int64_t) S->t[1], (int64_t) S->t[0]));
+
+  for( r = 0; r < 12; ++r ) {
+    const uint8_t * s = blake2b_avx2_sigma[r];
+
+    G(a, b, c, d, MSG(s, 0, 2, 4, 6), MSG(s, 1, 3, 5, 7));
+
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+    G(a, b, c, d, MSG(s, 8, 10, 12, 14), MSG(s, 9, 11, 13, 15));
+
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+  }
+
+  _mm256_storeu_si256((__m256i *) &S->h[0], _mm256_xor_si256(h0, _mm256_xor_si256(a, c)));
+  _mm256_storeu_si256((__m256i *) &S->h[4], _mm256_xor_si256(h1, _mm256_xor_si256(b, d)));
+}
+
+#undef G
+#undef MSG
+#undef ROTR32
+#undef ROTR24
+#undef ROTR16
+#undef ROTR63
+
+#endif
@@ -20,6 +20,7 @@
 #include <paludis/util/blake2b.hh>
 #include <paludis/util/byte_swap.hh>
 #include <paludis/util/digest_registry.hh>
+#include <paludis/util/cpu_features.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/exception.hh>
 #include <sstream>
@@ -31,33 +32,42 @@
 
 using namespace paludis;
 
-Blake2b::Blake2b(std::istream & s)
+extern "C" int paludis_blake2b_use_avx2()
 {
-    std::fill(&H[0], &H[BLAKE2B_OUTBYTES/8], 0);
-
-    std::streambuf * buf(s.rdbuf());
+    return cpu_has_avx2();
+}
 
-    uint8_t m[64];
-    std::streamsize block_size;
+Blake2b::Blake2b()
+{
+    std::fill(&H[0], &H[BLAKE2B_OUTBYTES/8], 0);
 
-    blake2b_state S;
     int err = 0;
-
-    if ( (err = blake2b_init(&S, BLAKE2B_OUTBYTES)) < 0 ) {
+    if ( (err = blake2b_init(&_state, BLAKE2B_OUTBYTES)) < 0 ) {
         throw InternalError(PALUDIS_HERE, "Blake2B hash failed to init. Error code " + stringify(err));
     }
+}
 
-    do
-    {
-        block_size = buf->sgetn(reinterpret_cast<char *>(m), 64);
-
-        if ( (err = blake2b_update(&S, &m[0], block_size)) < 0 ) {
-            throw InternalError(PALUDIS_HERE, "Blake2B hash failed to update. Error code " + stringify(err));
-        }
+Blake2b::Blake2b(std::istream & s) :
+    Blake2b()
+{
+    digest_stream(*this, s);
+    finish();
+}
 
-    } while (64 == block_size);
+void
+Blake2b::update(const char * data, std::size_t length)
+{
+    int err = 0;
+    if ( (err = blake2b_update(&_state, data, length)) < 0 ) {
+        throw InternalError(PALUDIS_HERE, "Blake2B hash failed to update. Error code " + stringify(err));
+    }
+}
 
-    if ( (err = blake2b_final(&S, &H[0], BLAKE2B_OUTBYTES)) < 0 ) {
+void
+Blake2b::finish()
+{
+    int err = 0;
+    if ( (err = blake2b_final(&_state, &H[0], BLAKE2B_OUTBYTES)) < 0 ) {
         throw InternalError(PALUDIS_HERE, "Blake2B hash failed to finalize. Error code " + stringify(err));
     }
 }
@@ -23,6 +23,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstddef>
 #include <paludis/util/attributes.hh>
 #include <inttypes.h>
 
@@ -49,13 +50,30 @@ namespace paludis
     {
         private:
             uint64_t H[BLAKE2B_OUTBYTES/8];
+            blake2b_state _state;
 
         public:
             /**
-             * Constructor.
+             * Constructor, for use with update() and finish().
+             */
+            Blake2b();
+
+            /**
+             * Constructor, for the digest of everything left in a stream.
              */
             Blake2b(std::istream & stream);
 
+            /**
+             * Add more data to the digest.
+             */
+            void update(const char * data, std::size_t length);
+
+            /**
+             * Add the final padding. Must be called once, after all the
+             * data has been given to update(), and before hexsum().
+             */
+            void finish();
+
             /**
              * Our checksum, as a string of hex characters.
              */
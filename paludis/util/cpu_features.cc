@@ -0,0 +1,99 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/cpu_features.hh>
+#include <paludis/util/system.hh>
+#include <paludis/util/env_var_names.hh>
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <cpuid.h>
+#  define PALUDIS_CPU_FEATURES_X86 1
+#endif
+
+using namespace paludis;
+
+namespace
+{
+    struct Detected
+    {
+        bool avx2;
+        bool sha_ni;
+
+        Detected() :
+            avx2(false),
+            sha_ni(false)
+        {
+#ifdef PALUDIS_CPU_FEATURES_X86
+            unsigned a, b, c, d;
+            if (! __get_cpuid(1, &a, &b, &c, &d))
+                return;
+
+            bool ssse3(c & (1u << 9));
+            bool sse41(c & (1u << 19));
+            bool osxsave(c & (1u << 27));
+            bool avx(c & (1u << 28));
+
+            /* AVX registers are only usable if the kernel saves them for us */
+            bool ymm_saved(false);
+            if (osxsave && avx)
+            {
+                unsigned xcr0_lo, xcr0_hi;
+                __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+                ymm_saved = (0x6 == (xcr0_lo & 0x6));
+            }
+
+            if (! __get_cpuid_count(7, 0, &a, &b, &c, &d))
+                return;
+
+            avx2 = ymm_saved && (b & (1u << 5));
+            sha_ni = ssse3 && sse41 && (b & (1u << 29));
+#endif
+        }
+    };
+
+    const Detected & detected()
+    {
+        static const Detected result;
+        return result;
+    }
+
+    std::atomic<bool> & use_cpu_features()
+    {
+        static std::atomic<bool> result(getenv_with_default(env_vars::disable_cpu_features, "").empty());
+        return result;
+    }
+}
+
+bool
+paludis::cpu_has_avx2()
+{
+    return use_cpu_features().load(std::memory_order_relaxed) && detected().avx2;
+}
+
+bool
+paludis::cpu_has_sha_ni()
+{
+    return use_cpu_features().load(std::memory_order_relaxed) && detected().sha_ni;
+}
+
+void
+paludis::set_use_cpu_features(const bool b)
+{
+    use_cpu_features().store(b);
+}
@@ -0,0 +1,63 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_CPU_FEATURES_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_CPU_FEATURES_HH 1
+
+#include <paludis/util/attributes.hh>
+
+/** \file
+ * Runtime detection of optional CPU features, for picking between portable
+ * and accelerated implementations of things like digests.
+ *
+ * \ingroup g_system
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * Can we use AVX2?
+     *
+     * \ingroup g_system
+     */
+    bool cpu_has_avx2() PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
+
+    /**
+     * Can we use the SHA extensions (and the SSE4.1 instructions that go
+     * along with them)?
+     *
+     * \ingroup g_system
+     */
+    bool cpu_has_sha_ni() PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
+
+    /**
+     * Turn the use of optional CPU features on or off. They start off on,
+     * unless PALUDIS_DISABLE_CPU_FEATURES is set to a non-empty value.
+     *
+     * This lets tests and benchmarks compare the portable and accelerated
+     * implementations.
+     *
+     * \ingroup g_system
+     */
+    void set_use_cpu_features(const bool) PALUDIS_VISIBLE;
+}
+
+#endif
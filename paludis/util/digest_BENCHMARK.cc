@@ -0,0 +1,103 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/digest_registry.hh>
+#include <paludis/util/cpu_features.hh>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    const std::vector<std::string> algos{ "BLAKE2B", "MD5", "RMD160", "SHA1", "SHA256", "SHA512", "WHIRLPOOL" };
+
+    template <typename F_>
+    double seconds(const F_ & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /* MiB per second for one algorithm over one large buffer */
+    double throughput(const std::string & algo, const std::string & data)
+    {
+        auto digester(DigestRegistry::get_instance()->make_digester(algo));
+        double taken(seconds([&] () {
+                    digester->update(data.data(), data.length());
+                    digester->finish();
+                    }));
+        return data.length() / (1024.0 * 1024.0) / taken;
+    }
+
+    /* files per second for lots of small files */
+    double many(const std::string & algo, const std::vector<std::string> & files)
+    {
+        double taken(seconds([&] () { DigestRegistry::get_instance()->get_multiple({ algo }, files); }));
+        return files.size() / taken;
+    }
+}
+
+int main(int, char *[])
+{
+    std::string large(64 * 1024 * 1024, '\0');
+    for (std::string::size_type i(0) ; i < large.length() ; ++i)
+        large[i] = static_cast<char>((i * 2654435761u) >> 13);
+
+    std::vector<std::string> small;
+    for (unsigned i(0) ; i < 20000 ; ++i)
+        small.push_back(large.substr(i * 97, 200 + (i * 37) % 4000));
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "cpu features: avx2 " << (cpu_has_avx2() ? "yes" : "no")
+        << ", sha_ni " << (cpu_has_sha_ni() ? "yes" : "no") << std::endl;
+
+    std::cout << std::left << std::setw(12) << "algorithm" << std::right
+        << std::setw(14) << "portable" << std::setw(14) << "accelerated" << "  (MiB/s, 64MiB buffer)" << std::endl;
+    for (const auto & algo : algos)
+    {
+        set_use_cpu_features(false);
+        double portable(throughput(algo, large));
+        set_use_cpu_features(true);
+        double accelerated(throughput(algo, large));
+
+        std::cout << std::left << std::setw(12) << algo << std::right
+            << std::setw(14) << portable << std::setw(14) << accelerated << std::endl;
+    }
+
+    std::cout << std::left << std::setw(12) << "algorithm" << std::right
+        << std::setw(14) << "portable" << std::setw(14) << "accelerated" << "  (files/s, " << small.size()
+        << " files of 200 to 4200 bytes)" << std::endl;
+    for (const auto & algo : algos)
+    {
+        set_use_cpu_features(false);
+        double portable(many(algo, small));
+        set_use_cpu_features(true);
+        double accelerated(many(algo, small));
+
+        std::cout << std::left << std::setw(12) << algo << std::right
+            << std::setw(14) << portable << std::setw(14) << accelerated << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
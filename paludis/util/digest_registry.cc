@@ -28,6 +28,8 @@ using namespace paludis;
 namespace
 {
     typedef std::map<std::string, DigestRegistry::Function> FunctionMap;
+    typedef std::map<std::string, DigestRegistry::DigesterFunction> DigesterFunctionMap;
+    typedef std::map<std::string, DigestRegistry::ManyFunction> ManyFunctionMap;
 }
 
 namespace paludis
@@ -42,6 +44,8 @@ namespace paludis
     struct Imp<DigestRegistry>
     {
         FunctionMap functions;
+        DigesterFunctionMap digester_functions;
+        ManyFunctionMap many_functions;
     };
 }
 
@@ -60,6 +64,72 @@ DigestRegistry::get(const std::string & algo) const
     return it->second;
 }
 
+std::shared_ptr<DigestRegistry::Digester>
+DigestRegistry::make_digester(const std::string & algo) const
+{
+    DigesterFunctionMap::const_iterator it(_imp->digester_functions.find(algo));
+    if (_imp->digester_functions.end() == it)
+        return nullptr;
+    return it->second();
+}
+
+std::map<std::string, std::string>
+DigestRegistry::get_multiple(const std::vector<std::string> & algos, std::istream & stream) const
+{
+    std::vector<std::pair<std::string, std::shared_ptr<Digester> > > digesters;
+    for (const auto & algo : algos)
+        if (auto digester = make_digester(algo))
+            digesters.emplace_back(algo, digester);
+
+    std::map<std::string, std::string> result;
+    if (digesters.empty())
+        return result;
+
+    /* each block is given to every digest while it is still in cache, and
+     * the file is read only once no matter how many digests we want */
+    std::vector<char> buffer(1024 * 1024);
+    std::streambuf * buf(stream.rdbuf());
+    std::streamsize n;
+    while (0 < ((n = buf->sgetn(buffer.data(), buffer.size()))))
+        for (auto & d : digesters)
+            d.second->update(buffer.data(), n);
+
+    for (auto & d : digesters)
+        result.emplace(d.first, d.second->finish());
+
+    return result;
+}
+
+std::vector<std::map<std::string, std::string> >
+DigestRegistry::get_multiple(const std::vector<std::string> & algos, const std::vector<std::string> & data) const
+{
+    std::vector<std::map<std::string, std::string> > result(data.size());
+
+    std::vector<std::string> one_at_a_time;
+    for (const auto & algo : algos)
+    {
+        ManyFunctionMap::const_iterator m(_imp->many_functions.find(algo));
+        if (_imp->many_functions.end() != m)
+        {
+            std::vector<std::string> hexsums(m->second(data));
+            for (std::size_t i(0) ; i < data.size() ; ++i)
+                result[i].emplace(algo, hexsums[i]);
+        }
+        else
+            one_at_a_time.push_back(algo);
+    }
+
+    for (std::size_t i(0) ; i < data.size() ; ++i)
+        for (const auto & algo : one_at_a_time)
+            if (auto digester = make_digester(algo))
+            {
+                digester->update(data[i].data(), data[i].length());
+                result[i].emplace(algo, digester->finish());
+            }
+
+    return result;
+}
+
 DigestRegistry::AlgorithmsConstIterator
 DigestRegistry::begin_algorithms() const
 {
@@ -73,11 +143,17 @@ DigestRegistry::end_algorithms() const
 }
 
 void
-DigestRegistry::register_function(const std::string & algo, const Function & func)
+DigestRegistry::register_function(const std::string & algo, const Function & func,
+        const DigesterFunction & digester_func, const ManyFunction & many_func)
 {
     _imp->functions.insert(std::make_pair(algo, func));
+    _imp->digester_functions.insert(std::make_pair(algo, digester_func));
+    if (many_func)
+        _imp->many_functions.insert(std::make_pair(algo, many_func));
 }
 
+DigestRegistry::Digester::~Digester() = default;
+
 namespace paludis
 {
     template class Pimp<DigestRegistry>;
@@ -26,8 +26,15 @@
 #include <paludis/util/pimp.hh>
 #include <paludis/util/singleton.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
+#include <algorithm>
 #include <functional>
+#include <istream>
+#include <map>
+#include <memory>
 #include <utility>
+#include <vector>
+#include <cstring>
+#include <inttypes.h>
 
 namespace paludis
 {
@@ -44,8 +51,61 @@ namespace paludis
         public:
             typedef std::function<std::string (std::istream &)> Function;
 
+            /**
+             * A digest that is given its data a piece at a time, so that
+             * several digests can be calculated from a single read of a
+             * file.
+             */
+            class PALUDIS_VISIBLE Digester
+            {
+                public:
+                    virtual ~Digester();
+
+                    virtual void update(const char * data, std::size_t length) = 0;
+
+                    /**
+                     * Our checksum, as a string of hex characters. Must be
+                     * called only once, after all the data has been given
+                     * to update.
+                     */
+                    virtual std::string finish() = 0;
+            };
+
+            typedef std::function<std::shared_ptr<Digester> ()> DigesterFunction;
+
+            /**
+             * Calculates the digests of several separate pieces of data at
+             * once. Only registered by algorithms that can do better than
+             * working through the pieces one at a time.
+             */
+            typedef std::function<std::vector<std::string> (const std::vector<std::string> &)> ManyFunction;
+
             Function get(const std::string & algo) const;
 
+            /**
+             * Return a new Digester for the named algorithm, or a null
+             * pointer if it is not supported.
+             */
+            std::shared_ptr<Digester> make_digester(const std::string & algo) const;
+
+            /**
+             * Calculate every named digest of a stream, reading the stream
+             * only once, in large blocks.
+             *
+             * Unsupported algorithms are left out of the result.
+             */
+            std::map<std::string, std::string> get_multiple(
+                    const std::vector<std::string> & algos, std::istream & stream) const;
+
+            /**
+             * Calculate every named digest of each of several pieces of
+             * data, for when there are lots of small files to deal with.
+             *
+             * Unsupported algorithms are left out of the results.
+             */
+            std::vector<std::map<std::string, std::string> > get_multiple(
+                    const std::vector<std::string> & algos, const std::vector<std::string> & data) const;
+
             struct AlgorithmsConstIteratorTag;
             typedef WrappedForwardIterator<AlgorithmsConstIteratorTag, const std::pair<const std::string, Function> > AlgorithmsConstIterator;
 
@@ -56,9 +116,9 @@ namespace paludis
             class Registration
             {
                 public:
-                    Registration(const std::string & algo)
+                    Registration(const std::string & algo, const ManyFunction & many_func = ManyFunction())
                     {
-                        get_instance()->register_function(algo, do_digest<T_>);
+                        get_instance()->register_function(algo, do_digest<T_>, make_digester_for<T_>, many_func);
                     }
             };
 
@@ -68,7 +128,8 @@ namespace paludis
 
             Pimp<DigestRegistry> _imp;
 
-            void register_function(const std::string & algo, const Function & func);
+            void register_function(const std::string & algo, const Function & func,
+                    const DigesterFunction & digester_func, const ManyFunction & many_func);
 
             template <typename T_>
             static std::string
@@ -77,8 +138,95 @@ namespace paludis
                 T_ digest(stream);
                 return digest.hexsum();
             }
+
+            template <typename T_>
+            class DigesterFor :
+                public Digester
+            {
+                private:
+                    T_ _digest;
+
+                public:
+                    void update(const char * data, std::size_t length) override
+                    {
+                        _digest.update(data, length);
+                    }
+
+                    std::string finish() override
+                    {
+                        _digest.finish();
+                        return _digest.hexsum();
+                    }
+            };
+
+            template <typename T_>
+            static std::shared_ptr<Digester>
+            make_digester_for()
+            {
+                return std::make_shared<DigesterFor<T_> >();
+            }
     };
 
+    /**
+     * Used by the digest classes to split the data given to their update
+     * method into whole blocks.
+     *
+     * Data is first used to fill up any partial block left over from the
+     * previous call in buffer. Runs of complete blocks are then passed to
+     * process, along with how many blocks there are, directly from data, and
+     * whatever is left is kept in buffer for next time.
+     *
+     * \ingroup g_digests
+     */
+    template <std::size_t block_size_, typename Process_>
+    void digest_blocks(uint8_t * const buffer, std::size_t & buffer_used,
+            const char * data, std::size_t length, const Process_ & process)
+    {
+        const uint8_t * d(reinterpret_cast<const uint8_t *>(data));
+
+        if (0 != buffer_used)
+        {
+            std::size_t n(std::min(block_size_ - buffer_used, length));
+            std::memcpy(buffer + buffer_used, d, n);
+            buffer_used += n;
+            d += n;
+            length -= n;
+
+            if (block_size_ != buffer_used)
+                return;
+
+            process(buffer, 1);
+            buffer_used = 0;
+        }
+
+        if (length >= block_size_)
+        {
+            std::size_t n(length / block_size_);
+            process(d, n);
+            d += n * block_size_;
+            length -= n * block_size_;
+        }
+
+        std::memcpy(buffer, d, length);
+        buffer_used = length;
+    }
+
+    /**
+     * Used by the digest classes to give everything in a stream to their
+     * update method.
+     *
+     * \ingroup g_digests
+     */
+    template <typename T_>
+    void digest_stream(T_ & digest, std::istream & stream)
+    {
+        std::vector<char> buffer(64 * 1024);
+        std::streambuf * buf(stream.rdbuf());
+        std::streamsize n;
+        while (0 < ((n = buf->sgetn(buffer.data(), buffer.size()))))
+            digest.update(buffer.data(), n);
+    }
+
     extern template class PALUDIS_VISIBLE WrappedForwardIterator<
             DigestRegistry::AlgorithmsConstIteratorTag,
             const std::pair<const std::string, DigestRegistry::Function> >;
@@ -0,0 +1,139 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/digest_registry.hh>
+#include <paludis/util/cpu_features.hh>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    const std::vector<std::string> all_algos{ "BLAKE2B", "MD5", "RMD160", "SHA1", "SHA256", "SHA512", "WHIRLPOOL" };
+
+    std::string make_data(const unsigned length)
+    {
+        std::string result;
+        for (unsigned i(0) ; i < length ; ++i)
+            result.append(1, static_cast<char>((i * 7 + length) & 0xff));
+        return result;
+    }
+
+    std::string single(const std::string & algo, const std::string & data)
+    {
+        std::stringstream s(data);
+        return DigestRegistry::get_instance()->get(algo)(s);
+    }
+}
+
+TEST(DigestRegistry, KnownValues)
+{
+    EXPECT_EQ("d41d8cd98f00b204e9800998ecf8427e", single("MD5", ""));
+    EXPECT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d", single("SHA1", "abc"));
+    EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", single("SHA256", "abc"));
+}
+
+TEST(DigestRegistry, Multiple)
+{
+    for (unsigned length : { 0u, 1u, 55u, 56u, 63u, 64u, 111u, 112u, 127u, 128u, 1000u, 3000000u })
+    {
+        std::string data(make_data(length));
+        std::stringstream s(data);
+        auto result(DigestRegistry::get_instance()->get_multiple(all_algos, s));
+
+        ASSERT_EQ(all_algos.size(), result.size());
+        for (const auto & algo : all_algos)
+            EXPECT_EQ(single(algo, data), result[algo]) << algo << " of " << length << " bytes";
+    }
+}
+
+TEST(DigestRegistry, MultipleUnsupported)
+{
+    std::stringstream s("abc");
+    auto result(DigestRegistry::get_instance()->get_multiple({ "SHA256", "NOT-A-DIGEST" }, s));
+    EXPECT_EQ(1u, result.size());
+    EXPECT_EQ(0u, result.count("NOT-A-DIGEST"));
+    EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", result["SHA256"]);
+}
+
+TEST(DigestRegistry, Pieces)
+{
+    std::string data(make_data(1000));
+
+    for (const auto & algo : all_algos)
+    {
+        std::string expected(single(algo, data));
+
+        for (unsigned piece : { 1u, 3u, 63u, 64u, 65u, 127u, 129u })
+        {
+            auto digester(DigestRegistry::get_instance()->make_digester(algo));
+            ASSERT_TRUE(bool(digester));
+            for (std::string::size_type p(0) ; p < data.length() ; p += piece)
+                digester->update(data.data() + p, std::min<std::string::size_type>(piece, data.length() - p));
+            EXPECT_EQ(expected, digester->finish()) << algo << " in pieces of " << piece;
+        }
+    }
+
+    EXPECT_FALSE(bool(DigestRegistry::get_instance()->make_digester("NOT-A-DIGEST")));
+}
+
+TEST(DigestRegistry, ManyPieces)
+{
+    std::vector<std::string> data;
+    for (unsigned length : { 0u, 1u, 111u, 112u, 128u, 1000u, 5u, 20000u, 240u })
+    {
+        data.push_back(make_data(length));
+
+        auto result(DigestRegistry::get_instance()->get_multiple(all_algos, data));
+        ASSERT_EQ(data.size(), result.size());
+
+        for (std::size_t i(0) ; i < data.size() ; ++i)
+        {
+            ASSERT_EQ(all_algos.size(), result[i].size());
+            for (const auto & algo : all_algos)
+                EXPECT_EQ(single(algo, data[i]), result[i][algo]) << algo << " of piece " << i << " of " << data.size();
+        }
+    }
+}
+
+TEST(DigestRegistry, WithoutCPUFeatures)
+{
+    std::vector<std::string> data;
+    for (unsigned length : { 0u, 3u, 64u, 127u, 129u, 4096u, 100000u })
+        data.push_back(make_data(length));
+
+    auto with_features(DigestRegistry::get_instance()->get_multiple(all_algos, data));
+
+    set_use_cpu_features(false);
+    auto without_features(DigestRegistry::get_instance()->get_multiple(all_algos, data));
+    std::vector<std::string> single_without_features;
+    for (const auto & d : data)
+        single_without_features.push_back(single("SHA256", d));
+    set_use_cpu_features(true);
+
+    for (std::size_t i(0) ; i < data.size() ; ++i)
+    {
+        for (const auto & algo : all_algos)
+            EXPECT_EQ(without_features[i][algo], with_features[i][algo]) << algo << " of " << data[i].length() << " bytes";
+        EXPECT_EQ(single_without_features[i], single("SHA256", data[i]));
+    }
+}
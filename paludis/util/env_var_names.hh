@@ -29,6 +29,7 @@ namespace paludis
     {
         const std::string bypass_userpriv_checks("PALUDIS_BYPASS_USERPRIV_CHECKS");
         const std::string default_output_conf("PALUDIS_DEFAULT_OUTPUT_CONF");
+        const std::string disable_cpu_features("PALUDIS_DISABLE_CPU_FEATURES");
         const std::string distribution("PALUDIS_DISTRIBUTION");
         const std::string distributions_dir("PALUDIS_DISTRIBUTIONS_DIR");
         const std::string do_nothing_sandboxy("PALUDIS_DO_NOTHING_SANDBOXY");
@@ -38,6 +39,7 @@ namespace paludis
         const std::string home("PALUDIS_HOME");
         const std::string hooker_dir("PALUDIS_HOOKER_DIR");
         const std::string ignore_hooks_named("PALUDIS_IGNORE_HOOKS_NAMED");
+        const std::string metadata_workers("PALUDIS_METADATA_WORKERS");
         const std::string no_chown("PALUDIS_NO_CHOWN");
         const std::string no_global_fetchers("PALUDIS_NO_GLOBAL_FETCHERS");
         const std::string no_global_hooks("PALUDIS_NO_GLOBAL_HOOKS");
@@ -20,8 +20,11 @@
 #include <paludis/util/exception.hh>
 #include <paludis/util/stringify.hh>
 #include <paludis/util/join.hh>
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <list>
+#include <vector>
 #include <cstdlib>
 #include <iostream>
 
@@ -35,12 +38,30 @@ using namespace paludis;
 
 namespace
 {
-    static thread_local std::list<std::string> context;
+    static thread_local std::vector<const Context *> context;
+
+    std::string context_message(const Context * const c)
+    {
+        try
+        {
+            return c->message();
+        }
+        catch (...)
+        {
+            return "(exception while formatting context)";
+        }
+    }
 }
 
-Context::Context(const std::string & s)
+Context::Context()
 {
-    context.push_back(s);
+    context.push_back(this);
+}
+
+Context::Context(const std::string & s) :
+    _message(s)
+{
+    context.push_back(this);
 }
 
 Context::~Context() noexcept(false)
@@ -50,13 +71,19 @@ Context::~Context() noexcept(false)
     context.pop_back();
 }
 
+std::string
+Context::message() const
+{
+    return _message;
+}
+
 std::string
 Context::backtrace(const std::string & delim)
 {
     if (context.empty())
         return "";
 
-    return join(context.begin(), context.end(), delim) + delim;
+    return join(context.begin(), context.end(), delim, context_message) + delim;
 }
 
 namespace paludis
@@ -67,7 +94,7 @@ namespace paludis
 
         ContextData()
         {
-            local_context.assign(context.begin(), context.end());
+            std::transform(context.begin(), context.end(), std::back_inserter(local_context), context_message);
         }
 
         ContextData(const ContextData & other) = default;
@@ -50,22 +50,74 @@ namespace paludis
             Context(const Context &);
             const Context & operator= (const Context &);
 
+            const std::string _message;
+
+        protected:
+            /**
+             * Constructor, for subclasses that override message().
+             *
+             * \since 3.0
+             */
+            Context();
+
         public:
             ///\name Basic operations
             ///\{
 
             Context(const std::string &);
 
-            ~Context() noexcept(false);
+            virtual ~Context() noexcept(false);
 
             ///\}
 
+            /**
+             * Our message, which is only asked for if a backtrace is made.
+             *
+             * \since 3.0
+             */
+            virtual std::string message() const;
+
             /**
              * Current context.
              */
             static std::string backtrace(const std::string & delim);
     };
 
+    /**
+     * A Context whose message is only formatted if it is needed, for use on
+     * hot paths where building the string would cost more than the work.
+     *
+     * The function is called from backtrace() and when an Exception is
+     * constructed, so anything it refers to must outlive the context.
+     *
+     * \ingroup g_exceptions
+     * \since 3.0
+     * \nosubgrouping
+     */
+    template <typename F_>
+    class LazyContext :
+        public Context
+    {
+        private:
+            const F_ _f;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit LazyContext(const F_ & f) :
+                _f(f)
+            {
+            }
+
+            ///\}
+
+            std::string message() const override
+            {
+                return _f();
+            }
+    };
+
     /**
      * Base exception class.
      *
@@ -0,0 +1,65 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/exception.hh>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(Context, Backtrace)
+{
+    EXPECT_EQ("", Context::backtrace("/"));
+    {
+        Context a("a");
+        {
+            Context b("b");
+            EXPECT_EQ("a/b/", Context::backtrace("/"));
+        }
+        EXPECT_EQ("a/", Context::backtrace("/"));
+    }
+    EXPECT_EQ("", Context::backtrace("/"));
+}
+
+TEST(Context, Lazy)
+{
+    int calls(0);
+    std::string name("monkey");
+
+    Context a("a");
+    LazyContext b([&] () { ++calls; return "b " + name; });
+    EXPECT_EQ(0, calls);
+
+    EXPECT_EQ("a/b monkey/", Context::backtrace("/"));
+    EXPECT_EQ(1, calls);
+
+    /* the message is captured when the exception is made, not when it is
+     * caught, since by then the context is gone */
+    try
+    {
+        throw ConfigurationError("oops");
+    }
+    catch (const Exception & e)
+    {
+        EXPECT_EQ(2, calls);
+        name = "cat";
+        EXPECT_EQ("a/b monkey/", e.backtrace("/"));
+    }
+    EXPECT_EQ(2, calls);
+}
@@ -34,6 +34,7 @@ using namespace paludis;
 typedef std::list<std::shared_ptr<Executive> > ExecutiveList;
 typedef std::map<std::string, ExecutiveList> Queues;
 typedef std::list<std::shared_ptr<Executive> > ReadyForPost;
+typedef std::map<std::string, int> Parallelism;
 
 Executive::~Executive() = default;
 
@@ -48,6 +49,7 @@ namespace paludis
         int done;
 
         Queues queues;
+        Parallelism parallelism;
         ReadyForPost ready_for_post;
         std::mutex mutex;
         std::condition_variable condition;
@@ -114,11 +116,22 @@ Executor::add(const std::shared_ptr<Executive> & x)
     _imp->queues.insert(std::make_pair(x->queue_name(), ExecutiveList())).first->second.push_back(x);
 }
 
+void
+Executor::set_queue_parallelism(const std::string & queue_name, const int n)
+{
+    if (n < 1)
+        throw InternalError(PALUDIS_HERE, "Queue '" + queue_name + "' must be allowed at least one running executive");
+
+    _imp->parallelism[queue_name] = n;
+}
+
 void
 Executor::execute()
 {
-    typedef std::map<std::string, std::pair<std::thread, std::shared_ptr<Executive> > > Running;
+    typedef std::map<std::shared_ptr<Executive>, std::thread> Running;
+    typedef std::map<std::string, int> RunningPerQueue;
     Running running;
+    RunningPerQueue running_per_queue;
 
     std::unique_lock<std::mutex> lock(_imp->mutex);
     while (true)
@@ -127,22 +140,40 @@ Executor::execute()
         for (Queues::iterator q(_imp->queues.begin()), q_end(_imp->queues.end()) ;
                 q != q_end ; )
         {
-            if ((running.end() != running.find(q->first)) || ! (*q->second.begin())->can_run())
+            Parallelism::const_iterator p(_imp->parallelism.find(q->first));
+            int limit(_imp->parallelism.end() == p ? 1 : p->second);
+            int & running_here(running_per_queue[q->first]);
+
+            while (running_here < limit && ! q->second.empty())
             {
-                ++q;
-                continue;
+                /* with one at a time, only the head may go, so that things
+                 * run in the order they were added */
+                ExecutiveList::iterator x(q->second.begin());
+                if (1 == limit)
+                {
+                    if (! (*x)->can_run())
+                        x = q->second.end();
+                }
+                else
+                    while (x != q->second.end() && ! (*x)->can_run())
+                        ++x;
+
+                if (x == q->second.end())
+                    break;
+
+                ++_imp->active;
+                --_imp->pending;
+                ++running_here;
+                (*x)->pre_execute_exclusive();
+                running.insert(std::make_pair(*x, std::thread(std::bind(&Executor::_one, this, *x))));
+                q->second.erase(x);
+                any = true;
             }
 
-            ++_imp->active;
-            --_imp->pending;
-            (*q->second.begin())->pre_execute_exclusive();
-            running.insert(std::make_pair(q->first, std::make_pair(std::thread(std::bind(&Executor::_one, this, *q->second.begin())), *q->second.begin())));
-            q->second.erase(q->second.begin());
             if (q->second.empty())
                 _imp->queues.erase(q++);
             else
                 ++q;
-            any = true;
         }
 
         if ((! any) && running.empty())
@@ -155,15 +186,16 @@ Executor::execute()
         _imp->condition.wait_for(lock, std::chrono::milliseconds(_imp->ms_update_interval));
 
         for (auto & r : running)
-            r.second.second->flush_threaded();
+            r.first->flush_threaded();
 
         for (auto & p : _imp->ready_for_post)
         {
             --_imp->active;
             ++_imp->done;
-            auto r = running.find(p->queue_name());
-            r->second.first.join();
+            auto r = running.find(p);
+            r->second.join();
             running.erase(r);
+            --running_per_queue[p->queue_name()];
             p->post_execute_exclusive();
         }
 
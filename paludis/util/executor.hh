@@ -61,6 +61,15 @@ namespace paludis
 
             void add(const std::shared_ptr<Executive> & x);
 
+            /**
+             * Allow up to n executives from the named queue to run at once.
+             *
+             * By default a queue runs one executive at a time, in the order
+             * they were added. Otherwise any executive in the queue may start
+             * once its can_run() says so.
+             */
+            void set_queue_parallelism(const std::string & queue_name, const int n);
+
             void execute();
 
             std::mutex & exclusivity_mutex() PALUDIS_ATTRIBUTE((warn_unused_result));
@@ -0,0 +1,122 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/file_lock.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/log.hh>
+#include <paludis/util/exception.hh>
+#include <paludis/util/stringify.hh>
+#include <paludis/util/pimp-impl.hh>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+using namespace paludis;
+
+namespace
+{
+    /* flock(2) locks belong to an open file, not to a thread, so every
+     * FileLock on the same path in this process has to share one. */
+    struct Held
+    {
+        std::recursive_mutex mutex;
+        int depth = 0;
+        int fd = -1;
+    };
+
+    std::mutex held_mutex;
+    std::map<std::string, std::shared_ptr<Held> > held;
+
+    const std::shared_ptr<Held> held_for(const FSPath & f)
+    {
+        std::unique_lock<std::mutex> lock(held_mutex);
+        std::shared_ptr<Held> & result(held[stringify(f)]);
+        if (! result)
+            result = std::make_shared<Held>();
+        return result;
+    }
+}
+
+namespace paludis
+{
+    template <>
+    struct Imp<FileLock>
+    {
+        const std::shared_ptr<Held> held;
+
+        Imp(const std::shared_ptr<Held> & h) :
+            held(h)
+        {
+        }
+    };
+}
+
+FileLock::FileLock(const FSPath & f) :
+    _imp(held_for(f))
+{
+    _imp->held->mutex.lock();
+    if (0 != _imp->held->depth++)
+        return;
+
+    Context context("When locking '" + stringify(f) + "':");
+
+    int fd(::open(stringify(f).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644));
+    if (-1 == fd)
+    {
+        Log::get_instance()->message("util.file_lock.open", ll_warning, lc_context)
+            << "Couldn't open lock file: " << std::strerror(errno);
+        return;
+    }
+
+    int r;
+    while (-1 == (r = ::flock(fd, LOCK_EX)) && EINTR == errno)
+        ;
+
+    if (-1 == r)
+    {
+        Log::get_instance()->message("util.file_lock.flock", ll_warning, lc_context)
+            << "Couldn't lock file: " << std::strerror(errno);
+        ::close(fd);
+        return;
+    }
+
+    _imp->held->fd = fd;
+}
+
+FileLock::~FileLock()
+{
+    if (0 == --_imp->held->depth && -1 != _imp->held->fd)
+    {
+        ::close(_imp->held->fd);
+        _imp->held->fd = -1;
+    }
+
+    _imp->held->mutex.unlock();
+}
+
+namespace paludis
+{
+    template class Pimp<FileLock>;
+}
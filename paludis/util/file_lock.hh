@@ -0,0 +1,74 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_FILE_LOCK_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_FILE_LOCK_HH 1
+
+#include <paludis/util/file_lock-fwd.hh>
+#include <paludis/util/fs_path-fwd.hh>
+#include <paludis/util/attributes.hh>
+#include <paludis/util/pimp.hh>
+
+/** \file
+ * Declarations for the FileLock class.
+ *
+ * \ingroup g_fs
+ *
+ * \section Examples
+ *
+ * - None at this time.
+ */
+
+namespace paludis
+{
+    /**
+     * Holds an exclusive lock on a file for as long as it exists.
+     *
+     * The lock excludes other processes, using flock(2), and other threads in
+     * this process. A thread that already holds the lock on a file may lock it
+     * again, so an operation that takes the lock may call another one that
+     * takes it too.
+     *
+     * The file is created if it does not exist. If it cannot be opened or
+     * locked, a warning is logged and we carry on without the lock held
+     * against other processes.
+     *
+     * \ingroup g_fs
+     * \nosubgrouping
+     */
+    class PALUDIS_VISIBLE FileLock
+    {
+        private:
+            Pimp<FileLock> _imp;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit FileLock(const FSPath &);
+            ~FileLock();
+
+            FileLock(const FileLock &) = delete;
+            FileLock & operator= (const FileLock &) = delete;
+
+            ///\}
+    };
+
+    extern template class Pimp<FileLock>;
+}
+
+#endif
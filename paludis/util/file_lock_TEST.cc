@@ -0,0 +1,109 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/file_lock.hh>
+#include <paludis/util/fs_path.hh>
+#include <paludis/util/fs_stat.hh>
+#include <paludis/util/stringify.hh>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+namespace
+{
+    /* flock locks belong to an open file, so a second open of the same file
+     * behaves like another process would */
+    bool locked_elsewhere(const FSPath & f)
+    {
+        int fd(::open(stringify(f).c_str(), O_RDWR | O_CLOEXEC));
+        if (-1 == fd)
+            return false;
+
+        bool result(-1 == ::flock(fd, LOCK_EX | LOCK_NB) && EWOULDBLOCK == errno);
+        ::close(fd);
+        return result;
+    }
+}
+
+TEST(FileLock, Works)
+{
+    FSPath f("file_lock_TEST_dir/works");
+    EXPECT_TRUE(! f.stat().exists());
+
+    {
+        FileLock lock(f);
+        EXPECT_TRUE(f.stat().is_regular_file());
+        EXPECT_TRUE(locked_elsewhere(f));
+    }
+
+    EXPECT_TRUE(! locked_elsewhere(f));
+}
+
+TEST(FileLock, Recursive)
+{
+    FSPath f("file_lock_TEST_dir/recursive");
+
+    {
+        FileLock lock(f);
+        {
+            FileLock again(f);
+            EXPECT_TRUE(locked_elsewhere(f));
+        }
+        EXPECT_TRUE(locked_elsewhere(f));
+    }
+
+    EXPECT_TRUE(! locked_elsewhere(f));
+}
+
+TEST(FileLock, Threads)
+{
+    FSPath f("file_lock_TEST_dir/threads");
+    std::atomic<bool> got_it(false);
+    std::thread t;
+
+    {
+        FileLock lock(f);
+        t = std::thread([&] () {
+                FileLock other(f);
+                got_it = true;
+                });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_TRUE(! got_it);
+    }
+
+    t.join();
+    EXPECT_TRUE(got_it);
+    EXPECT_TRUE(! locked_elsewhere(f));
+}
+
+TEST(FileLock, NoDirectory)
+{
+    FSPath f("file_lock_TEST_dir/no_directory/lock");
+    FileLock lock(f);
+    EXPECT_TRUE(! f.stat().exists());
+}
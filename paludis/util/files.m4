@@ -17,11 +17,12 @@ add(`checked_delete',                    `hh')
 add(`clone',                             `hh', `impl')
 add(`config_file',                       `hh', `cc', `fwd', `se', `gtest', `testscript')
 add(`cookie',                            `hh', `cc')
+add(`cpu_features',                      `hh', `cc')
 add(`create_iterator',                   `hh', `fwd', `impl', `gtest')
 add(`damerau_levenshtein',               `hh', `cc', `gtest')
 add(`destringify',                       `hh', `cc', `gtest')
 add(`deferred_construction_ptr',         `hh', `cc', `fwd', `gtest')
-add(`digest_registry',                   `hh', `cc')
+add(`digest_registry',                   `hh', `cc', `gtest')
 add(`discard_output_stream',             `hh', `cc')
 add(`elf',                               `hh', `cc')
 add(`elf_dynamic_section',               `hh', `cc')
@@ -31,16 +32,18 @@ add(`elf_symbol_section',                `hh', `cc')
 add(`elf_types',                         `hh')
 add(`enum_iterator',                     `hh', `cc', `fwd', `gtest')
 add(`env_var_names',                     `hh', `cc')
-add(`exception',                         `hh', `cc')
+add(`exception',                         `hh', `cc', `gtest')
 add(`executor',                          `hh', `cc', `fwd')
 add(`extract_host_from_url',             `hh', `cc', `fwd', `gtest')
 add(`fd_holder',                         `hh')
+add(`file_lock',                         `hh', `cc', `fwd', `gtest', `testscript')
 add(`fs_iterator',                       `hh', `cc', `fwd', `se', `gtest', `testscript')
 add(`fs_error',                          `hh', `cc')
 add(`fs_path',                           `hh', `cc', `fwd', `se', `gtest', `testscript')
 add(`fs_stat',                           `hh', `cc', `fwd', `gtest', `testscript')
 add(`graph',                             `hh', `cc', `fwd', `impl', `gtest')
 add(`hashes',                            `hh', `cc', `gtest')
+add(`interned_string',                   `hh', `cc', `gtest')
 add(`iterator_funcs',                    `hh', `gtest')
 add(`iterator_range',                    `hh')
 add(`indirect_iterator',                 `hh', `fwd', `impl', `gtest')
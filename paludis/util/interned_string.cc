@@ -0,0 +1,67 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/interned_string.hh>
+#include <paludis/util/hashes.hh>
+#include <mutex>
+#include <unordered_map>
+
+using namespace paludis;
+
+namespace
+{
+    /* split by hash, so threads creating lots of names at once (for example
+     * when loading repositories in parallel) rarely want the same lock */
+    const std::size_t n_shards(64);
+
+    struct Shard
+    {
+        std::mutex mutex;
+
+        /* nodes never move, so handing out pointers to the entries is safe */
+        std::unordered_map<std::string, std::size_t, Hash<std::string> > strings;
+    };
+
+    Shard * shards()
+    {
+        /* deliberately leaked, so that names in static objects stay valid
+         * however late they are destroyed */
+        static Shard * const result(new Shard[n_shards]);
+        return result;
+    }
+}
+
+InternedString::InternedString(const std::string & s)
+{
+    std::size_t hash(Hash<std::string>()(s));
+    Shard & shard(shards()[(hash >> 7) % n_shards]);
+
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    _entry = &*shard.strings.try_emplace(s, hash).first;
+}
+
+std::size_t
+InternedString::number_interned()
+{
+    std::size_t result(0);
+    for (std::size_t i(0) ; i != n_shards ; ++i)
+    {
+        std::unique_lock<std::mutex> lock(shards()[i].mutex);
+        result += shards()[i].strings.size();
+    }
+    return result;
+}
@@ -0,0 +1,85 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PALUDIS_GUARD_PALUDIS_UTIL_INTERNED_STRING_HH
+#define PALUDIS_GUARD_PALUDIS_UTIL_INTERNED_STRING_HH 1
+
+#include <paludis/util/attributes.hh>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace paludis
+{
+    /**
+     * A pointer-sized handle to a string held in a global, thread-safe table,
+     * so that equal strings share storage and compare and hash in constant
+     * time.
+     *
+     * Strings are never removed from the table, so this is for things like
+     * names, where there is a bounded set of values that are used over and
+     * over again.
+     *
+     * Ordering is by string value, so it is the same from run to run.
+     *
+     * \ingroup g_data_structures
+     * \since 3.0
+     */
+    class PALUDIS_VISIBLE InternedString
+    {
+        private:
+            const std::pair<const std::string, std::size_t> * _entry;
+
+        public:
+            ///\name Basic operations
+            ///\{
+
+            explicit InternedString(const std::string &);
+
+            ///\}
+
+            const std::string & value() const PALUDIS_ATTRIBUTE((warn_unused_result))
+            {
+                return _entry->first;
+            }
+
+            /**
+             * Our hash, which is the same as Hash<std::string> for our value.
+             */
+            std::size_t hash() const PALUDIS_ATTRIBUTE((warn_unused_result))
+            {
+                return _entry->second;
+            }
+
+            bool operator== (const InternedString & other) const PALUDIS_ATTRIBUTE((warn_unused_result))
+            {
+                return _entry == other._entry;
+            }
+
+            bool operator< (const InternedString & other) const PALUDIS_ATTRIBUTE((warn_unused_result))
+            {
+                return _entry != other._entry && _entry->first < other._entry->first;
+            }
+
+            /**
+             * How many distinct strings have been interned, for statistics.
+             */
+            static std::size_t number_interned() PALUDIS_ATTRIBUTE((warn_unused_result));
+    };
+}
+
+#endif
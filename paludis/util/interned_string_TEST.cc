@@ -0,0 +1,68 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/util/interned_string.hh>
+#include <paludis/util/hashes.hh>
+#include <paludis/util/thread_pool.hh>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace paludis;
+
+TEST(InternedString, Works)
+{
+    InternedString a("monkey"), b(std::string("mon") + "key"), c("gorilla");
+
+    EXPECT_EQ("monkey", a.value());
+    EXPECT_EQ(&a.value(), &b.value());
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a == c);
+
+    EXPECT_EQ(Hash<std::string>()("monkey"), a.hash());
+    EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(InternedString, Ordering)
+{
+    InternedString a("aardvark"), b("badger"), a2("aardvark");
+
+    EXPECT_TRUE(a < b);
+    EXPECT_FALSE(b < a);
+    EXPECT_FALSE(a < a2);
+    EXPECT_FALSE(a2 < a);
+}
+
+TEST(InternedString, Threads)
+{
+    std::vector<const std::string *> values(8);
+    {
+        ThreadPool pool;
+        for (unsigned t(0) ; t != values.size() ; ++t)
+            pool.create_thread([&values, t] () {
+                    for (unsigned i(0) ; i != 1000 ; ++i)
+                        InternedString("thread-" + std::to_string(i));
+                    values[t] = &InternedString("thread-500").value();
+                    });
+    }
+
+    for (const auto & v : values)
+        EXPECT_EQ(values[0], v);
+    EXPECT_TRUE(InternedString::number_interned() >= 1000u);
+}
@@ -22,6 +22,7 @@
 #include <paludis/util/singleton-impl.hh>
 #include <paludis/util/exception.hh>
 #include <iostream>
+#include <atomic>
 #include <exception>
 #include <mutex>
 
@@ -44,7 +45,7 @@ namespace paludis
     struct Imp<Log>
     {
         std::mutex mutex;
-        LogLevel log_level;
+        std::atomic<LogLevel> log_level;
         std::ostream * stream;
         std::string program_name;
         std::string previous_context;
@@ -161,6 +162,8 @@ Log::_message(const std::string & id, const LogLevel l, const LogContext c, cons
 }
 
 LogMessageHandler::LogMessageHandler(const LogMessageHandler & o) :
+    _log(o._log),
+    _wanted(o._wanted),
     _id(o._id),
     _message(o._message),
     _log_level(o._log_level),
@@ -190,7 +193,8 @@ Log::set_program_name(const std::string & s)
 
 LogMessageHandler::LogMessageHandler(Log * const ll, const std::string & id, const LogLevel l, const LogContext c) :
     _log(ll),
-    _id(id),
+    _wanted(l >= ll->log_level()),
+    _id(_wanted ? id : std::string()),
     _log_level(l),
     _log_context(c)
 {
@@ -204,7 +208,7 @@ LogMessageHandler::_append(const std::string & s)
 
 LogMessageHandler::~LogMessageHandler()
 {
-    if (0 == std::uncaught_exceptions() && ! _message.empty())
+    if (_wanted && 0 == std::uncaught_exceptions() && ! _message.empty())
         _log->_message(_id, _log_level, _log_context, _message);
 }
 
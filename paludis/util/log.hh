@@ -111,6 +111,7 @@ namespace paludis
 
         private:
             Log * _log;
+            bool _wanted;
             std::string _id;
             std::string _message;
             LogLevel _log_level;
@@ -132,12 +133,16 @@ namespace paludis
 
             /**
              * Append some text to our message.
+             *
+             * Nothing is stringified if the message is below the log level,
+             * so callers need not guard debug messages themselves.
              */
             template <typename T_>
             LogMessageHandler &
             operator<< (const T_ & t)
             {
-                _append(stringify(t));
+                if (_wanted)
+                    _append(stringify(t));
                 return *this;
             }
     };
@@ -82,6 +82,24 @@ TEST(Log, Messages)
     EXPECT_TRUE(std::string::npos != t.str().find("three.14"));
 }
 
+TEST(Log, Discarded)
+{
+    Log::destroy_instance();
+
+    std::stringstream s;
+    Log::get_instance()->set_log_stream(&s);
+    Log::get_instance()->set_log_level(ll_warning);
+
+    /* below the log level, nothing should even be stringified */
+    EXPECT_NO_THROW(Log::get_instance()->message("test.log", ll_debug, lc_no_context)
+            << "one" << throws_a_monkey_when_stringified() << "two");
+    EXPECT_TRUE(s.str().empty());
+
+    EXPECT_THROW(Log::get_instance()->message("test.log", ll_warning, lc_no_context)
+            << "one" << throws_a_monkey_when_stringified() << "two", Monkey);
+    EXPECT_TRUE(s.str().empty());
+}
+
 TEST(Log, Exceptions)
 {
     Log::destroy_instance();
@@ -147,46 +147,52 @@ MD5::_update(const uint8_t * const block)
     _r[3] += d;
 }
 
-MD5::MD5(std::istream & stream) :
+MD5::MD5() :
     _size(0),
-    _done_one_pad(false)
+    _buffer_used(0)
 {
     _r[0] = 0x67452301;
     _r[1] = 0xefcdab89;
     _r[2] = 0x98badcfe;
     _r[3] = 0x10325476;
+}
 
-    uint8_t buffer[64];
-    int c;
-    int s(0);
-    while (-1 != ((c = _get(stream))))
-    {
-        buffer[s++] = c;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
-    while (56 != s)
-    {
-        buffer[s++] = 0;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
+MD5::MD5(std::istream & stream) :
+    MD5()
+{
+    digest_stream(*this, stream);
+    finish();
+}
+
+void
+MD5::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<64>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+            for ( ; n > 0 ; --n, b += 64)
+                _update(b);
+            });
+}
 
-    buffer[56] = static_cast<uint8_t>(_size >> (0 * 8));
-    buffer[57] = static_cast<uint8_t>(_size >> (1 * 8));
-    buffer[58] = static_cast<uint8_t>(_size >> (2 * 8));
-    buffer[59] = static_cast<uint8_t>(_size >> (3 * 8));
-    buffer[60] = static_cast<uint8_t>(_size >> (4 * 8));
-    buffer[61] = static_cast<uint8_t>(_size >> (5 * 8));
-    buffer[62] = static_cast<uint8_t>(_size >> (6 * 8));
-    buffer[63] = static_cast<uint8_t>(_size >> (7 * 8));
-    _update(&buffer[0]);
+void
+MD5::finish()
+{
+    uint64_t size(_size * 8);
+
+    char padding[64] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 56 ? 56 : 120) - _buffer_used);
+
+    char length[8] = {
+        static_cast<char>(size >> (0 * 8)),
+        static_cast<char>(size >> (1 * 8)),
+        static_cast<char>(size >> (2 * 8)),
+        static_cast<char>(size >> (3 * 8)),
+        static_cast<char>(size >> (4 * 8)),
+        static_cast<char>(size >> (5 * 8)),
+        static_cast<char>(size >> (6 * 8)),
+        static_cast<char>(size >> (7 * 8))
+    };
+    update(length, 8);
 }
 
 std::string
@@ -201,24 +207,6 @@ MD5::hexsum() const
     return result.str();
 }
 
-int
-MD5::_get(std::istream & stream)
-{
-    char c;
-    if (stream.get(c))
-    {
-        _size += 8;
-        return static_cast<unsigned char>(c);
-    }
-    else if (! _done_one_pad)
-    {
-        _done_one_pad = true;
-        return 0x80;
-    }
-    else
-        return -1;
-}
-
 const uint8_t MD5::_s[64] = {
     7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
     5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
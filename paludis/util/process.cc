@@ -314,6 +314,12 @@ ProcessCommand::clearenv()
     return *this;
 }
 
+const std::map<std::string, std::string> &
+ProcessCommand::setenvs() const
+{
+    return _imp->setenvs;
+}
+
 ProcessCommand &
 ProcessCommand::chdir(const FSPath & f)
 {
@@ -1252,6 +1258,12 @@ Process::clearenv()
     return *this;
 }
 
+const std::map<std::string, std::string> &
+Process::setenvs() const
+{
+    return _imp->command.setenvs();
+}
+
 Process &
 Process::chdir(const FSPath & path)
 {
@@ -1451,7 +1463,7 @@ RunningProcessHandle::~RunningProcessHandle() noexcept(false)
 RunningProcessHandle::RunningProcessHandle(RunningProcessHandle && other) :
     _imp(other._imp->pid, std::move(other._imp->thread))
 {
-    _imp->pid = -1;
+    other._imp->pid = -1;
 }
 
 int
@@ -31,6 +31,7 @@
 #include <memory>
 #include <functional>
 #include <initializer_list>
+#include <map>
 #include <vector>
 
 #include <sys/types.h>
@@ -80,6 +81,12 @@ namespace paludis
             ProcessCommand & chdir(const FSPath &);
             ProcessCommand & setuid_setgid(uid_t, gid_t);
 
+            /**
+             * The environment variables we have been asked to set in the
+             * child.
+             */
+            const std::map<std::string, std::string> & setenvs() const;
+
             void exec_prepare();
             void exec(int err_fd = -1) PALUDIS_ATTRIBUTE((noreturn));
 
@@ -106,6 +113,12 @@ namespace paludis
             Process & chdir(const FSPath &);
             Process & setuid_setgid(uid_t, gid_t);
 
+            /**
+             * The environment variables we have been asked to set in the
+             * child, not including any that are only added by run().
+             */
+            const std::map<std::string, std::string> & setenvs() const;
+
             Process & capture_stdout(std::ostream &);
             Process & capture_stderr(std::ostream &);
             Process & capture_output_to_fd(std::ostream &, int fd_or_minus_one, const std::string & env_var_with_fd);
@@ -126,47 +126,53 @@ RMD160::_update(const uint8_t * const block)
     _h[0] = t;
 }
 
-RMD160::RMD160(std::istream & stream) :
+RMD160::RMD160() :
     _size(0),
-    _done_one_pad(false)
+    _buffer_used(0)
 {
     _h[0] = 0x67452301;
     _h[1] = 0xefcdab89;
     _h[2] = 0x98badcfe;
     _h[3] = 0x10325476;
     _h[4] = 0xc3d2e1f0;
+}
 
-    uint8_t buffer[64];
-    int c;
-    int s(0);
-    while (-1 != ((c = _get(stream))))
-    {
-        buffer[s++] = c;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
-    while (56 != s)
-    {
-        buffer[s++] = 0;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
+RMD160::RMD160(std::istream & stream) :
+    RMD160()
+{
+    digest_stream(*this, stream);
+    finish();
+}
 
-    buffer[56] = static_cast<uint8_t>(_size >> (0 * 8));
-    buffer[57] = static_cast<uint8_t>(_size >> (1 * 8));
-    buffer[58] = static_cast<uint8_t>(_size >> (2 * 8));
-    buffer[59] = static_cast<uint8_t>(_size >> (3 * 8));
-    buffer[60] = static_cast<uint8_t>(_size >> (4 * 8));
-    buffer[61] = static_cast<uint8_t>(_size >> (5 * 8));
-    buffer[62] = static_cast<uint8_t>(_size >> (6 * 8));
-    buffer[63] = static_cast<uint8_t>(_size >> (7 * 8));
-    _update(&buffer[0]);
+void
+RMD160::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<64>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+            for ( ; n > 0 ; --n, b += 64)
+                _update(b);
+            });
+}
+
+void
+RMD160::finish()
+{
+    uint64_t size(_size * 8);
+
+    char padding[64] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 56 ? 56 : 120) - _buffer_used);
+
+    char length[8] = {
+        static_cast<char>(size >> (0 * 8)),
+        static_cast<char>(size >> (1 * 8)),
+        static_cast<char>(size >> (2 * 8)),
+        static_cast<char>(size >> (3 * 8)),
+        static_cast<char>(size >> (4 * 8)),
+        static_cast<char>(size >> (5 * 8)),
+        static_cast<char>(size >> (6 * 8)),
+        static_cast<char>(size >> (7 * 8))
+    };
+    update(length, 8);
 }
 
 std::string
@@ -181,24 +187,6 @@ RMD160::hexsum() const
     return result.str();
 }
 
-int
-RMD160::_get(std::istream & stream)
-{
-    char c;
-    if (stream.get(c))
-    {
-        _size += 8;
-        return static_cast<unsigned char>(c);
-    }
-    else if (! _done_one_pad)
-    {
-        _done_one_pad = true;
-        return 0x80;
-    }
-    else
-        return -1;
-}
-
 const uint8_t RMD160::_r[80] = {
     0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
     7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
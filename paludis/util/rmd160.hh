@@ -22,6 +22,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstddef>
 #include <inttypes.h>
 #include <paludis/util/attributes.hh>
 
@@ -51,18 +52,33 @@ namespace paludis
 
             uint32_t _h[5];
             uint64_t _size;
-            bool _done_one_pad;
+            uint8_t _buffer[64];
+            std::size_t _buffer_used;
 
             void PALUDIS_HIDDEN _update(const uint8_t * const block);
 
-            inline int PALUDIS_HIDDEN _get(std::istream & stream);
-
         public:
             /**
-             * Constructor.
+             * Constructor, for use with update() and finish().
+             */
+            RMD160();
+
+            /**
+             * Constructor, for the digest of everything left in a stream.
              */
             RMD160(std::istream & stream);
 
+            /**
+             * Add more data to the digest.
+             */
+            void update(const char * data, std::size_t length);
+
+            /**
+             * Add the final padding. Must be called once, after all the
+             * data has been given to update(), and before hexsum().
+             */
+            void finish();
+
             /**
              * Our checksum, as a string of hex characters.
              */
@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <string.h>
 #include <cstring>
+#include <algorithm>
 #include <errno.h>
 
 using namespace paludis;
@@ -58,6 +59,36 @@ SafeIFStreamBuf::underflow()
     return traits_type::to_int_type(*gptr());
 }
 
+std::streamsize
+SafeIFStreamBuf::xsgetn(char_type * s, std::streamsize n)
+{
+    /* small reads go through our buffer as normal, but there's no point
+     * copying large reads through it 512 bytes at a time */
+    if (n < buffer_size - lookbehind_size)
+        return std::streambuf::xsgetn(s, n);
+
+    std::streamsize result(std::min<std::streamsize>(n, egptr() - gptr()));
+    std::memcpy(s, gptr(), result);
+    gbump(result);
+
+    while (result < n)
+    {
+        ssize_t n_read(read(fd, s + result, n - result));
+        if (-1 == n_read)
+            throw SafeIFStreamError("Error reading from fd " + stringify(fd) + ": " + strerror(errno));
+        else if (0 == n_read)
+            break;
+        result += n_read;
+    }
+
+    /* keep the last few bytes around, so that putback still works */
+    int n_putback(std::min<std::streamsize>(result, lookbehind_size));
+    std::memcpy(buffer + (lookbehind_size - n_putback), s + result - n_putback, n_putback);
+    setg(buffer + (lookbehind_size - n_putback), buffer + lookbehind_size, buffer + lookbehind_size);
+
+    return result;
+}
+
 SafeIFStreamBuf::pos_type
 SafeIFStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode)
 {
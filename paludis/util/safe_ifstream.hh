@@ -56,6 +56,7 @@ namespace paludis
             char buffer[buffer_size];
 
             int_type underflow() override;
+            std::streamsize xsgetn(char_type *, std::streamsize) override;
             pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override;
             pos_type seekpos(pos_type, std::ios_base::openmode) override;
 
@@ -49,6 +49,24 @@ TEST(SafeIFStream, Existing)
     EXPECT_EQ(std::string(1000, 'x'), t);
 }
 
+TEST(SafeIFStream, LargeRead)
+{
+    SafeIFStream s(FSPath::cwd() / "safe_ifstream_TEST_dir" / "existing");
+    ASSERT_TRUE(bool(s));
+    std::string t;
+    s >> t;
+    EXPECT_EQ("first", t);
+
+    std::string buffer(2000, '\0');
+    std::streamsize n(s.rdbuf()->sgetn(&buffer[0], buffer.size()));
+    EXPECT_EQ(1002, n);
+    EXPECT_EQ("\n" + std::string(1000, 'x') + "\n", buffer.substr(0, n));
+
+    ASSERT_TRUE(s.unget());
+    EXPECT_EQ('\n', s.get());
+    EXPECT_EQ(std::char_traits<char>::eof(), s.get());
+}
+
 TEST(SafeIFStream, ExistingSym)
 {
     SafeIFStream s(FSPath::cwd() / "safe_ifstream_TEST_dir" / "existing");
@@ -24,6 +24,7 @@
 #include <istream>
 #include <iomanip>
 #include <algorithm>
+#include <cstring>
 
 using namespace paludis;
 
@@ -109,8 +110,11 @@ namespace
 }
 
 void
-SHA1::process_block(uint32_t * w)
+SHA1::process_block(const uint8_t * block)
 {
+    uint32_t w[80];
+    std::memcpy(w, block, 64);
+
     uint32_t a(h0);
     uint32_t b(h1);
     uint32_t c(h2);
@@ -135,46 +139,44 @@ SHA1::process_block(uint32_t * w)
 }
 
 
-SHA1::SHA1(std::istream & s) :
+SHA1::SHA1() :
     h0(0x67452301U),
     h1(0xEFCDAB89U),
     h2(0x98BADCFEU),
     h3(0x10325476U),
-    h4(0xC3D2E1F0U)
+    h4(0xC3D2E1F0U),
+    _size(0),
+    _buffer_used(0)
 {
-    std::streambuf * buf(s.rdbuf());
-    uint64_t size(0);
+}
 
-    union
-    {
-        uint8_t  m[64];
-        uint32_t w[80];
-    } block;
-    std::streamsize block_size;
+SHA1::SHA1(std::istream & s) :
+    SHA1()
+{
+    digest_stream(*this, s);
+    finish();
+}
 
-    do
-    {
-        block_size = buf->sgetn(reinterpret_cast<char *>(block.m), 64);
-        size += block_size * 8;
+void
+SHA1::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<64>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+            for ( ; n > 0 ; --n, b += 64)
+                process_block(b);
+            });
+}
 
-        if (64 != block_size)
-        {
-            block.m[block_size++] = 0x80U;
-
-            if (56 < block_size)
-            {
-                std::fill(&block.m[block_size], &block.m[64], 0);
-                process_block(block.w);
-                block_size = 0;
-            }
-
-            std::fill(&block.m[block_size], &block.m[56], 0);
-            block.w[14] = to_bigendian<uint32_t>((size >> 32) & 0xFFFFFFFFU);
-            block.w[15] = to_bigendian<uint32_t>(size & 0xFFFFFFFFU);
-        }
+void
+SHA1::finish()
+{
+    uint64_t size(_size * 8);
+
+    char padding[64] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 56 ? 56 : 120) - _buffer_used);
 
-        process_block(block.w);
-    } while (64 == block_size);
+    uint32_t length[2] = { to_bigendian<uint32_t>((size >> 32) & 0xFFFFFFFFU), to_bigendian<uint32_t>(size & 0xFFFFFFFFU) };
+    update(reinterpret_cast<const char *>(length), 8);
 }
 
 std::string
@@ -23,6 +23,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstddef>
 #include <inttypes.h>
 #include <paludis/util/attributes.hh>
 
@@ -47,15 +48,34 @@ namespace paludis
     {
         private:
             uint32_t h0, h1, h2, h3, h4;
+            uint64_t _size;
+            uint8_t _buffer[64];
+            std::size_t _buffer_used;
 
-            void PALUDIS_HIDDEN process_block(uint32_t *);
+            void PALUDIS_HIDDEN process_block(const uint8_t *);
 
         public:
             /**
-             * Constructor.
+             * Constructor, for use with update() and finish().
+             */
+            SHA1();
+
+            /**
+             * Constructor, for the digest of everything left in a stream.
              */
             SHA1(std::istream & stream);
 
+            /**
+             * Add more data to the digest.
+             */
+            void update(const char * data, std::size_t length);
+
+            /**
+             * Add the final padding. Must be called once, after all the
+             * data has been given to update(), and before hexsum().
+             */
+            void finish();
+
             /**
              * Our checksum, as a string of hex characters.
              */
@@ -20,10 +20,15 @@
 #include "sha256.hh"
 #include <paludis/util/attributes.hh>
 #include <paludis/util/digest_registry.hh>
+#include <paludis/util/cpu_features.hh>
 #include <istream>
 #include <iomanip>
 #include <sstream>
 
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
+
 using namespace paludis;
 
 /*
@@ -94,6 +99,73 @@ namespace
     }
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+#  define PALUDIS_SHA256_SHA_NI 1
+
+namespace
+{
+    /*
+     * SHA-256 using the SHA extensions. Each call to sha256rnds2 does two
+     * rounds, on the state split up as ABEF and CDGH, and sha256msg1 and
+     * sha256msg2 do most of the work for the message schedule.
+     */
+    PALUDIS_ATTRIBUTE((target("sha,sse4.1,ssse3")))
+    void update_sha_ni(uint32_t * const h, const uint32_t * const k, const uint8_t * data, std::size_t n)
+    {
+        const __m128i byte_swap(_mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL));
+
+        __m128i tmp(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[0])));
+        __m128i state1(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[4])));
+
+        tmp = _mm_shuffle_epi32(tmp, 0xb1);
+        state1 = _mm_shuffle_epi32(state1, 0x1b);
+        __m128i state0(_mm_alignr_epi8(tmp, state1, 8));
+        state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+        for ( ; n > 0 ; --n, data += 64)
+        {
+            const __m128i abef_save(state0);
+            const __m128i cdgh_save(state1);
+
+            __m128i m[4];
+#pragma GCC unroll 16
+            for (int g(0) ; g < 16 ; ++g)
+            {
+                if (g < 4)
+                    m[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * g)), byte_swap);
+
+                __m128i msg(_mm_add_epi32(m[g % 4], _mm_loadu_si128(reinterpret_cast<const __m128i *>(k + 4 * g))));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+                if (g >= 3 && g < 15)
+                {
+                    tmp = _mm_alignr_epi8(m[g % 4], m[(g + 3) % 4], 4);
+                    m[(g + 1) % 4] = _mm_add_epi32(m[(g + 1) % 4], tmp);
+                    m[(g + 1) % 4] = _mm_sha256msg2_epu32(m[(g + 1) % 4], m[g % 4]);
+                }
+
+                msg = _mm_shuffle_epi32(msg, 0x0e);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+                if (g >= 1 && g < 13)
+                    m[(g + 3) % 4] = _mm_sha256msg1_epu32(m[(g + 3) % 4], m[g % 4]);
+            }
+
+            state0 = _mm_add_epi32(state0, abef_save);
+            state1 = _mm_add_epi32(state1, cdgh_save);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1b);
+        state1 = _mm_shuffle_epi32(state1, 0xb1);
+        state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+        state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[0]), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[4]), state1);
+    }
+}
+#endif
+
 void
 SHA256::_update(const uint8_t * const block)
 {
@@ -138,9 +210,9 @@ SHA256::_update(const uint8_t * const block)
     _h[7] += h;
 }
 
-SHA256::SHA256(std::istream & stream) :
+SHA256::SHA256() :
     _size(0),
-    _done_one_pad(false)
+    _buffer_used(0)
 {
     _h[0] = 0x6a09e667;
     _h[1] = 0xbb67ae85;
@@ -150,38 +222,51 @@ SHA256::SHA256(std::istream & stream) :
     _h[5] = 0x9b05688c;
     _h[6] = 0x1f83d9ab;
     _h[7] = 0x5be0cd19;
+}
 
-    uint8_t buffer[64];
-    int c;
-    int s(0);
-    while (-1 != ((c = _get(stream))))
-    {
-        buffer[s++] = c;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
-    while (56 != s)
-    {
-        buffer[s++] = 0;
-        if (64 == s)
-        {
-            _update(&buffer[0]);
-            s = 0;
-        }
-    }
+SHA256::SHA256(std::istream & stream) :
+    SHA256()
+{
+    digest_stream(*this, stream);
+    finish();
+}
+
+void
+SHA256::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<64>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+#ifdef PALUDIS_SHA256_SHA_NI
+            if (cpu_has_sha_ni())
+            {
+                update_sha_ni(_h, _k, b, n);
+                return;
+            }
+#endif
+            for ( ; n > 0 ; --n, b += 64)
+                _update(b);
+            });
+}
+
+void
+SHA256::finish()
+{
+    uint64_t size(_size * 8);
+
+    char padding[64] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 56 ? 56 : 120) - _buffer_used);
 
-    buffer[56] = static_cast<uint8_t>(_size >> (7 * 8));
-    buffer[57] = static_cast<uint8_t>(_size >> (6 * 8));
-    buffer[58] = static_cast<uint8_t>(_size >> (5 * 8));
-    buffer[59] = static_cast<uint8_t>(_size >> (4 * 8));
-    buffer[60] = static_cast<uint8_t>(_size >> (3 * 8));
-    buffer[61] = static_cast<uint8_t>(_size >> (2 * 8));
-    buffer[62] = static_cast<uint8_t>(_size >> (1 * 8));
-    buffer[63] = static_cast<uint8_t>(_size >> (0 * 8));
-    _update(&buffer[0]);
+    char length[8] = {
+        static_cast<char>(size >> (7 * 8)),
+        static_cast<char>(size >> (6 * 8)),
+        static_cast<char>(size >> (5 * 8)),
+        static_cast<char>(size >> (4 * 8)),
+        static_cast<char>(size >> (3 * 8)),
+        static_cast<char>(size >> (2 * 8)),
+        static_cast<char>(size >> (1 * 8)),
+        static_cast<char>(size >> (0 * 8))
+    };
+    update(length, 8);
 }
 
 std::string
@@ -196,24 +281,6 @@ SHA256::hexsum() const
     return result.str();
 }
 
-int
-SHA256::_get(std::istream & stream)
-{
-    char c;
-    if (stream.get(c))
-    {
-        _size += 8;
-        return static_cast<unsigned char>(c);
-    }
-    else if (! _done_one_pad)
-    {
-        _done_one_pad = true;
-        return 0x80;
-    }
-    else
-        return -1;
-}
-
 const uint32_t
 paludis::SHA256::_k[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
@@ -20,11 +20,18 @@
 #include <paludis/util/sha512.hh>
 #include <paludis/util/byte_swap.hh>
 #include <paludis/util/digest_registry.hh>
+#include <paludis/util/cpu_features.hh>
 #include <sstream>
 #include <istream>
 #include <iomanip>
 #include <limits>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
 
 using namespace paludis;
 
@@ -95,8 +102,11 @@ namespace
 }
 
 void
-SHA512::process_block(uint64_t * w)
+SHA512::process_block(const uint8_t * block)
 {
+    uint64_t w[80];
+    std::memcpy(w, block, 128);
+
     uint64_t a(h0);
     uint64_t b(h1);
     uint64_t c(h2);
@@ -135,7 +145,7 @@ SHA512::process_block(uint64_t * w)
     h7 += h;
 }
 
-SHA512::SHA512(std::istream & s) :
+SHA512::SHA512() :
     h0(0x6A09E667F3BCC908ULL),
     h1(0xBB67AE8584CAA73BULL),
     h2(0x3C6EF372FE94F82BULL),
@@ -143,44 +153,40 @@ SHA512::SHA512(std::istream & s) :
     h4(0x510E527FADE682D1ULL),
     h5(0x9B05688C2B3E6C1FULL),
     h6(0x1F83D9ABFB41BD6BULL),
-    h7(0x5BE0CD19137E2179ULL)
+    h7(0x5BE0CD19137E2179ULL),
+    _size(0),
+    _buffer_used(0)
 {
-    std::streambuf * buf(s.rdbuf());
-    uint64_t size_l(0);
-    uint64_t size_h(0);
-
-    union
-    {
-        uint8_t  m[128];
-        uint64_t w[80];
-    } block;
-    std::streamsize block_size;
+}
 
-    do
-    {
-        block_size = buf->sgetn(reinterpret_cast<char *>(block.m), 128);
-        if (size_l > std::numeric_limits<uint64_t>::max() - block_size * 8)
-            ++size_h;
-        size_l += block_size * 8;
+SHA512::SHA512(std::istream & s) :
+    SHA512()
+{
+    digest_stream(*this, s);
+    finish();
+}
 
-        if (128 != block_size)
-        {
-            block.m[block_size++] = 0x80U;
+void
+SHA512::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<128>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+            for ( ; n > 0 ; --n, b += 128)
+                process_block(b);
+            });
+}
 
-            if (112 < block_size)
-            {
-                std::fill(&block.m[block_size], &block.m[128], 0);
-                process_block(block.w);
-                block_size = 0;
-            }
+void
+SHA512::finish()
+{
+    uint64_t size_l(_size << 3);
+    uint64_t size_h(_size >> 61);
 
-            std::fill(&block.m[block_size], &block.m[112], 0);
-            block.w[14] = to_bigendian(size_h);
-            block.w[15] = to_bigendian(size_l);
-        }
+    char padding[128] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 112 ? 112 : 240) - _buffer_used);
 
-        process_block(block.w);
-    } while (128 == block_size);
+    uint64_t length[2] = { to_bigendian(size_h), to_bigendian(size_l) };
+    update(reinterpret_cast<const char *>(length), 16);
 }
 
 std::string
@@ -199,8 +205,210 @@ SHA512::hexsum() const
     return result.str();
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+#  define PALUDIS_SHA512_AVX2 1
+
+namespace
+{
+    /*
+     * For hashing lots of small pieces of data, one lane of an AVX2 register
+     * per piece. Each piece is split into its whole blocks, which are used
+     * in place, and one or two blocks of padding.
+     */
+    struct Piece
+    {
+        const uint8_t * data;
+        std::size_t n_data_blocks;
+        std::size_t n_blocks;
+        uint8_t tail[256];
+
+        Piece(const std::string & s) :
+            data(reinterpret_cast<const uint8_t *>(s.data())),
+            n_data_blocks(s.length() / 128)
+        {
+            std::size_t left(s.length() % 128);
+            std::size_t n_tail_blocks(left + 17 > 128 ? 2 : 1);
+            n_blocks = n_data_blocks + n_tail_blocks;
+
+            std::fill(&tail[0], &tail[256], 0);
+            std::memcpy(tail, data + n_data_blocks * 128, left);
+            tail[left] = 0x80U;
+
+            uint64_t size_l(to_bigendian(uint64_t(s.length()) << 3));
+            uint64_t size_h(to_bigendian(uint64_t(s.length()) >> 61));
+            std::memcpy(tail + n_tail_blocks * 128 - 16, &size_h, 8);
+            std::memcpy(tail + n_tail_blocks * 128 - 8, &size_l, 8);
+        }
+
+        const uint8_t * block(const std::size_t i) const
+        {
+            return i < n_data_blocks ? data + i * 128 : tail + (i - n_data_blocks) * 128;
+        }
+    };
+
+    template <int n_>
+    PALUDIS_ATTRIBUTE((target("avx2"))) inline __m256i rotr_4way(__m256i x)
+    {
+        return _mm256_or_si256(_mm256_srli_epi64(x, n_), _mm256_slli_epi64(x, 64 - n_));
+    }
+
+    PALUDIS_ATTRIBUTE((target("avx2"))) inline __m256i xor3_4way(__m256i x, __m256i y, __m256i z)
+    {
+        return _mm256_xor_si256(_mm256_xor_si256(x, y), z);
+    }
+
+    inline uint64_t load_bigendian(const uint8_t * p)
+    {
+        uint64_t result;
+        std::memcpy(&result, p, 8);
+        return from_bigendian(result);
+    }
+
+    /* one block from each of four pieces, with the state stored as
+     * state[word][lane] */
+    PALUDIS_ATTRIBUTE((target("avx2")))
+    void process_block_4way(uint64_t (& state)[8][4], const uint8_t * const (& blocks)[4])
+    {
+        __m256i w[16];
+        for (int t(0) ; t < 16 ; ++t)
+            w[t] = _mm256_set_epi64x(
+                    load_bigendian(blocks[3] + 8 * t), load_bigendian(blocks[2] + 8 * t),
+                    load_bigendian(blocks[1] + 8 * t), load_bigendian(blocks[0] + 8 * t));
+
+        __m256i v[8];
+        for (int i(0) ; i < 8 ; ++i)
+            v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state[i]));
+
+        __m256i a(v[0]), b(v[1]), c(v[2]), d(v[3]), e(v[4]), f(v[5]), g(v[6]), h(v[7]);
+
+        for (int t(0) ; t < 80 ; ++t)
+        {
+            if (t >= 16)
+            {
+                __m256i w2(w[(t - 2) % 16]), w15(w[(t - 15) % 16]);
+                __m256i s1(xor3_4way(rotr_4way<19>(w2), rotr_4way<61>(w2), _mm256_srli_epi64(w2, 6)));
+                __m256i s0(xor3_4way(rotr_4way<1>(w15), rotr_4way<8>(w15), _mm256_srli_epi64(w15, 7)));
+                w[t % 16] = _mm256_add_epi64(_mm256_add_epi64(s1, w[(t - 7) % 16]), _mm256_add_epi64(s0, w[t % 16]));
+            }
+
+            __m256i big_s1(xor3_4way(rotr_4way<14>(e), rotr_4way<18>(e), rotr_4way<41>(e)));
+            __m256i ch(_mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+            __m256i t1(_mm256_add_epi64(_mm256_add_epi64(h, big_s1),
+                        _mm256_add_epi64(_mm256_add_epi64(ch, _mm256_set1_epi64x(k[t])), w[t % 16])));
+
+            __m256i big_s0(xor3_4way(rotr_4way<28>(a), rotr_4way<34>(a), rotr_4way<39>(a)));
+            __m256i maj(_mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
+            __m256i t2(_mm256_add_epi64(big_s0, maj));
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi64(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi64(t1, t2);
+        }
+
+        v[0] = _mm256_add_epi64(v[0], a);
+        v[1] = _mm256_add_epi64(v[1], b);
+        v[2] = _mm256_add_epi64(v[2], c);
+        v[3] = _mm256_add_epi64(v[3], d);
+        v[4] = _mm256_add_epi64(v[4], e);
+        v[5] = _mm256_add_epi64(v[5], f);
+        v[6] = _mm256_add_epi64(v[6], g);
+        v[7] = _mm256_add_epi64(v[7], h);
+
+        for (int i(0) ; i < 8 ; ++i)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(state[i]), v[i]);
+    }
+}
+#endif
+
+std::vector<std::string>
+SHA512::hexsums(const std::vector<std::string> & data)
+{
+    std::vector<std::string> result(data.size());
+
+#ifdef PALUDIS_SHA512_AVX2
+    if (cpu_has_avx2() && data.size() > 1)
+    {
+        const SHA512 initial;
+        const uint8_t zeros[128] = { 0 };
+
+        uint64_t state[8][4];
+        const uint8_t * blocks[4];
+        std::shared_ptr<Piece> pieces[4];
+        std::size_t indices[4], done[4];
+        std::size_t next(0);
+
+        while (true)
+        {
+            bool any(false);
+            for (int lane(0) ; lane < 4 ; ++lane)
+            {
+                if ((! pieces[lane]) && next < data.size())
+                {
+                    indices[lane] = next;
+                    pieces[lane] = std::make_shared<Piece>(data[next++]);
+                    done[lane] = 0;
+
+                    state[0][lane] = initial.h0;
+                    state[1][lane] = initial.h1;
+                    state[2][lane] = initial.h2;
+                    state[3][lane] = initial.h3;
+                    state[4][lane] = initial.h4;
+                    state[5][lane] = initial.h5;
+                    state[6][lane] = initial.h6;
+                    state[7][lane] = initial.h7;
+                }
+
+                /* lanes with nothing left to do churn through a block of
+                 * zeros, and whatever they come up with is thrown away */
+                blocks[lane] = pieces[lane] ? pieces[lane]->block(done[lane]) : zeros;
+                any = any || pieces[lane];
+            }
+
+            if (! any)
+                break;
+
+            process_block_4way(state, blocks);
+
+            for (int lane(0) ; lane < 4 ; ++lane)
+                if (pieces[lane] && ++done[lane] == pieces[lane]->n_blocks)
+                {
+                    SHA512 finished;
+                    finished.h0 = state[0][lane];
+                    finished.h1 = state[1][lane];
+                    finished.h2 = state[2][lane];
+                    finished.h3 = state[3][lane];
+                    finished.h4 = state[4][lane];
+                    finished.h5 = state[5][lane];
+                    finished.h6 = state[6][lane];
+                    finished.h7 = state[7][lane];
+
+                    result[indices[lane]] = finished.hexsum();
+                    pieces[lane].reset();
+                }
+        }
+
+        return result;
+    }
+#endif
+
+    for (std::size_t i(0) ; i < data.size() ; ++i)
+    {
+        SHA512 s;
+        s.update(data[i].data(), data[i].length());
+        s.finish();
+        result[i] = s.hexsum();
+    }
+
+    return result;
+}
+
 namespace
 {
-    DigestRegistry::Registration<SHA512> registration("SHA512");
+    DigestRegistry::Registration<SHA512> registration("SHA512", &SHA512::hexsums);
 }
 
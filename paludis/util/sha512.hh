@@ -23,6 +23,8 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstddef>
+#include <vector>
 #include <paludis/util/attributes.hh>
 #include <inttypes.h>
 
@@ -47,19 +49,48 @@ namespace paludis
     {
         private:
             uint64_t h0, h1, h2, h3, h4, h5, h6, h7;
+            uint64_t _size;
+            uint8_t _buffer[128];
+            std::size_t _buffer_used;
 
-            void PALUDIS_HIDDEN process_block(uint64_t *);
+            void PALUDIS_HIDDEN process_block(const uint8_t *);
 
         public:
             /**
-             * Constructor.
+             * Constructor, for use with update() and finish().
+             */
+            SHA512();
+
+            /**
+             * Constructor, for the digest of everything left in a stream.
              */
             SHA512(std::istream & stream);
 
+            /**
+             * Add more data to the digest.
+             */
+            void update(const char * data, std::size_t length);
+
+            /**
+             * Add the final padding. Must be called once, after all the
+             * data has been given to update(), and before hexsum().
+             */
+            void finish();
+
             /**
              * Our checksum, as a string of hex characters.
              */
             std::string hexsum() const;
+
+            /**
+             * The checksums of several separate pieces of data, as strings
+             * of hex characters.
+             *
+             * Where AVX2 is available, four pieces are worked on at once,
+             * which is much quicker than doing them one after another when
+             * there are lots of small files.
+             */
+            static std::vector<std::string> hexsums(const std::vector<std::string> & data);
     };
 }
 
@@ -25,6 +25,7 @@
 #include <iomanip>
 #include <limits>
 #include <algorithm>
+#include <cstring>
 #include <utility>
 
 using namespace paludis;
@@ -387,8 +388,13 @@ namespace
 }
 
 void
-Whirlpool::process_block(const uint64_t *eta)
+Whirlpool::process_block(const uint8_t * block)
 {
+    // Nominally uint8_t[8][8], but for efficiency we process an entire row
+    // at a time where possible.
+    uint64_t eta[8];
+    std::memcpy(eta, block, 64);
+
     auto w(W(H, eta));
 
     // This is only safe because sigma (and hence rho and hence W) memoises;
@@ -397,62 +403,41 @@ Whirlpool::process_block(const uint64_t *eta)
         H[i] = w(i) ^ H[i] ^ eta[i];
 }
 
-Whirlpool::Whirlpool(std::istream & s)
+Whirlpool::Whirlpool() :
+    _size(0),
+    _buffer_used(0)
 {
     std::fill(&H[0], &H[8], 0);
+}
 
-    std::streambuf * buf(s.rdbuf());
-    uint64_t size_1(0);
-    uint64_t size_2(0);
-    uint64_t size_3(0);
-    uint64_t size_4(0);
+Whirlpool::Whirlpool(std::istream & s) :
+    Whirlpool()
+{
+    digest_stream(*this, s);
+    finish();
+}
 
-    union mu
-    {
-        uint8_t m[64];
-        // Nominally uint8_t[8][8], but for efficiency we process an entire row
-        // at a time where possible.
-        uint64_t eta[8];
-    } block;
-    std::streamsize block_size;
-
-    do
-    {
-        block_size = buf->sgetn(reinterpret_cast<char *>(block.m), 64);
-        if (size_1 > std::numeric_limits<uint64_t>::max() - block_size * 8)
-        {
-            if (size_2 == std::numeric_limits<uint64_t>::max())
-            {
-                if (size_3 == std::numeric_limits<uint64_t>::max())
-                {
-                    ++size_4;
-                }
-                ++size_3;
-            }
-            ++size_2;
-        }
-        size_1 += block_size * 8;
+void
+Whirlpool::update(const char * data, std::size_t length)
+{
+    _size += length;
+    digest_blocks<64>(_buffer, _buffer_used, data, length, [&] (const uint8_t * b, std::size_t n) {
+            for ( ; n > 0 ; --n, b += 64)
+                process_block(b);
+            });
+}
 
-        if (64 != block_size)
-        {
-            block.m[block_size++] = 0x80U;
-
-            if (32 < block_size)
-            {
-                std::fill(&block.m[block_size], &block.m[64], 0);
-                process_block(block.eta);
-                block_size = 0;
-            }
-
-            std::fill(&block.m[block_size], &block.m[32], 0);
-            block.eta[4] = to_bigendian(size_4);
-            block.eta[5] = to_bigendian(size_3);
-            block.eta[6] = to_bigendian(size_2);
-            block.eta[7] = to_bigendian(size_1);
-        }
+void
+Whirlpool::finish()
+{
+    uint64_t size_1(_size << 3);
+    uint64_t size_2(_size >> 61);
+
+    char padding[64] = { static_cast<char>(0x80) };
+    update(padding, (_buffer_used < 32 ? 32 : 96) - _buffer_used);
 
-        process_block(block.eta);
-    } while (64 == block_size);
+    uint64_t length[4] = { 0, 0, to_bigendian(size_2), to_bigendian(size_1) };
+    update(reinterpret_cast<const char *>(length), 32);
 }
 
 std::string
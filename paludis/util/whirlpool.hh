@@ -23,6 +23,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstddef>
 #include <paludis/util/attributes.hh>
 #include <inttypes.h>
 
@@ -47,15 +48,34 @@ namespace paludis
     {
         private:
             uint64_t H[8];
+            uint64_t _size;
+            uint8_t _buffer[64];
+            std::size_t _buffer_used;
 
-            void PALUDIS_HIDDEN process_block(const uint64_t *);
+            void PALUDIS_HIDDEN process_block(const uint8_t *);
 
         public:
             /**
-             * Constructor.
+             * Constructor, for use with update() and finish().
+             */
+            Whirlpool();
+
+            /**
+             * Constructor, for the digest of everything left in a stream.
              */
             Whirlpool(std::istream & stream);
 
+            /**
+             * Add more data to the digest.
+             */
+            void update(const char * data, std::size_t length);
+
+            /**
+             * Add the final padding. Must be called once, after all the
+             * data has been given to update(), and before hexsum().
+             */
+            void finish();
+
             /**
              * Our checksum, as a string of hex characters.
              */
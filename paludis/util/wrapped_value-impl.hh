@@ -45,12 +45,10 @@ namespace paludis
     template <typename Tag_>
     WrappedValue<Tag_>::WrappedValue(
             const typename WrappedValueTraits<Tag_>::UnderlyingType & v,
-            const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type & p)
+            const typename WrappedValueDevoid<typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type & p) :
+        _value(WrappedValueValidate<Tag_, typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type::validate(v, p) ?
+                v : throw typename WrappedValueTraits<Tag_>::ExceptionType(v))
     {
-        if (WrappedValueValidate<Tag_, typename WrappedValueTraits<Tag_>::ValidationParamsType>::Type::validate(v, p))
-            _value = std::make_shared<typename WrappedValueTraits<Tag_>::UnderlyingType>(v);
-        else
-            throw typename WrappedValueTraits<Tag_>::ExceptionType(v);
     }
 
     template <typename Tag_>
@@ -65,14 +63,14 @@ namespace paludis
     bool
     WrappedValue<Tag_>::WrappedValue::operator< (const WrappedValue & other) const
     {
-        return value() < other.value();
+        return _value < other._value;
     }
 
     template <typename Tag_>
     bool
     WrappedValue<Tag_>::WrappedValue::operator== (const WrappedValue & other) const
     {
-        return value() == other.value();
+        return _value == other._value;
     }
 
     template <typename Tag_>
@@ -88,7 +86,14 @@ namespace paludis
     const typename WrappedValueTraits<Tag_>::UnderlyingType &
     WrappedValue<Tag_>::value() const
     {
-        return *_value;
+        return _value.value();
+    }
+
+    template <typename Tag_>
+    std::size_t
+    WrappedValue<Tag_>::hash() const
+    {
+        return _value.hash();
     }
 
     template <typename Tag_>
@@ -23,7 +23,10 @@
 #include <paludis/util/wrapped_value-fwd.hh>
 #include <paludis/util/no_type.hh>
 #include <paludis/util/operators.hh>
+#include <paludis/util/interned_string.hh>
+#include <paludis/util/hashes.hh>
 #include <memory>
+#include <string>
 
 namespace paludis
 {
@@ -39,12 +42,65 @@ namespace paludis
         typedef NoType<0u> * Type;
     };
 
+    /**
+     * How a WrappedValue holds its value.
+     *
+     * Strings, which is what almost every WrappedValue holds, are interned,
+     * so that the many copies of the same name share one string and compare
+     * and hash by pointer.
+     *
+     * \since 3.0
+     */
+    template <typename T_>
+    class WrappedValueStorage
+    {
+        private:
+            std::shared_ptr<const T_> _value;
+
+        public:
+            explicit WrappedValueStorage(const T_ & v) :
+                _value(std::make_shared<const T_>(v))
+            {
+            }
+
+            const T_ & value() const
+            {
+                return *_value;
+            }
+
+            std::size_t hash() const
+            {
+                return Hash<T_>()(*_value);
+            }
+
+            bool operator== (const WrappedValueStorage & other) const
+            {
+                return *_value == *other._value;
+            }
+
+            bool operator< (const WrappedValueStorage & other) const
+            {
+                return *_value < *other._value;
+            }
+    };
+
+    template <>
+    class WrappedValueStorage<std::string> :
+        public InternedString
+    {
+        public:
+            explicit WrappedValueStorage(const std::string & v) :
+                InternedString(v)
+            {
+            }
+    };
+
     template <typename Tag_>
     class PALUDIS_VISIBLE WrappedValue :
         public relational_operators::HasRelationalOperators
     {
         private:
-            std::shared_ptr<const typename WrappedValueTraits<Tag_>::UnderlyingType> _value;
+            WrappedValueStorage<typename WrappedValueTraits<Tag_>::UnderlyingType> _value;
 
         public:
             explicit WrappedValue(
@@ -58,6 +114,11 @@ namespace paludis
 
             const typename WrappedValueTraits<Tag_>::UnderlyingType & value() const PALUDIS_ATTRIBUTE((warn_unused_result));
 
+            /**
+             * \since 3.0
+             */
+            std::size_t hash() const PALUDIS_ATTRIBUTE((warn_unused_result));
+
             bool operator< (const WrappedValue &) const PALUDIS_ATTRIBUTE((warn_unused_result));
             bool operator== (const WrappedValue &) const PALUDIS_ATTRIBUTE((warn_unused_result));
     };
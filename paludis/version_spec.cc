@@ -60,10 +60,21 @@ namespace paludis
 
         const VersionSpecOptions options;
 
+        /* see make_sort_key */
+        std::string sort_key;
+        std::string::size_type sort_key_revision_offset;
+        bool sort_key_usable;
+        bool sort_key_usable_for_star;
+
         Imp(const VersionSpecOptions & o) :
-            options(o)
+            options(o),
+            sort_key_revision_offset(0),
+            sort_key_usable(false),
+            sort_key_usable_for_star(false)
         {
         }
+
+        void make_sort_key();
     };
 
     template <>
@@ -85,6 +96,78 @@ namespace paludis
     }
 }
 
+namespace
+{
+    bool is_suffix_type(const VersionSpecComponentType t)
+    {
+        return (t >= vsct_alpha && t <= vsct_rc) || t == vsct_patch;
+    }
+
+    /* appends a component to a sort key, returning false if it can't be
+     * represented */
+    bool append_sort_key_component(std::string & key, const VersionSpecComponent & part)
+    {
+        key.append(1, static_cast<char>(part.type()));
+
+        if (part.type() == vsct_floatlike)
+        {
+            /* compared stringwise, so a terminator below any digit makes
+             * 1.01 sort before 1.015 */
+            key.append(strip_trailing(part.number_value(), "0"));
+            key.append(1, '\0');
+        }
+        else if (part.number_value() == "MAX")
+            key.append(2, '\xff');
+        else
+        {
+            /* compared by length and then stringwise */
+            std::string::size_type length(part.number_value().length());
+            if (length >= 0xffff)
+                return false;
+            key.append(1, static_cast<char>(length >> 8));
+            key.append(1, static_cast<char>(length & 0xff));
+            key.append(part.number_value());
+        }
+
+        return true;
+    }
+}
+
+/* The sort key is a string whose byte ordering matches componentwise_compare,
+ * so that comparing versions is a single memcmp. Each component becomes its
+ * type followed by its value, and the key ends with vsct_empty, which is
+ * where componentwise_compare puts the end of a version. Trailing -r0 parts
+ * are left out, since they compare equal to the end. */
+void
+Imp<VersionSpec>::make_sort_key()
+{
+    Parts::const_iterator p_end(parts.end());
+    while (p_end != parts.begin() && prev(p_end)->type() == vsct_revision && prev(p_end)->number_value() == "0")
+        --p_end;
+
+    sort_key.clear();
+    sort_key_revision_offset = std::string::npos;
+    sort_key_usable = true;
+    for (Parts::const_iterator p(parts.begin()) ; p != p_end ; ++p)
+    {
+        if (p->type() == vsct_ignore)
+            continue;
+        if (p->type() == vsct_revision && std::string::npos == sort_key_revision_offset)
+            sort_key_revision_offset = sort_key.length();
+        if (! append_sort_key_component(sort_key, *p))
+            sort_key_usable = false;
+    }
+
+    if (std::string::npos == sort_key_revision_offset)
+        sort_key_revision_offset = sort_key.length();
+    sort_key.append(1, static_cast<char>(vsct_empty));
+
+    /* =1_alpha* matches any alpha, and =1-r0* is picky about what follows,
+     * so leave those to the slow path */
+    sort_key_usable_for_star = sort_key_usable && p_end == parts.end() &&
+        ! (is_suffix_type(parts.back().type()) && std::string::npos == parts.back().text().find_first_of("0123456789"));
+}
+
 VersionSpec::VersionSpec(const std::string & text, const VersionSpecOptions & options) :
     _imp(options)
 {
@@ -330,6 +413,8 @@ VersionSpec::VersionSpec(const std::string & text, const VersionSpecOptions & op
     /* trailing stuff? */
     if (! parser.eof())
         throw BadVersionSpecError(text, "unexpected trailing text '" + text.substr(parser.offset()) + "'");
+
+    _imp->make_sort_key();
 }
 
 VersionSpec::VersionSpec(const VersionSpec & other) :
@@ -337,6 +422,10 @@ VersionSpec::VersionSpec(const VersionSpec & other) :
 {
     _imp->text = other._imp->text;
     _imp->parts = other._imp->parts;
+    _imp->sort_key = other._imp->sort_key;
+    _imp->sort_key_revision_offset = other._imp->sort_key_revision_offset;
+    _imp->sort_key_usable = other._imp->sort_key_usable;
+    _imp->sort_key_usable_for_star = other._imp->sort_key_usable_for_star;
 }
 
 const VersionSpec &
@@ -346,6 +435,10 @@ VersionSpec::operator= (const VersionSpec & other)
     {
         _imp->text = other._imp->text;
         _imp->parts = other._imp->parts;
+        _imp->sort_key = other._imp->sort_key;
+        _imp->sort_key_revision_offset = other._imp->sort_key_revision_offset;
+        _imp->sort_key_usable = other._imp->sort_key_usable;
+        _imp->sort_key_usable_for_star = other._imp->sort_key_usable_for_star;
     }
     return *this;
 }
@@ -498,18 +591,37 @@ namespace
 int
 VersionSpec::compare(const VersionSpec & other) const
 {
+    if (_imp->sort_key_usable && other._imp->sort_key_usable)
+    {
+        int c(_imp->sort_key.compare(other._imp->sort_key));
+        return c < 0 ? -1 : c > 0 ? 1 : 0;
+    }
+
     return componentwise_compare(_imp->parts, other._imp->parts, compare_comparator);
 }
 
 bool
 VersionSpec::tilde_compare(const VersionSpec & other) const
 {
+    /* everything before the revision must match, and then our revision must
+     * be at least theirs */
+    if (_imp->sort_key_usable && other._imp->sort_key_usable)
+        return 0 == _imp->sort_key.compare(0, _imp->sort_key_revision_offset,
+                other._imp->sort_key, 0, other._imp->sort_key_revision_offset) &&
+            0 <= _imp->sort_key.compare(_imp->sort_key_revision_offset, std::string::npos,
+                    other._imp->sort_key, other._imp->sort_key_revision_offset, std::string::npos);
+
     return componentwise_compare(_imp->parts, other._imp->parts, tilde_compare_comparator);
 }
 
 bool
 VersionSpec::equal_star_compare(const VersionSpec & other) const
 {
+    /* their components, without the end marker, must start ours */
+    if (_imp->sort_key_usable && other._imp->sort_key_usable_for_star)
+        return 0 == _imp->sort_key.compare(0, other._imp->sort_key.length() - 1,
+                other._imp->sort_key, 0, other._imp->sort_key.length() - 1);
+
     return componentwise_compare(_imp->parts, other._imp->parts, equal_star_compare_comparator);
 }
 
@@ -591,6 +703,7 @@ VersionSpec::remove_revision() const
                 result._imp->parts.begin(),
                 result._imp->parts.end(),
                 IsVersionSpecComponentType<vsct_revision>()), result._imp->parts.end());
+    result._imp->make_sort_key();
 
     std::string::size_type p;
     if (std::string::npos != ((p = result._imp->text.rfind("-r"))))
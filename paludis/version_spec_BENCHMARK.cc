@@ -0,0 +1,100 @@
+/* vim: set sw=4 sts=4 et foldmethod=syntax : */
+
+/*
+ * This file is part of the Paludis package manager. Paludis is free software;
+ * you can redistribute it and/or modify it under the terms of the GNU General
+ * Public License version 2, as published by the Free Software Foundation.
+ *
+ * Paludis is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <paludis/version_spec.hh>
+
+#include <paludis/util/exception.hh>
+#include <paludis/util/options.hh>
+#include <paludis/util/stringify.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace paludis;
+
+namespace
+{
+    /* a spread of the shapes found in a real tree */
+    std::vector<VersionSpec> make_versions(const unsigned n)
+    {
+        const char * const suffixes[] = { "", "", "", "_alpha", "_beta2", "_pre20230101", "_rc1", "_p3", "-scm" };
+        std::mt19937 random(42);
+
+        std::vector<VersionSpec> result;
+        result.reserve(n);
+        for (unsigned i(0) ; i < n ; ++i)
+        {
+            std::string v(stringify(random() % 5) + "." + stringify(random() % 30));
+            if (random() % 2)
+                v.append("." + stringify(random() % 12));
+            if (0 == random() % 10)
+                v.append("a");
+            v.append(suffixes[random() % (sizeof(suffixes) / sizeof(suffixes[0]))]);
+            if (0 == random() % 3)
+                v.append("-r" + stringify(random() % 4));
+            result.push_back(VersionSpec(v, { }));
+        }
+        return result;
+    }
+
+    template <typename F_>
+    double nanoseconds_per(const unsigned long n, const F_ & f)
+    {
+        auto start(std::chrono::steady_clock::now());
+        f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    }
+}
+
+int main(int, char *[])
+{
+    const std::vector<VersionSpec> versions(make_versions(100000));
+
+    std::vector<VersionSpec> sorted(versions);
+    double sort(nanoseconds_per(versions.size(), [&] () { std::sort(sorted.begin(), sorted.end()); }));
+    if (! std::is_sorted(sorted.begin(), sorted.end()))
+        throw InternalError(PALUDIS_HERE, "not sorted");
+
+    const unsigned n_matches(200);
+    unsigned long tilde_hits(0), star_hits(0);
+    double tilde(nanoseconds_per(n_matches * versions.size(), [&] () {
+                for (unsigned p(0) ; p < n_matches ; ++p)
+                    for (const auto & v : versions)
+                        tilde_hits += v.tilde_compare(versions[p]);
+                }));
+    double star(nanoseconds_per(n_matches * versions.size(), [&] () {
+                for (unsigned p(0) ; p < n_matches ; ++p)
+                    for (const auto & v : versions)
+                        star_hits += v.equal_star_compare(versions[p]);
+                }));
+    if (0 == tilde_hits || 0 == star_hits)
+        throw InternalError(PALUDIS_HERE, "nothing matched");
+
+    std::cout << std::fixed << std::setprecision(1)
+        << versions.size() << " versions:" << std::endl
+        << "    sort:                 " << sort << "ns per version" << std::endl
+        << "    ~ match:              " << tilde << "ns per comparison" << std::endl
+        << "    =* match:             " << star << "ns per comparison" << std::endl;
+
+    return EXIT_SUCCESS;
+}
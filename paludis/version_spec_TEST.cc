@@ -432,6 +432,45 @@ TEST(VersionSpec, Ordering)
     }
 }
 
+TEST(VersionSpec, SortKeyEdgeCases)
+{
+    ASSERT_TRUE(VersionSpec("1.01", { }) < VersionSpec("1.015", { }));
+    ASSERT_TRUE(VersionSpec("1.2-r0.1", { }) > VersionSpec("1.2", { }));
+    ASSERT_TRUE(VersionSpec("1.2-r0.0.1", { }) < VersionSpec("1.2-r0.1", { }));
+    ASSERT_TRUE(VersionSpec("1_alpha-scm", { }) > VersionSpec("1_alpha99999999999999999999", { }));
+    ASSERT_TRUE(VersionSpec("1_alpha-scm", { }) < VersionSpec("1_beta", { }));
+
+    ASSERT_TRUE(VersionSpec("1-r0.1", { }).tilde_compare(VersionSpec("1", { })));
+    ASSERT_TRUE(VersionSpec("1-r0", { }).tilde_compare(VersionSpec("1-r0.0", { })));
+    ASSERT_TRUE(! VersionSpec("1.2-r0.0.1", { }).tilde_compare(VersionSpec("1.2-r0.1", { })));
+
+    ASSERT_TRUE(VersionSpec("1-r0", { }).equal_star_compare(VersionSpec("1", { })));
+    ASSERT_TRUE(! VersionSpec("1.2", { }).equal_star_compare(VersionSpec("1-r0", { })));
+    ASSERT_TRUE(! VersionSpec("1.2", { }).equal_star_compare(VersionSpec("1-r0.1", { })));
+    ASSERT_TRUE(VersionSpec("1.2-r0.1", { }).equal_star_compare(VersionSpec("1.2-r0", { })));
+    ASSERT_TRUE(! VersionSpec("1.01", { }).equal_star_compare(VersionSpec("1.0", { })));
+    ASSERT_TRUE(VersionSpec("1.010", { }).equal_star_compare(VersionSpec("1.01", { })));
+}
+
+TEST(VersionSpec, HugeNumbers)
+{
+    /* too long for the sort key, so these take the slow path, including
+     * when compared against something that doesn't */
+    std::string huge(70000, '9');
+    VersionSpec v1(huge, { }), v2(huge + ".1", { }), v3("1." + huge, { }), v4("1.2", { });
+
+    ASSERT_TRUE(v1 < v2);
+    ASSERT_TRUE(v2 > v1);
+    ASSERT_TRUE(v1 > v4);
+    ASSERT_TRUE(v4 < v1);
+    ASSERT_TRUE(v3 > v4);
+    ASSERT_TRUE(v1 == VersionSpec("0" + huge, { }));
+    ASSERT_TRUE(v2.equal_star_compare(v1));
+    ASSERT_TRUE(! v1.equal_star_compare(v2));
+    ASSERT_TRUE(VersionSpec(huge + "-r2", { }).tilde_compare(VersionSpec(huge + "-r1", { })));
+    ASSERT_TRUE(! VersionSpec(huge + "-r1", { }).tilde_compare(VersionSpec(huge + "-r2", { })));
+}
+
 TEST(VersionSpec, Components)
 {
     VersionSpec v1("1.2x_pre3_rc-scm", { });
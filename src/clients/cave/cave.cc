@@ -27,6 +27,9 @@
 #include <paludis/action.hh>
 #include <paludis/about.hh>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
 #include <cstdlib>
 #include <string>
 #include <algorithm>
@@ -40,6 +43,16 @@ using std::endl;
 using std::cout;
 using std::cerr;
 
+namespace
+{
+    std::string format_seconds(const std::chrono::steady_clock::duration & d)
+    {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3) << std::chrono::duration<double>(d).count() << "s";
+        return s.str();
+    }
+}
+
 int main(int argc, char * argv[])
 {
     Context context(std::string("In program ") + argv[0] + " " + join(argv + 1, argv + argc, " ") + ":");
@@ -88,6 +101,8 @@ int main(int argc, char * argv[])
             cave_var = cave_var + " --" + cmdline.a_log_level.long_name() + " " + cmdline.a_log_level.argument();
         if (cmdline.a_colour.specified())
             cave_var = cave_var + " --" + cmdline.a_colour.long_name() + " " + cmdline.a_colour.argument();
+        if (cmdline.a_selection_cache.specified())
+            cave_var = cave_var + " --" + cmdline.a_selection_cache.long_name();
         setenv("CAVE", cave_var.c_str(), 1);
 
         if (cmdline.a_colour.argument() == "yes")
@@ -97,12 +112,34 @@ int main(int argc, char * argv[])
 
         Log::get_instance()->set_program_name(argv[0]);
         Log::get_instance()->set_log_level(cmdline.a_log_level.option());
+        auto start(std::chrono::steady_clock::now());
         std::shared_ptr<Environment> env(EnvironmentFactory::get_instance()->create(cmdline.a_environment.argument()));
 
+        if (cmdline.a_startup_profile.specified())
+        {
+            cerr << "Created environment in " << format_seconds(std::chrono::steady_clock::now() - start) << endl;
+            for (const auto & t : *env->repository_startup_times())
+                cerr << "    " << t.name() << ": created in " << format_seconds(t.create_time())
+                    << ", preloaded in " << format_seconds(t.preload_time()) << endl;
+        }
+
         std::shared_ptr<Sequence<std::string> > seq(std::make_shared<Sequence<std::string>>());
         std::copy(next(cmdline.begin_parameters()), cmdline.end_parameters(), seq->back_inserter());
 
-        return cave::CommandFactory::get_instance()->create(*cmdline.begin_parameters())->run(env, seq);
+        if (cmdline.a_selection_cache.specified())
+            env->set_selection_cache_enabled(true);
+
+        int result(cave::CommandFactory::get_instance()->create(*cmdline.begin_parameters())->run(env, seq));
+
+        if (cmdline.a_selection_cache.specified())
+        {
+            const SelectionCacheStatistics s(env->selection_cache_statistics());
+            Log::get_instance()->message("cave.selection_cache.statistics", ll_debug, lc_no_context)
+                << "Selection cache: " << s.hits() << " hits, " << s.misses() << " misses, "
+                << s.uncacheable() << " uncacheable";
+        }
+
+        return result;
     }
     catch (const args::DoHelp & h)
     {
@@ -24,7 +24,7 @@
 #include <paludis/args/args.hh>
 #include <paludis/args/do_help.hh>
 #include <paludis/environment.hh>
-#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/user_dep_spec.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/iterator_funcs.hh>
@@ -76,34 +76,30 @@ namespace
         }
     };
 
-    std::string stringify_contents_entry(const std::shared_ptr<const ContentsEntry> & entry)
+    std::string stringify_contents_entry(const PackedContentsEntry & e)
     {
-        return entry->make_accept_returning(
-            [&] (const ContentsFileEntry & e) {
+        switch (e.type)
+        {
+            case pcet_file:
                 return fuc(fs_file(),
-                           fv<'p'>(e.part_key()
-                                    ? stringify(e.part_key()->parse_value())
-                                    : ""),
-                           fv<'s'>(stringify(e.location_key()->parse_value())));
-            },
+                           fv<'p'>(std::string(e.part)),
+                           fv<'s'>(std::string(e.path)));
 
-            [&] (const ContentsDirEntry & e) {
-                return fuc(fs_dir(), fv<'s'>(stringify(e.location_key()->parse_value())));
-            },
+            case pcet_dir:
+                return fuc(fs_dir(), fv<'s'>(std::string(e.path)));
 
-            [&] (const ContentsSymEntry & e) {
+            case pcet_sym:
                 return fuc(fs_sym(),
-                           fv<'p'>(e.part_key()
-                                    ? stringify(e.part_key()->parse_value())
-                                    : ""),
-                           fv<'s'>(stringify(e.location_key()->parse_value())),
-                           fv<'t'>(stringify(e.target_key()->parse_value())));
-            },
-
-            [&] (const ContentsOtherEntry & e) {
-                return fuc(fs_other(), fv<'s'>(stringify(e.location_key()->parse_value())));
-            }
-            );
+                           fv<'p'>(std::string(e.part)),
+                           fv<'s'>(std::string(e.path)),
+                           fv<'t'>(std::string(e.target)));
+
+            case pcet_other:
+            case last_pcet:
+                break;
+        }
+
+        return fuc(fs_other(), fv<'s'>(std::string(e.path)));
     }
 }
 
@@ -136,16 +132,9 @@ ContentsCommand::run(
         nothing_matching_error(env.get(), *cmdline.begin_parameters(), filter::InstalledAtRoot(env->preferred_root_key()->parse_value()));
 
     const std::shared_ptr<const PackageID> id(*entries->last());
-    auto contents(id->contents());
-    if (! contents)
+    if (! id->for_each_contents_entry([&] (const PackedContentsEntry & e) { cout << stringify_contents_entry(e) << "\n"; }))
         throw BadIDForCommand(spec, id, "does not support listing contents");
 
-    std::transform(
-            contents->begin(),
-            contents->end(),
-            std::ostream_iterator<std::string>(cout, "\n"),
-            std::bind(stringify_contents_entry, std::placeholders::_1));
-
     return EXIT_SUCCESS;
 }
 
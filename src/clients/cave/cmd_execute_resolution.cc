@@ -414,44 +414,73 @@ namespace
                     + cmdline.execution_options.a_change_phases_for.long_name() + "'");
     }
 
-    bool do_fetch(
+    void append_phase_options(
+            const ExecuteResolutionCommandLine & cmdline,
+            const std::shared_ptr<Sequence<std::string> > & args,
+            const int x, const int y, const bool was_target)
+    {
+        if (cmdline.execution_options.a_skip_phase.specified() || cmdline.execution_options.a_abort_at_phase.specified()
+                || cmdline.execution_options.a_skip_until_phase.specified())
+        {
+            if (apply_phase(cmdline, x, y, was_target))
+            {
+                const std::initializer_list<const args::ArgsOption *> options({ &cmdline.execution_options.a_skip_phase,
+                        &cmdline.execution_options.a_abort_at_phase, &cmdline.execution_options.a_skip_until_phase });
+                for (const auto & option : options)
+                    if (option->specified())
+                    {
+                        const std::shared_ptr<const Sequence<std::string> > f(option->forwardable_args());
+                        std::copy(f->begin(), f->end(), args->back_inserter());
+                    }
+            }
+        }
+    }
+
+    /* runs 'cave perform' with the given arguments, either inside this
+     * process using the environment we already have, or as a new process
+     * that has to load everything again */
+    bool perform(
             const std::shared_ptr<Environment> & env,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs,
-            const PackageDepSpec & id_spec,
-            const int x, const int y, const int f, const int s, bool normal_only, const bool was_target,
+            const std::shared_ptr<Sequence<std::string> > & args,
+            const bool in_process,
             std::recursive_mutex & job_mutex,
             JobActiveState & active_state,
             std::mutex & executor_mutex)
     {
-        Context context("When fetching for '" + stringify(id_spec) + "':");
+        if (in_process)
+        {
+            try
+            {
+                PerformCommand command;
+                return 0 == command.run(env, args, std::bind(&set_output_manager, std::ref(job_mutex),
+                            std::ref(active_state), std::placeholders::_1));
+            }
+            catch (const Exception & e)
+            {
+                /* this is what the error would have looked like from a
+                 * separate cave perform */
+                std::shared_ptr<OutputManager> output_manager;
+                {
+                    std::unique_lock<std::recursive_mutex> lock(job_mutex);
+                    output_manager = active_state.output_manager();
+                }
+
+                std::ostream & stream(output_manager ? output_manager->stderr_stream() : std::cerr);
+                stream << endl;
+                stream << (dynamic_cast<const ActionAbortedError *>(&e) ? "Action aborted:" : "Error:") << endl;
+                stream << "  * " << e.backtrace("\n  * ") << e.message() << " (" << e.what() << ")" << endl;
+                stream << endl;
+                return false;
+            }
+        }
 
         std::string command(cmdline.program_options.a_perform_program.argument());
         if (command.empty())
             command = "$CAVE perform";
 
-        command.append(" fetch --hooks --if-supported --managed-output ");
-        if (0 != n_fetch_jobs)
-            command.append("--output-exclusivity with-others --no-terminal-titles ");
-        command.append(stringify(id_spec));
-        command.append(" --x-of-y '" + make_x_of_y(x, y, f, s) + "'");
-
-        if (normal_only)
-            command.append(" --regulars-only --ignore-manual-fetch-errors");
-
-        if (cmdline.execution_options.a_skip_phase.specified() || cmdline.execution_options.a_abort_at_phase.specified()
-                || cmdline.execution_options.a_skip_until_phase.specified())
-        {
-            if (apply_phase(cmdline, x, y, was_target))
-            {
-                if (cmdline.execution_options.a_skip_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_phase.forwardable_string());
-                if (cmdline.execution_options.a_abort_at_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_abort_at_phase.forwardable_string());
-                if (cmdline.execution_options.a_skip_until_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_until_phase.forwardable_string());
-            }
-        }
+        for (const auto & arg : *args)
+            command.append(" " + args::escape(arg));
 
         if (cmdline.import_options.a_unpackaged_repository_params.specified())
         {
@@ -470,10 +499,51 @@ namespace
         return 0 == retcode;
     }
 
+    bool do_fetch(
+            const std::shared_ptr<Environment> & env,
+            const ExecuteResolutionCommandLine & cmdline,
+            const bool output_with_others,
+            const bool in_process,
+            const PackageDepSpec & id_spec,
+            const int x, const int y, const int f, const int s, bool normal_only, const bool was_target,
+            std::recursive_mutex & job_mutex,
+            JobActiveState & active_state,
+            std::mutex & executor_mutex)
+    {
+        Context context("When fetching for '" + stringify(id_spec) + "':");
+
+        auto args(std::make_shared<Sequence<std::string> >());
+        args->push_back("fetch");
+        args->push_back("--hooks");
+        args->push_back("--if-supported");
+        if (! in_process)
+            args->push_back("--managed-output");
+        if (output_with_others)
+        {
+            args->push_back("--output-exclusivity");
+            args->push_back("with-others");
+            args->push_back("--no-terminal-titles");
+        }
+        args->push_back(stringify(id_spec));
+        args->push_back("--x-of-y");
+        args->push_back(make_x_of_y(x, y, f, s));
+
+        if (normal_only)
+        {
+            args->push_back("--regulars-only");
+            args->push_back("--ignore-manual-fetch-errors");
+        }
+
+        append_phase_options(cmdline, args, x, y, was_target);
+
+        return perform(env, cmdline, args, in_process, job_mutex, active_state, executor_mutex);
+    }
+
     bool do_install(
             const std::shared_ptr<Environment> & env,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs,
+            const bool output_with_others,
+            const bool in_process,
             const PackageDepSpec & id_spec,
             const RepositoryName & destination_repository_name,
             const std::shared_ptr<const Sequence<PackageDepSpec> > & replacing_specs,
@@ -487,55 +557,38 @@ namespace
     {
         Context context("When " + destination_string + " for '" + stringify(id_spec) + "':");
 
-        std::string command(cmdline.program_options.a_perform_program.argument());
-        if (command.empty())
-            command = "$CAVE perform";
-
-        command.append(" install --hooks --managed-output ");
-        if (0 != n_fetch_jobs)
-            command.append("--output-exclusivity with-others ");
-        command.append(stringify(id_spec));
-        command.append(" --destination " + stringify(destination_repository_name));
-        for (const auto & spec : *replacing_specs)
-            command.append(" --replacing " + stringify(spec));
-
-        command.append(" --x-of-y '" + make_x_of_y(x, y, f, s) + "'");
-
-        if (cmdline.execution_options.a_skip_phase.specified() || cmdline.execution_options.a_abort_at_phase.specified()
-                || cmdline.execution_options.a_skip_until_phase.specified())
+        auto args(std::make_shared<Sequence<std::string> >());
+        args->push_back("install");
+        args->push_back("--hooks");
+        if (! in_process)
+            args->push_back("--managed-output");
+        if (output_with_others)
         {
-            if (apply_phase(cmdline, x, y, was_target))
-            {
-                if (cmdline.execution_options.a_skip_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_phase.forwardable_string());
-                if (cmdline.execution_options.a_abort_at_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_abort_at_phase.forwardable_string());
-                if (cmdline.execution_options.a_skip_until_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_until_phase.forwardable_string());
-            }
+            args->push_back("--output-exclusivity");
+            args->push_back("with-others");
         }
-
-        if (cmdline.import_options.a_unpackaged_repository_params.specified())
+        args->push_back(stringify(id_spec));
+        args->push_back("--destination");
+        args->push_back(stringify(destination_repository_name));
+        for (const auto & spec : *replacing_specs)
         {
-            for (const auto & param : cmdline.import_options.a_unpackaged_repository_params.args())
-                command.append(" --" + cmdline.import_options.a_unpackaged_repository_params.long_name() + " " + args::escape(param));
+            args->push_back("--replacing");
+            args->push_back(stringify(spec));
         }
 
-        IPCInputManager input_manager(env.get(), std::bind(&set_output_manager, std::ref(job_mutex),
-                    std::ref(active_state), std::placeholders::_1));
-        Process process(ProcessCommand({ "sh", "-c", command }));
-        process.pipe_command_handler("PALUDIS_IPC", std::bind(lock_pipe_command,
-                    std::ref(executor_mutex), input_manager.pipe_command_handler(), std::placeholders::_1));
+        args->push_back("--x-of-y");
+        args->push_back(make_x_of_y(x, y, f, s));
 
-        int retcode(process.run().wait());
-        const std::shared_ptr<OutputManager> output_manager(input_manager.underlying_output_manager_if_constructed());
-        return 0 == retcode;
+        append_phase_options(cmdline, args, x, y, was_target);
+
+        return perform(env, cmdline, args, in_process, job_mutex, active_state, executor_mutex);
     }
 
     bool do_uninstall(
             const std::shared_ptr<Environment> & env,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs,
+            const bool output_with_others,
+            const bool in_process,
             const PackageDepSpec & id_spec,
             const int x, const int y,
             const int f, const int s,
@@ -546,50 +599,34 @@ namespace
     {
         Context context("When removing '" + stringify(id_spec) + "':");
 
-        std::string command(cmdline.program_options.a_perform_program.argument());
-        if (command.empty())
-            command = "$CAVE perform";
-
-        command.append(" uninstall --hooks --managed-output ");
-        if (0 != n_fetch_jobs)
-            command.append("--output-exclusivity with-others ");
-        command.append(stringify(id_spec));
-
-        command.append(" --x-of-y '" + make_x_of_y(x, y, f, s) + "'");
-
-        if (cmdline.execution_options.a_skip_phase.specified() || cmdline.execution_options.a_abort_at_phase.specified()
-                || cmdline.execution_options.a_skip_until_phase.specified())
+        auto args(std::make_shared<Sequence<std::string> >());
+        args->push_back("uninstall");
+        args->push_back("--hooks");
+        if (! in_process)
+            args->push_back("--managed-output");
+        if (output_with_others)
         {
-            if (apply_phase(cmdline, x, y, was_target))
-            {
-                if (cmdline.execution_options.a_skip_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_phase.forwardable_string());
-                if (cmdline.execution_options.a_abort_at_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_abort_at_phase.forwardable_string());
-                if (cmdline.execution_options.a_skip_until_phase.specified())
-                    command.append(" " + cmdline.execution_options.a_skip_until_phase.forwardable_string());
-            }
+            args->push_back("--output-exclusivity");
+            args->push_back("with-others");
         }
+        args->push_back(stringify(id_spec));
 
-        if (cmdline.import_options.a_unpackaged_repository_params.specified())
-        {
-            for (const auto & param : cmdline.import_options.a_unpackaged_repository_params.args())
-                command.append(" --" + cmdline.import_options.a_unpackaged_repository_params.long_name() + " " + args::escape(param));
-        }
+        args->push_back("--x-of-y");
+        args->push_back(make_x_of_y(x, y, f, s));
 
-        IPCInputManager input_manager(env.get(), std::bind(&set_output_manager, std::ref(job_mutex),
-                    std::ref(active_state), std::placeholders::_1));
+        append_phase_options(cmdline, args, x, y, was_target);
 
-        Process process(ProcessCommand({ "sh", "-c", command }));
-        process.pipe_command_handler("PALUDIS_IPC", std::bind(lock_pipe_command,
-                    std::ref(executor_mutex), input_manager.pipe_command_handler(), std::placeholders::_1));
+        bool result(perform(env, cmdline, args, in_process, job_mutex, active_state, executor_mutex));
 
-        int retcode(process.run().wait());
-        const std::shared_ptr<OutputManager> output_manager(input_manager.underlying_output_manager_if_constructed());
+        std::shared_ptr<OutputManager> output_manager;
+        {
+            std::unique_lock<std::recursive_mutex> lock(job_mutex);
+            output_manager = active_state.output_manager();
+        }
         if (output_manager)
             output_manager->succeeded();
 
-        return 0 == retcode;
+        return result;
     }
 
     void
@@ -811,8 +848,10 @@ namespace
     {
         const std::shared_ptr<Environment> env;
         const ExecuteResolutionCommandLine & cmdline;
-        const int n_fetch_jobs;
+        const bool output_with_others;
+        const bool in_process;
         ExecuteCounts & counts;
+        int & x_number;
         std::recursive_mutex & job_mutex;
         std::mutex & executor_mutex;
         const ExecuteOneVisitorPart part;
@@ -821,16 +860,20 @@ namespace
         ExecuteOneVisitor(
                 const std::shared_ptr<Environment> & e,
                 const ExecuteResolutionCommandLine & c,
-                const int n,
+                const bool o,
+                const bool i,
                 ExecuteCounts & k,
+                int & n,
                 std::recursive_mutex & m,
                 std::mutex & x,
                 ExecuteOneVisitorPart p,
                 int r) :
             env(e),
             cmdline(c),
-            n_fetch_jobs(n),
+            output_with_others(o),
+            in_process(i),
             counts(k),
+            x_number(n),
             job_mutex(m),
             executor_mutex(x),
             part(p),
@@ -870,9 +913,9 @@ namespace
             {
                 case x1_pre:
                     {
-                        ++counts.x_installs;
+                        x_number = ++counts.x_installs;
                         starting_action(env, action_string, ensequence(install_item.origin_id_spec()),
-                                install_item.replacing_specs(), counts.x_installs, counts.y_installs,
+                                install_item.replacing_specs(), x_number, counts.y_installs,
                                 counts.f_installs, counts.s_installs);
                     }
                     break;
@@ -885,7 +928,7 @@ namespace
                             install_item.set_state(active_state);
                         }
 
-                        if (! do_fetch(env, cmdline, n_fetch_jobs, install_item.origin_id_spec(), counts.x_installs, counts.y_installs,
+                        if (! do_fetch(env, cmdline, output_with_others, in_process, install_item.origin_id_spec(), x_number, counts.y_installs,
                                     counts.f_installs, counts.s_installs, false, install_item.was_target(),
                                     job_mutex, *active_state, executor_mutex))
                         {
@@ -895,9 +938,9 @@ namespace
                             return 1;
                         }
 
-                        if (! do_install(env, cmdline, n_fetch_jobs, install_item.origin_id_spec(), install_item.destination_repository_name(),
+                        if (! do_install(env, cmdline, output_with_others, in_process, install_item.origin_id_spec(), install_item.destination_repository_name(),
                                     install_item.replacing_specs(), destination_string,
-                                    counts.x_installs, counts.y_installs, counts.f_installs, counts.s_installs,
+                                    x_number, counts.y_installs, counts.f_installs, counts.s_installs,
                                     install_item.was_target(), job_mutex, *active_state, executor_mutex))
                         {
                             std::unique_lock<std::recursive_mutex> lock(job_mutex);
@@ -926,8 +969,8 @@ namespace
             {
                 case x1_pre:
                     {
-                        ++counts.x_installs;
-                        starting_action(env, "remove", uninstall_item.ids_to_remove_specs(), nullptr, counts.x_installs, counts.y_installs,
+                        x_number = ++counts.x_installs;
+                        starting_action(env, "remove", uninstall_item.ids_to_remove_specs(), nullptr, x_number, counts.y_installs,
                                 counts.f_installs, counts.s_installs);
                     }
                     break;
@@ -941,7 +984,7 @@ namespace
                         }
 
                         for (const auto & id : *uninstall_item.ids_to_remove_specs())
-                            if (! do_uninstall(env, cmdline, n_fetch_jobs, id, counts.x_installs, counts.y_installs,
+                            if (! do_uninstall(env, cmdline, output_with_others, in_process, id, x_number, counts.y_installs,
                                         counts.f_installs, counts.s_installs, uninstall_item.was_target(),
                                         job_mutex, *active_state, executor_mutex))
                             {
@@ -958,6 +1001,12 @@ namespace
 
                 case x1_post:
                     done_action(env, "remove", uninstall_item.ids_to_remove_specs(), nullptr, 0 == retcode);
+
+                    /* a separate process would have reloaded whatever we removed from */
+                    if (in_process)
+                        for (const auto & repository : env->repositories())
+                            if (repository->installed_root_key())
+                                repository->invalidate();
                     break;
             }
 
@@ -970,8 +1019,8 @@ namespace
             {
                 case x1_pre:
                     {
-                        ++counts.x_fetches;
-                        starting_action(env, "fetch", ensequence(fetch_item.origin_id_spec()), nullptr, counts.x_fetches, counts.y_fetches,
+                        x_number = ++counts.x_fetches;
+                        starting_action(env, "fetch", ensequence(fetch_item.origin_id_spec()), nullptr, x_number, counts.y_fetches,
                                 counts.f_fetches, counts.s_fetches);
                     }
                     break;
@@ -984,7 +1033,7 @@ namespace
                             fetch_item.set_state(active_state);
                         }
 
-                        if (! do_fetch(env, cmdline, n_fetch_jobs, fetch_item.origin_id_spec(), counts.x_fetches, counts.y_fetches,
+                        if (! do_fetch(env, cmdline, output_with_others, in_process, fetch_item.origin_id_spec(), x_number, counts.y_fetches,
                                     counts.f_fetches, counts.s_fetches, true, fetch_item.was_target(), job_mutex, *active_state, executor_mutex))
                         {
                             std::unique_lock<std::recursive_mutex> lock(job_mutex);
@@ -1141,6 +1190,42 @@ namespace
         }
     };
 
+    bool is_finished(const ExecuteJob & job)
+    {
+        return job.state()->make_accept_returning(
+                [&] (const JobSkippedState &)   { return true; },
+                [&] (const JobPendingState &)   { return false; },
+                [&] (const JobActiveState &)    { return false; },
+                [&] (const JobSucceededState &) { return true; },
+                [&] (const JobFailedState &)    { return true; }
+                );
+    }
+
+    bool is_in_fetch_queue(const ExecuteJob & job, const int n_fetch_jobs)
+    {
+        return 0 != n_fetch_jobs && visitor_cast<const FetchJob>(job);
+    }
+
+    /* when installs run in parallel, a barrier job waits for everything
+     * before it to finish, and nothing after it starts until it is done */
+    bool is_barrier(const ExecuteJob & job, const JobNumber job_number, const int n_fetch_jobs)
+    {
+        if (is_in_fetch_queue(job, n_fetch_jobs))
+            return false;
+
+        /* removing things can break anything that is running */
+        if (visitor_cast<const UninstallJob>(job))
+            return true;
+
+        /* we're ordered after something that hasn't run yet, so we're
+         * breaking a cycle and the usual order is all we have */
+        for (const auto & requirement : *job.requirements())
+            if (requirement.job_number() >= job_number)
+                return true;
+
+        return false;
+    }
+
     struct ExecuteJobExecutive :
         Executive
     {
@@ -1148,7 +1233,11 @@ namespace
         const ExecuteResolutionCommandLine & cmdline;
         Executor & executor;
         const int n_fetch_jobs;
+        const int n_install_jobs;
         const std::shared_ptr<ExecuteJob> job;
+        const JobNumber job_number;
+        const bool barrier;
+        const JobNumber last_barrier;
         const std::shared_ptr<JobLists> lists;
         JobRequirementIf require_if;
         std::mutex & global_retcode_mutex;
@@ -1162,13 +1251,17 @@ namespace
         std::recursive_mutex job_mutex;
 
         bool want, already_done;
+        int x_number;
 
         ExecuteJobExecutive(
                 const std::shared_ptr<Environment> & e,
                 const ExecuteResolutionCommandLine & c,
                 Executor & x,
                 const int n,
+                const int i,
                 const std::shared_ptr<ExecuteJob> & j,
+                const JobNumber jn,
+                const JobNumber lb,
                 const std::shared_ptr<JobLists> & l,
                 JobRequirementIf r,
                 std::mutex & m,
@@ -1179,7 +1272,11 @@ namespace
             cmdline(c),
             executor(x),
             n_fetch_jobs(n),
+            n_install_jobs(i),
             job(j),
+            job_number(jn),
+            barrier(is_barrier(*j, jn, n)),
+            last_barrier(lb),
             lists(l),
             require_if(r),
             global_retcode_mutex(m),
@@ -1190,10 +1287,26 @@ namespace
             last_flushed(Timestamp::now()),
             last_output(last_flushed),
             want(true),
-            already_done(false)
+            already_done(false),
+            x_number(0)
         {
         }
 
+        bool output_with_others() const
+        {
+            return 0 != n_fetch_jobs || 1 < n_install_jobs;
+        }
+
+        /* only one job at a time may run inside this process, so fetches that
+         * run alongside other jobs and parallel installs get their own */
+        bool in_process() const
+        {
+            return (! cmdline.program_options.a_perform_program.specified())
+                && (! cmdline.program_options.a_perform_in_subprocesses.specified())
+                && 1 == n_install_jobs
+                && ! is_in_fetch_queue(*job, n_fetch_jobs);
+        }
+
         std::string queue_name() const override
         {
             if (0 != n_fetch_jobs)
@@ -1228,14 +1341,29 @@ namespace
                 if (! requirement.required_if()[jri_fetching])
                     continue;
 
-                const std::shared_ptr<const ExecuteJob> req(*lists->execute_job_list()->fetch(requirement.job_number()));
-                if (! req->state()->make_accept_returning(
-                            [&] (const JobSkippedState &)   { return true; },
-                            [&] (const JobPendingState &)   { return false; },
-                            [&] (const JobActiveState &)    { return false; },
-                            [&] (const JobSucceededState &) { return true; },
-                            [&] (const JobFailedState &)    { return true; }
-                            ))
+                if (! is_finished(**lists->execute_job_list()->fetch(requirement.job_number())))
+                    return false;
+            }
+
+            if (1 < n_install_jobs && ! is_in_fetch_queue(*job, n_fetch_jobs))
+            {
+                /* the executor no longer keeps us in order, so anything we
+                 * depend upon in any way has to be done first */
+                for (const auto & requirement : *job->requirements())
+                    if (requirement.job_number() < job_number
+                            && ! is_finished(**lists->execute_job_list()->fetch(requirement.job_number())))
+                        return false;
+
+                if (barrier)
+                {
+                    for (JobNumber n(0) ; n < job_number ; ++n)
+                    {
+                        const std::shared_ptr<const ExecuteJob> other(*lists->execute_job_list()->fetch(n));
+                        if ((! is_in_fetch_queue(*other, n_fetch_jobs)) && ! is_finished(*other))
+                            return false;
+                    }
+                }
+                else if (-1 != last_barrier && ! is_finished(**lists->execute_job_list()->fetch(last_barrier)))
                     return false;
             }
 
@@ -1323,7 +1451,7 @@ namespace
 
             if (want)
             {
-                ExecuteOneVisitor execute(env, cmdline, n_fetch_jobs, counts, job_mutex, executor.exclusivity_mutex(), x1_pre, local_retcode);
+                ExecuteOneVisitor execute(env, cmdline, output_with_others(), in_process(), counts, x_number, job_mutex, executor.exclusivity_mutex(), x1_pre, local_retcode);
                 int job_retcode(job->accept_returning<int>(execute));
                 local_retcode |= job_retcode;
             }
@@ -1333,7 +1461,7 @@ namespace
         {
             if (want)
             {
-                ExecuteOneVisitor execute(env, cmdline, n_fetch_jobs, counts, job_mutex, executor.exclusivity_mutex(), x1_main, local_retcode);
+                ExecuteOneVisitor execute(env, cmdline, output_with_others(), in_process(), counts, x_number, job_mutex, executor.exclusivity_mutex(), x1_main, local_retcode);
                 int job_retcode(job->accept_returning<int>(execute));
                 local_retcode |= job_retcode;
             }
@@ -1346,7 +1474,7 @@ namespace
 
         void display_active(const bool force)
         {
-            if (n_fetch_jobs == 0)
+            if (! output_with_others())
                 return;
 
             std::unique_lock<std::recursive_mutex> lock(job_mutex);
@@ -1415,7 +1543,7 @@ namespace
         {
             if (want)
             {
-                ExecuteOneVisitor execute(env, cmdline, n_fetch_jobs, counts, job_mutex, executor.exclusivity_mutex(), x1_post, local_retcode);
+                ExecuteOneVisitor execute(env, cmdline, output_with_others(), in_process(), counts, x_number, job_mutex, executor.exclusivity_mutex(), x1_post, local_retcode);
                 local_retcode |= job->accept_returning<int>(execute);
 
                 std::unique_lock<std::recursive_mutex> lock(job_mutex);
@@ -1446,7 +1574,8 @@ namespace
             const std::shared_ptr<Environment> & env,
             const std::shared_ptr<JobLists> & lists,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs)
+            const int n_fetch_jobs,
+            const int n_install_jobs)
     {
         int retcode(0);
         std::mutex retcode_mutex;
@@ -1475,11 +1604,21 @@ namespace
                     + cmdline.execution_options.a_continue_on_failure.long_name() + "'");
 
         Executor executor(100);
+        if (1 < n_install_jobs)
+            executor.set_queue_parallelism("execute", n_install_jobs);
 
         std::string old_heading;
-        for (const auto & job : *lists->execute_job_list())
-            executor.add(std::make_shared<ExecuteJobExecutive>(env, cmdline, executor, n_fetch_jobs, job, lists, require_if, retcode_mutex,
-                            retcode, counts, old_heading));
+        JobNumber last_barrier(-1);
+        for (JobList<ExecuteJob>::ConstIterator j(lists->execute_job_list()->begin()), j_end(lists->execute_job_list()->end()) ;
+                j != j_end ; ++j)
+        {
+            const JobNumber job_number(lists->execute_job_list()->number(j));
+            auto executive(std::make_shared<ExecuteJobExecutive>(env, cmdline, executor, n_fetch_jobs, n_install_jobs, *j, job_number,
+                        last_barrier, lists, require_if, retcode_mutex, retcode, counts, old_heading));
+            if (executive->barrier)
+                last_barrier = job_number;
+            executor.add(executive);
+        }
 
         executor.execute();
 
@@ -1495,7 +1634,8 @@ namespace
             const std::shared_ptr<Environment> & env,
             const std::shared_ptr<JobLists> & lists,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs)
+            const int n_fetch_jobs,
+            const int n_install_jobs)
     {
         for (const auto & job : *lists->execute_job_list())
             if (! job->state())
@@ -1507,7 +1647,7 @@ namespace
         if (0 != retcode || cmdline.a_pretend.specified())
             return retcode;
 
-        retcode |= execute_executions(env, lists, cmdline, n_fetch_jobs);
+        retcode |= execute_executions(env, lists, cmdline, n_fetch_jobs, n_install_jobs);
 
         if (0 != retcode)
             return retcode;
@@ -1650,7 +1790,8 @@ namespace
             const std::shared_ptr<Environment> & env,
             const std::shared_ptr<JobLists> & lists,
             const ExecuteResolutionCommandLine & cmdline,
-            const int n_fetch_jobs)
+            const int n_fetch_jobs,
+            const int n_install_jobs)
     {
         Context context("When executing chosen resolution:");
 
@@ -1662,7 +1803,7 @@ namespace
 
         try
         {
-            retcode = execute_resolution_main(env, lists, cmdline, n_fetch_jobs);
+            retcode = execute_resolution_main(env, lists, cmdline, n_fetch_jobs, n_install_jobs);
         }
         catch (...)
         {
@@ -1738,7 +1879,11 @@ ExecuteResolutionCommand::run(
     else
         n_fetch_jobs = 1;
 
-    return execute_resolution(env, lists, cmdline, n_fetch_jobs);
+    int n_install_jobs(cmdline.execution_options.a_install_jobs.argument());
+    if (n_install_jobs < 1)
+        throw args::DoHelp("--" + cmdline.execution_options.a_install_jobs.long_name() + " must be at least 1");
+
+    return execute_resolution(env, lists, cmdline, n_fetch_jobs, n_install_jobs);
 }
 
 int
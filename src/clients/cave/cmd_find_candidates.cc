@@ -18,6 +18,7 @@
  */
 
 #include "cmd_find_candidates.hh"
+#include "search_extras.hh"
 #include "search_extras_handle.hh"
 
 #include <paludis/args/args.hh>
@@ -43,6 +44,7 @@
 #include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/visitor_cast.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/make_named_values.hh>
 
 #include <cstdlib>
 #include <iostream>
@@ -151,7 +153,7 @@ int
 FindCandidatesCommand::run_hosted(
         const std::shared_ptr<Environment> & env,
         const SearchCommandLineCandidateOptions & search_options,
-        const SearchCommandLineMatchOptions &,
+        const SearchCommandLineMatchOptions & match_options,
         const SearchCommandLineIndexOptions & index_options,
         const std::string & name_description_substring_hint,
         const std::function<void (const PackageDepSpec &)> & yield,
@@ -165,23 +167,40 @@ FindCandidatesCommand::run_hosted(
 
         CaveSearchExtrasDB * db(SearchExtrasHandle::get_instance()->open_db_function(stringify(index_options.a_index.argument()).c_str()));
 
+        /* also in cmd_match.cc */
+        bool default_names_and_descriptions((! match_options.a_name.specified()) &&
+                (! match_options.a_description.specified()) && (! match_options.a_key.specified()));
+
+        /* HOMEPAGE is the only key the index knows about, so any other key
+         * means the hint can't be used to narrow things down */
+        bool only_homepage_keys(match_options.a_key.specified() && match_options.a_key.end_args() == std::find_if(
+                    match_options.a_key.begin_args(), match_options.a_key.end_args(),
+                    [] (const std::string & k) { return k != "HOMEPAGE"; }));
+        bool hint_usable(only_homepage_keys || ! match_options.a_key.specified());
+
         std::list<std::string> specs;
 
-        SearchExtrasHandle::get_instance()->find_candidates_function(db, specs,
-                search_options.a_all_versions.specified(),
-                search_options.a_visible.specified(),
-                name_description_substring_hint);
+        SearchExtrasHandle::get_instance()->find_candidates_function(db, specs, make_named_values<CaveSearchExtrasQuery>(
+                    n::all_versions() = search_options.a_all_versions.specified(),
+                    n::keywords() = std::list<std::string>(index_options.a_keyword.begin_args(), index_options.a_keyword.end_args()),
+                    n::slot() = index_options.a_slot.argument(),
+                    n::text() = hint_usable ? name_description_substring_hint : "",
+                    n::text_in_descriptions() = default_names_and_descriptions || match_options.a_description.specified(),
+                    n::text_in_homepages() = only_homepage_keys,
+                    n::text_in_names() = default_names_and_descriptions || match_options.a_name.specified(),
+                    n::visible() = search_options.a_visible.specified()
+                    ));
 
         SearchExtrasHandle::get_instance()->cleanup_db_function(db);
 
+        std::list<PackageDepSpec> matches;
+        for (const auto & matching_spec : search_options.a_matching.args())
+            matches.push_back(parse_user_package_dep_spec(matching_spec, env.get(), { updso_allow_wildcards }));
+
         for (auto & spec : specs)
         {
             step("Checking indexed candidates");
 
-            std::list<PackageDepSpec> matches;
-            for (const auto & matching_spec : search_options.a_matching.args())
-                matches.push_back(parse_user_package_dep_spec(matching_spec, env.get(), { updso_allow_wildcards }));
-
             if (! matches.empty())
             {
                 bool ok(false);
@@ -201,6 +220,8 @@ FindCandidatesCommand::run_hosted(
             yield(parse_user_package_dep_spec(spec, env.get(), { }));
         }
     }
+    else if (index_options.a_keyword.specified() || index_options.a_slot.specified())
+        throw args::DoHelp("--keyword and --slot require --index");
     else if (! search_options.a_matching.specified())
     {
         step("Searching repositories");
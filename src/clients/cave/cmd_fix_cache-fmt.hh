@@ -3,3 +3,7 @@
 const auto fs_fixing = make_format_string_fetcher("fix-cache/fixing", 1)
     << "Fixing cache for " << c::bold_blue_or_pink() << param<'s'>() << c::normal() << "...\\n";
 
+
+const auto fs_stats = make_format_string_fetcher("fix-cache/stats", 1)
+    << "* " << c::bold_blue_or_pink() << param<'s'>() << ":" << c::normal() << "%{column 30}"
+    << param<'r'>() << " rebuilt, " << param<'u'>() << " reused\\n";
@@ -28,8 +28,12 @@
 
 #include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/thread_pool.hh>
 
+#include <exception>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <set>
 #include <algorithm>
 #include <cstdlib>
@@ -69,6 +73,9 @@ namespace
         args::SwitchArg a_installable;
         args::SwitchArg a_installed;
 
+        args::ArgsGroup g_output_options;
+        args::SwitchArg a_stats;
+
         FixCacheCommandLine() :
             g_repositories(main_options_section(), "Repositories", "Select repositories whose cache is to be "
                     "regenerated. If none of these restrictions are specified, all repositories are selected. "
@@ -76,7 +83,10 @@ namespace
             a_repository(&g_repositories, "repository", 'r', "Select the repository with the specified name. May "
                     "be specified multiple times."),
             a_installable(&g_repositories, "installable", 'i', "Select all installable repositories.", true),
-            a_installed(&g_repositories, "installed", 'I', "Select all installed repositories", true)
+            a_installed(&g_repositories, "installed", 'I', "Select all installed repositories", true),
+            g_output_options(main_options_section(), "Output Options", "Control the output."),
+            a_stats(&g_output_options, "stats", '\0', "Show how many cache entries were rebuilt and how many "
+                    "could be reused for each repository", true)
         {
         }
     };
@@ -132,10 +142,42 @@ FixCacheCommand::run(
             repository_names.insert(repository->name());
 
     for (const auto & repository_name : repository_names)
-    {
         cout << fuc(fs_fixing(), fv<'s'>(stringify(repository_name)));
-        const std::shared_ptr<Repository> repo(env->fetch_repository(repository_name));
-        repo->regenerate_cache();
+
+    /* repositories don't share caches, so they can all be done at once */
+    std::mutex mutex;
+    std::map<RepositoryName, RegenerateCacheStatistics> statistics;
+    std::exception_ptr exception;
+    {
+        ThreadPool pool;
+        for (const auto & repository_name : repository_names)
+            pool.create_thread([&, repository_name] () {
+                    try
+                    {
+                        const std::shared_ptr<Repository> repo(env->fetch_repository(repository_name));
+                        RegenerateCacheStatistics s(repo->regenerate_cache());
+
+                        std::unique_lock<std::mutex> lock(mutex);
+                        statistics.insert(std::make_pair(repository_name, s));
+                    }
+                    catch (...)
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        if (! exception)
+                            exception = std::current_exception();
+                    }
+                    });
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    if (cmdline.a_stats.specified())
+    {
+        cout << std::endl;
+        for (const auto & s : statistics)
+            cout << fuc(fs_stats(), fv<'s'>(stringify(s.first)), fv<'r'>(stringify(s.second.rebuilt())),
+                    fv<'u'>(stringify(s.second.reused())));
     }
 
     return EXIT_SUCCESS;
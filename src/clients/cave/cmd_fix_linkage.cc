@@ -29,6 +29,7 @@
 #include <paludis/util/create_iterator-impl.hh>
 #include <paludis/util/log.hh>
 #include <paludis/broken_linkage_finder.hh>
+#include <paludis/environment.hh>
 #include <paludis/package_id.hh>
 #include <paludis/name.hh>
 #include <paludis/dep_spec.hh>
@@ -61,13 +62,17 @@ namespace
         args::ArgsGroup g_linkage_options;
         args::StringSetArg a_libraries;
         args::SwitchArg a_exact;
+        args::StringArg a_cache;
 
         FixLinkageCommandLine() :
             g_execution_options(main_options_section(), "Execution Options", "Control execution."),
             a_execute(&g_execution_options, "execute", 'x', "Execute the suggested actions", true),
             g_linkage_options(main_options_section(), "Linkage options", "Options relating to linkage"),
             a_libraries(&g_linkage_options, "library", 'l', "Only rebuild packages linked against this library, even if it exists. May be specified multiple times."),
-            a_exact(&g_linkage_options, "exact", 'e', "Rebuild the same package version that is currently installed", true)
+            a_exact(&g_linkage_options, "exact", 'e', "Rebuild the same package version that is currently installed", true),
+            a_cache(&g_linkage_options, "cache", '\0', "Remember what was found in each file here, so that later runs only need "
+                    "to read files that have changed. Defaults to 'var/cache/paludis/linkage' inside the root. Use '/var/empty' "
+                    "to disable.")
         {
             add_usage_line("[ -x|--execute ] [ --library foo.so.1 ] [ -- options for 'cave resolve' ]");
 
@@ -180,7 +185,9 @@ FixLinkageCommand::run(const std::shared_ptr<Environment> & env,
     {
         DisplayCallback display_callback("Searching: ");
         ScopedNotifierCallback display_callback_holder(env.get(), NotifierCallbackFunction(std::cref(display_callback)));
-        finder = std::make_shared<BrokenLinkageFinder>(env.get(), libraries);
+        FSPath cache_file(cmdline.a_cache.specified() ? FSPath(cmdline.a_cache.argument()) :
+                env->preferred_root_key()->parse_value() / "var/cache/paludis/linkage");
+        finder = std::make_shared<BrokenLinkageFinder>(env.get(), libraries, cache_file);
     }
 
     if (finder->begin_broken_packages() == finder->end_broken_packages())
@@ -44,9 +44,15 @@
 #include <cstdlib>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
 #include <mutex>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <thread>
+#include <vector>
 #include <unistd.h>
 
 #include "command_command_line.hh"
@@ -79,12 +85,19 @@ namespace
         args::ArgsGroup g_filters;
         args::StringSetArg a_matching;
 
+        args::ArgsGroup g_jobs_options;
+        args::IntegerArg a_jobs;
+
         GenerateMetadataCommandLine() :
             g_filters(main_options_section(), "Filters", "Filter the output. Each filter may be specified more than once."),
             a_matching(&g_filters, "matching", 'm', "Consider only IDs matching this spec. Note that certain specs "
-                    "may force metadata generation anyway, e.g. to see whether a slot matches.")
+                    "may force metadata generation anyway, e.g. to see whether a slot matches."),
+            g_jobs_options(main_options_section(), "Jobs Options", "Options controlling jobs and parallelism."),
+            a_jobs(&g_jobs_options, "jobs", 'j', "The number of threads to use. Metadata generation is mostly "
+                    "spent waiting for bash and for the disk, so values higher than the number of processors "
+                    "can help. Defaults to the number of processors.")
         {
-            add_usage_line("[ --matching spec ]");
+            add_usage_line("[ --matching spec ] [ --jobs n ]");
         }
     };
 
@@ -106,10 +119,23 @@ namespace
     {
     };
 
+    struct PhaseTime
+    {
+        std::chrono::steady_clock::duration total;
+        int count;
+
+        PhaseTime() :
+            total(std::chrono::steady_clock::duration::zero()),
+            count(0)
+        {
+        }
+    };
+
     struct DisplayCallback
     {
         mutable std::mutex mutex;
         mutable std::map<std::string, int> metadata;
+        mutable std::map<std::string, PhaseTime> phase_times;
         mutable int steps;
         int total;
         mutable std::string stage;
@@ -225,42 +251,120 @@ namespace
         void visit(const NotifierCallbackLinkageStepEvent &) const
         {
         }
+
+        void visit(const NotifierCallbackMetadataPhaseEvent & e) const
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            PhaseTime & t(phase_times[e.phase()]);
+            t.total += e.duration();
+            ++t.count;
+        }
     };
 
-    void worker(std::mutex & mutex, PackageIDSequence::ConstIterator & i, const PackageIDSequence::ConstIterator & i_end, bool & fail,
-            DisplayCallback & display_callback)
+    std::string format_seconds(const std::chrono::steady_clock::duration & d)
     {
-        while (true)
-        {
-            std::shared_ptr<const PackageID> id;
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-                if (i != i_end)
-                    id = *i++;
-            }
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3) << std::chrono::duration<double>(d).count() << "s";
+        return s.str();
+    }
 
-            if (! id)
-                return;
+    /* One package directory's worth of IDs. We never split these between
+     * threads, so that the layout's and the eclass mtime caches' view of
+     * that directory is only built once and stays warm. */
+    typedef std::vector<std::shared_ptr<const PackageID> > Batch;
 
-            for (const auto & key : id->metadata())
-                try
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Batch> batches;
+    };
+
+    /* Each thread gets its own queue holding a contiguous run of batches, so
+     * threads mostly work through neighbouring directories rather than
+     * contending over one shared iterator. A thread that runs out of work
+     * steals from the back of someone else's queue, which is the work that
+     * queue's owner would otherwise get to last. */
+    class Scheduler
+    {
+        private:
+            std::vector<std::unique_ptr<WorkQueue> > _queues;
+
+        public:
+            Scheduler(const PackageIDSequence & ids, const unsigned n_queues)
+            {
+                std::vector<Batch> batches;
+                std::map<std::pair<RepositoryName, QualifiedPackageName>, Batch::size_type> batch_for;
+                for (const auto & id : ids)
                 {
-                    MetadataVisitor v;
-                    key->accept(v);
+                    auto b(batch_for.insert(std::make_pair(std::make_pair(id->repository_name(), id->name()), batches.size())));
+                    if (b.second)
+                        batches.push_back(Batch());
+                    batches[b.first->second].push_back(id);
                 }
-                catch (const InternalError &)
+
+                for (unsigned n(0) ; n != n_queues ; ++n)
+                    _queues.push_back(std::make_unique<WorkQueue>());
+
+                for (std::vector<Batch>::size_type b(0), b_end(batches.size()) ; b != b_end ; ++b)
+                    _queues[(b * n_queues) / b_end]->batches.push_back(std::move(batches[b]));
+            }
+
+            bool next(const unsigned me, Batch & result)
+            {
                 {
-                    throw;
+                    WorkQueue & mine(*_queues[me]);
+                    std::unique_lock<std::mutex> lock(mine.mutex);
+                    if (! mine.batches.empty())
+                    {
+                        result = std::move(mine.batches.front());
+                        mine.batches.pop_front();
+                        return true;
+                    }
                 }
-                catch (const Exception & e)
+
+                for (unsigned n(1), n_end(_queues.size()) ; n < n_end ; ++n)
                 {
-                    std::unique_lock<std::mutex> lock(mutex);
-                    std::cerr << "When processing '" << **i << "' got exception '" << e.message() << "' (" << e.what() << ")" << std::endl;
-                    fail = true;
-                    break;
+                    WorkQueue & victim(*_queues[(me + n) % n_end]);
+                    std::unique_lock<std::mutex> lock(victim.mutex);
+                    if (! victim.batches.empty())
+                    {
+                        result = std::move(victim.batches.back());
+                        victim.batches.pop_back();
+                        return true;
+                    }
                 }
 
-            display_callback(DoneOne());
+                return false;
+            }
+    };
+
+    void worker(const unsigned me, Scheduler & scheduler, std::mutex & mutex, bool & fail, DisplayCallback & display_callback)
+    {
+        Batch batch;
+        while (scheduler.next(me, batch))
+        {
+            for (const auto & id : batch)
+            {
+                for (const auto & key : id->metadata())
+                    try
+                    {
+                        MetadataVisitor v;
+                        key->accept(v);
+                    }
+                    catch (const InternalError &)
+                    {
+                        throw;
+                    }
+                    catch (const Exception & e)
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        std::cerr << "When processing '" << *id << "' got exception '" << e.message() << "' (" << e.what() << ")" << std::endl;
+                        fail = true;
+                        break;
+                    }
+
+                display_callback(DoneOne());
+            }
         }
     }
 }
@@ -293,26 +397,44 @@ GenerateMetadataCommand::run(
         }
     }
 
+    unsigned n_jobs(std::thread::hardware_concurrency());
+    if (cmdline.a_jobs.specified())
+    {
+        if (cmdline.a_jobs.argument() < 1)
+            throw args::DoHelp("--jobs must be at least 1");
+        n_jobs = cmdline.a_jobs.argument();
+    }
+    if (n_jobs == 0)
+        n_jobs = 1;
+
     const std::shared_ptr<const PackageIDSequence> ids((*env)[selection::AllVersionsSorted(g)]);
     bool fail(false);
     std::mutex mutex;
 
-    PackageIDSequence::ConstIterator i(ids->begin());
-    PackageIDSequence::ConstIterator i_end(ids->end());
+    auto start(std::chrono::steady_clock::now());
+    std::map<std::string, PhaseTime> phase_times;
     {
         DisplayCallback callback;
         callback.total = std::distance(ids->begin(), ids->end());
         ScopedNotifierCallback display_callback_holder(env.get(), NotifierCallbackFunction(std::cref(callback)));
-        ThreadPool pool;
 
-        unsigned n_procs(std::thread::hardware_concurrency());
-        if (n_procs == 0)
-            n_procs = 1;
+        Scheduler scheduler(*ids, n_jobs);
+        {
+            ThreadPool pool;
+            for (unsigned n(0) ; n != n_jobs ; ++n)
+                pool.create_thread(std::bind(&worker, n, std::ref(scheduler), std::ref(mutex), std::ref(fail), std::ref(callback)));
+        }
 
-        for (int n(0), n_end(n_procs) ; n != n_end ; ++n)
-            pool.create_thread(std::bind(&worker, std::ref(mutex), std::ref(i), std::cref(i_end), std::ref(fail), std::ref(callback)));
+        std::unique_lock<std::mutex> lock(callback.mutex);
+        phase_times = callback.phase_times;
     }
 
+    cout << "Processed " << std::distance(ids->begin(), ids->end()) << " IDs using " << n_jobs << (1 == n_jobs ? " job in " : " jobs in ")
+        << format_seconds(std::chrono::steady_clock::now() - start) << endl;
+    for (const auto & p : phase_times)
+        cout << "    " << p.first << ": " << p.second.count << " in " << format_seconds(p.second.total)
+            << " (" << format_seconds(p.second.total / p.second.count) << " each)" << endl;
+
     return fail ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
@@ -39,6 +39,8 @@
 #include <paludis/choice.hh>
 #include <paludis/about.hh>
 #include <paludis/notifier_callback.hh>
+#include <paludis/dep_spec.hh>
+#include <paludis/slot.hh>
 
 #include <paludis/util/set.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
@@ -47,6 +49,9 @@
 #include <paludis/util/visitor_cast.hh>
 #include <paludis/util/iterator_funcs.hh>
 #include <paludis/util/stringify.hh>
+#include <paludis/util/make_named_values.hh>
+#include <paludis/util/visitor.hh>
+#include <paludis/util/sequence.hh>
 
 #include <cstdlib>
 #include <iostream>
@@ -54,6 +59,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
 #include <unistd.h>
 
 #include "config.h"
@@ -191,6 +197,10 @@ namespace
         void visit(const NotifierCallbackLinkageStepEvent &) const
         {
         }
+
+        void visit(const NotifierCallbackMetadataPhaseEvent &) const
+        {
+        }
     };
 
     struct ManageSearchIndexCommandLine :
@@ -198,6 +208,10 @@ namespace
     {
         args::ArgsGroup g_actions;
         args::SwitchArg a_create;
+        args::SwitchArg a_update;
+
+        args::ArgsGroup g_update_options;
+        args::StringSetArg a_repository;
 
         std::string app_name() const override
         {
@@ -213,17 +227,117 @@ namespace
         {
             return "Manages a search index for use by cave search. A search index is only valid until "
                 "a package is installed or uninstalled, or a sync is performed, or configuration is "
-                "changed.";
+                "changed. After a sync, the packages from the synced repositories can be reindexed "
+                "using --update, for example from a sync_post hook.";
         }
 
         ManageSearchIndexCommandLine() :
             g_actions(main_options_section(), "Actions", "Specify which action to perform. Exactly one action must be specified."),
             a_create(&g_actions, "create", 'c', "Create a new search index. The existing search index is removed if "
-                    "it already exists", true)
+                    "it already exists", true),
+            a_update(&g_actions, "update", 'u', "Update an existing search index, reindexing every package that is "
+                    "or was in one of the repositories specified using --repository", true),
+            g_update_options(main_options_section(), "Update Options", "Options for --update."),
+            a_repository(&g_update_options, "repository", 'r', "Reindex packages in this repository. May be "
+                    "specified multiple times.")
         {
             add_usage_line("--create ~/cave-search-index");
+            add_usage_line("--update --repository gentoo ~/cave-search-index");
+        }
+    };
+
+    struct HomepageCollector
+    {
+        std::string & result;
+
+        void visit(const SimpleURISpecTree::NodeType<AllDepSpec>::Type & node)
+        {
+            std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), accept_visitor(*this));
+        }
+
+        /* we don't know what the user has enabled, so index everything and
+         * leave cave match to decide */
+        void visit(const SimpleURISpecTree::NodeType<ConditionalDepSpec>::Type & node)
+        {
+            std::for_each(indirect_iterator(node.begin()), indirect_iterator(node.end()), accept_visitor(*this));
+        }
+
+        void visit(const SimpleURISpecTree::NodeType<SimpleURIDepSpec>::Type & node)
+        {
+            if (! result.empty())
+                result.append(" ");
+            result.append(stringify(*node.spec()));
         }
     };
+
+    /* ids must be sorted, and contain every version of each package they
+     * include */
+    void add_candidates(
+            CaveSearchExtrasDB * const db,
+            const std::shared_ptr<const PackageIDSequence> & ids,
+            const DisplayCallback & display_callback)
+    {
+        bool is_best(false);
+        bool had_best_visible(false);
+        std::string old_name;
+        for (auto i(ids->rbegin()), i_end(ids->rend()) ;
+                i != i_end ; ++i)
+        {
+            display_callback(ManageStep{"Writing"});
+
+            std::string name(stringify((*i)->name()));
+            std::string short_desc;
+            std::string long_desc;
+            std::string homepage;
+            std::string slot;
+            std::list<std::string> keywords;
+            if ((*i)->short_description_key())
+                short_desc = (*i)->short_description_key()->parse_value();
+            if ((*i)->long_description_key())
+                long_desc = (*i)->long_description_key()->parse_value();
+            if ((*i)->homepage_key())
+            {
+                HomepageCollector h{homepage};
+                (*i)->homepage_key()->parse_value()->top()->accept(h);
+            }
+            if ((*i)->slot_key())
+                slot = (*i)->slot_key()->parse_value().raw_value();
+            if ((*i)->keywords_key())
+            {
+                auto k((*i)->keywords_key()->parse_value());
+                std::transform(k->begin(), k->end(), std::back_inserter(keywords), &stringify<KeywordName>);
+            }
+
+            bool is_visible(! (*i)->masked());
+
+            if (name != old_name)
+            {
+                is_best = true;
+                had_best_visible = false;
+                old_name = name;
+            }
+
+            bool is_best_visible(is_visible && ! had_best_visible);
+            if (is_best_visible)
+                had_best_visible = true;
+
+            SearchExtrasHandle::get_instance()->add_candidate_function(db, make_named_values<CaveSearchExtrasCandidate>(
+                        n::best() = is_best,
+                        n::best_visible() = is_best_visible,
+                        n::homepage() = homepage,
+                        n::keywords() = keywords,
+                        n::long_description() = long_desc,
+                        n::name() = name,
+                        n::repository() = stringify((*i)->repository_name()),
+                        n::short_description() = short_desc,
+                        n::slot() = slot,
+                        n::spec() = stringify((*i)->uniquely_identifying_spec()),
+                        n::visible() = is_visible
+                        ));
+
+            is_best = false;
+        }
+    }
 }
 
 int
@@ -244,13 +358,15 @@ ManageSearchIndexCommand::run(
     if (cmdline.parameters().size() != 1)
         throw args::DoHelp("manage-search-index requires exactly one parameter");
 
-    if (! cmdline.a_create.specified())
+    if (1 != (cmdline.a_create.specified() + cmdline.a_update.specified()))
         throw args::DoHelp("exactly one action must be specified");
 
     FSPath index_file(*cmdline.begin_parameters());
-    index_file.unlink();
 
+    if (cmdline.a_create.specified())
     {
+        index_file.unlink();
+
         DisplayCallback display_callback;
         ScopedNotifierCallback display_callback_holder(env.get(),
                 NotifierCallbackFunction(std::cref(display_callback)));
@@ -263,40 +379,49 @@ ManageSearchIndexCommand::run(
         display_callback.total = display_callback.steps + std::distance(ids->begin(), ids->end()) + 1;
 
         SearchExtrasHandle::get_instance()->starting_adds_function(db);
+        add_candidates(db, ids, display_callback);
 
-        bool is_best(false);
-        bool had_best_visible(false);
-        std::string old_name;
-        for (auto i(ids->rbegin()), i_end(ids->rend()) ;
-                i != i_end ; ++i)
-        {
-            display_callback(ManageStep{"Writing"});
+        display_callback(ManageStep{"Finalising"});
+        SearchExtrasHandle::get_instance()->done_adds_function(db);
+        SearchExtrasHandle::get_instance()->cleanup_db_function(db);
+    }
+    else
+    {
+        if (! cmdline.a_repository.specified())
+            throw args::DoHelp("--update requires at least one --repository");
 
-            std::string name(stringify((*i)->name()));
-            std::string short_desc;
-            std::string long_desc;
-            if ((*i)->short_description_key())
-                short_desc = (*i)->short_description_key()->parse_value();
-            if ((*i)->long_description_key())
-                long_desc = (*i)->long_description_key()->parse_value();
+        DisplayCallback display_callback;
+        ScopedNotifierCallback display_callback_holder(env.get(),
+                NotifierCallbackFunction(std::cref(display_callback)));
 
-            bool is_visible(! (*i)->masked());
+        display_callback(ManageStep{"Opening DB"});
+        CaveSearchExtrasDB * db(SearchExtrasHandle::get_instance()->open_db_function(stringify(index_file).c_str()));
 
-            if (name != old_name)
+        /* a package that has been added to or removed from one of our
+         * repositories can also change which versions are best elsewhere, so
+         * we redo every version of each affected package */
+        display_callback(ManageStep{"Querying"});
+        std::set<std::string> names;
+        for (const auto & repository : cmdline.a_repository.args())
+        {
+            std::list<std::string> indexed_names;
+            SearchExtrasHandle::get_instance()->find_package_names_function(db, indexed_names, repository);
+            names.insert(indexed_names.begin(), indexed_names.end());
+
+            if (env->has_repository_named(RepositoryName(repository)))
             {
-                is_best = true;
-                had_best_visible = false;
-                old_name = name;
+                auto ids((*env)[selection::BestVersionOnly(generator::InRepository(RepositoryName(repository)))]);
+                for (const auto & id : *ids)
+                    names.insert(stringify(id->name()));
             }
+        }
 
-            bool is_best_visible(is_visible && ! had_best_visible);
-            if (is_best_visible)
-                had_best_visible = true;
-
-            SearchExtrasHandle::get_instance()->add_candidate_function(db, stringify((*i)->uniquely_identifying_spec()),
-                    is_visible, is_best, is_best_visible, name, short_desc, long_desc);
-
-            is_best = false;
+        SearchExtrasHandle::get_instance()->starting_adds_function(db);
+        for (const auto & name : names)
+        {
+            SearchExtrasHandle::get_instance()->remove_package_function(db, name);
+            add_candidates(db, (*env)[selection::AllVersionsSorted(generator::Package(QualifiedPackageName(name)))],
+                    display_callback);
         }
 
         display_callback(ManageStep{"Finalising"});
@@ -76,7 +76,8 @@ namespace
                     ("auto",          'a', "If pattern starts with a /, full; if it contains a /, partial; otherwise, basename")
                     ("basename",      'b', "Basename match")
                     ("full",          'f', "Full match")
-                    ("partial",       'p', "Partial match"),
+                    ("partial",       'p', "Partial match")
+                    ("within",        'w', "Full match, or anything beneath the pattern if it is a directory"),
                     "auto"),
             a_dereference(&g_owner_options, "dereference", 'd', "If the pattern is a path that exists and is a symbolic link, "
                     "dereference it recursively, and then search for the real path.", true),
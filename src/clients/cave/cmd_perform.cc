@@ -189,15 +189,22 @@ namespace
                 + cmdline.a_output_exclusivity.long_name() + "'");
     }
 
+    typedef std::function<void (const std::shared_ptr<OutputManager> &)> OnOutputManager;
+
     struct OutputManagerFromIPCOrEnvironment
     {
         std::shared_ptr<OutputManagerFromIPC> manager_if_ipc;
         std::shared_ptr<OutputManagerFromEnvironment> manager_if_env;
+        const OnOutputManager on_output_manager;
+        bool told_about_output_manager;
 
         OutputManagerFromIPCOrEnvironment(
                 const Environment * const e,
                 const PerformCommandLine & cmdline,
-                const std::shared_ptr<const PackageID> & id)
+                const std::shared_ptr<const PackageID> & id,
+                const OnOutputManager & o) :
+            on_output_manager(o),
+            told_about_output_manager(false)
         {
             if (cmdline.a_managed_output.specified())
                 manager_if_ipc = std::make_shared<OutputManagerFromIPC>(e, id, get_output_exclusivity(cmdline),
@@ -207,12 +214,24 @@ namespace
                             ClientOutputFeatures() + cof_summary_at_end);
         }
 
+        void tell_about_output_manager()
+        {
+            if (told_about_output_manager || ! on_output_manager)
+                return;
+
+            const std::shared_ptr<OutputManager> output_manager(output_manager_if_constructed());
+            if (output_manager)
+            {
+                told_about_output_manager = true;
+                on_output_manager(output_manager);
+            }
+        }
+
         const std::shared_ptr<OutputManager> operator() (const Action & a)
         {
-            if (manager_if_env)
-                return (*manager_if_env)(a);
-            else
-                return (*manager_if_ipc)(a);
+            const std::shared_ptr<OutputManager> result(manager_if_env ? (*manager_if_env)(a) : (*manager_if_ipc)(a));
+            tell_about_output_manager();
+            return result;
         }
 
         const std::shared_ptr<OutputManager> output_manager_if_constructed()
@@ -229,6 +248,7 @@ namespace
                 manager_if_env->construct_standard_if_unconstructed();
             else
                 manager_if_ipc->construct_standard_if_unconstructed();
+            tell_about_output_manager();
         }
     };
 
@@ -394,6 +414,15 @@ PerformCommand::run(
         const std::shared_ptr<Environment> & env,
         const std::shared_ptr<const Sequence<std::string > > & args
         )
+{
+    return run(env, args, OnOutputManager());
+}
+
+int
+PerformCommand::run(
+        const std::shared_ptr<Environment> & env,
+        const std::shared_ptr<const Sequence<std::string > > & args,
+        const std::function<void (const std::shared_ptr<OutputManager> &)> & on_output_manager)
 {
     PerformCommandLine cmdline;
     cmdline.run(args, "CAVE", "CAVE_PERFORM_OPTIONS", "CAVE_PERFORM_CMDLINE");
@@ -445,7 +474,7 @@ PerformCommand::run(
         if (cmdline.a_if_supported.specified() && ! id->supports_action(SupportsActionTest<ConfigAction>()))
             return EXIT_SUCCESS;
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         ConfigActionOptions options(make_named_values<ConfigActionOptions>(
                     n::make_output_manager() = std::ref(output_manager_holder)
                     ));
@@ -457,7 +486,7 @@ PerformCommand::run(
         if (cmdline.a_if_supported.specified() && ! id->supports_action(SupportsActionTest<FetchAction>()))
             return EXIT_SUCCESS;
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         WantInstallPhase want_phase(cmdline, output_manager_holder);
         std::shared_ptr<Sequence<FetchActionFailure> > failures(std::make_shared<Sequence<FetchActionFailure>>());
         FetchActionOptions options(make_named_values<FetchActionOptions>(
@@ -494,7 +523,7 @@ PerformCommand::run(
         if (cmdline.a_if_supported.specified() && ! id->supports_action(SupportsActionTest<PretendFetchAction>()))
             return EXIT_SUCCESS;
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         FetchActionOptions options(make_named_values<FetchActionOptions>(
                     n::errors() = std::make_shared<Sequence<FetchActionFailure>>(),
                     n::exclude_unmirrorable() = cmdline.a_exclude_unmirrorable.specified(),
@@ -523,7 +552,7 @@ PerformCommand::run(
         if (cmdline.a_if_supported.specified() && ! id->supports_action(SupportsActionTest<InfoAction>()))
             return EXIT_SUCCESS;
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         InfoActionOptions options(make_named_values<InfoActionOptions>(
                     n::make_output_manager() = std::ref(output_manager_holder)
                     ));
@@ -541,7 +570,7 @@ PerformCommand::run(
         const std::shared_ptr<Repository> destination(env->fetch_repository(
                     RepositoryName(cmdline.a_destination.argument())));
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         WantInstallPhase want_phase(cmdline, output_manager_holder);
         InstallActionOptions options(make_named_values<InstallActionOptions>(
                     n::destination() = destination,
@@ -567,7 +596,7 @@ PerformCommand::run(
         const std::shared_ptr<Repository> destination(env->fetch_repository(
                     RepositoryName(cmdline.a_destination.argument())));
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         PretendActionOptions options(make_named_values<PretendActionOptions>(
                     n::destination() = destination,
                     n::make_output_manager() = std::ref(output_manager_holder),
@@ -583,7 +612,7 @@ PerformCommand::run(
         if (cmdline.a_if_supported.specified() && ! id->supports_action(SupportsActionTest<UninstallAction>()))
             return EXIT_SUCCESS;
 
-        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id);
+        OutputManagerFromIPCOrEnvironment output_manager_holder(env.get(), cmdline, id, on_output_manager);
         WantInstallPhase want_phase(cmdline, output_manager_holder);
         UninstallActionOptions options(make_named_values<UninstallActionOptions>(
                     n::config_protect() = cmdline.a_config_protect.argument(),
@@ -21,6 +21,8 @@
 #define PALUDIS_GUARD_SRC_CLIENTS_CAVE_CMD_PERFORM_HH 1
 
 #include "command.hh"
+#include <paludis/output_manager-fwd.hh>
+#include <functional>
 
 namespace paludis
 {
@@ -37,6 +39,15 @@ namespace paludis
                         const std::shared_ptr<const Sequence<std::string > > & args
                         ) override;
 
+                /**
+                 * Perform on behalf of another command in this process,
+                 * telling it about our output manager once we have one.
+                 */
+                int run(
+                        const std::shared_ptr<Environment> &,
+                        const std::shared_ptr<const Sequence<std::string > > & args,
+                        const std::function<void (const std::shared_ptr<OutputManager> &)> & on_output_manager);
+
                 std::shared_ptr<args::ArgsHandler> make_doc_cmdline() override;
         };
     }
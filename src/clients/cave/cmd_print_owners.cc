@@ -73,7 +73,8 @@ namespace
                     ("auto",          "If pattern starts with a /, full; if it contains a /, partial; otherwise, basename")
                     ("basename",      "Basename match")
                     ("full",          "Full match")
-                    ("partial",       "Partial match"),
+                    ("partial",       "Partial match")
+                    ("within",        "Full match, or anything beneath the pattern if it is a directory"),
                     "auto"),
             a_matching(&g_owner_options, "matching", 'm', "Show only IDs matching this spec. If specified multiple "
                     "times, only IDs matching every spec are selected."),
@@ -23,7 +23,7 @@
 #include <paludis/args/log_level_arg.hh>
 
 #include <paludis/filter.hh>
-#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/generator.hh>
 #include <paludis/selection.hh>
 #include <paludis/package_id.hh>
@@ -127,13 +127,9 @@ namespace
 
             void operator()(const std::shared_ptr<const PackageID>& package)
             {
-                const auto contents(package->contents());
-
-                if (! contents)
-                    return;
-
-                for (const auto & entry : *contents)
-                    _contents->insert(entry->location_key()->parse_value());
+                package->for_each_contents_entry([&] (const PackedContentsEntry & entry) {
+                        _contents->insert(FSPath(std::string(entry.path)));
+                    });
             }
 
         private:
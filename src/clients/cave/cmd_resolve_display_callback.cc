@@ -132,6 +132,11 @@ DisplayCallback::visit(const NotifierCallbackLinkageStepEvent & e) const
     update();
 }
 
+void
+DisplayCallback::visit(const NotifierCallbackMetadataPhaseEvent &) const
+{
+}
+
 void
 DisplayCallback::update() const
 {
@@ -113,6 +113,12 @@ namespace
             const std::shared_ptr<Set<QualifiedPackageName> > & result,
             const PackageDepSpec & spec)
     {
+        if (spec.package_ptr())
+        {
+            result->insert(*spec.package_ptr());
+            return;
+        }
+
         const std::shared_ptr<const PackageID> id(*((*env)[selection::RequireExactlyOne(
                         generator::Matches(spec, nullptr, { }))])->begin());
         result->insert(id->name());
@@ -124,10 +130,11 @@ namespace
             const SearchCommandLineMatchOptions & match_options,
             const PackageDepSpec & spec,
             const std::shared_ptr<const Set<std::string> > & patterns,
+            const bool already_matched,
             const std::function<void (const PackageDepSpec &)> & success
             )
     {
-        if (match_command.run_hosted(env, match_options, patterns, spec))
+        if (already_matched || match_command.run_hosted(env, match_options, patterns, spec))
             success(spec);
     }
 
@@ -247,6 +254,10 @@ namespace
         void visit(const NotifierCallbackLinkageStepEvent &) const
         {
         }
+
+        void visit(const NotifierCallbackMetadataPhaseEvent &) const
+        {
+        }
     };
 
     void step(DisplayCallback & display_callback, const std::string & s)
@@ -280,8 +291,10 @@ SearchCommand::run(
     std::string name_description_substring_hint;
     do
     {
-        /* cmd_match.cc has similar logic too */
-        if (cmdline.match_options.a_key.specified())
+        /* cmd_match.cc has similar logic too. the index also knows about
+         * HOMEPAGE */
+        if (cmdline.match_options.a_key.end_args() != std::find_if(cmdline.match_options.a_key.begin_args(),
+                    cmdline.match_options.a_key.end_args(), [] (const std::string & k) { return k != "HOMEPAGE"; }))
             break;
 
         if ((cmdline.match_options.a_type.argument() != "text") && (cmdline.match_options.a_type.argument() != "exact"))
@@ -296,6 +309,19 @@ SearchCommand::run(
         name_description_substring_hint = *cmdline.begin_parameters();
     } while (false);
 
+    /* for a plain case insensitive substring search, the index gives exactly
+     * the answer cave match would, so we don't need to load any metadata to
+     * check the candidates it returns. sqlite only folds case for ascii, so
+     * anything else still gets checked. */
+    bool index_is_exact(cmdline.index_options.a_index.specified() &&
+            (! name_description_substring_hint.empty()) &&
+            cmdline.match_options.a_type.argument() == "text" &&
+            (! cmdline.match_options.a_case_sensitive.specified()) &&
+            (! cmdline.match_options.a_key.specified()) &&
+            cmdline.parameters().size() == 1 &&
+            name_description_substring_hint.end() == std::find_if(name_description_substring_hint.begin(),
+                name_description_substring_hint.end(), [] (char c) { return 0 != (c & 0x80); }));
+
     {
         DisplayCallback display_callback;
         ScopedNotifierCallback display_callback_holder(env.get(),
@@ -311,7 +337,7 @@ SearchCommand::run(
         retcode |= find_candidates_command.run_hosted(env, cmdline.search_options, cmdline.match_options,
                 cmdline.index_options, name_description_substring_hint, std::bind(
                     &found_candidate, env, std::ref(match_command), std::cref(cmdline.match_options),
-                    std::placeholders::_1, patterns, std::function<void (const PackageDepSpec &)>(std::bind(
+                    std::placeholders::_1, patterns, index_is_exact, std::function<void (const PackageDepSpec &)>(std::bind(
                             &found_match, env, std::ref(matches), std::placeholders::_1
                             ))),
                 std::bind(&step, std::ref(display_callback), std::placeholders::_1)
@@ -66,7 +66,11 @@ SearchCommandLineIndexOptions::SearchCommandLineIndexOptions(args::ArgsHandler *
     g_index_options(this, "Index Options", "Controls the use of an index. An index may be created using "
             "cave manage-search-index. Note that strange errors or partial results may occur if the index "
             "is not up to date."),
-    a_index(&g_index_options, "index", '\0', "Use the specified index file")
+    a_index(&g_index_options, "index", '\0', "Use the specified index file"),
+    a_keyword(&g_index_options, "keyword", '\0', "Only consider versions with the specified keyword, according "
+            "to the index. May be specified multiple times, in which case every keyword must be present. Requires --index."),
+    a_slot(&g_index_options, "slot", '\0', "Only consider versions in the specified slot, according to the index. "
+            "Requires --index.")
 {
 }
 
@@ -66,6 +66,8 @@ namespace paludis
 
             args::ArgsGroup g_index_options;
             args::StringArg a_index;
+            args::StringSetArg a_keyword;
+            args::StringArg a_slot;
         };
     }
 }
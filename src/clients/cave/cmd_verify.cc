@@ -27,9 +27,7 @@
 #include <paludis/args/do_help.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/make_named_values.hh>
-#include <paludis/util/indirect_iterator-impl.hh>
 #include <paludis/util/safe_ifstream.hh>
-#include <paludis/util/visitor_cast.hh>
 #include <paludis/util/md5.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/stringify.hh>
@@ -45,10 +43,11 @@
 #include <paludis/hook.hh>
 #include <paludis/metadata_key.hh>
 #include <paludis/output_manager_from_environment.hh>
-#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <cstdlib>
 #include <iostream>
 #include <algorithm>
+#include <functional>
 #include <set>
 
 #include "command_command_line.hh"
@@ -114,91 +113,71 @@ namespace
             cout << fuc(fs_error(), fv<'t'>(text), fv<'p'>(stringify(path)));
         }
 
-        bool check_mtime(const ContentsEntry & e, const FSPath & p, const FSStat & f)
+        bool check_mtime(const PackedContentsEntry & e, const FSPath & p, const FSStat & f)
         {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("mtime"));
-            if (e.end_metadata() != k)
+            if (e.has_mtime && (e.mtime != f.mtim().seconds()))
             {
-                const MetadataTimeKey * kk(visitor_cast<const MetadataTimeKey>(**k));
-                if (kk && (kk->parse_value().seconds() != f.mtim().seconds()))
-                {
-                    message(p, "Modification time changed");
-                    return false;
-                }
+                message(p, "Modification time changed");
+                return false;
             }
 
             return true;
         }
 
-        bool check_md5(const ContentsEntry & e, const FSPath & f)
+        bool check_md5(const PackedContentsEntry & e, const FSPath & f)
         {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("md5"));
-            if (e.end_metadata() != k)
+            if (e.has_md5)
             {
-                const MetadataValueKey<std::string> * kk(visitor_cast<const MetadataValueKey<std::string> >(**k));
-                if (kk)
+                SafeIFStream s(f);
+                MD5 md5(s);
+                if (e.md5_hexsum() != md5.hexsum())
                 {
-                    SafeIFStream s(f);
-                    MD5 md5(s);
-                    if (kk->parse_value() != md5.hexsum())
-                    {
-                        message(f, "Contents (md5) changed");
-                        return false;
-                    }
+                    message(f, "Contents (md5) changed");
+                    return false;
                 }
             }
 
             return true;
         }
 
-        bool is_volatile(const ContentsEntry & e)
-        {
-            ContentsEntry::MetadataConstIterator k(e.find_metadata("volatile"));
-            if (e.end_metadata() != k)
-            {
-                const MetadataValueKey<bool> * kk(visitor_cast<const MetadataValueKey<bool> >(**k));
-                if (kk)
-                    return kk->parse_value();
-            }
-            return false;
-        }
-
-        void visit(const ContentsFileEntry & e)
+        void operator() (const PackedContentsEntry & e)
         {
-            FSPath f(e.location_key()->parse_value());
-            FSStat f_stat(f);
-            if (! f_stat.exists())
-                message(f, "Does not exist");
-            else if (! f_stat.is_regular_file())
-                message(f, "Not a regular file");
-            else if (! is_volatile(e))
-                check_mtime(e, f, f_stat) && check_md5(e, f);
-        }
+            if (pcet_other == e.type)
+                return;
 
-        void visit(const ContentsSymEntry & e)
-        {
-            FSPath f(e.location_key()->parse_value());
-            FSStat f_stat(f);
-            if (! f_stat.exists())
-                message(f, "Does not exist");
-            else if (! f_stat.is_symlink())
-                message(f, "Not a symbolic link");
-            else
-                check_mtime(e, f, f_stat);
-        }
-
-        void visit(const ContentsDirEntry & e)
-        {
-            FSPath f(e.location_key()->parse_value());
+            FSPath f{std::string(e.path)};
             FSStat f_stat(f);
             if (! f_stat.exists())
+            {
                 message(f, "Does not exist");
-            else if (! f_stat.is_directory())
-                message(f, "Not a directory");
-        }
+                return;
+            }
 
-        void visit(const ContentsOtherEntry &)
-        {
+            switch (e.type)
+            {
+                case pcet_file:
+                    if (! f_stat.is_regular_file())
+                        message(f, "Not a regular file");
+                    else if (! e.is_volatile)
+                        check_mtime(e, f, f_stat) && check_md5(e, f);
+                    break;
+
+                case pcet_sym:
+                    if (! f_stat.is_symlink())
+                        message(f, "Not a symbolic link");
+                    else
+                        check_mtime(e, f, f_stat);
+                    break;
+
+                case pcet_dir:
+                    if (! f_stat.is_directory())
+                        message(f, "Not a directory");
+                    break;
+
+                case pcet_other:
+                case last_pcet:
+                    break;
+            }
         }
     };
 }
@@ -234,12 +213,8 @@ VerifyCommand::run(
     int exit_status(0);
     for (const auto & id : *entries)
     {
-        auto contents(id->contents());
-        if (! contents)
-            continue;
-
         Verifier v(id);
-        std::for_each(indirect_iterator(contents->begin()), indirect_iterator(contents->end()), accept_visitor(v));
+        id->for_each_contents_entry(std::ref(v));
         exit_status |= v.exit_status;
     }
 
@@ -37,6 +37,11 @@ CaveCommandLine::CaveCommandLine() :
             ("no",         'n', "No"),
             "auto"),
     a_color(&a_colour, "color", true),
+    a_selection_cache(&g_global_options, "selection-cache", '\0',
+            "Remember the results of repeated package queries until a repository changes. Hit and miss "
+            "counts are shown at debug log level.", true),
+    a_startup_profile(&g_global_options, "startup-profile", '\0',
+            "Show how long the environment and each repository took to start up.", true),
     a_help(&g_global_options, "help", 'h', "display help message", false),
     a_version(&g_global_options, "version", 'v', "display version information", false)
 {
@@ -50,6 +50,8 @@ namespace paludis
             args::LogLevelArg a_log_level;
             args::EnumArg a_colour;
             args::AliasArg a_color;
+            args::SwitchArg a_selection_cache;
+            args::SwitchArg a_startup_profile;
             args::SwitchArg a_help;
             args::SwitchArg a_version;
 
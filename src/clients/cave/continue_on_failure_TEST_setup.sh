@@ -51,7 +51,7 @@ mkdir -p root/var/db/pkg
 mkdir -p root/${SYSCONFDIR}
 touch root/${SYSCONFDIR}/ld.so.conf
 
-mkdir -p repo1/{eclass,distfiles,profiles/testprofile,cat/{a,b,c,d,e,u,v,w,x,y,z}/files} || exit 1
+mkdir -p repo1/{eclass,distfiles,profiles/testprofile,cat/{a,b,c,d,e,p,q,r,s,t,u,v,w,x,y,z}/files} || exit 1
 
 cd repo1 || exit 1
 echo "test-repo-1" > profiles/repo_name || exit 1
@@ -252,5 +252,84 @@ src_install() {
 }
 END
 
+cat <<"END" > cat/t/t-1.ebuild || exit 1
+DESCRIPTION="Test t"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND="cat/s"
+
+src_install() {
+    mkdir -p ${D}${TEST_ROOT}
+    touch ${D}${TEST_ROOT}/t
+}
+END
+
+cat <<"END" > cat/s/s-1.ebuild || exit 1
+DESCRIPTION="Test s"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND=""
+
+pkg_setup() {
+    die "supposed to fail"
+}
+END
+
+cat <<"END" > cat/r/r-1.ebuild || exit 1
+DESCRIPTION="Test r"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND=""
+
+src_install() {
+    mkdir -p ${D}${TEST_ROOT}
+    touch ${D}${TEST_ROOT}/r
+}
+END
+
+cat <<"END" > cat/q/q-1.ebuild || exit 1
+DESCRIPTION="Test q"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND=""
+
+src_install() {
+    mkdir -p ${D}${TEST_ROOT}
+    touch ${D}${TEST_ROOT}/q
+}
+END
+
+cat <<"END" > cat/p/p-1.ebuild || exit 1
+DESCRIPTION="Test p"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND="cat/q"
+
+src_install() {
+    mkdir -p ${D}${TEST_ROOT}
+    touch ${D}${TEST_ROOT}/p
+}
+END
+
 cd ..
 
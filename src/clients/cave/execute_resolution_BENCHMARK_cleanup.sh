@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+if [ -d execute_resolution_BENCHMARK_dir ] ; then
+    rm -fr execute_resolution_BENCHMARK_dir
+else
+    true
+fi
+
@@ -0,0 +1,97 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir execute_resolution_BENCHMARK_dir || exit 1
+cd execute_resolution_BENCHMARK_dir || exit 1
+
+mkdir -p build
+mkdir -p config/.paludis-execute-resolution-benchmark/repositories
+
+cat <<END > config/.paludis-execute-resolution-benchmark/specpath.conf
+config-suffix =
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/use.conf
+*/* foo
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/licenses.conf
+*/* *
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/keywords.conf
+*/* test
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/general.conf
+world = `pwd`/root/world
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/bashrc
+export CHOST="my-chost"
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/repositories/repo1.conf
+location = `pwd`/repo1
+cache = /var/empty
+format = e
+names_cache = /var/empty
+profiles = \${location}/profiles/testprofile
+builddir = `pwd`/build
+END
+
+cat <<END > config/.paludis-execute-resolution-benchmark/repositories/installed.conf
+location = `pwd`/root/var/db/pkg
+format = vdb
+names_cache = /var/empty
+builddir = `pwd`/build
+END
+
+mkdir -p root/tmp
+mkdir -p root/var/db/pkg
+mkdir -p root/${SYSCONFDIR}
+touch root/${SYSCONFDIR}/ld.so.conf
+
+mkdir -p repo1/{eclass,distfiles,profiles/testprofile,cat/everything} || exit 1
+cd repo1 || exit 1
+echo "test-repo-1" > profiles/repo_name || exit 1
+cat <<END > profiles/categories || exit 1
+cat
+END
+cat <<END > profiles/testprofile/make.defaults
+ARCH=test
+USERLAND=test
+KERNEL=test
+TESTPROFILE_WAS_SOURCED=yes
+PROFILE_ORDERING=1
+USE_EXPAND="USERLAND KERNEL"
+END
+
+everything=
+for p in $(seq 1 10) ; do
+    mkdir -p cat/pkg${p} || exit 1
+    cat <<END > cat/pkg${p}/pkg${p}-1.ebuild || exit 1
+DESCRIPTION="Benchmark package ${p}"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND=""
+END
+    everything="${everything} cat/pkg${p}"
+done
+
+cat <<END > cat/everything/everything-1.ebuild || exit 1
+DESCRIPTION="Depends upon every benchmark package"
+HOMEPAGE="http://paludis.exherbo.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+RDEPEND="${everything}"
+END
+
+cd ..
@@ -31,11 +31,13 @@
 #include <paludis/repository.hh>
 #include <paludis/selection.hh>
 #include <paludis/util/indirect_iterator-impl.hh>
+#include <paludis/util/sequence.hh>
 #include <paludis/util/wrapped_forward_iterator.hh>
 #include <paludis/util/fs_stat.hh>
 #include <paludis/util/stringify.hh>
 #include <algorithm>
 #include <functional>
+#include <map>
 
 using namespace paludis;
 
@@ -55,6 +57,13 @@ namespace
     {
         return std::string::npos != stringify(e->location_key()->parse_value()).find(q);
     }
+
+    bool handle_within(const std::string & q, const std::shared_ptr<const ContentsEntry> & e)
+    {
+        std::string l(stringify(e->location_key()->parse_value()));
+        std::string prefix("/" == q ? q : q + "/");
+        return q == l || 0 == l.compare(0, prefix.length(), prefix);
+    }
 }
 
 int
@@ -70,6 +79,12 @@ paludis::cave::owner_common(
     std::function<bool (const std::string &, const std::shared_ptr<const ContentsEntry> &)> handler;
     std::string query(q);
 
+    /* full and within matches can be answered by a repository's file owner
+     * index, if it has one, rather than by going through every ID's
+     * contents */
+    bool use_index(false);
+    bool within(false);
+
     if (dereference)
     {
         FSPath query_path(query);
@@ -85,15 +100,27 @@ paludis::cave::owner_common(
         query.erase(query.length() - 1);
 
     if ("full" == type)
+    {
         handler = handle_full;
+        use_index = true;
+    }
     else if ("basename" == type)
         handler = handle_basename;
     else if ("partial" == type)
         handler = handle_partial;
+    else if ("within" == type)
+    {
+        handler = handle_within;
+        use_index = true;
+        within = true;
+    }
     else
     {
         if (! query.empty() && '/' == query.at(0))
+        {
             handler = handle_full;
+            use_index = true;
+        }
         else if (std::string::npos != query.find('/'))
             handler = handle_partial;
         else
@@ -103,8 +130,29 @@ paludis::cave::owner_common(
     std::shared_ptr<const PackageIDSequence> ids((*env)[selection::AllVersionsSorted(generator::All() |
                 filter::InstalledAtRoot(env->preferred_root_key()->parse_value()) | matching )]);
 
+    std::map<RepositoryName, std::shared_ptr<const PackageIDSequence> > index_owners;
+
     for (const auto & id : *ids)
     {
+        auto repo(env->fetch_repository(id->repository_name()));
+        if (use_index && repo->file_owner_interface())
+        {
+            auto o(index_owners.find(repo->name()));
+            if (index_owners.end() == o)
+                o = index_owners.insert(std::make_pair(repo->name(), within ?
+                            repo->file_owner_interface()->file_owners_within(FSPath(query)) :
+                            repo->file_owner_interface()->file_owners(FSPath(query)))).first;
+
+            if (o->second->end() != std::find_if(o->second->begin(), o->second->end(),
+                        [&] (const std::shared_ptr<const PackageID> & i) { return *i == *id; }))
+            {
+                callback(id);
+                found = true;
+            }
+
+            continue;
+        }
+
         std::shared_ptr<const Contents> contents(id->contents());
         if (! contents)
             continue;
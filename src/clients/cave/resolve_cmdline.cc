@@ -397,6 +397,9 @@ ResolveCommandLineExecutionOptions::ResolveCommandLineExecutionOptions(args::Arg
     a_fetch_jobs(&g_jobs_options, "fetch-jobs", 'J', "The number of parallel fetch jobs to launch. If set to 0, fetches "
             "will be carried out sequentially with other jobs. Values higher than 1 are currently treated "
             "as being 1. Defaults to 1, or if --fetch is specified, 0."),
+    a_install_jobs(&g_jobs_options, "install-jobs", '\0', "The number of install and uninstall jobs to run at once. "
+            "A job is only started once every job it depends upon has finished, uninstalls are carried out on "
+            "their own, and merging into a repository is serialised. Defaults to 1."),
 
     g_phase_options(this, "Phase Options", "Options controlling which phases to execute. No sanity checking "
             "is done, allowing you to shoot as many feet off as you desire. Phase names do not have the "
@@ -417,6 +420,7 @@ ResolveCommandLineExecutionOptions::ResolveCommandLineExecutionOptions(args::Arg
             "all")
 {
     a_fetch_jobs.set_argument(-1);
+    a_install_jobs.set_argument(1);
 }
 
 ResolveCommandLineProgramOptions::ResolveCommandLineProgramOptions(args::ArgsHandler * const h) :
@@ -434,6 +438,10 @@ ResolveCommandLineProgramOptions::ResolveCommandLineProgramOptions(args::ArgsHan
             "the resolution. Defaults to '$CAVE execute-resolution'."),
     a_perform_program(&g_program_options, "perform-program", '\0', "The program used to perform "
             "actions. Defaults to '$CAVE perform'."),
+    a_perform_in_subprocesses(&g_program_options, "perform-in-subprocesses", '\0', "Perform each action "
+            "in a new process, rather than using the already loaded configuration and repositories. Implied "
+            "by --perform-program. Fetches running alongside other jobs, and jobs run in parallel using "
+            "--install-jobs, always use a new process.", true),
     a_update_world_program(&g_program_options, "update-world-program", '\0', "The program used to perform "
             "world updates. Defaults to '$CAVE update-world'."),
     a_graph_program(&g_program_options, "graph-program", '\0', "The program used to create Graphviz graphs. "
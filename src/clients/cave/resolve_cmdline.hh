@@ -138,6 +138,7 @@ namespace paludis
             args::ArgsGroup g_jobs_options;
             args::SwitchArg a_fetch;
             args::IntegerArg a_fetch_jobs;
+            args::IntegerArg a_install_jobs;
 
             args::ArgsGroup g_phase_options;
             args::StringSetArg a_skip_phase;
@@ -183,6 +184,7 @@ namespace paludis
             args::StringArg a_graph_jobs_program;
             args::StringArg a_execute_resolution_program;
             args::StringArg a_perform_program;
+            args::SwitchArg a_perform_in_subprocesses;
             args::StringArg a_update_world_program;
             args::StringArg a_graph_program;
         };
@@ -111,6 +111,9 @@
 #include <list>
 #include <map>
 #include <thread>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
 
 #include "config.h"
 
@@ -586,7 +589,25 @@ namespace
         }
     };
 
-    void display_restarts_if_requested(const std::list<SuggestRestart> & restarts,
+    struct Restart
+    {
+        SuggestRestart suggestion;
+
+        /// How long the attempt that ended with this restart took.
+        std::chrono::steady_clock::duration time_taken;
+
+        /// How many decisions were kept, or -1 if we started from scratch.
+        int decisions_kept;
+    };
+
+    std::string format_seconds(const std::chrono::steady_clock::duration & d)
+    {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3) << std::chrono::duration<double>(d).count() << "s";
+        return s.str();
+    }
+
+    void display_restarts_if_requested(const std::list<Restart> & restarts,
             const ResolveCommandLineResolutionOptions & resolution_options)
     {
         if (! resolution_options.a_dump_restarts.specified())
@@ -594,10 +615,22 @@ namespace
 
         std::cout << "Dumping restarts:" << std::endl << std::endl;
 
-        for (const auto & restart : restarts)
+        int number(0);
+        std::chrono::steady_clock::duration total_time(0);
+        for (const auto & r : restarts)
         {
+            const SuggestRestart & restart(r.suggestion);
+            total_time += r.time_taken;
+
             std::cout << "* " << restart.resolvent() << std::endl;
 
+            std::cout << "    Restart " << ++number << " after " << format_seconds(r.time_taken) << ", ";
+            if (-1 == r.decisions_kept)
+                std::cout << "starting again from scratch";
+            else
+                std::cout << "keeping " << r.decisions_kept << " decisions";
+            std::cout << std::endl;
+
             std::cout << "    Had decided upon ";
             auto c(get_decided_id_or_null(restart.previous_decision()));
             if (c)
@@ -615,6 +648,7 @@ namespace
             std::cout << std::endl;
         }
 
+        std::cout << std::endl << number << " restarts took " << format_seconds(total_time) << std::endl;
         std::cout << std::endl;
     }
 
@@ -1088,7 +1122,7 @@ paludis::cave::resolve_common(
     std::shared_ptr<Resolver> resolver(std::make_shared<Resolver>(env.get(), resolver_functions));
     bool is_set(false);
     std::shared_ptr<const Sequence<std::string> > targets_cleaned_up;
-    std::list<SuggestRestart> restarts;
+    std::list<Restart> restarts;
 
     try
     {
@@ -1097,17 +1131,22 @@ paludis::cave::resolve_common(
             ScopedNotifierCallback display_callback_holder(env.get(),
                     NotifierCallbackFunction(std::cref(display_callback)));
 
-            bool first(true);
+            bool first(true), add_targets(true);
+            auto attempt_start(std::chrono::steady_clock::now());
             while (true)
             {
                 try
                 {
-                    if (purge)
+                    /* if we're carrying on after a restart, we already have them */
+                    if (add_targets)
                     {
-                        resolver->purge();
-                        targets_cleaned_up = std::make_shared<Sequence<std::string>>();
-                    } else
-                        targets_cleaned_up = add_resolver_targets(env, resolver, resolution_options, targets_if_not_purge, is_set);
+                        if (purge)
+                        {
+                            resolver->purge();
+                            targets_cleaned_up = std::make_shared<Sequence<std::string>>();
+                        } else
+                            targets_cleaned_up = add_resolver_targets(env, resolver, resolution_options, targets_if_not_purge, is_set);
+                    }
 
                     if (first)
                     {
@@ -1132,10 +1171,24 @@ paludis::cave::resolve_common(
                 }
                 catch (const SuggestRestart & e)
                 {
-                    restarts.push_back(e);
                     display_callback(ResolverRestart());
                     get_initial_constraints_for_helper.add_suggested_restart(e);
-                    resolver = std::make_shared<Resolver>(env.get(), resolver_functions);
+
+                    /* if we can, only redo the decisions that the restart could have affected */
+                    int decisions_kept(-1);
+                    add_targets = ! resolver->restart_from(e);
+                    if (add_targets)
+                        resolver = std::make_shared<Resolver>(env.get(), resolver_functions);
+                    else
+                    {
+                        const auto & resolutions(*resolver->resolved()->resolutions_by_resolvent());
+                        decisions_kept = std::count_if(resolutions.begin(), resolutions.end(),
+                                [] (const std::shared_ptr<Resolution> & r) { return bool(r->decision()); });
+                    }
+
+                    auto now(std::chrono::steady_clock::now());
+                    restarts.push_back(Restart{ e, now - attempt_start, decisions_kept });
+                    attempt_start = now;
 
                     if (restarts.size() > 9000)
                         throw InternalError(PALUDIS_HERE, "Restarted over nine thousand times. Something's "
@@ -19,8 +19,10 @@
 
 #include "search_extras.hh"
 #include <paludis/util/exception.hh>
+#include <paludis/util/log.hh>
 #include <paludis/util/stringify.hh>
 #include <sqlite3.h>
+#include <vector>
 
 using namespace paludis;
 
@@ -28,33 +30,200 @@ struct CaveSearchExtrasDB
 {
     sqlite3 * db;
     sqlite3_stmt * add_candidate;
+    sqlite3_stmt * add_text;
+    sqlite3_stmt * add_keyword;
+
+    bool has_text_index;
 };
 
+namespace
+{
+    /* bump this whenever the tables change, so that old indexes are
+     * rejected rather than giving strange results */
+    const int schema_version(2);
+
+    void exec(CaveSearchExtrasDB * const data, const std::string & sql)
+    {
+        if (SQLITE_OK != sqlite3_exec(data->db, sql.c_str(), nullptr, nullptr, nullptr))
+            throw InternalError(PALUDIS_HERE, "sqlite3_exec '" + sql + "' failed: " + stringify(sqlite3_errmsg(data->db)));
+    }
+
+    sqlite3_stmt * prepare(CaveSearchExtrasDB * const data, const std::string & sql)
+    {
+        sqlite3_stmt * result;
+        if (SQLITE_OK != sqlite3_prepare_v2(data->db, sql.c_str(), -1, &result, nullptr))
+            throw InternalError(PALUDIS_HERE, "sqlite3_prepare_v2 '" + sql + "' failed: " + stringify(sqlite3_errmsg(data->db)));
+        return result;
+    }
+
+    void reset(CaveSearchExtrasDB * const data, sqlite3_stmt * const stmt)
+    {
+        if (SQLITE_OK != sqlite3_reset(stmt))
+            throw InternalError(PALUDIS_HERE, "sqlite3_reset failed: " + stringify(sqlite3_errmsg(data->db)));
+        if (SQLITE_OK != sqlite3_clear_bindings(stmt))
+            throw InternalError(PALUDIS_HERE, "sqlite3_clear_bindings failed: " + stringify(sqlite3_errmsg(data->db)));
+    }
+
+    void bind_text(CaveSearchExtrasDB * const data, sqlite3_stmt * const stmt, const int n, const std::string & value)
+    {
+        if (SQLITE_OK != sqlite3_bind_text(stmt, n, value.c_str(), value.length(), SQLITE_TRANSIENT))
+            throw InternalError(PALUDIS_HERE, "sqlite3_bind_text " + stringify(n) + " failed: " + stringify(sqlite3_errmsg(data->db)));
+    }
+
+    void bind_int(CaveSearchExtrasDB * const data, sqlite3_stmt * const stmt, const int n, const sqlite3_int64 value)
+    {
+        if (SQLITE_OK != sqlite3_bind_int64(stmt, n, value))
+            throw InternalError(PALUDIS_HERE, "sqlite3_bind_int64 " + stringify(n) + " failed: " + stringify(sqlite3_errmsg(data->db)));
+    }
+
+    void step_done(CaveSearchExtrasDB * const data, sqlite3_stmt * const stmt)
+    {
+        int code;
+        if (SQLITE_DONE != (code = sqlite3_step(stmt)))
+            throw InternalError(PALUDIS_HERE, "sqlite3_step failed: " + stringify(code) + ": " + stringify(sqlite3_errmsg(data->db)));
+    }
+
+    /* runs a statement with text parameters, returning the first column of
+     * any rows it produces */
+    void run_query(CaveSearchExtrasDB * const data, const std::string & sql,
+            const std::vector<std::string> & params, std::list<std::string> & out)
+    {
+        sqlite3_stmt * stmt(prepare(data, sql));
+        try
+        {
+            for (std::vector<std::string>::size_type i(0) ; i != params.size() ; ++i)
+                bind_text(data, stmt, i + 1, params[i]);
+
+            while (true)
+            {
+                int code(sqlite3_step(stmt));
+                if (code == SQLITE_DONE)
+                    break;
+                else if (code == SQLITE_ROW)
+                    out.push_back(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+                else
+                    throw InternalError(PALUDIS_HERE, "sqlite3_step '" + sql + "' failed: " + stringify(code));
+            }
+        }
+        catch (...)
+        {
+            sqlite3_finalize(stmt);
+            throw;
+        }
+
+        sqlite3_finalize(stmt);
+    }
+
+    CaveSearchExtrasDB * open_db_without_checks(const std::string & file)
+    {
+        auto data(new CaveSearchExtrasDB);
+        data->add_candidate = nullptr;
+        data->add_text = nullptr;
+        data->add_keyword = nullptr;
+        data->has_text_index = false;
+
+        if (SQLITE_OK != sqlite3_open(file.c_str(), &data->db))
+        {
+            delete data;
+            throw InternalError(PALUDIS_HERE, "sqlite3_open failed");
+        }
+
+        return data;
+    }
+
+    bool has_table(CaveSearchExtrasDB * const data, const std::string & name)
+    {
+        std::list<std::string> names;
+        run_query(data, "select name from sqlite_master where name = ?1", { name }, names);
+        return ! names.empty();
+    }
+
+    /* phrase queries against a trigram index match substrings, but only
+     * for at least three characters */
+    bool usable_for_text_index(const std::string & text)
+    {
+        unsigned characters(0);
+        for (char c : text)
+            if (0x80 != (static_cast<unsigned char>(c) & 0xc0))
+                ++characters;
+        return characters >= 3;
+    }
+
+    std::string like_pattern(const std::string & text)
+    {
+        std::string result("%");
+        for (char c : text)
+            switch (c)
+            {
+                case '%':
+                case '_':
+                case '\\':
+                    result.append(1, '\\');
+                    /* fall through */
+                default:
+                    result.append(1, c);
+            }
+        result.append("%");
+        return result;
+    }
+
+    std::string fts_phrase(const std::string & text)
+    {
+        std::string result("\"");
+        for (char c : text)
+        {
+            if (c == '"')
+                result.append(1, '"');
+            result.append(1, c);
+        }
+        result.append("\"");
+        return result;
+    }
+}
+
 extern "C"
 CaveSearchExtrasDB *
 cave_search_extras_create_db(const std::string & file)
 {
-    auto data(cave_search_extras_open_db(file));
-
-    if (SQLITE_OK != sqlite3_exec(data->db, "drop table if exists candidates", nullptr, nullptr, nullptr))
-        throw InternalError(PALUDIS_HERE, "sqlite3_exec drop candidates failed");
-
-    if (SQLITE_OK != sqlite3_exec(data->db, "create table candidates ( "
-                "spec text not null primary key, "
-                "is_visible int not null, "
-                "is_best int not_null, "
-                "is_best_visible int not_null, "
-                "name text not null, "
-                "short_desc text not null, "
-                "long_desc text not null"
-                ")", nullptr, nullptr, nullptr))
-        throw InternalError(PALUDIS_HERE, "sqlite3_exec create candidates failed");
-
-    if (SQLITE_OK != sqlite3_prepare_v2(data->db, "insert into candidates "
-                "( spec, is_visible, is_best, is_best_visible, name, short_desc, long_desc ) "
-                "values ( ?1, ?2, ?3, ?4, ?5, ?6, ?7 )",
-                -1, &data->add_candidate, nullptr))
-        throw InternalError(PALUDIS_HERE, "sqlite3_prepare_v2 insert into candidates failed");
+    auto data(open_db_without_checks(file));
+
+    exec(data, "drop table if exists candidates_text");
+    exec(data, "drop table if exists keywords");
+    exec(data, "drop table if exists candidates");
+
+    exec(data, "create table candidates ( "
+            "spec text not null primary key, "
+            "is_visible int not null, "
+            "is_best int not_null, "
+            "is_best_visible int not_null, "
+            "name text not null, "
+            "repository text not null, "
+            "slot text not null, "
+            "short_desc text not null, "
+            "long_desc text not null, "
+            "homepage text not null"
+            ")");
+    exec(data, "create index candidates_name on candidates ( name )");
+    exec(data, "create index candidates_repository on candidates ( repository )");
+
+    /* candidate is the rowid of the entry in candidates */
+    exec(data, "create table keywords ( "
+            "candidate int not null, "
+            "keyword text not null"
+            ")");
+    exec(data, "create index keywords_keyword on keywords ( keyword )");
+    exec(data, "create index keywords_candidate on keywords ( candidate )");
+
+    /* the trigram tokeniser needs sqlite 3.34 built with fts5. without it
+     * we still work, just with a full scan for every text search */
+    if (SQLITE_OK == sqlite3_exec(data->db, "create virtual table candidates_text using fts5 ( "
+                "name, short_desc, long_desc, homepage, tokenize = 'trigram' )", nullptr, nullptr, nullptr))
+        data->has_text_index = true;
+    else
+        Log::get_instance()->message("cave.search_index.no_text_index", ll_warning, lc_context)
+            << "Could not create a full text index, so text searches will be slow. sqlite said: " << sqlite3_errmsg(data->db);
+
+    exec(data, "pragma user_version = " + stringify(schema_version));
 
     return data;
 }
@@ -62,11 +231,23 @@ cave_search_extras_create_db(const std::string & file)
 extern "C" CaveSearchExtrasDB *
 cave_search_extras_open_db(const std::string & file)
 {
-    auto data(new CaveSearchExtrasDB);
-    if (SQLITE_OK != sqlite3_open(file.c_str(), &data->db))
-        throw InternalError(PALUDIS_HERE, "sqlite3_open failed");
+    auto data(open_db_without_checks(file));
 
-    data->add_candidate = nullptr;
+    try
+    {
+        std::list<std::string> version;
+        run_query(data, "pragma user_version", { }, version);
+        if (version.empty() || version.front() != stringify(schema_version))
+            throw ConfigurationError("Search index '" + file + "' was not created by this version of cave, "
+                    "and must be recreated using 'cave manage-search-index --create'");
+
+        data->has_text_index = has_table(data, "candidates_text");
+    }
+    catch (...)
+    {
+        cave_search_extras_cleanup(data);
+        throw;
+    }
 
     return data;
 }
@@ -77,6 +258,10 @@ cave_search_extras_cleanup(CaveSearchExtrasDB * const data)
 {
     if (data->add_candidate)
         sqlite3_finalize(data->add_candidate);
+    if (data->add_text)
+        sqlite3_finalize(data->add_text);
+    if (data->add_keyword)
+        sqlite3_finalize(data->add_keyword);
 
     sqlite3_close(data->db);
     delete data;
@@ -86,120 +271,152 @@ extern "C"
 void
 cave_search_extras_add_candidate(
         CaveSearchExtrasDB * const data,
-        const std::string & spec,
-        const bool visible,
-        const bool best,
-        const bool best_visible,
-        const std::string & name,
-        const std::string & short_desc,
-        const std::string & long_desc)
+        const CaveSearchExtrasCandidate & candidate)
+{
+    reset(data, data->add_candidate);
+    bind_text(data, data->add_candidate, 1, candidate.spec());
+    bind_int(data, data->add_candidate, 2, candidate.visible() ? 1 : 0);
+    bind_int(data, data->add_candidate, 3, candidate.best() ? 1 : 0);
+    bind_int(data, data->add_candidate, 4, candidate.best_visible() ? 1 : 0);
+    bind_text(data, data->add_candidate, 5, candidate.name());
+    bind_text(data, data->add_candidate, 6, candidate.repository());
+    bind_text(data, data->add_candidate, 7, candidate.slot());
+    bind_text(data, data->add_candidate, 8, candidate.short_description());
+    bind_text(data, data->add_candidate, 9, candidate.long_description());
+    bind_text(data, data->add_candidate, 10, candidate.homepage());
+    step_done(data, data->add_candidate);
+
+    sqlite3_int64 rowid(sqlite3_last_insert_rowid(data->db));
+
+    if (data->has_text_index)
+    {
+        reset(data, data->add_text);
+        bind_int(data, data->add_text, 1, rowid);
+        bind_text(data, data->add_text, 2, candidate.name());
+        bind_text(data, data->add_text, 3, candidate.short_description());
+        bind_text(data, data->add_text, 4, candidate.long_description());
+        bind_text(data, data->add_text, 5, candidate.homepage());
+        step_done(data, data->add_text);
+    }
+
+    for (const auto & keyword : candidate.keywords())
+    {
+        reset(data, data->add_keyword);
+        bind_int(data, data->add_keyword, 1, rowid);
+        bind_text(data, data->add_keyword, 2, keyword);
+        step_done(data, data->add_keyword);
+    }
+}
+
+extern "C"
+void
+cave_search_extras_remove_package(
+        CaveSearchExtrasDB * const data,
+        const std::string & name)
 {
-    if (SQLITE_OK != sqlite3_reset(data->add_candidate))
-        throw InternalError(PALUDIS_HERE, "sqlite3_reset add candidate failed");
-    if (SQLITE_OK != sqlite3_clear_bindings(data->add_candidate))
-        throw InternalError(PALUDIS_HERE, "sqlite3_clear_bindings add candidate failed");
-
-    if (SQLITE_OK != sqlite3_bind_text(data->add_candidate, 1, spec.c_str(), spec.length(), SQLITE_TRANSIENT))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 1 failed");
-    if (SQLITE_OK != sqlite3_bind_int(data->add_candidate, 2, visible ? 1 : 0))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 2 failed");
-    if (SQLITE_OK != sqlite3_bind_int(data->add_candidate, 3, best ? 1 : 0))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 3 failed");
-    if (SQLITE_OK != sqlite3_bind_int(data->add_candidate, 4, best_visible ? 1 : 0))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 4 failed");
-    if (SQLITE_OK != sqlite3_bind_text(data->add_candidate, 5, name.c_str(), name.length(), SQLITE_TRANSIENT))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 5 failed");
-    if (SQLITE_OK != sqlite3_bind_text(data->add_candidate, 6, short_desc.c_str(), short_desc.length(), SQLITE_TRANSIENT))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 6 failed");
-    if (SQLITE_OK != sqlite3_bind_text(data->add_candidate, 7, long_desc.c_str(), long_desc.length(), SQLITE_TRANSIENT))
-        throw InternalError(PALUDIS_HERE, "sqlite3_bind_text add candidate 7 failed");
-
-    int code;
-    if (SQLITE_DONE != (code = sqlite3_step(data->add_candidate)))
-        throw InternalError(PALUDIS_HERE, "sqlite3_step failed: " + stringify(code));
+    std::list<std::string> ignored;
+    if (data->has_text_index)
+        run_query(data, "delete from candidates_text where rowid in ( select rowid from candidates where name = ?1 )",
+                { name }, ignored);
+    run_query(data, "delete from keywords where candidate in ( select rowid from candidates where name = ?1 )",
+            { name }, ignored);
+    run_query(data, "delete from candidates where name = ?1", { name }, ignored);
 }
 
 extern "C"
 void
 cave_search_extras_starting_adds(CaveSearchExtrasDB * const data)
 {
-    if (SQLITE_OK != sqlite3_exec(data->db, "begin", nullptr, nullptr, nullptr))
-        throw InternalError(PALUDIS_HERE, "sqlite3_exec begin failed");
+    exec(data, "begin");
+
+    if (! data->add_candidate)
+        data->add_candidate = prepare(data, "insert into candidates "
+                "( spec, is_visible, is_best, is_best_visible, name, repository, slot, short_desc, long_desc, homepage ) "
+                "values ( ?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10 )");
+    if (data->has_text_index && ! data->add_text)
+        data->add_text = prepare(data, "insert into candidates_text "
+                "( rowid, name, short_desc, long_desc, homepage ) "
+                "values ( ?1, ?2, ?3, ?4, ?5 )");
+    if (! data->add_keyword)
+        data->add_keyword = prepare(data, "insert into keywords ( candidate, keyword ) values ( ?1, ?2 )");
 }
 
 extern "C"
 void
 cave_search_extras_done_adds(CaveSearchExtrasDB * const data)
 {
-    if (SQLITE_OK != sqlite3_exec(data->db, "commit", nullptr, nullptr, nullptr))
-        throw InternalError(PALUDIS_HERE, "sqlite3_exec commit failed");
+    exec(data, "commit");
 }
 
 extern "C"
 void
 cave_search_extras_find_candidates(CaveSearchExtrasDB * const data,
         std::list<std::string> & out,
-        const bool all_versions, const bool visible,
-        const std::string & name_description_substring_hint)
+        const CaveSearchExtrasQuery & query)
 {
-    sqlite3_stmt * find_candidates;
-
-    std::string s;
-    if (all_versions && visible)
-        s = "is_visible";
-    else if (visible)
-        s = "is_best_visible";
-    else if (all_versions)
-        s = "1";
-    else
-        s = "is_best";
-
-    std::string h;
-    std::string p1;
-    if (! name_description_substring_hint.empty())
-    {
-        h = " and ( name like ?1 escape '\\' or short_desc like ?1 escape '\\' or long_desc like ?1 escape '\\' )";
-
-        p1 = "%";
-        for (char c : name_description_substring_hint)
-            switch (c)
-            {
-                case '%':
-                case '_':
-                case '\\':
-                    p1.append(1, '\\');
-                    /* fall through */
-                default:
-                    p1.append(1, c);
-            }
-        p1.append("%");
-    }
+    std::vector<std::string> params;
+    auto param([&] (const std::string & value) -> std::string {
+            params.push_back(value);
+            return "?" + stringify(params.size());
+            });
 
-    int code;
-    if (SQLITE_OK != ((code = sqlite3_prepare_v2(data->db, ("select spec from candidates where " + s + " = 1" + h).c_str(), -1, &find_candidates, nullptr))))
-        throw InternalError(PALUDIS_HERE, "sqlite3_prepare_v2 select from candidates failed:" + stringify(code));
+    std::string sql("select spec from candidates where ");
+    if (query.all_versions() && query.visible())
+        sql.append("is_visible = 1");
+    else if (query.visible())
+        sql.append("is_best_visible = 1");
+    else if (query.all_versions())
+        sql.append("1 = 1");
+    else
+        sql.append("is_best = 1");
 
-    if (! p1.empty())
+    std::list<std::string> columns;
+    if (query.text_in_names())
+        columns.push_back("name");
+    if (query.text_in_descriptions())
     {
-        if (SQLITE_OK != sqlite3_bind_text(find_candidates, 1, p1.c_str(), p1.length(), SQLITE_TRANSIENT))
-            throw InternalError(PALUDIS_HERE, "sqlite3_bind_text select from candidates 1 failed");
+        columns.push_back("short_desc");
+        columns.push_back("long_desc");
     }
+    if (query.text_in_homepages())
+        columns.push_back("homepage");
 
-    while (true)
+    if ((! query.text().empty()) && (! columns.empty()))
     {
-        code = sqlite3_step(find_candidates);
-
-        if (code == SQLITE_DONE)
-            break;
-        else if (code == SQLITE_ROW)
+        if (data->has_text_index && usable_for_text_index(query.text()))
         {
-            std::string text(reinterpret_cast<const char *>(sqlite3_column_text(find_candidates, 0)));
-            out.push_back(text);
+            std::string filter;
+            for (const auto & column : columns)
+                filter.append((filter.empty() ? "" : " ") + column);
+
+            sql.append(" and rowid in ( select rowid from candidates_text where candidates_text match "
+                    + param("{" + filter + "} : " + fts_phrase(query.text())) + " )");
         }
         else
-            throw InternalError(PALUDIS_HERE, "sqlite3_step select from candidates failed:" + stringify(code));
+        {
+            std::string p(param(like_pattern(query.text())));
+            std::string filter;
+            for (const auto & column : columns)
+                filter.append((filter.empty() ? "" : " or ") + column + " like " + p + " escape '\\'");
+
+            sql.append(" and ( " + filter + " )");
+        }
     }
 
-    sqlite3_finalize(find_candidates);
+    for (const auto & keyword : query.keywords())
+        sql.append(" and rowid in ( select candidate from keywords where keyword = " + param(keyword) + " )");
+
+    if (! query.slot().empty())
+        sql.append(" and slot = " + param(query.slot()));
+
+    run_query(data, sql, params, out);
 }
 
+extern "C"
+void
+cave_search_extras_find_package_names(CaveSearchExtrasDB * const data,
+        std::list<std::string> & out,
+        const std::string & repository)
+{
+    run_query(data, "select distinct name from candidates where repository = ?1", { repository }, out);
+}
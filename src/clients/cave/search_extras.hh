@@ -21,11 +21,72 @@
 #define PALUDIS_GUARD_SRC_CLIENTS_CAVE_SEARCH_EXTRAS_HH 1
 
 #include <paludis/util/attributes.hh>
+#include <paludis/util/named_value.hh>
 #include <string>
 #include <list>
 
+namespace paludis
+{
+    namespace n
+    {
+        typedef Name<struct name_all_versions> all_versions;
+        typedef Name<struct name_best> best;
+        typedef Name<struct name_best_visible> best_visible;
+        typedef Name<struct name_homepage> homepage;
+        typedef Name<struct name_keywords> keywords;
+        typedef Name<struct name_long_description> long_description;
+        typedef Name<struct name_name> name;
+        typedef Name<struct name_repository> repository;
+        typedef Name<struct name_short_description> short_description;
+        typedef Name<struct name_slot> slot;
+        typedef Name<struct name_spec> spec;
+        typedef Name<struct name_text> text;
+        typedef Name<struct name_text_in_descriptions> text_in_descriptions;
+        typedef Name<struct name_text_in_homepages> text_in_homepages;
+        typedef Name<struct name_text_in_names> text_in_names;
+        typedef Name<struct name_visible> visible;
+    }
+}
+
 struct CaveSearchExtrasDB;
 
+/**
+ * One package version, as stored in a search index.
+ */
+struct CaveSearchExtrasCandidate
+{
+    paludis::NamedValue<paludis::n::best, bool> best;
+    paludis::NamedValue<paludis::n::best_visible, bool> best_visible;
+    paludis::NamedValue<paludis::n::homepage, std::string> homepage;
+    paludis::NamedValue<paludis::n::keywords, std::list<std::string> > keywords;
+    paludis::NamedValue<paludis::n::long_description, std::string> long_description;
+    paludis::NamedValue<paludis::n::name, std::string> name;
+    paludis::NamedValue<paludis::n::repository, std::string> repository;
+    paludis::NamedValue<paludis::n::short_description, std::string> short_description;
+    paludis::NamedValue<paludis::n::slot, std::string> slot;
+    paludis::NamedValue<paludis::n::spec, std::string> spec;
+    paludis::NamedValue<paludis::n::visible, bool> visible;
+};
+
+/**
+ * What to look for in a search index.
+ *
+ * If text is not empty, candidates must contain it, ignoring case, in one of
+ * the selected fields. Every keyword must be present, and if slot is not
+ * empty, it must match exactly.
+ */
+struct CaveSearchExtrasQuery
+{
+    paludis::NamedValue<paludis::n::all_versions, bool> all_versions;
+    paludis::NamedValue<paludis::n::keywords, std::list<std::string> > keywords;
+    paludis::NamedValue<paludis::n::slot, std::string> slot;
+    paludis::NamedValue<paludis::n::text, std::string> text;
+    paludis::NamedValue<paludis::n::text_in_descriptions, bool> text_in_descriptions;
+    paludis::NamedValue<paludis::n::text_in_homepages, bool> text_in_homepages;
+    paludis::NamedValue<paludis::n::text_in_names, bool> text_in_names;
+    paludis::NamedValue<paludis::n::visible, bool> visible;
+};
+
 extern "C" CaveSearchExtrasDB * cave_search_extras_create_db(const std::string &) PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
 
 extern "C" CaveSearchExtrasDB * cave_search_extras_open_db(const std::string &) PALUDIS_VISIBLE PALUDIS_ATTRIBUTE((warn_unused_result));
@@ -34,12 +95,16 @@ extern "C" void cave_search_extras_cleanup(CaveSearchExtrasDB * const) PALUDIS_V
 
 extern "C" void cave_search_extras_starting_adds(CaveSearchExtrasDB * const) PALUDIS_VISIBLE;
 
-extern "C" void cave_search_extras_add_candidate(CaveSearchExtrasDB * const, const std::string &,
-        const bool, const bool, const bool, const std::string &, const std::string &, const std::string &) PALUDIS_VISIBLE;
+extern "C" void cave_search_extras_add_candidate(CaveSearchExtrasDB * const, const CaveSearchExtrasCandidate &) PALUDIS_VISIBLE;
+
+extern "C" void cave_search_extras_remove_package(CaveSearchExtrasDB * const, const std::string &) PALUDIS_VISIBLE;
 
 extern "C" void cave_search_extras_done_adds(CaveSearchExtrasDB * const) PALUDIS_VISIBLE;
 
 extern "C" void cave_search_extras_find_candidates(CaveSearchExtrasDB * const, std::list<std::string> &,
-        const bool, const bool, const std::string &) PALUDIS_VISIBLE;
+        const CaveSearchExtrasQuery &) PALUDIS_VISIBLE;
+
+extern "C" void cave_search_extras_find_package_names(CaveSearchExtrasDB * const, std::list<std::string> &,
+        const std::string &) PALUDIS_VISIBLE;
 
 #endif
@@ -44,8 +44,10 @@ SearchExtrasHandle::SearchExtrasHandle() :
     cleanup_db_function(nullptr),
     starting_adds_function(nullptr),
     add_candidate_function(nullptr),
+    remove_package_function(nullptr),
     done_adds_function(nullptr),
-    find_candidates_function(nullptr)
+    find_candidates_function(nullptr),
+    find_package_names_function(nullptr)
 {
 #ifndef ENABLE_SEARCH_INDEX
     throw NotAvailableError("cave was built without support for search indexes");
@@ -70,6 +72,10 @@ SearchExtrasHandle::SearchExtrasHandle() :
     if (! add_candidate_function)
         throw args::DoHelp("Search index creation not available because dlsym said " + stringify(::dlerror()));
 
+    remove_package_function = STUPID_CAST(RemovePackageFunction, ::dlsym(handle, "cave_search_extras_remove_package"));
+    if (! remove_package_function)
+        throw args::DoHelp("Search index creation not available because dlsym said " + stringify(::dlerror()));
+
     starting_adds_function = STUPID_CAST(StartingAddsFunction, ::dlsym(handle, "cave_search_extras_starting_adds"));
     if (! starting_adds_function)
         throw args::DoHelp("Search index creation not available because dlsym said " + stringify(::dlerror()));
@@ -81,6 +87,10 @@ SearchExtrasHandle::SearchExtrasHandle() :
     find_candidates_function = STUPID_CAST(FindCandidatesFunction, ::dlsym(handle, "cave_search_extras_find_candidates"));
     if (! find_candidates_function)
         throw args::DoHelp("Search index not available because dlsym said " + stringify(::dlerror()));
+
+    find_package_names_function = STUPID_CAST(FindPackageNamesFunction, ::dlsym(handle, "cave_search_extras_find_package_names"));
+    if (! find_package_names_function)
+        throw args::DoHelp("Search index creation not available because dlsym said " + stringify(::dlerror()));
 #endif
 }
 
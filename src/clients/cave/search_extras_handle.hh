@@ -25,6 +25,8 @@
 #include <string>
 
 struct CaveSearchExtrasDB;
+struct CaveSearchExtrasCandidate;
+struct CaveSearchExtrasQuery;
 
 namespace paludis
 {
@@ -38,13 +40,15 @@ namespace paludis
 
             typedef void (* CleanupDBFunction)(CaveSearchExtrasDB * const);
 
-            typedef void (* AddCandidateFunction)(CaveSearchExtrasDB * const, const std::string &,
-                    const bool, const bool, const bool, const std::string &, const std::string &, const std::string &);
+            typedef void (* AddCandidateFunction)(CaveSearchExtrasDB * const, const CaveSearchExtrasCandidate &);
+            typedef void (* RemovePackageFunction)(CaveSearchExtrasDB * const, const std::string &);
             typedef void (* StartingAddsFunction)(CaveSearchExtrasDB * const);
             typedef void (* DoneAddsFunction)(CaveSearchExtrasDB * const);
 
             typedef void (* FindCandidatesFunction)(CaveSearchExtrasDB * const, std::list<std::string> &,
-                    const bool, const bool, const std::string &);
+                    const CaveSearchExtrasQuery &);
+            typedef void (* FindPackageNamesFunction)(CaveSearchExtrasDB * const, std::list<std::string> &,
+                    const std::string &);
 
             void * handle;
 
@@ -55,9 +59,11 @@ namespace paludis
 
             StartingAddsFunction starting_adds_function;
             AddCandidateFunction add_candidate_function;
+            RemovePackageFunction remove_package_function;
             DoneAddsFunction done_adds_function;
 
             FindCandidatesFunction find_candidates_function;
+            FindPackageNamesFunction find_package_names_function;
 
             SearchExtrasHandle()
 #ifndef ENABLE_SEARCH_INDEX
@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# vim: set ft=sh sw=4 sts=4 et :
+
+mkdir search_index_TEST_dir || exit 1
+cd search_index_TEST_dir || exit 1
+mkdir -p build
+
+mkdir -p config/.paludis-search-index-test/repositories
+cat <<END > config/.paludis-search-index-test/specpath.conf
+config-suffix =
+END
+
+cat <<END > config/.paludis-search-index-test/use.conf
+*/* foo
+END
+
+cat <<END > config/.paludis-search-index-test/licenses.conf
+*/* *
+END
+
+cat <<END > config/.paludis-search-index-test/keywords.conf
+*/* test
+END
+
+cat <<END > config/.paludis-search-index-test/general.conf
+world = `pwd`/root/world
+END
+
+cat <<END > config/.paludis-search-index-test/repositories/repo1.conf
+location = `pwd`/repo1
+cache = /var/empty
+format = e
+names_cache = /var/empty
+profiles = \${location}/profiles/testprofile
+builddir = `pwd`/build
+END
+
+cat <<END > config/.paludis-search-index-test/repositories/installed.conf
+location = `pwd`/root/var/db/pkg
+format = vdb
+names_cache = /var/empty
+builddir = `pwd`/build
+END
+
+mkdir -p root/tmp
+mkdir -p root/var/db/pkg
+mkdir -p root/${SYSCONFDIR}
+touch root/${SYSCONFDIR}/ld.so.conf
+
+mkdir -p repo1/{eclass,distfiles,profiles/testprofile,cat/{alpha,beta,gamma}} || exit 1
+
+cd repo1 || exit 1
+echo "test-repo-1" > profiles/repo_name || exit 1
+cat <<END > profiles/categories || exit 1
+cat
+END
+cat <<END > profiles/testprofile/make.defaults
+ARCH=test
+USERLAND=test
+KERNEL=test
+END
+
+cat <<"END" > cat/alpha/alpha-1.ebuild || exit 1
+DESCRIPTION="A thing for Monkeys"
+HOMEPAGE="http://alpha.example.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="test"
+END
+
+cp cat/alpha/alpha-{1,2}.ebuild || exit 1
+
+cat <<"END" > cat/beta/beta-1.ebuild || exit 1
+DESCRIPTION="Badgers"
+HOMEPAGE="http://beta.example.org/"
+SRC_URI=""
+SLOT="2"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="~test"
+END
+
+cat <<"END" > cat/gamma/gamma-1.ebuild || exit 1
+DESCRIPTION="Nothing to see here"
+HOMEPAGE="http://gamma.example.org/"
+SRC_URI=""
+SLOT="0"
+IUSE=""
+LICENSE="GPL-2"
+KEYWORDS="other"
+END
+
+cd ..
@@ -21,7 +21,7 @@
 #include "exceptions.hh"
 #include "parse_spec_with_nice_error.hh"
 #include <paludis/action.hh>
-#include <paludis/contents.hh>
+#include <paludis/packed_contents.hh>
 #include <paludis/environment.hh>
 #include <paludis/filter.hh>
 #include <paludis/filtered_generator.hh>
@@ -50,38 +50,23 @@ using std::endl;
 
 namespace
 {
-    struct GetSize
+    unsigned long get_size(const PackedContentsEntry & e)
     {
-        unsigned long visit(const ContentsDirEntry &) const
-        {
+        if (pcet_file != e.type)
             return 0;
-        }
 
-        unsigned long visit(const ContentsSymEntry &) const
-        {
-            return 0;
-        }
+        FSPath path{std::string(e.path)};
+        FSStat stat(path);
 
-        unsigned long visit(const ContentsOtherEntry &) const
+        if (stat.is_regular_file_or_symlink_to_regular_file())
+            return stat.file_size();
+        else
         {
+            Log::get_instance()->message("cave.size.missing", ll_warning, lc_context) << "Couldn't get size for '"
+                << path << "'";
             return 0;
         }
-
-        unsigned long visit(const ContentsFileEntry & e) const
-        {
-            FSPath path(e.location_key()->parse_value());
-            FSStat stat(path);
-
-            if (stat.is_regular_file_or_symlink_to_regular_file())
-                return stat.file_size();
-            else
-            {
-                Log::get_instance()->message("cave.size.missing", ll_warning, lc_context) << "Couldn't get size for '"
-                    << path << "'";
-                return 0;
-            }
-        }
-    };
+    }
 }
 
 int
@@ -104,13 +89,9 @@ paludis::cave::size_common(
     for (auto i(best ? entries->last() : entries->begin()), i_end(entries->end()) ;
             i != i_end ; ++i)
     {
-        auto contents((*i)->contents());
-        if (! contents)
-            throw BadIDForCommand(spec, (*i), "does not support listing contents");
-
         unsigned long size(0);
-        for (const auto & entry : *contents)
-            size += entry->accept_returning<unsigned long>(GetSize());
+        if (! (*i)->for_each_contents_entry([&] (const PackedContentsEntry & e) { size += get_size(e); }))
+            throw BadIDForCommand(spec, (*i), "does not support listing contents");
 
         if (purdy)
             cout << pretty_print_bytes(size) << endl;